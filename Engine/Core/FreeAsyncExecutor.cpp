@@ -0,0 +1,177 @@
+#include "../Engine.h"
+
+namespace Engine
+{
+    namespace Core
+    {
+        FreeAsyncExecutor::FreeAsyncExecutor() : Tasks(nullptr), TasksCapacity(0), TasksFirst(0), TasksCount(0),
+                                                 Backpressure(FreeAsyncBackpressure::Coalesce),
+                                                 QueueCapacity(0), IsRunning(false),
+                                                 DroppedCount(0), CoalescedCount(0) {}
+
+        FreeAsyncExecutor::~FreeAsyncExecutor()
+        {
+            Stop();
+            delete[] Tasks;
+        }
+
+        void FreeAsyncExecutor::Start(int ThreadsCount, FreeAsyncBackpressure Backpressure, int QueueCapacity)
+        {
+            if (ThreadsCount < 0)
+                throw std::domain_error("ThreadsCount is less than zero.");
+            if (QueueCapacity < 0)
+                throw std::domain_error("QueueCapacity is less than zero.");
+            if (ThreadsCount == 0)
+                ThreadsCount = std::thread::hardware_concurrency();
+            if (ThreadsCount == 0)
+                ThreadsCount = 1;
+
+            std::lock_guard<std::mutex> guard(Mutex);
+            if (IsRunning)
+                throw std::logic_error("Cannot start twice.");
+            this->Backpressure = Backpressure;
+            this->QueueCapacity = QueueCapacity;
+            DroppedCount = 0;
+            CoalescedCount = 0;
+            IsRunning = true;
+            for (int i = 0; i < ThreadsCount; i++)
+                Threads.Add(new std::thread([this] { WorkerProcess(); }));
+        }
+
+        void FreeAsyncExecutor::Stop()
+        {
+            {
+                std::lock_guard<std::mutex> guard(Mutex);
+                if (!IsRunning)
+                    return;
+                IsRunning = false;
+                while (TasksCount > 0)
+                    UpdateKeyState(PopTask().Key, -1, 0);
+            }
+            Condition.notify_all();
+            Threads.ForEach([](std::thread * Thread) {
+                Thread->join();
+                delete Thread;
+            });
+            Threads.Clear();
+        }
+
+        bool FreeAsyncExecutor::Submit(const void * Key, Utilities::Task<void()> Task)
+        {
+            {
+                std::lock_guard<std::mutex> guard(Mutex);
+                if (!IsRunning)
+                    return false;
+
+                if (Key != nullptr && KeyStates.Contains(Key))
+                {
+                    KeyState state = KeyStates.GetValue(Key);
+                    switch (Backpressure)
+                    {
+                        case FreeAsyncBackpressure::SkipTick:
+                            DroppedCount++;
+                            return false;
+                        case FreeAsyncBackpressure::Coalesce:
+                            if (state.Queued > 0)
+                            {
+                                CoalescedCount++;
+                                return false;
+                            }
+                            break;
+                        case FreeAsyncBackpressure::Enqueue:
+                            break;
+                    }
+                }
+
+                if (QueueCapacity > 0 && TasksCount >= QueueCapacity)
+                {
+                    DroppedCount++;
+                    return false;
+                }
+
+                PushTask(Key, std::move(Task));
+                UpdateKeyState(Key, 1, 0);
+            }
+            Condition.notify_one();
+            return true;
+        }
+
+        long long FreeAsyncExecutor::GetDroppedCount()
+        {
+            return DroppedCount;
+        }
+
+        long long FreeAsyncExecutor::GetCoalescedCount()
+        {
+            return CoalescedCount;
+        }
+
+        inline void FreeAsyncExecutor::PushTask(const void * Key, Utilities::Task<void()> Task)
+        {
+            if (TasksCount == TasksCapacity)
+            {
+                int capacity = TasksCapacity > 0 ? TasksCapacity * 2 : 16;
+                Entry * tasks = new Entry[capacity];
+                for (int i = 0; i < TasksCount; i++)
+                    tasks[i] = std::move(Tasks[(TasksFirst + i) % TasksCapacity]);
+                delete[] Tasks;
+                Tasks = tasks;
+                TasksCapacity = capacity;
+                TasksFirst = 0;
+            }
+            Entry& entry = Tasks[(TasksFirst + TasksCount) % TasksCapacity];
+            entry.Key = Key;
+            entry.Task = std::move(Task);
+            TasksCount++;
+        }
+
+        inline FreeAsyncExecutor::Entry FreeAsyncExecutor::PopTask()
+        {
+            Entry entry = std::move(Tasks[TasksFirst]);
+            TasksFirst = (TasksFirst + 1) % TasksCapacity;
+            TasksCount--;
+            return entry;
+        }
+
+        void FreeAsyncExecutor::WorkerProcess()
+        {
+            ENGINE_PROFILE_THREAD_NAME("FreeAsync");
+            Entry entry;
+            std::unique_lock<std::mutex> guard(Mutex);
+            while (true)
+            {
+#ifdef ENGINE_PROFILING
+                long long idle_start = Utilities::Profiler::Now();
+#endif
+                Condition.wait(guard, [this] { return !IsRunning || TasksCount > 0; });
+                if (!IsRunning)
+                    return;
+                entry = PopTask();
+                UpdateKeyState(entry.Key, -1, 1);
+                guard.unlock();
+#ifdef ENGINE_PROFILING
+                Utilities::Profiler::RecordSpan("Idle", nullptr, idle_start, Utilities::Profiler::Now());
+#endif
+
+                entry.Task(); // Exceptions are handled by the task
+                entry.Task = nullptr;
+
+                guard.lock();
+                UpdateKeyState(entry.Key, 0, -1);
+            }
+        }
+
+        inline void FreeAsyncExecutor::UpdateKeyState(const void * Key, int QueuedDiff, int RunningDiff)
+        {
+            if (Key == nullptr)
+                return;
+            KeyState state = KeyStates.Contains(Key) ? KeyStates.GetValue(Key) : KeyState{ 0, 0 };
+            state.Queued += QueuedDiff;
+            state.Running += RunningDiff;
+            if (state.Queued == 0 && state.Running == 0)
+                KeyStates.Remove(Key);
+            else
+                KeyStates.SetValue(Key, state);
+        }
+    }
+}
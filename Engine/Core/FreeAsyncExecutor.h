@@ -0,0 +1,79 @@
+#pragma once
+
+#include "../Engine.dec.h"
+#include "../Utilities/Task.h"
+#include "../Utilities/Collections/List.h"
+#include "../Utilities/Collections/Dictionary.h"
+
+namespace Engine
+{
+    namespace Core
+    {
+        class FreeAsyncExecutor final
+        {
+        public:
+            FreeAsyncExecutor();
+            ~FreeAsyncExecutor();
+
+            FreeAsyncExecutor(const FreeAsyncExecutor&) = delete;
+            FreeAsyncExecutor& operator=(const FreeAsyncExecutor&) = delete;
+
+            /// @brief Starts the worker threads and resets the counters.
+            /// @param ThreadsCount The number of worker threads, 0 to use the hardware concurrency.
+            /// @param Backpressure What to do with a task whose source has unfinished tasks.
+            /// @param QueueCapacity The maximum number of waiting tasks, 0 for no limit.
+            void Start(int ThreadsCount, FreeAsyncBackpressure Backpressure, int QueueCapacity);
+            /// @brief Drops the waiting tasks and waits for the running ones to finish.
+            void Stop();
+
+            /// @brief Queues a task to be executed by a worker thread.
+            /// @param Key Identifies the source of the task (like a Module) for the backpressure policy.
+            ///        Tasks with a nullptr Key are always queued, unless the queue is full.
+            /// @param Task The function that will be called.
+            /// @return Whether the task is queued.
+            bool Submit(const void * Key, Utilities::Task<void()> Task);
+
+            /// @brief Gets the number of tasks dropped since the last start.
+            long long GetDroppedCount();
+            /// @brief Gets the number of tasks merged into a waiting task since the last start.
+            long long GetCoalescedCount();
+        private:
+            struct Entry
+            {
+                const void * Key;
+                Utilities::Task<void()> Task;
+            };
+
+            struct KeyState
+            {
+                int Queued;
+                int Running;
+            };
+
+            std::mutex Mutex;
+            std::condition_variable Condition;
+
+            // A ring of the waiting tasks, since the tasks are move-only.
+            // Grows when full and never shrinks, so it stops allocating once it fits the load.
+            Entry * Tasks;
+            int TasksCapacity;
+            int TasksFirst;
+            int TasksCount;
+            // Only contains the keys that have waiting or running tasks
+            Utilities::Collections::Dictionary<const void*, KeyState, false> KeyStates;
+
+            Utilities::Collections::List<std::thread*, false> Threads;
+            FreeAsyncBackpressure Backpressure;
+            int QueueCapacity;
+            bool IsRunning;
+
+            std::atomic<long long> DroppedCount;
+            std::atomic<long long> CoalescedCount;
+
+            void PushTask(const void * Key, Utilities::Task<void()> Task);
+            Entry PopTask();
+            void WorkerProcess();
+            void UpdateKeyState(const void * Key, int QueuedDiff, int RunningDiff);
+        };
+    }
+}
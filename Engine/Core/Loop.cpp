@@ -1,15 +1,47 @@
 #include "../Engine.h"
 #include <chrono>
+#include <cmath>
 
 namespace Engine
 {
     namespace Core
     {
+        // Rounded up, so that a job is never executed early
+        static inline long long ToTick(double Time)
+        {
+            return Time > 0 ? (long long)std::ceil(Time * 1000) : 0;
+        }
+
+        // Owns a reference of a Queued job submitted to FreeAsync,
+        // and cancels the job if the executor drops it without executing it.
+        struct FreeAsyncScheduledJob final
+        {
+            ScheduledJob * Job;
+
+            FreeAsyncScheduledJob(ScheduledJob * Job) : Job(Job) {}
+            FreeAsyncScheduledJob(FreeAsyncScheduledJob&& Other) noexcept : Job(Other.Job)
+            {
+                Other.Job = nullptr;
+            }
+            ~FreeAsyncScheduledJob()
+            {
+                if (Job == nullptr)
+                    return;
+                int expected = ScheduledJob::States::Queued;
+                Job->State.compare_exchange_strong(expected, ScheduledJob::States::Cancelled);
+                Job->RemoveReference();
+            }
+        };
+
         Loop::Loop() : Chunk0ModulesStartIndex(0), Chunk0ModulesEndIndex(0),
-                                 isRunning(false),
+                                 isRunning(false), AcceptsSchedules(false), PushingCount(0),
                                  StartTime(std::chrono::time_point<std::chrono::steady_clock>()),
                                  Time(0), TimeDiff(0), TimeAsFloat(0), TimeDiffAsFloat(0),
                                  ShouldStop(false),
+                                 Pacing(TickPolicy::Unthrottled), TickFrequency(60), MaxCatchUpTicks(5),
+                                 IsIdle(false), WakeRequested(false), SpinMargin(std::chrono::milliseconds(1)),
+                                 FreeAsyncThreadsCount(0), FreeAsyncPolicy(FreeAsyncBackpressure::Coalesce),
+                                 FreeAsyncQueueCapacity(0),
                                  Modules(
 
                 // OnAdd
@@ -73,8 +105,11 @@ namespace Engine
                     // Add the module
                     Parent->Add(Item, Index);
                     if (isRunning)
+                    {
                         // This kind of std::tuple construction requires C++17
-                        ToEditModules.Push(std::tuple(Add, Index, Item));
+                        ToEditModules.TryPush(std::tuple(Add, Index, Item));
+                        Wake();
+                    }
                 },
 
                 // OnSetItem
@@ -87,7 +122,10 @@ namespace Engine
                         {
                             Parent->SetItem(Index, Value);
                             if (isRunning)
-                                ToEditModules.Push(std::tuple(Replace, Index, Value));
+                            {
+                                ToEditModules.TryPush(std::tuple(Replace, Index, Value));
+                                Wake();
+                            }
                         }
                         else throw std::invalid_argument("Module's ExecutionChunk doesn't match the index.");
                     }
@@ -103,7 +141,10 @@ namespace Engine
 
                         Parent->RemoveByIndex(Index);
                         if (isRunning)
-                            ToEditModules.Push(std::tuple(Remove, Index, nullptr));
+                        {
+                            ToEditModules.TryPush(std::tuple(Remove, Index, nullptr));
+                            Wake();
+                        }
 
                         if (ExecutionChunk <= 0)
                             Chunk0ModulesEndIndex--;
@@ -118,13 +159,22 @@ namespace Engine
                 {
                     Parent->Clear();
                     if (isRunning)
-                        ToEditModules.Push(std::tuple(Clear, -1, nullptr));
+                    {
+                        ToEditModules.TryPush(std::tuple(Clear, -1, nullptr));
+                        Wake();
+                    }
                     Chunk0ModulesStartIndex = 0;
                     Chunk0ModulesEndIndex = 0;
                 }
             )
         {
+            Modules.SetMutexName("Loop.Modules");
+            isRunning.Mutex.SetName("Loop.isRunning");
+        }
 
+        Loop::~Loop()
+        {
+            ClearToSchedule();
         }
 
         void Loop::Run()
@@ -139,201 +189,109 @@ namespace Engine
                     throw std::logic_error("Cannot start twice.");
                 ToEditModules.Clear(); // Just to be sure
                 UpdatingModules = Modules;
-                ToSchedule.Clear(); // Just to be sure
-                ToSchedule.SetAutoShrink(false);
+                ClearToSchedule(); // Just to be sure
+                AcceptsSchedules.store(true, std::memory_order_release);
                 isRunning = true;
                 StartTime = std::chrono::steady_clock::now();
             });
 
+            ENGINE_PROFILE_THREAD_NAME("Loop");
+
             // No need to shared-lock the mutex on time updates
             std::chrono::time_point<std::chrono::steady_clock> StartTimeLocalCopy = StartTime;
             double PreviousTime = 0;
+
+            TickPolicy tick_policy = Pacing;
+            double tick_frequency = TickFrequency;
+            int max_catch_up_ticks = MaxCatchUpTicks;
+            auto tick_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(1.0 / tick_frequency)
+            );
+            // TargetFrequency: the start time of the next tick
+            auto next_tick_time = StartTimeLocalCopy;
+            // FixedTimestep: the real time not simulated yet, starting with the first tick
+            auto accumulated_time = tick_period;
+            auto last_time = StartTimeLocalCopy;
+            long long fixed_ticks_count = 0;
             Time = 0;
             TimeDiff = 0;
             TimeAsFloat = 0;
             TimeDiffAsFloat = 0;
 
             ShouldStop = false;
+            WakeRequested = false;
             Schedules.Clear();
-            Schedules.SetAutoShrink(false);
+            // Whether the last tick had an enabled EveryTick module, if not the loop may sleep
+            bool has_every_tick_modules = true;
+            bool was_idle = false;
 
             UpdatingModules.ForEach([this](Module * Item) { Item->Acquire(this); Item->_Start(); });
 
-            // Threads initialization
+            // Thread pool initialization
+            // The main thread executes BoundedAsync jobs too, while waiting for the pool.
 
-            unsigned int threads_count = std::thread::hardware_concurrency();
-            if (threads_count == 0) threads_count = 1;
-            enum thread_state
-            {
-                /// @brief Should start working, set by the main thread
-                ready,
-                /// @brief Is working, set by each thread in the pool
-                working,
-                /// @brief Waiting for the main thread to continue, set by each thread
-                passing,
-                /// @brief Current ExecutionChunk done, set by each thread
-                done,
-                /// @brief Used to detect bugs
-                error
-            };
-            Utilities::Collections::List<std::thread*, false> threads(threads_count);
-            Utilities::Collections::List<thread_state> thread_states(threads_count);
-            threads.SetAutoShrink(false);
-            thread_states.SetAutoShrink(false);
+            int threads_count = (int)std::thread::hardware_concurrency() - 1;
+            if (threads_count < 1) threads_count = 1;
+            Utilities::WorkStealingPool pool(threads_count);
 
-            std::condition_variable condition;
-            std::mutex condition_mutex;
+            FreeAsync.Start(FreeAsyncThreadsCount, FreeAsyncPolicy, FreeAsyncQueueCapacity);
 
-            Utilities::Shared<int> CurrentExecutionChunk = -128; // Only set by the main thread
-            Utilities::Shared<int, true> ModuleIndex = 0;
-            Utilities::Shared<bool> ShouldTerminate = false;
+            auto update_job = [](void * Loop, void * Module) {
+                ((Core::Loop*)Loop)->ExecuteUpdate((Core::Module*)Module);
+            };
+            auto scheduled_job = [](void * Loop, void * Job) {
+                ((Core::Loop*)Loop)->ExecuteScheduledJob(*(ScheduledJob*)Job);
+                ((ScheduledJob*)Job)->RemoveReference();
+            };
 
-            for (int i = 0; i < threads_count; i++)
-            {
-                thread_states.Add(done);
-                // Update loop: thread pool
-                threads.Add(new std::thread([&](int thread_index) {
-                    while (true)
+            // Executes the due schedules, BoundedAsync ones are left running in the pool.
+            auto execute_schedules = [&]() {
+                ScheduledJob * job = Schedules.Advance((long long)(Time * 1000));
+                while (job != nullptr)
+                {
+                    ScheduledJob * next = job->Next;
+
+                    // From now on Reschedule fails, as the job is going to be executed at this time
+                    int expected = ScheduledJob::States::Pending;
+                    if (!job->State.compare_exchange_strong(expected, ScheduledJob::States::Queued))
                     {
-                        std::unique_lock<std::mutex> condition_guard(condition_mutex);
-                        condition.wait(condition_guard, [&]() {
-                            return thread_states.GetItem(thread_index) == thread_state::ready;
-                        });
-                        if (ShouldTerminate)
-                        {
-                            thread_states.SetItem(thread_index, thread_state::done);
-                            condition_guard.unlock();
-                            condition.notify_all();
-                            return;
-                        }
-                        thread_states.SetItem(thread_index, thread_state::working);
-                        condition_guard.unlock();
-                        if (CurrentExecutionChunk == 0)
-                        {
-                            ScheduledJob job;
-                            bool done_for_now = false;
-                            auto guard = ModuleIndex.Mutex.GetLock();
-                            while (!Schedules.IsEmpty())
-                            {
-                                job = ScheduledJob(nullptr, nullptr);
-                                if (Schedules.GetFirstPriority() <= Time)
-                                    switch (Schedules.GetFirstItem().first)
-                                    {
-                                        case ExecutionType::FreeAsync:
-                                            std::thread([&](ScheduledJob job) {
-                                                ExecuteScheduledJob(job);
-                                            }, Schedules.Pop().second).detach();
-                                            break;
-                                        case ExecutionType::BoundedAsync:
-                                            job = Schedules.Pop().second;
-                                            break;
-                                        case ExecutionType::SingleThreaded:
-                                            condition_guard.lock();
-                                            thread_states.SetItem(thread_index, thread_state::passing);
-                                            condition_guard.unlock();
-                                            condition.notify_all();
-                                            done_for_now = true;
-                                            break;
-                                    }
-                                else break;
-                                guard.Unlock();
-                                if (done_for_now) break;
-                                if (job.Task != nullptr) ExecuteScheduledJob(job);
-                                guard = ModuleIndex.Mutex.GetLock();
-                            }
-                            // Wait for the main thread to continue to run the schedules.
-                            // And do not continue to the modules yet.
-                            if (done_for_now) continue;
-                        }
-                        {
-                            Module * module;
-                            bool done_for_now = false;
-                            auto guard = ModuleIndex.Mutex.GetLock();
-                            while (ModuleIndex < UpdatingModules.GetCount()
-                                && CurrentExecutionChunk == UpdatingModules.GetItem(ModuleIndex)->GetExecutionChunk())
-                            {
-                                if (!UpdatingModules.GetItem(ModuleIndex)->isEnabled)
-                                {
-                                    ModuleIndex = ModuleIndex + 1;
-                                    continue;
-                                }
-                                module = nullptr;
-                                switch (UpdatingModules.GetItem(ModuleIndex)->GetExecutionType())
-                                {
-                                    case ExecutionType::FreeAsync:
-                                        std::thread([&](Module * module) {
-                                            ExecuteUpdate(module);
-                                        }, UpdatingModules.GetItem(ModuleIndex)).detach();
-                                        ModuleIndex = ModuleIndex + 1;
-                                        break;
-                                    case ExecutionType::BoundedAsync:
-                                        module = UpdatingModules.GetItem(ModuleIndex);
-                                        ModuleIndex = ModuleIndex + 1;
-                                        break;
-                                    case ExecutionType::SingleThreaded:
-                                        condition_guard.lock();
-                                        thread_states.SetItem(thread_index, thread_state::passing);
-                                        condition_guard.unlock();
-                                        condition.notify_all();
-                                        done_for_now = true;
-                                        break;
-                                }
-                                guard.Unlock();
-                                if (done_for_now) break;
-                                if (module != nullptr) ExecuteUpdate(module);
-                                guard = ModuleIndex.Mutex.GetLock();
-                            }
-                            // Wait for the main thread to continue to run the modules.
-                            // And do not set the state to 'done' yet.
-                            if (done_for_now) continue;
-                        }
-                        condition_guard.lock();
-                        thread_states.SetItem(thread_index, thread_state::done);
-                        condition_guard.unlock();
-                        condition.notify_all();
+                        if (expected == ScheduledJob::States::Rescheduling)
+                            Schedules.Add(job); // Is moved to its new time when the push of Reschedule is drained
+                        else
+                            job->RemoveReference(); // Cancelled
+                        job = next;
+                        continue;
                     }
-                }, i));
-            }
 
-            auto pool_process = [&]()->thread_state {
-                // start
-                std::unique_lock<std::mutex> condition_guard(condition_mutex);
-                for (int i = 0; i < threads_count; i++)
-                    thread_states.SetItem(i, thread_state::ready);
-                condition_guard.unlock();
-                condition.notify_all();
-                // wait
-                thread_state result = thread_state::error;
-                condition_guard.lock();
-                condition.wait(condition_guard, [&]() {
-                    int done_count = 0;
-                    int passing_count = 0;
-                    for (int i = 0; i < threads_count; i++)
-                        switch (thread_states.GetItem(i))
-                        {
-                            case thread_state::done: done_count++; break;
-                            case thread_state::passing: passing_count++; break;
-                            default: return false;
-                        }
-                    if (done_count == threads_count) result = thread_state::done;
-                    else if (passing_count == threads_count) result = thread_state::passing;
-                    else result = thread_state::error;
-                    return true;
-                });
-                if (result == thread_state::error)
-                    throw std::logic_error("This is a bug!");
-                return result;
+                    switch (job->Type)
+                    {
+                        case ExecutionType::FreeAsync:
+                            FreeAsync.Submit(nullptr, [this, queued = FreeAsyncScheduledJob(job)] {
+                                ExecuteScheduledJob(*queued.Job);
+                            });
+                            break;
+                        case ExecutionType::BoundedAsync:
+                            pool.Submit({ scheduled_job, this, job });
+                            break;
+                        case ExecutionType::SingleThreaded:
+                            pool.Wait();
+                            ExecuteScheduledJob(*job);
+                            job->RemoveReference();
+                            break;
+                    }
+                    job = next;
+                }
             };
 
-            thread_state pool_state = thread_state::done;
-
             // Update loop: main thread
             while (!ShouldStop)
             {
+                ENGINE_PROFILE_SCOPE("Tick", nullptr, 0);
+
                 // Update Modules list changes
-                while (!ToEditModules.IsEmpty())
+                std::tuple<ModulesEditType, int, Module*> item;
+                while (ToEditModules.TryPop(item))
                 {
-                    auto item = ToEditModules.Pop();
                     Module * to_remove;
                     switch(std::get<0>(item))
                     {
@@ -367,136 +325,156 @@ namespace Engine
                 }
 
                 // Update Schedules
-                while (!ToSchedule.IsEmpty())
-                {
-                    auto item = ToSchedule.Pop();
-                    Schedules.Push(std::pair(std::get<0>(item), std::get<1>(item)), std::get<2>(item));
-                }
+                ENGINE_PROFILE_COUNTER("ToSchedule", ToSchedule.GetCount());
+                ToSchedule.Drain([this](ScheduledJob *& Job) {
+                    if (Job->State.load() == ScheduledJob::States::Cancelled)
+                        Job->RemoveReference(); // Dropped lazily by Schedules, if it is there
+                    else if (Schedules.Contains(Job))
+                    {
+                        // Rescheduled
+                        Schedules.Remove(Job);
+                        Schedules.Add(Job);
+                        Job->RemoveReference();
+                    }
+                    else Schedules.Add(Job);
+                });
+                ENGINE_PROFILE_COUNTER("Schedules", Schedules.GetCount());
 
                 if (UpdatingModules.GetCount() == 0)
                     break;
 
-                auto duration = std::chrono::steady_clock::now() - StartTimeLocalCopy;
+                // Sleeps until the next event of Schedules, unless woken up
+                if (!has_every_tick_modules && !WakeRequested.exchange(false))
+                {
+                    long long next_tick = Schedules.GetNextEventTick();
+                    auto deadline = StartTimeLocalCopy + std::chrono::milliseconds(next_tick);
+                    if (next_tick < 0 || deadline > std::chrono::steady_clock::now())
+                    {
+                        ENGINE_PROFILE_SCOPE("Idle", nullptr, 0);
+                        WaitIdle(deadline, next_tick >= 0);
+                        was_idle = true;
+                        continue;
+                    }
+                }
+
+                auto now = std::chrono::steady_clock::now();
                 PreviousTime = Time;
-                Time = (double)std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0;
-                TimeDiff = Time - PreviousTime;
+                if (tick_policy == TickPolicy::FixedTimestep)
+                {
+                    // The time slept with nothing to do is skipped
+                    if (was_idle)
+                    {
+                        fixed_ticks_count = (long long)(
+                            std::chrono::duration<double>(now - StartTimeLocalCopy).count() * tick_frequency
+                        );
+                        accumulated_time = tick_period;
+                        last_time = now;
+                    }
+                    accumulated_time += now - last_time;
+                    last_time = now;
+                    if (accumulated_time > tick_period * max_catch_up_ticks)
+                        accumulated_time = tick_period * max_catch_up_ticks;
+                    if (accumulated_time < tick_period)
+                    {
+                        if (!WaitUntil(now + (tick_period - accumulated_time)))
+                            continue; // Stopped
+                        now = std::chrono::steady_clock::now();
+                        accumulated_time += now - last_time;
+                        last_time = now;
+                    }
+                    accumulated_time -= tick_period;
+                    Time = (double)fixed_ticks_count / tick_frequency;
+                    TimeDiff = 1.0 / tick_frequency;
+                    fixed_ticks_count++;
+                }
+                else
+                {
+                    if (tick_policy == TickPolicy::TargetFrequency)
+                    {
+                        if (now < next_tick_time)
+                        {
+                            if (!WaitUntil(next_tick_time))
+                                continue; // Stopped
+                            now = std::chrono::steady_clock::now();
+                        }
+                        // Stays on the grid of the first tick, unless it is a whole period late
+                        next_tick_time += tick_period;
+                        if (next_tick_time <= now)
+                            next_tick_time = now + tick_period;
+                    }
+                    auto duration = now - StartTimeLocalCopy;
+                    Time = (double)std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0;
+                    TimeDiff = Time - PreviousTime;
+                }
+                was_idle = false;
                 TimeAsFloat = (float)Time;
                 TimeDiffAsFloat = (float)TimeDiff;
 
-                CurrentExecutionChunk = -128;
-                ModuleIndex = 0;
-
+                // The modules are sorted by their ExecutionChunk.
+                // Each chunk is fed to the pool module by module and ends with a barrier,
+                // SingleThreaded modules are executed by the main thread after a barrier.
+                int modules_count = UpdatingModules.GetCount();
+                int module_index = 0;
+                bool schedules_done = false;
+                has_every_tick_modules = false;
                 while (true)
                 {
-                    // Set ModuleIndex
-                    if (ModuleIndex >= UpdatingModules.GetCount())
-                        if (CurrentExecutionChunk <= 0)
-                            CurrentExecutionChunk = 0;
-                        else break;
-                    else if (CurrentExecutionChunk < UpdatingModules.GetItem(ModuleIndex)->GetExecutionChunk())
-                        if (CurrentExecutionChunk <= 0 && UpdatingModules.GetItem(ModuleIndex)->GetExecutionChunk() > 0)
-                            CurrentExecutionChunk = 0;
-                        else CurrentExecutionChunk = UpdatingModules.GetItem(ModuleIndex)->GetExecutionChunk();
-                    //  Normal process
-                    if (CurrentExecutionChunk == 0)
+                    int chunk = module_index < modules_count ?
+                                UpdatingModules.GetItem(module_index)->GetExecutionChunk() : 1;
+
+                    // Schedules are executed right before Chunk-0 Modules
+                    if (!schedules_done && chunk >= 0)
                     {
-                        ScheduledJob job;
-                        bool pass_to_pool = false;
-                        bool chunk_done = false;
-                        auto guard = ModuleIndex.Mutex.GetLock();
-                        while (!Schedules.IsEmpty())
-                        {
-                            job = ScheduledJob(nullptr, nullptr);
-                            if (Schedules.GetFirstPriority() <= Time)
-                                switch (Schedules.GetFirstItem().first)
-                                {
-                                    case ExecutionType::FreeAsync:
-                                        std::thread([&](ScheduledJob job) {
-                                            ExecuteScheduledJob(job);
-                                        }, Schedules.Pop().second).detach();
-                                        break;
-                                    case ExecutionType::SingleThreaded:
-                                        job = Schedules.Pop().second;
-                                        break;
-                                    case ExecutionType::BoundedAsync:
-                                        pass_to_pool = true;
-                                        break;
-                                }
-                            else break;
-                            guard.Unlock();
-                            if (pass_to_pool)
-                            {
-                                chunk_done = pool_process() == thread_state::done;
-                                if (chunk_done) break;
-                                pass_to_pool = false;
-                            }
-                            if (job.Task != nullptr) ExecuteScheduledJob(job);
-                            guard = ModuleIndex.Mutex.GetLock();
-                        }
-                        if (chunk_done)
-                        {
-                            // chunk-0 is done now.
-                            CurrentExecutionChunk = CurrentExecutionChunk + 1;
-                            continue;
-                        }
+                        ENGINE_PROFILE_SCOPE("Dispatch Schedules", nullptr, 0);
+                        execute_schedules();
+                        schedules_done = true;
+                        // Otherwise, they share the barrier of Chunk-0
+                        if (chunk > 0)
+                            pool.Wait();
                     }
+
+                    if (module_index >= modules_count)
+                        break;
+                    ENGINE_PROFILE_SCOPE("Chunk", nullptr, chunk);
+
+                    for (; module_index < modules_count; module_index++)
                     {
-                        Module * module;
-                        bool pass_to_pool = false;
-                        bool chunk_done = false;
-                        auto guard = ModuleIndex.Mutex.GetLock();
-                        while (ModuleIndex < UpdatingModules.GetCount()
-                            && CurrentExecutionChunk == UpdatingModules.GetItem(ModuleIndex)->GetExecutionChunk())
+                        Module * module = UpdatingModules.GetItem(module_index);
+                        if (module->GetExecutionChunk() != chunk)
+                            break;
+                        if (!module->isEnabled)
+                            continue;
+                        if (module->GetUpdateMode() == UpdateMode::WhenSignalled)
                         {
-                            if (!UpdatingModules.GetItem(ModuleIndex)->isEnabled)
-                            {
-                                ModuleIndex = ModuleIndex + 1;
+                            if (!module->isSignalled.exchange(false))
                                 continue;
-                            }
-                            module = nullptr;
-                            switch (UpdatingModules.GetItem(ModuleIndex)->GetExecutionType())
-                            {
-                                case ExecutionType::FreeAsync:
-                                    std::thread([&](Module * module) {
-                                        ExecuteUpdate(module);
-                                    }, UpdatingModules.GetItem(ModuleIndex)).detach();
-                                    ModuleIndex = ModuleIndex + 1;
-                                    break;
-                                case ExecutionType::SingleThreaded:
-                                    module = UpdatingModules.GetItem(ModuleIndex);
-                                    ModuleIndex = ModuleIndex + 1;
-                                    break;
-                                case ExecutionType::BoundedAsync:
-                                    pass_to_pool = true;
-                                    break;
-                            }
-                            guard.Unlock();
-                            if (pass_to_pool)
-                            {
-                                chunk_done = pool_process() == thread_state::done;
-                                if (chunk_done) break;
-                                pass_to_pool = false;
-                            }
-                            if (module != nullptr) ExecuteUpdate(module);
-                            guard = ModuleIndex.Mutex.GetLock();
+                        }
+                        else has_every_tick_modules = true;
+                        switch (module->GetExecutionType())
+                        {
+                            case ExecutionType::FreeAsync:
+                                FreeAsync.Submit(module, [this, module] { ExecuteUpdate(module); });
+                                break;
+                            case ExecutionType::BoundedAsync:
+                                pool.Submit({ update_job, this, module });
+                                break;
+                            case ExecutionType::SingleThreaded:
+                                pool.Wait();
+                                ExecuteUpdate(module);
+                                break;
                         }
                     }
-                    CurrentExecutionChunk = CurrentExecutionChunk + 1;
+                    pool.Wait();
                 }
             }
 
-            ShouldTerminate = true;
-            pool_process();
-            for (int i = 0; i < threads_count; i++)
-            {
-                threads.GetItem(i)->join();
-                delete threads.GetItem(i);
-            }
+            pool.Wait();
+            // Queued FreeAsync jobs are dropped, the running ones are waited for
+            FreeAsync.Stop();
 
             UpdatingModules.ForEach([](Module * Item) { Item->_Stop(); Item->Release(); });
             UpdatingModules.Clear();
 
-            Schedules.SetAutoShrink(true);
             Schedules.Clear();
 
             Time = 0;
@@ -506,16 +484,29 @@ namespace Engine
 
             Modules.LockAndDo([&] {
                 auto guard = isRunning.Mutex.GetLock();
-                ToSchedule.SetAutoShrink(true);
-                ToSchedule.Clear();
+                AcceptsSchedules.store(false, std::memory_order_seq_cst);
+                // A push that has seen AcceptsSchedules set would land after the clearing
+                while (PushingCount.load(std::memory_order_seq_cst) != 0)
+                    std::this_thread::yield();
+                ClearToSchedule();
                 ToEditModules.Clear();
                 isRunning = false;
             });
         }
 
+        void Loop::Wake()
+        {
+            WakeRequested.store(true);
+            WakeIfIdle();
+        }
+
         void Loop::Stop()
         {
             ShouldStop = true;
+            {
+                std::lock_guard<std::mutex> guard(WaitMutex);
+            }
+            WaitCondition.notify_all();
         }
 
         bool Loop::IsRunning()
@@ -523,44 +514,230 @@ namespace Engine
             return isRunning;
         }
 
-        void Loop::Schedule(
-                std::function<void()> Func,
-                std::function<void(std::exception&)> ExceptionHandler,
+        void Loop::SetScheduleCapacity(int Capacity)
+        {
+            ToSchedule.SetCapacity(Capacity);
+        }
+
+        void Loop::SetFreeAsyncThreadsCount(int ThreadsCount)
+        {
+            if (ThreadsCount < 0)
+                throw std::domain_error("ThreadsCount is less than zero.");
+            FreeAsyncThreadsCount = ThreadsCount;
+        }
+
+        void Loop::SetTickPolicy(TickPolicy Policy, double Frequency, int MaxCatchUpTicks)
+        {
+            if (Frequency <= 0)
+                throw std::domain_error("Frequency is not greater than zero.");
+            if (MaxCatchUpTicks < 1)
+                throw std::domain_error("MaxCatchUpTicks is less than one.");
+            Pacing = Policy;
+            TickFrequency = Frequency;
+            this->MaxCatchUpTicks = MaxCatchUpTicks;
+        }
+
+        TickPolicy Loop::GetTickPolicy()
+        {
+            return Pacing;
+        }
+
+        double Loop::GetTickFrequency()
+        {
+            return TickFrequency;
+        }
+
+        void Loop::SetFreeAsyncBackpressure(FreeAsyncBackpressure Backpressure)
+        {
+            FreeAsyncPolicy = Backpressure;
+        }
+
+        void Loop::SetFreeAsyncQueueCapacity(int Capacity)
+        {
+            if (Capacity < 0)
+                throw std::domain_error("Capacity is less than zero.");
+            FreeAsyncQueueCapacity = Capacity;
+        }
+
+        long long Loop::GetFreeAsyncDroppedCount()
+        {
+            return FreeAsync.GetDroppedCount();
+        }
+
+        long long Loop::GetFreeAsyncCoalescedCount()
+        {
+            return FreeAsync.GetCoalescedCount();
+        }
+
+        ScheduleHandle Loop::Schedule(
+                Utilities::Task<void()> Func,
+                Utilities::Task<void(std::exception&)> ExceptionHandler,
                 double Time, ExecutionType ExecutionType
         ) {
-            auto guard = isRunning.Mutex.GetLock();
-            if (isRunning)
-                ToSchedule.Push(std::tuple(ExecutionType, ScheduledJob(Func, ExceptionHandler), Time));
+            return Schedule(Time, ExecutionType, std::move(Func), std::move(ExceptionHandler));
         }
 
-        void Loop::Schedule(
+        ScheduleHandle Loop::Schedule(
                 double Time,
-                std::function<void()> Func,
-                std::function<void(std::exception&)> ExceptionHandler,
+                Utilities::Task<void()> Func,
+                Utilities::Task<void(std::exception&)> ExceptionHandler,
                 ExecutionType ExecutionType
         ) {
-            auto guard = isRunning.Mutex.GetLock();
-            if (isRunning)
-                ToSchedule.Push(std::tuple(ExecutionType, ScheduledJob(Func, ExceptionHandler), Time));
+            return Schedule(Time, ExecutionType, std::move(Func), std::move(ExceptionHandler));
         }
 
-        void Loop::Schedule(
+        ScheduleHandle Loop::Schedule(
                 double Time, ExecutionType ExecutionType,
-                std::function<void()> Func,
-                std::function<void(std::exception&)> ExceptionHandler
+                Utilities::Task<void()> Func,
+                Utilities::Task<void(std::exception&)> ExceptionHandler
         ) {
-            auto guard = isRunning.Mutex.GetLock();
-            if (isRunning)
-                ToSchedule.Push(std::tuple(ExecutionType, ScheduledJob(Func, ExceptionHandler), Time));
+            // Checked again by Push, this one only saves the allocation
+            if (!AcceptsSchedules.load(std::memory_order_acquire))
+                return ScheduleHandle();
+
+            ScheduledJob * job = new ScheduledJob(std::move(Func), std::move(ExceptionHandler), ExecutionType, ToTick(Time), this);
+            ScheduleHandle handle(job);
+            if (!Push(job))
+                return ScheduleHandle();
+            return handle;
         }
 
-        Loop::ScheduledJob::ScheduledJob(
-            std::function<void()> Task,
-            std::function<void(std::exception&)> ExceptionHandler
-        ) : Task(Task), ExceptionHandler(ExceptionHandler) {}
+        ScheduleHandle Loop::ScheduleRepeating(
+                double Period, RepeatType RepeatType,
+                Utilities::Task<void()> Func,
+                Utilities::Task<void(std::exception&)> ExceptionHandler,
+                double Time, ExecutionType ExecutionType
+        ) {
+            if (Period <= 0)
+                throw std::domain_error("Period is not greater than zero.");
+            if (!AcceptsSchedules.load(std::memory_order_acquire))
+                return ScheduleHandle();
+
+            long long period_ticks = (long long)std::round(Period * 1000);
+            if (period_ticks < 1) period_ticks = 1;
+            ScheduledJob * job = new ScheduledJob(
+                std::move(Func), std::move(ExceptionHandler), ExecutionType, ToTick(Time), this, period_ticks, RepeatType
+            );
+            ScheduleHandle handle(job);
+            if (!Push(job))
+                return ScheduleHandle();
+            return handle;
+        }
+
+        // Sleeps until shortly before the deadline, then spins, since a sleep may overshoot.
+        // Returns false if the Loop is stopped while waiting.
+        bool Loop::WaitUntil(std::chrono::steady_clock::time_point Deadline)
+        {
+            auto sleep_end = Deadline - SpinMargin;
+            if (std::chrono::steady_clock::now() < sleep_end)
+            {
+                {
+                    std::unique_lock<std::mutex> guard(WaitMutex);
+                    if (WaitCondition.wait_until(guard, sleep_end, [this] { return (bool)ShouldStop; }))
+                        return false;
+                }
+                // Converges to twice the average overshoot
+                auto overshoot = std::chrono::steady_clock::now() - sleep_end;
+                SpinMargin = (SpinMargin * 7 + overshoot * 2) / 8;
+                if (SpinMargin < std::chrono::microseconds(20))
+                    SpinMargin = std::chrono::microseconds(20);
+                else if (SpinMargin > std::chrono::milliseconds(2))
+                    SpinMargin = std::chrono::milliseconds(2);
+            }
+            while (std::chrono::steady_clock::now() < Deadline)
+            {
+                if (ShouldStop)
+                    return false;
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        // Sleeps until the deadline or until woken up by Stop, Wake or a push to the inboxes
+        void Loop::WaitIdle(std::chrono::steady_clock::time_point Deadline, bool HasDeadline)
+        {
+            IsIdle.store(true);
+            // Pairs with the fence of WakeIfIdle:
+            // either the pushed items are seen here, or IsIdle is seen by the pusher.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> guard(WaitMutex);
+                auto should_wake = [this] {
+                    return WakeRequested.load() || ShouldStop || !ToSchedule.IsEmpty() || !ToEditModules.IsEmpty();
+                };
+                if (HasDeadline)
+                    WaitCondition.wait_until(guard, Deadline, should_wake);
+                else
+                    WaitCondition.wait(guard, should_wake);
+            }
+            IsIdle.store(false);
+        }
+
+        // Is called after pushing to the inboxes, only locks if the loop is sleeping
+        inline void Loop::WakeIfIdle()
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (IsIdle.load(std::memory_order_relaxed))
+            {
+                {
+                    std::lock_guard<std::mutex> guard(WaitMutex);
+                }
+                WaitCondition.notify_all();
+            }
+        }
+
+        // Takes a reference of the job, even on failure.
+        // Fails once the Loop stops accepting schedules, the stopping Loop waits for the pushes that got past the check.
+        inline bool Loop::Push(ScheduledJob * job)
+        {
+            // Pairs with the AcceptsSchedules store and the PushingCount check of the stopping Loop:
+            // either the store is seen here, or the increment is seen there.
+            PushingCount.fetch_add(1, std::memory_order_seq_cst);
+            bool pushed = AcceptsSchedules.load(std::memory_order_seq_cst) && ToSchedule.TryPush(job);
+            PushingCount.fetch_sub(1, std::memory_order_release);
+            if (!pushed)
+            {
+                job->RemoveReference();
+                return false;
+            }
+            WakeIfIdle();
+            return true;
+        }
+
+        bool Loop::Reschedule(ScheduledJob * job, double Time)
+        {
+            // Keeps the Loop from handing the job to an executor until the new time is pushed
+            int expected = ScheduledJob::States::Pending;
+            if (!job->State.compare_exchange_strong(expected, ScheduledJob::States::Rescheduling))
+                return false;
+
+            long long previous_tick = job->DueTick.exchange(ToTick(Time));
+            job->AddReference();
+            bool pushed = Push(job);
+            if (!pushed)
+                job->DueTick.store(previous_tick);
+
+            expected = ScheduledJob::States::Rescheduling;
+            // Fails if cancelled meanwhile
+            return job->State.compare_exchange_strong(expected, ScheduledJob::States::Pending) && pushed;
+        }
+
+        void Loop::ClearToSchedule()
+        {
+            ScheduledJob * job;
+            while (ToSchedule.TryPop(job))
+            {
+                job->CancelIfNotStarted();
+                job->RemoveReference();
+            }
+        }
 
         inline void Loop::ExecuteScheduledJob(ScheduledJob& job)
         {
+            int expected = ScheduledJob::States::Queued;
+            if (!job.State.compare_exchange_strong(expected, ScheduledJob::States::Started))
+                return; // Cancelled
+            ENGINE_PROFILE_SCOPE("Scheduled Job", nullptr, job.DueTick.load());
             try
             {
                 job.Task();
@@ -582,9 +759,37 @@ namespace Engine
                 }
                 catch (...) {} // ignore
             }
+
+            if (job.PeriodTicks == 0)
+                return;
+
+            // Repeat
+            long long next_tick;
+            if (job.Repeat == RepeatType::FixedRate)
+            {
+                long long now_tick = (long long)(this->Time.Get() * 1000);
+                next_tick = job.DueTick.load() + job.PeriodTicks;
+                if (next_tick <= now_tick) // Skip the missed calls
+                    next_tick += ((now_tick - next_tick) / job.PeriodTicks + 1) * job.PeriodTicks;
+            }
+            else
+            {
+                auto duration = std::chrono::steady_clock::now() - StartTime.Get();
+                next_tick = ToTick((double)std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0)
+                            + job.PeriodTicks;
+            }
+            job.DueTick.store(next_tick);
+
+            expected = ScheduledJob::States::Started;
+            if (!job.State.compare_exchange_strong(expected, ScheduledJob::States::Pending))
+                return; // Cancelled
+            job.AddReference();
+            if (!Push(&job))
+                job.State.store(ScheduledJob::States::Cancelled);
         }
         inline void Loop::ExecuteUpdate(Module * module)
         {
+            ENGINE_PROFILE_SCOPE("Update", module, module->GetExecutionChunk());
             try
             {
                 module->OnUpdate();
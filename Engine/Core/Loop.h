@@ -3,7 +3,10 @@
 #include "../Engine.dec.h"
 #include "../Utilities/Shared.h"
 #include "../Utilities/Collections/List.h"
-#include "../Utilities/Collections/PriorityQueue.h"
+#include "../Utilities/Collections/Inbox.h"
+#include "FreeAsyncExecutor.h"
+#include "ScheduleHandle.h"
+#include "TimingWheel.h"
 
 namespace Engine
 {
@@ -12,6 +15,7 @@ namespace Engine
         class Loop final
         {
             friend Module;
+            friend ScheduleHandle;
         public:
             /// @brief The modules that are going to be running.
             ///
@@ -19,6 +23,8 @@ namespace Engine
             Utilities::Collections::List<Module*> Modules;
 
             Loop();
+            /// @brief Cancels and releases the schedules left in the inbox.
+            ~Loop();
 
             /// @brief Starts the loop.
             ///
@@ -26,6 +32,12 @@ namespace Engine
             void Run();
             /// @brief Stops the loop.
             void Stop();
+            /// @brief Makes the loop run a tick if it is sleeping.
+            ///
+            /// The loop sleeps while its enabled modules are all WhenSignalled and none is signalled,
+            /// until a scheduled job is due, a job is scheduled or the modules are edited.
+            /// Can be called by any thread.
+            void Wake();
 
             /// @brief Checks if the loop is running.
             bool IsRunning();
@@ -34,14 +46,18 @@ namespace Engine
             ///
             /// Will not call if the Loop is stopped before the call.
             /// Is executed right before Chunk-0 Modules.
+            /// Never blocks, can be called by any thread.
             ///
             /// @param Task The function that will be called.
             /// @param ExceptionHandler The function that will be called to handle exceptions thrown by Task.
             /// @param Time The time when the function will be called.
             ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
-            void Schedule(
-                std::function<void()> Task,
-                std::function<void(std::exception&)> ExceptionHandler = nullptr,
+            ///        Has a precision of 1 millisecond, the function is never called early.
+            /// @return A handle to cancel the job.
+            ///         Is empty if the Loop is not running or the schedule inbox is full.
+            ScheduleHandle Schedule(
+                Utilities::Task<void()> Task,
+                Utilities::Task<void(std::exception&)> ExceptionHandler = nullptr,
                 double Time = 0,
                 ExecutionType ExecutionType = ExecutionType::BoundedAsync
             );
@@ -49,37 +65,116 @@ namespace Engine
             ///
             /// Will not call if the Loop is stopped before the call.
             /// Is executed right before Chunk-0 Modules.
+            /// Never blocks, can be called by any thread.
             ///
             /// @param Task The function that will be called.
             /// @param ExceptionHandler The function that will be called to handle exceptions thrown by Task.
             /// @param Time The time when the function will be called.
             ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
-            void Schedule(
+            ///        Has a precision of 1 millisecond, the function is never called early.
+            /// @return A handle to cancel the job.
+            ///         Is empty if the Loop is not running or the schedule inbox is full.
+            ScheduleHandle Schedule(
                 double Time,
-                std::function<void()> Task,
-                std::function<void(std::exception&)> ExceptionHandler = nullptr,
+                Utilities::Task<void()> Task,
+                Utilities::Task<void(std::exception&)> ExceptionHandler = nullptr,
                 ExecutionType ExecutionType = ExecutionType::BoundedAsync
             );
             /// @brief Schedules to call a function.
             ///
             /// Will not call if the Loop is stopped before the call.
             /// Is executed right before Chunk-0 Modules.
+            /// Never blocks, can be called by any thread.
             ///
             /// @param Task The function that will be called.
             /// @param ExceptionHandler The function that will be called to handle exceptions thrown by Task.
             /// @param Time The time when the function will be called.
             ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
-            void Schedule(
+            ///        Has a precision of 1 millisecond, the function is never called early.
+            /// @return A handle to cancel the job.
+            ///         Is empty if the Loop is not running or the schedule inbox is full.
+            ScheduleHandle Schedule(
                 double Time,
                 ExecutionType ExecutionType,
-                std::function<void()> Task,
-                std::function<void(std::exception&)> ExceptionHandler = nullptr
+                Utilities::Task<void()> Task,
+                Utilities::Task<void(std::exception&)> ExceptionHandler = nullptr
+            );
+
+            /// @brief Schedules to call a function repeatedly.
+            ///
+            /// Will stop calling when the Loop is stopped or the returned handle is cancelled.
+            /// A call is never started while the previous call is running.
+            /// Never blocks, can be called by any thread.
+            ///
+            /// @param Period The time between the calls, in seconds with a precision of 1 millisecond.
+            /// @param RepeatType Whether the Period is counted from the start of the previous call or from its end.
+            /// @param Task The function that will be called.
+            /// @param ExceptionHandler The function that will be called to handle exceptions thrown by Task.
+            /// @param Time The time of the first call.
+            ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
+            /// @return A handle to cancel the calls or reschedule the next one.
+            ///         Is empty if the Loop is not running or the schedule inbox is full.
+            ScheduleHandle ScheduleRepeating(
+                double Period,
+                RepeatType RepeatType,
+                Utilities::Task<void()> Task,
+                Utilities::Task<void(std::exception&)> ExceptionHandler = nullptr,
+                double Time = 0,
+                ExecutionType ExecutionType = ExecutionType::BoundedAsync
             );
+
+            /// @brief Sets the maximum number of schedules waiting to be taken by the Loop.
+            ///
+            /// Schedule fails while the inbox is full.
+            ///
+            /// @param Capacity The maximum number of waiting schedules, 0 (default) for no limit.
+            void SetScheduleCapacity(int Capacity);
+
+            /// @brief Sets how the ticks are paced.
+            ///
+            /// Is applied on the next Run. Default is Unthrottled.
+            ///
+            /// @param Policy See TickPolicy.
+            /// @param Frequency The ticks per second of TargetFrequency and FixedTimestep.
+            /// @param MaxCatchUpTicks The maximum number of FixedTimestep ticks that are run back to back
+            ///        to catch up with the real time. The time further behind is skipped.
+            void SetTickPolicy(TickPolicy Policy, double Frequency = 60, int MaxCatchUpTicks = 5);
+            TickPolicy GetTickPolicy();
+            /// @brief Gets the ticks per second of TargetFrequency and FixedTimestep.
+            double GetTickFrequency();
+
+            /// @brief Sets the number of threads that execute the FreeAsync Modules and scheduled tasks.
+            ///
+            /// Is applied on the next Run.
+            ///
+            /// @param ThreadsCount The number of threads, 0 (default) to use the hardware concurrency.
+            void SetFreeAsyncThreadsCount(int ThreadsCount);
+            /// @brief Sets what happens to a FreeAsync Module update
+            ///        while the previous updates of the Module are not done yet.
+            ///
+            /// Is applied on the next Run. Default is Coalesce.
+            void SetFreeAsyncBackpressure(FreeAsyncBackpressure Backpressure);
+            /// @brief Sets the maximum number of FreeAsync jobs waiting to be executed.
+            ///
+            /// Jobs are dropped while the queue is full. Is applied on the next Run.
+            ///
+            /// @param Capacity The maximum number of waiting jobs, 0 (default) for no limit.
+            void SetFreeAsyncQueueCapacity(int Capacity);
+            /// @brief Gets the number of FreeAsync jobs dropped since the last start.
+            long long GetFreeAsyncDroppedCount();
+            /// @brief Gets the number of FreeAsync Module updates
+            ///        merged into a waiting update since the last start.
+            long long GetFreeAsyncCoalescedCount();
         private:
             int Chunk0ModulesStartIndex;
             int Chunk0ModulesEndIndex;
 
             Utilities::Shared<bool, true> isRunning;
+            // Lets Schedule check isRunning without locking
+            std::atomic<bool> AcceptsSchedules;
+            // The pushes to ToSchedule that have seen AcceptsSchedules set and are not done yet.
+            // The stopping Loop waits for them before clearing the inbox, so no job is pushed after it.
+            std::atomic<int> PushingCount;
             Utilities::Shared<std::chrono::time_point<std::chrono::steady_clock>> StartTime;
             Utilities::Shared<double> Time;
             Utilities::Shared<double> TimeDiff;
@@ -87,24 +182,43 @@ namespace Engine
             Utilities::Shared<float> TimeDiffAsFloat;
             Utilities::Shared<bool> ShouldStop;
 
-            struct ScheduledJob
-            {
-                std::function<void()> Task;
-                std::function<void(std::exception&)> ExceptionHandler;
-                ScheduledJob() {}
-                ScheduledJob(
-                    std::function<void()> Task,
-                    std::function<void(std::exception&)> ExceptionHandler
-                );
-            };
+            Utilities::Shared<TickPolicy> Pacing;
+            Utilities::Shared<double> TickFrequency;
+            Utilities::Shared<int> MaxCatchUpTicks;
+            // Lets Stop interrupt the waiting between ticks
+            std::mutex WaitMutex;
+            std::condition_variable WaitCondition;
+            // Set while the loop sleeps with nothing to do
+            std::atomic<bool> IsIdle;
+            // Makes the loop run a tick instead of sleeping
+            std::atomic<bool> WakeRequested;
+            // How long before a deadline the waiting thread wakes up to spin, learned from the past sleeps.
+            // Only accessed by the thread that runs the loop.
+            std::chrono::steady_clock::duration SpinMargin;
+
+            Utilities::Shared<int> FreeAsyncThreadsCount;
+            Utilities::Shared<FreeAsyncBackpressure> FreeAsyncPolicy;
+            Utilities::Shared<int> FreeAsyncQueueCapacity;
+            FreeAsyncExecutor FreeAsync;
 
-            Utilities::Collections::PriorityQueue<std::pair<ExecutionType, ScheduledJob>, double> Schedules;
+            // Only accessed by the thread that runs the loop
+            TimingWheel Schedules;
 
             enum ModulesEditType : std::int_fast8_t { Add, Replace, Remove, Clear };
-            Utilities::Collections::Queue<std::tuple<ModulesEditType, int, Module*>> ToEditModules;
-            Utilities::Collections::List<Module*> UpdatingModules;
-            Utilities::Collections::Queue<std::tuple<ExecutionType, ScheduledJob, double>> ToSchedule;
+            // Pushed while the Modules list is locked
+            Utilities::Collections::Inbox<std::tuple<ModulesEditType, int, Module*>> ToEditModules;
+            // Only accessed by the thread that runs the loop
+            Utilities::Collections::List<Module*, false> UpdatingModules;
+            // New, rescheduled and repeated jobs, each with a reference owned by the inbox.
+            // The reference is moved to Schedules if the job is not in it yet.
+            Utilities::Collections::Inbox<ScheduledJob*> ToSchedule;
 
+            bool WaitUntil(std::chrono::steady_clock::time_point Deadline);
+            void WaitIdle(std::chrono::steady_clock::time_point Deadline, bool HasDeadline);
+            void WakeIfIdle();
+            bool Push(ScheduledJob*);
+            bool Reschedule(ScheduledJob*, double Time);
+            void ClearToSchedule();
             void ExecuteScheduledJob(ScheduledJob&);
             void ExecuteUpdate(Module*);
         };
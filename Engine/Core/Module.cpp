@@ -7,7 +7,7 @@ namespace Engine
         Module::Module(std::int_fast8_t ExecutionChunk) : ExecutionChunk(ExecutionChunk >= -128 ?
                                                             (ExecutionChunk <= 127 ? ExecutionChunk : 127)
                                                             : -128),
-                                                        isEnabled(true), loop(nullptr) {}
+                                                        isEnabled(true), loop(nullptr), isSignalled(false) {}
 
         Module::~Module() {}
 
@@ -17,7 +17,10 @@ namespace Engine
             {
                 isEnabled = true;
                 if (loop != nullptr && loop.Get()->isRunning)
+                {
                     OnEnable();
+                    loop.Get()->Wake();
+                }
             }
         }
 
@@ -51,6 +54,19 @@ namespace Engine
             return ExecutionType::BoundedAsync;
         }
 
+        UpdateMode Module::GetUpdateMode()
+        {
+            return UpdateMode::EveryTick;
+        }
+
+        void Module::Signal()
+        {
+            isSignalled.store(true);
+            Loop * loop = this->loop;
+            if (loop != nullptr)
+                loop->Wake();
+        }
+
         void Module::OnException(std::exception& e) {} // ignore
 
         double Module::GetTime()
@@ -96,34 +112,48 @@ namespace Engine
             return loop;
         }
 
-        void Module::Schedule(
-                std::function<void()> Task,
+        ScheduleHandle Module::Schedule(
+                Utilities::Task<void()> Task,
                 double Time,
                 ExecutionType ExecutionType
         ) {
             if (GetLoop() == nullptr)
                 throw std::runtime_error("No loop to schedule in.");
-            GetLoop()->Schedule(Time, ExecutionType, Task, [&](std::exception& e) { OnException(e); });
+            return GetLoop()->Schedule(Time, ExecutionType, std::move(Task), [this](std::exception& e) { OnException(e); });
         }
 
-        void Module::Schedule(
+        ScheduleHandle Module::Schedule(
                 double Time,
-                std::function<void()> Task,
+                Utilities::Task<void()> Task,
                 ExecutionType ExecutionType
         ) {
             if (GetLoop() == nullptr)
                 throw std::runtime_error("No loop to schedule in.");
-            GetLoop()->Schedule(Time, ExecutionType, Task, [&](std::exception& e) { OnException(e); });
+            return GetLoop()->Schedule(Time, ExecutionType, std::move(Task), [this](std::exception& e) { OnException(e); });
         }
 
-        void Module::Schedule(
+        ScheduleHandle Module::Schedule(
                 double Time,
                 ExecutionType ExecutionType,
-                std::function<void()> Task
+                Utilities::Task<void()> Task
+        ) {
+            if (GetLoop() == nullptr)
+                throw std::runtime_error("No loop to schedule in.");
+            return GetLoop()->Schedule(Time, ExecutionType, std::move(Task), [this](std::exception& e) { OnException(e); });
+        }
+
+        ScheduleHandle Module::ScheduleRepeating(
+                double Period,
+                RepeatType RepeatType,
+                Utilities::Task<void()> Task,
+                double Time,
+                ExecutionType ExecutionType
         ) {
             if (GetLoop() == nullptr)
                 throw std::runtime_error("No loop to schedule in.");
-            GetLoop()->Schedule(Time, ExecutionType, Task, [&](std::exception& e) { OnException(e); });
+            return GetLoop()->ScheduleRepeating(
+                Period, RepeatType, std::move(Task), [this](std::exception& e) { OnException(e); }, Time, ExecutionType
+            );
         }
 
         void Module::Acquire(Loop * loop)
@@ -131,6 +161,7 @@ namespace Engine
             if (this->loop != nullptr)
                 throw std::logic_error("Cannot add one Module to multiple Loops.");
             this->loop = loop;
+            ENGINE_PROFILE_SOURCE_NAME(this, GetName());
         }
 
         void Module::Release()
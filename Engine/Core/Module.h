@@ -2,6 +2,7 @@
 
 #include "../Engine.dec.h"
 #include "../Utilities/Shared.h"
+#include "ScheduleHandle.h"
 
 namespace Engine
 {
@@ -49,6 +50,17 @@ namespace Engine
             virtual std::string GetName() = 0;
 
             virtual ExecutionType GetExecutionType();
+            /// @brief Gets when the module is updated, EveryTick by default.
+            ///
+            /// A Loop whose enabled modules are all WhenSignalled sleeps
+            /// until a module is signalled or a scheduled job is due.
+            virtual UpdateMode GetUpdateMode();
+
+            /// @brief Requests an update of a WhenSignalled module on the next tick,
+            ///        waking the Loop if it is sleeping.
+            ///
+            /// Signals are merged until the update. Can be called by any thread.
+            void Signal();
         protected:
             /// @brief Is called on loop start or when being added
             ///        to the loop while the loop is running.
@@ -100,8 +112,11 @@ namespace Engine
             /// @param Task The function that will be called.
             /// @param Time The time when the function will be called.
             ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
-            void Schedule(
-                std::function<void()> Task,
+            ///        Has a precision of 1 millisecond, the function is never called early.
+            /// @return A handle to cancel the job.
+            ///         Is empty if the Loop is not running or its schedule inbox is full.
+            ScheduleHandle Schedule(
+                Utilities::Task<void()> Task,
                 double Time = 0,
                 ExecutionType ExecutionType = ExecutionType::BoundedAsync
             );
@@ -115,9 +130,12 @@ namespace Engine
             /// @param Task The function that will be called.
             /// @param Time The time when the function will be called.
             ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
-            void Schedule(
+            ///        Has a precision of 1 millisecond, the function is never called early.
+            /// @return A handle to cancel the job.
+            ///         Is empty if the Loop is not running or its schedule inbox is full.
+            ScheduleHandle Schedule(
                 double Time,
-                std::function<void()> Task,
+                Utilities::Task<void()> Task,
                 ExecutionType ExecutionType = ExecutionType::BoundedAsync
             );
             /// @brief Schedules to call a function.
@@ -130,16 +148,41 @@ namespace Engine
             /// @param Task The function that will be called.
             /// @param Time The time when the function will be called.
             ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
-            void Schedule(
+            ///        Has a precision of 1 millisecond, the function is never called early.
+            /// @return A handle to cancel the job.
+            ///         Is empty if the Loop is not running or its schedule inbox is full.
+            ScheduleHandle Schedule(
                 double Time,
                 ExecutionType ExecutionType,
-                std::function<void()> Task
+                Utilities::Task<void()> Task
+            );
+            /// @brief Schedules to call a function repeatedly.
+            ///
+            /// Will stop calling when the Loop is stopped or the returned handle is cancelled.
+            /// A call is never started while the previous call is running.
+            ///
+            /// The exceptions thrown by the Task will be handled by this module
+            ///
+            /// @param Period The time between the calls, in seconds with a precision of 1 millisecond.
+            /// @param RepeatType Whether the Period is counted from the start of the previous call or from its end.
+            /// @param Task The function that will be called.
+            /// @param Time The time of the first call.
+            ///        Time = 0 or Time <= CurrentTime results in calling the function shortly.
+            /// @return A handle to cancel the calls or reschedule the next one.
+            ///         Is empty if the Loop is not running or its schedule inbox is full.
+            ScheduleHandle ScheduleRepeating(
+                double Period,
+                RepeatType RepeatType,
+                Utilities::Task<void()> Task,
+                double Time = 0,
+                ExecutionType ExecutionType = ExecutionType::BoundedAsync
             );
         private:
             const std::int_fast8_t ExecutionChunk;
 
             Utilities::Shared<bool> isEnabled;
             Utilities::Shared<Loop*> loop;
+            std::atomic<bool> isSignalled;
 
             void Acquire(Loop*);
             void Release();
@@ -0,0 +1,195 @@
+#include "../Engine.h"
+
+namespace Engine
+{
+    namespace Core
+    {
+// -------- SCHEDULED JOB -------- //
+
+        // The freed jobs are kept in a cache per thread.
+        // A job is usually created by one thread and freed by another (the Loop or an executor),
+        // so the caches move the blocks between the threads in batches through a global list.
+        // The blocks are never deleted, there are at most as many as the peak number of jobs.
+        struct FreeJobBlock
+        {
+            FreeJobBlock * Next;
+            /// @brief The next batch in FreeJobBatches, only set on the first block of a batch.
+            FreeJobBlock * NextBatch;
+            /// @brief The number of blocks of the batch, only set on the first block of a batch.
+            int BatchCount;
+        };
+        static_assert(sizeof(FreeJobBlock) <= sizeof(ScheduledJob), "A ScheduledJob cannot hold a FreeJobBlock.");
+
+        // Is zero-initialized and trivially destructible, so no access needs an initialization check.
+        struct FreeJobCache
+        {
+            static constexpr int BatchCount = 64;
+
+            FreeJobBlock * Blocks;
+            int Count;
+        };
+
+        static std::mutex FreeJobBatchesMutex;
+        static FreeJobBlock * FreeJobBatches = nullptr;
+
+        static thread_local FreeJobCache ThreadFreeJobs;
+
+        // Gives the cached blocks of a thread to the other threads when it exits
+        struct FreeJobCacheOwner
+        {
+            ~FreeJobCacheOwner()
+            {
+                if (ThreadFreeJobs.Count == 0)
+                    return;
+                ThreadFreeJobs.Blocks->BatchCount = ThreadFreeJobs.Count;
+                std::lock_guard<std::mutex> guard(FreeJobBatchesMutex);
+                ThreadFreeJobs.Blocks->NextBatch = FreeJobBatches;
+                FreeJobBatches = ThreadFreeJobs.Blocks;
+                ThreadFreeJobs.Blocks = nullptr;
+                ThreadFreeJobs.Count = 0;
+            }
+        };
+
+        static thread_local FreeJobCacheOwner ThreadFreeJobsOwner;
+
+        void * ScheduledJob::operator new(std::size_t Size)
+        {
+            if (ThreadFreeJobs.Count == 0)
+            {
+                std::lock_guard<std::mutex> guard(FreeJobBatchesMutex);
+                if (FreeJobBatches == nullptr)
+                    return ::operator new(Size);
+                ThreadFreeJobs.Blocks = FreeJobBatches;
+                ThreadFreeJobs.Count = FreeJobBatches->BatchCount;
+                FreeJobBatches = FreeJobBatches->NextBatch;
+            }
+            FreeJobBlock * block = ThreadFreeJobs.Blocks;
+            ThreadFreeJobs.Blocks = block->Next;
+            ThreadFreeJobs.Count--;
+            return block;
+        }
+
+        void ScheduledJob::operator delete(void * Pointer) noexcept
+        {
+            if (ThreadFreeJobs.Count == 0)
+                (void)&ThreadFreeJobsOwner; // Registers its destruction on the exit of the thread
+
+            FreeJobBlock * block = (FreeJobBlock*)Pointer;
+            block->Next = ThreadFreeJobs.Blocks;
+            ThreadFreeJobs.Blocks = block;
+            if (++ThreadFreeJobs.Count < FreeJobCache::BatchCount * 2)
+                return;
+
+            // Keeps a batch for the thread and gives the other one away
+            FreeJobBlock * last = block;
+            for (int i = 1; i < FreeJobCache::BatchCount; i++)
+                last = last->Next;
+            ThreadFreeJobs.Blocks = last->Next;
+            ThreadFreeJobs.Count -= FreeJobCache::BatchCount;
+            last->Next = nullptr;
+            block->BatchCount = FreeJobCache::BatchCount;
+            std::lock_guard<std::mutex> guard(FreeJobBatchesMutex);
+            block->NextBatch = FreeJobBatches;
+            FreeJobBatches = block;
+        }
+
+        ScheduledJob::ScheduledJob(
+            Utilities::Task<void()> Task,
+            Utilities::Task<void(std::exception&)> ExceptionHandler,
+            ExecutionType Type,
+            long long DueTick,
+            Loop * ParentLoop,
+            long long PeriodTicks,
+            RepeatType Repeat
+        ) : Task(std::move(Task)), ExceptionHandler(std::move(ExceptionHandler)), Type(Type),
+            Repeat(Repeat), PeriodTicks(PeriodTicks), DueTick(DueTick), State(States::Pending), ParentLoop(ParentLoop),
+            Next(nullptr), Prev(nullptr), SlotIndex(-1), ReferencesCount(1) {}
+
+        void ScheduledJob::AddReference()
+        {
+            ReferencesCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void ScheduledJob::RemoveReference()
+        {
+            if (ReferencesCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+
+        bool ScheduledJob::CancelIfNotStarted()
+        {
+            int state = State.load();
+            while (state == States::Pending || state == States::Queued || state == States::Rescheduling)
+                if (State.compare_exchange_weak(state, States::Cancelled))
+                    return true;
+            return false;
+        }
+
+// -------- SCHEDULE HANDLE -------- //
+
+        ScheduleHandle::ScheduleHandle() : Job(nullptr) {}
+
+        ScheduleHandle::ScheduleHandle(ScheduledJob * Job) : Job(Job)
+        {
+            if (Job != nullptr)
+                Job->AddReference();
+        }
+
+        ScheduleHandle::~ScheduleHandle()
+        {
+            if (Job != nullptr)
+                Job->RemoveReference();
+        }
+
+        ScheduleHandle::ScheduleHandle(const ScheduleHandle& Other) : ScheduleHandle(Other.Job) {}
+
+        ScheduleHandle::ScheduleHandle(ScheduleHandle&& Other) noexcept : Job(Other.Job)
+        {
+            Other.Job = nullptr;
+        }
+
+        ScheduleHandle& ScheduleHandle::operator=(ScheduleHandle Other) noexcept
+        {
+            std::swap(Job, Other.Job);
+            return *this;
+        }
+
+        bool ScheduleHandle::Cancel()
+        {
+            if (Job == nullptr)
+                return false;
+            // A started repeating job is cancelled before its next call
+            int state = Job->State.load();
+            while (state == ScheduledJob::States::Pending
+                   || state == ScheduledJob::States::Queued
+                   || state == ScheduledJob::States::Rescheduling
+                   || (state == ScheduledJob::States::Started && Job->PeriodTicks > 0))
+                if (Job->State.compare_exchange_weak(state, ScheduledJob::States::Cancelled))
+                    return true;
+            return false;
+        }
+
+        bool ScheduleHandle::Reschedule(double Time)
+        {
+            if (Job == nullptr)
+                return false;
+            return Job->ParentLoop->Reschedule(Job, Time);
+        }
+
+        bool ScheduleHandle::IsPending()
+        {
+            if (Job == nullptr)
+                return false;
+            int state = Job->State.load();
+            return state == ScheduledJob::States::Pending
+                   || state == ScheduledJob::States::Queued
+                   || state == ScheduledJob::States::Rescheduling
+                   || (state == ScheduledJob::States::Started && Job->PeriodTicks > 0);
+        }
+
+        ScheduleHandle::operator bool() const
+        {
+            return Job != nullptr;
+        }
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../Engine.dec.h"
+#include "../Utilities/Task.h"
+
+namespace Engine
+{
+    namespace Core
+    {
+        struct ScheduledJob final
+        {
+            /// Queued: returned by the TimingWheel as due and handed to an executor, not started yet.
+            /// Rescheduling: being moved to a new time by Loop::Reschedule, is Pending again after it.
+            enum States : int { Pending = 0, Cancelled = 1, Started = 2, Queued = 3, Rescheduling = 4 };
+
+            Utilities::Task<void()> Task;
+            Utilities::Task<void(std::exception&)> ExceptionHandler;
+            ExecutionType Type;
+            RepeatType Repeat;
+            /// @brief The period in milliseconds, 0 if the job is not repeating.
+            long long PeriodTicks;
+            /// @brief The due time in milliseconds since the start of the Loop.
+            std::atomic<long long> DueTick;
+            std::atomic<int> State;
+            Loop * ParentLoop;
+
+            // Links of the TimingWheel, only accessed by the thread that runs the Loop
+
+            /// @brief The next job in the same TimingWheel slot or in the list of due jobs.
+            ScheduledJob * Next;
+            ScheduledJob * Prev;
+            /// @brief The index of the TimingWheel slot that contains the job, -1 if none.
+            int SlotIndex;
+
+            /// @brief Creates a job with one reference.
+            ScheduledJob(
+                Utilities::Task<void()> Task,
+                Utilities::Task<void(std::exception&)> ExceptionHandler,
+                ExecutionType Type,
+                long long DueTick,
+                Loop * ParentLoop,
+                long long PeriodTicks = 0,
+                RepeatType Repeat = RepeatType::FixedRate
+            );
+
+            void AddReference();
+            /// @brief Deletes the job when the last reference is removed.
+            void RemoveReference();
+            /// @brief Cancels the job if it is not started yet.
+            /// @return Whether the job is cancelled by this call.
+            bool CancelIfNotStarted();
+
+            /// @brief Reuses the memory of a freed job if any, so scheduling does not allocate once warmed up.
+            static void * operator new(std::size_t Size);
+            /// @brief Keeps the memory for the next jobs.
+            static void operator delete(void * Pointer) noexcept;
+        private:
+            std::atomic<int> ReferencesCount;
+        };
+
+        class ScheduleHandle final
+        {
+            friend Loop;
+        public:
+            /// @brief Creates an empty handle.
+            ScheduleHandle();
+            ~ScheduleHandle();
+
+            ScheduleHandle(const ScheduleHandle&);
+            ScheduleHandle(ScheduleHandle&&) noexcept;
+            ScheduleHandle& operator=(ScheduleHandle) noexcept;
+
+            /// @brief Cancels the scheduled job if it is not started yet,
+            ///        or stops the future calls of a repeating job.
+            ///
+            /// Can be called by any thread.
+            ///
+            /// @return Whether the job is cancelled by this call.
+            bool Cancel();
+            /// @brief Moves the job to a new time if it is still pending.
+            ///
+            /// Can be called by any thread, as long as the Loop exists.
+            /// For a repeating job, sets the time of the next call.
+            ///
+            /// @param Time The new time, like the Time of Loop::Schedule.
+            /// @return false if the job is already due and handed to an executor, started, cancelled,
+            ///         being rescheduled by another thread, or the Loop is not running.
+            ///         If true, the job is not called at its previous time.
+            bool Reschedule(double Time);
+            /// @brief Checks if the job is going to be called,
+            ///        i.e. is not started or cancelled, or is repeating and not cancelled.
+            bool IsPending();
+
+            /// @brief Checks if the handle refers to a job, i.e. the schedule was successful.
+            explicit operator bool() const;
+        private:
+            ScheduledJob * Job;
+
+            /// @brief Adds a reference to the Job.
+            ScheduleHandle(ScheduledJob * Job);
+        };
+    }
+}
@@ -0,0 +1,221 @@
+#include "../Engine.h"
+
+namespace Engine
+{
+    namespace Core
+    {
+        TimingWheel::TimingWheel() : Slots(), DueCount(0), CurrentTick(0), Count(0), LevelCounts() {}
+
+        TimingWheel::~TimingWheel()
+        {
+            Clear();
+        }
+
+        void TimingWheel::Add(ScheduledJob * Job)
+        {
+            Insert(Job);
+        }
+
+        ScheduledJob * TimingWheel::Advance(long long Tick)
+        {
+            while (CurrentTick < Tick)
+            {
+                if (Count == 0)
+                {
+                    CurrentTick = Tick;
+                    break;
+                }
+
+                // Skip to the next slot boundary of the lowest level that has jobs
+                int empty_levels = 0;
+                while (empty_levels + 1 < LevelsCount && LevelCounts[empty_levels] == 0)
+                    empty_levels++;
+                if (empty_levels > 0)
+                {
+                    long long last_empty_tick = CurrentTick | ((1LL << (SlotBits * empty_levels)) - 1);
+                    if (last_empty_tick >= Tick)
+                    {
+                        CurrentTick = Tick;
+                        break;
+                    }
+                    CurrentTick = last_empty_tick;
+                }
+                CurrentTick++;
+
+                // Cascade the higher levels that reached a new slot, from the top,
+                // then the jobs of level 0 become due.
+                int level = 0;
+                while (level + 1 < LevelsCount && (CurrentTick & ((1LL << (SlotBits * (level + 1))) - 1)) == 0)
+                    level++;
+                for (; level >= 0; level--)
+                {
+                    ScheduledJob * job = Take(level * SlotsCount + (int)((CurrentTick >> (SlotBits * level)) & (SlotsCount - 1)));
+                    while (job != nullptr)
+                    {
+                        ScheduledJob * next = job->Next;
+                        if (job->State.load(std::memory_order_relaxed) == ScheduledJob::States::Cancelled)
+                        {
+                            job->SlotIndex = -1;
+                            job->RemoveReference();
+                        }
+                        else
+                            Insert(job); // Level 0 jobs are either due, or further than the wheel covers
+                        job = next;
+                    }
+                }
+            }
+
+            ScheduledJob * due = Take(DueSlotIndex);
+            for (ScheduledJob * job = due; job != nullptr; job = job->Next)
+                job->SlotIndex = -1;
+            return due;
+        }
+
+        void TimingWheel::Remove(ScheduledJob * Job)
+        {
+            Slot& slot = Slots[Job->SlotIndex];
+            if (Job->Prev == nullptr)
+                slot.First = Job->Next;
+            else
+                Job->Prev->Next = Job->Next;
+            if (Job->Next == nullptr)
+                slot.Last = Job->Prev;
+            else
+                Job->Next->Prev = Job->Prev;
+
+            slot.Count--;
+            if (Job->SlotIndex == DueSlotIndex)
+                DueCount--;
+            else
+            {
+                Count--;
+                LevelCounts[Job->SlotIndex / SlotsCount]--;
+            }
+            Job->Next = nullptr;
+            Job->Prev = nullptr;
+            Job->SlotIndex = -1;
+        }
+
+        void TimingWheel::Clear()
+        {
+            for (int i = 0; i <= DueSlotIndex; i++)
+            {
+                ScheduledJob * job = Take(i);
+                while (job != nullptr)
+                {
+                    ScheduledJob * next = job->Next;
+                    job->CancelIfNotStarted();
+                    job->SlotIndex = -1;
+                    job->RemoveReference();
+                    job = next;
+                }
+            }
+            CurrentTick = 0;
+        }
+
+        bool TimingWheel::Contains(ScheduledJob * Job)
+        {
+            return Job->SlotIndex >= 0;
+        }
+
+        int TimingWheel::GetCount()
+        {
+            return Count + DueCount;
+        }
+
+        long long TimingWheel::GetCurrentTick()
+        {
+            return CurrentTick;
+        }
+
+        long long TimingWheel::GetNextEventTick()
+        {
+            if (DueCount > 0)
+                return CurrentTick;
+
+            long long next_tick = -1;
+            for (int level = 0; level < LevelsCount; level++)
+            {
+                if (LevelCounts[level] == 0)
+                    continue;
+                // The slots of a level are reached in order, starting after the current one
+                int shift = SlotBits * level;
+                int current = (int)((CurrentTick >> shift) & (SlotsCount - 1));
+                for (int i = 1; i <= SlotsCount; i++)
+                {
+                    int index = (current + i) & (SlotsCount - 1);
+                    if (Slots[level * SlotsCount + index].Count == 0)
+                        continue;
+                    long long rotation_start = (CurrentTick >> (shift + SlotBits)) << (shift + SlotBits);
+                    long long tick = rotation_start + ((long long)index << shift);
+                    if (index <= current)
+                        tick += 1LL << (shift + SlotBits);
+                    if (next_tick < 0 || tick < next_tick)
+                        next_tick = tick;
+                    break;
+                }
+            }
+            return next_tick;
+        }
+
+        void TimingWheel::Insert(ScheduledJob * Job)
+        {
+            long long tick = Job->DueTick.load(std::memory_order_relaxed);
+            long long delta = tick - CurrentTick;
+            if (delta <= 0)
+            {
+                Append(DueSlotIndex, Job);
+                return;
+            }
+
+            int level = 0;
+            while (level + 1 < LevelsCount && delta >= (1LL << (SlotBits * (level + 1))))
+                level++;
+            // Too far for the wheel, will be inserted again when its slot is reached
+            if (delta >= (1LL << (SlotBits * LevelsCount)))
+                tick = CurrentTick + (1LL << (SlotBits * LevelsCount)) - 1;
+
+            Append(level * SlotsCount + (int)((tick >> (SlotBits * level)) & (SlotsCount - 1)), Job);
+        }
+
+        inline void TimingWheel::Append(int SlotIndex, ScheduledJob * Job)
+        {
+            Slot& slot = Slots[SlotIndex];
+            Job->Next = nullptr;
+            Job->Prev = slot.Last;
+            Job->SlotIndex = SlotIndex;
+            if (slot.Last == nullptr)
+                slot.First = Job;
+            else
+                slot.Last->Next = Job;
+            slot.Last = Job;
+            slot.Count++;
+
+            if (SlotIndex == DueSlotIndex)
+                DueCount++;
+            else
+            {
+                Count++;
+                LevelCounts[SlotIndex / SlotsCount]++;
+            }
+        }
+
+        // The SlotIndex of the taken jobs is left to be updated by the caller
+        inline ScheduledJob * TimingWheel::Take(int SlotIndex)
+        {
+            Slot& slot = Slots[SlotIndex];
+            ScheduledJob * first = slot.First;
+            if (SlotIndex == DueSlotIndex)
+                DueCount -= slot.Count;
+            else
+            {
+                Count -= slot.Count;
+                LevelCounts[SlotIndex / SlotsCount] -= slot.Count;
+            }
+            slot.First = nullptr;
+            slot.Last = nullptr;
+            slot.Count = 0;
+            return first;
+        }
+    }
+}
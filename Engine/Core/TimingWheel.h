@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../Engine.dec.h"
+
+namespace Engine
+{
+    namespace Core
+    {
+        /// Has 4 levels of 256 slots. A slot of level L covers 256^L ticks,
+        /// its jobs are moved to the lower levels when the wheel reaches it.
+        /// Jobs due further than 256^4 ticks are moved around level 3 until they are due.
+        ///
+        /// Only the thread that runs the Loop may use the wheel.
+        class TimingWheel final
+        {
+        public:
+            TimingWheel();
+            ~TimingWheel();
+
+            TimingWheel(const TimingWheel&) = delete;
+            TimingWheel& operator=(const TimingWheel&) = delete;
+
+            /// @brief Adds a job by its DueTick in O(1).
+            ///
+            /// The wheel owns a reference of the job until it is returned by Advance.
+            /// Jobs due at or before the current tick are returned by the next Advance.
+            void Add(ScheduledJob * Job);
+            /// @brief Moves the wheel forward to Tick.
+            ///
+            /// Cancelled jobs met on the way are dropped.
+            ///
+            /// @return The due jobs linked by their Next, in the order of their slots.
+            ///         The caller owns their references.
+            ScheduledJob * Advance(long long Tick);
+            /// @brief Removes a job in O(1), giving its reference back to the caller.
+            void Remove(ScheduledJob * Job);
+            /// @brief Cancels and removes all jobs, and moves the wheel back to tick 0.
+            void Clear();
+
+            /// @brief Checks if a job is in the wheel.
+            bool Contains(ScheduledJob * Job);
+
+            /// @brief Gets the number of jobs in the wheel, including the cancelled ones not dropped yet.
+            int GetCount();
+            /// @brief Gets the tick that the wheel has reached.
+            long long GetCurrentTick();
+            /// @brief Gets the first tick at which Advance may return a job or move jobs between levels.
+            ///
+            /// No job is due before it, so it is the latest time to wake up for the next Advance.
+            ///
+            /// @return -1 if the wheel is empty.
+            long long GetNextEventTick();
+        private:
+            static constexpr int LevelsCount = 4;
+            static constexpr int SlotBits = 8;
+            static constexpr int SlotsCount = 1 << SlotBits;
+
+            /// @brief The SlotIndex of the jobs that are due but not returned by Advance yet.
+            static constexpr int DueSlotIndex = LevelsCount * SlotsCount;
+
+            struct Slot
+            {
+                ScheduledJob * First;
+                ScheduledJob * Last;
+                int Count;
+            };
+
+            /// @brief Slots[Level * SlotsCount + Index], the last one is the list of due jobs.
+            Slot Slots[LevelsCount * SlotsCount + 1];
+            int DueCount;
+            long long CurrentTick;
+            /// @brief The number of jobs in Slots.
+            int Count;
+            /// @brief The number of jobs in each level of Slots.
+            int LevelCounts[LevelsCount];
+
+            void Insert(ScheduledJob * Job);
+            void Append(int SlotIndex, ScheduledJob * Job);
+            ScheduledJob * Take(int SlotIndex);
+        };
+    }
+}
@@ -1,11 +1,24 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
 #include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
 #include <mutex>
+#include <new>
+#include <ostream>
 #include <shared_mutex>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -26,32 +39,115 @@ namespace Engine
             class LockAfterSharedLockException;
             class TryLockAfterSharedLockException;
             class UpgradableSharedLockAfterSharedLockException;
+            class UnlockedGuardException;
         }
+        /// @brief Which waiting threads a RecursiveMutex lets in first.
+        enum RecursiveMutexFairness : std::int_fast8_t {
+            /// @brief Shared-locks are acquired while a lock is waiting.
+            ///        A stream of readers can keep a writer out indefinitely.
+            ReaderPreferring = 0,
+            /// @brief New shared-locks wait while a lock is waiting.
+            ///        A stream of writers can keep the readers out indefinitely.
+            WriterPreferring = 1,
+            /// @brief New shared-locks wait while a lock is waiting,
+            ///        and the shared-locks that waited are acquired before the next lock.
+            ///        Neither readers nor writers wait for more than one phase of the other.
+            PhaseFair = 2,
+        };
+        /// @brief The kinds of RecursiveMutex acquisitions, as reported by the lock debugging tools.
+        enum RecursiveMutexLockKind : std::int_fast8_t {
+            ExclusiveLockKind = 0,
+            SharedLockKind = 1,
+            UpgradableSharedLockKind = 2,
+        };
         /// @brief Mutex that supports recursive locking in a thread.
         ///
         /// This class is meant for sharing data between different threads
         /// and is much easier to use than a normal mutex.
-        template <bool SupportsSharedLock = true, bool SupportsUpgradableSharedLock = true> class RecursiveMutex;
+        template <
+            bool SupportsSharedLock = true,
+            bool SupportsUpgradableSharedLock = true,
+            RecursiveMutexFairness Fairness = PhaseFair
+        > class RecursiveMutex;
         /// @brief To be the base class for the classes that use a RecursiveMutex
         ///        and need a LockAndDo function.
         template <bool SupportsSharedLock = true, bool SupportsUpgradableSharedLock = true> class MutexContained;
         /// @brief Shared object with automatic mutex locking on set/get.
         /// @tparam AllowManualLocking If true, The class will use a public RecursiveMutex that
         ///         can also be controlled by user.
-        ///         Else, a private std::shared_mutex will be used.
+        ///         Else, the type is stored in a std::atomic if it is always lock-free,
+        ///         behind a sequence lock if it is trivially copyable,
+        ///         or behind a private std::shared_mutex otherwise.
         template <typename Type, bool AllowManualLocking = false> class Shared;
+        /// @brief A move-only function wrapper.
+        ///
+        /// Stores small functions without a heap allocation, sizeof(Task) is 64 bytes by default.
+        template <typename Signature, std::size_t InlineSize = 56> class Task;
+        /// @brief Records timing events per thread and exports them as Chrome traces.
+        ///
+        /// The engine is only instrumented if ENGINE_PROFILING is defined.
+        class Profiler;
+        /// @brief Collects the contention statistics of the RecursiveMutexes and reports them as text or JSON.
+        ///
+        /// The mutexes are only instrumented if ENGINE_LOCK_PROFILING is defined.
+        class LockProfiler;
+        /// @brief The contention statistics of a RecursiveMutex.
+        struct LockStats;
+        /// @brief Records the order in which the threads acquire the RecursiveMutexes
+        ///        and reports the orders that may deadlock.
+        ///
+        /// The mutexes are only checked if ENGINE_LOCK_ORDER_CHECKING is defined.
+        class LockOrderChecker;
+        /// @brief A RecursiveMutex in the lock-order graph of the LockOrderChecker.
+        struct LockOrderNode;
+        /// @brief Thread pool with per-worker job deques and work stealing.
+        ///
+        /// Fed by a single thread that uses Wait as a barrier.
+        class WorkStealingPool;
 
         namespace Collections
         {
             template <typename ItemsType, bool UseMutex = true> class ResizableArray;
+            /// @brief How List, Stack, Queue and PriorityQueue grow and shrink their allocated memory.
+            struct GrowthPolicy;
             /// @brief Array list or array list interface.
             ///
             /// List interfaces define custom Add, Remove, SetItem and Clear functions for a list.
             template <typename ItemsType, bool UseMutex = true> class List;
             template <typename ItemsType, bool UseMutex = true> class Stack;
             template <typename ItemsType, bool UseMutex = true> class Queue;
-            template <typename ItemsType, typename PriorityType = int, bool LessPriorityFirst = true, bool UseMutex = true> class PriorityQueue;
+            /// @brief A heap of items ordered by priority.
+            /// @tparam Arity The number of children of a heap node, 2 for a binary heap.
+            /// @tparam StableOrder Whether the items of equal priority pop in the order they were pushed.
+            template <
+                typename ItemsType,
+                typename PriorityType = int,
+                bool LessPriorityFirst = true,
+                bool UseMutex = true,
+                int Arity = 4,
+                bool StableOrder = true
+            > class PriorityQueue;
+            /// @brief A priority queue whose Push returns a handle, to update the priority of the item or remove it.
+            template <
+                typename ItemsType,
+                typename PriorityType = int,
+                bool LessPriorityFirst = true,
+                bool UseMutex = true,
+                int Arity = 4
+            > class IndexedPriorityQueue;
             template <typename KeyType, typename ValueType, bool UseMutex = true> class Dictionary;
+            /// @brief A sorted dictionary, a B+-tree with logarithmic inserts and range queries.
+            template <typename KeyType, typename ValueType, bool UseMutex = true> class OrderedDictionary;
+            /// @brief An unordered dictionary, an open-addressing hash table with constant-time lookups.
+            template <typename KeyType, typename ValueType, bool UseMutex = true, typename HashType = std::hash<KeyType>> class HashDictionary;
+            /// @brief A thread-safe unordered dictionary, striped over HashDictionaries with their own mutexes.
+            template <typename KeyType, typename ValueType, typename HashType = std::hash<KeyType>> class ConcurrentDictionary;
+            /// @brief A lock-free multi-producer single-consumer queue.
+            template <typename ItemsType> class Inbox;
+            /// @brief A lock-free fixed-capacity single-producer single-consumer ring queue.
+            template <typename ItemsType> class SpscRingQueue;
+            /// @brief A lock-free fixed-capacity multi-producer multi-consumer ring queue.
+            template <typename ItemsType> class MpmcRingQueue;
         }
     }
 
@@ -67,11 +163,58 @@ namespace Engine
             /// @brief Are executed inside the loop in separate threads.
             ///        Recommended for normal Modules.
             BoundedAsync = 0,
-            /// @brief Are executed outside the loop in new individual threads.
+            /// @brief Are executed outside the loop by the FreeAsync worker threads.
             ///        Only recommended for long scheduled tasks that sleep a lot,
             ///        and NOT Modules.
             FreeAsync = 1,
         };
+        /// @brief What a Loop does with a FreeAsync Module update
+        ///        while the previous updates of the Module are not done yet.
+        enum FreeAsyncBackpressure : std::int_fast8_t {
+            /// @brief Skips the update.
+            SkipTick = 0,
+            /// @brief Merges the update into the one that is waiting to be executed.
+            ///        Queues it if the previous update is already running.
+            Coalesce = 1,
+            /// @brief Queues the update, as long as the FreeAsync queue is not full.
+            Enqueue = 2,
+        };
+        /// @brief How the next call of a repeating scheduled job is timed.
+        enum RepeatType : std::int_fast8_t {
+            /// @brief Every Period from the first call.
+            ///        The calls missed while the previous call was running are skipped.
+            FixedRate = 0,
+            /// @brief Period after the previous call returns.
+            FixedDelay = 1,
+        };
+        /// @brief When a Module is updated by its Loop.
+        enum UpdateMode : std::int_fast8_t {
+            /// @brief On every tick.
+            EveryTick = 0,
+            /// @brief Only on the ticks after Module::Signal is called.
+            ///        Lets the Loop sleep while there is nothing to do.
+            WhenSignalled = 1,
+        };
+        /// @brief How a Loop paces its ticks.
+        enum TickPolicy : std::int_fast8_t {
+            /// @brief Starts each tick right after the previous one.
+            ///        Keeps a core busy even if there is nothing to do.
+            Unthrottled = 0,
+            /// @brief Starts the ticks at a target frequency, sleeping between them.
+            ///        The time diff is the real time between the ticks.
+            TargetFrequency = 1,
+            /// @brief Runs one tick per timestep of real time, catching up if it is late.
+            ///        The time advances by exactly one timestep per tick.
+            FixedTimestep = 2,
+        };
+        /// @brief Executes the FreeAsync Modules and scheduled tasks of a Loop.
+        class FreeAsyncExecutor;
+        /// @brief A reference-counted job scheduled in a Loop.
+        struct ScheduledJob;
+        /// @brief Refers to a job scheduled in a Loop, used to cancel it.
+        class ScheduleHandle;
+        /// @brief Hierarchical timing wheel of ScheduledJob objects, with 1 millisecond ticks.
+        class TimingWheel;
         /// @brief Manages and runs Module objects.
         class Loop;
         /// @brief Abstract class to implement the application's modules.
@@ -2,15 +2,30 @@
 
 #include "Utilities/Accessor.h"
 #include "Utilities/RecursiveMutex.h"
+#include "Utilities/LockProfiler.h"
+#include "Utilities/LockOrderChecker.h"
 #include "Utilities/MutexContained.h"
 #include "Utilities/Shared.h"
+#include "Utilities/Task.h"
+#include "Utilities/Profiler.h"
+#include "Utilities/WorkStealingPool.h"
 
 #include "Utilities/Collections/ResizableArray.h"
 #include "Utilities/Collections/List.h"
 #include "Utilities/Collections/Stack.h"
 #include "Utilities/Collections/Queue.h"
 #include "Utilities/Collections/PriorityQueue.h"
+#include "Utilities/Collections/IndexedPriorityQueue.h"
 #include "Utilities/Collections/Dictionary.h"
+#include "Utilities/Collections/OrderedDictionary.h"
+#include "Utilities/Collections/HashDictionary.h"
+#include "Utilities/Collections/ConcurrentDictionary.h"
+#include "Utilities/Collections/Inbox.h"
+#include "Utilities/Collections/SpscRingQueue.h"
+#include "Utilities/Collections/MpmcRingQueue.h"
 
+#include "Core/FreeAsyncExecutor.h"
+#include "Core/ScheduleHandle.h"
+#include "Core/TimingWheel.h"
 #include "Core/Loop.h"
 #include "Core/Module.h"
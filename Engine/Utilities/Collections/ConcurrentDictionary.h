@@ -0,0 +1,444 @@
+#pragma once
+
+#include "../../Engine.dec.h"
+#include "../RecursiveMutex.h"
+#include "HashDictionary.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// The keys are spread by their hash over stripes, each one a HashDictionary with its own mutex,
+            /// so the threads that use the keys of different stripes do not wait for each other.
+            /// Each operation on a key locks one stripe only, and is atomic.
+            ///
+            /// ForEach copies one stripe at a time and calls the body with no lock,
+            /// so it only holds back the writers of a stripe while copying it,
+            /// and sees the changes of the stripes it has not copied yet.
+            /// GetSnapshot shared-locks all the stripes at once for a consistent copy.
+            template <typename KeyType, typename ValueType, typename HashType>
+            class ConcurrentDictionary final
+            {
+            public:
+                typedef std::function<void(KeyType Key)> ForEachBody;
+                typedef std::function<void(KeyType Key, bool& BreakLoop)> ForEachBodyWithBreakBool;
+                typedef std::function<void(KeyType Key, std::function<void()> Break)> ForEachBodyWithBreakFunction;
+                typedef std::function<void(KeyType Key, ValueType Value)> ForEachBodyWithValue;
+                typedef std::function<void(KeyType Key, ValueType Value, bool& BreakLoop)> ForEachBodyWithValueWithBreakBool;
+                typedef std::function<void(KeyType Key, ValueType Value, std::function<void()> Break)> ForEachBodyWithValueWithBreakFunction;
+                typedef std::function<ValueType(KeyType Key)> AddFunction;
+                typedef std::function<ValueType(KeyType Key, ValueType Value)> UpdateFunction;
+                typedef HashDictionary<KeyType, ValueType, false, HashType> SnapshotType;
+
+                /// @param StripesCount The number of stripes, rounded up to a power of 2.
+                ///        0 for 4 per hardware thread, at least 16.
+                ConcurrentDictionary(int StripesCount = 0);
+                ~ConcurrentDictionary();
+
+                ConcurrentDictionary(const ConcurrentDictionary&) = delete;
+                ConcurrentDictionary& operator=(const ConcurrentDictionary&) = delete;
+
+                /// @brief Assigns a value to a key.
+                void SetValue(KeyType Key, ValueType Value);
+                /// @brief Removes a key-value pair.
+                void Remove(KeyType Key);
+                /// @brief Removes a key-value pair, if the key exists.
+                /// @return Whether the key existed.
+                bool TryRemove(KeyType Key);
+                /// @brief Removes a key-value pair, if the key exists.
+                /// @param ValueOut The removed value, if the key existed.
+                /// @return Whether the key existed.
+                bool TryRemove(KeyType Key, ValueType& ValueOut);
+                /// @brief Clears the key-value pairs, one stripe at a time.
+                ///
+                /// The pairs added to the cleared stripes while clearing are kept.
+                void Clear();
+
+                /// @brief Gets the value that is assigned to a key, after assigning Value to it if it had none.
+                ValueType GetOrAdd(KeyType Key, ValueType Value);
+                /// @brief Gets the value that is assigned to a key, after assigning Add(Key) to it if it had none.
+                ///
+                /// Add is called once at most, while the stripe of the key is locked,
+                /// so it should not use the other keys of the dictionary.
+                ValueType GetOrAdd(KeyType Key, AddFunction Add);
+                /// @brief Assigns AddValue to a key if it had no value, or Update(Key, Value) otherwise.
+                ///
+                /// Update is called while the stripe of the key is locked,
+                /// so it should not use the other keys of the dictionary.
+                /// @return The new value.
+                ValueType AddOrUpdate(KeyType Key, ValueType AddValue, UpdateFunction Update);
+
+                /// @brief Gets the value that is assigned to a key.
+                ValueType GetValue(KeyType Key);
+                /// @brief Gets the value that is assigned to a key, if any.
+                /// @param ValueOut The value, if the key exists.
+                /// @return True if the key exists in the dictionary.
+                bool TryGetValue(KeyType Key, ValueType& ValueOut);
+                /// @brief Checks if a key exists in the dictionary.
+                /// @param Key The search subject.
+                /// @return True if the key exists in the dictionary.
+                bool Contains(KeyType Key);
+                /// @brief Gets the items count.
+                ///
+                /// Is an approximation while other threads are adding or removing.
+                int GetCount();
+                /// @brief Checks whether the dictionary is empty.
+                ///
+                /// Is an approximation while other threads are adding or removing.
+                bool IsEmpty();
+                /// @brief Gets the number of stripes.
+                int GetStripesCount();
+
+                /// @brief Copies the key-value pairs as they are at a single point in time.
+                ///
+                /// Shared-locks all the stripes while copying, so the writers wait for the whole copy.
+                SnapshotType GetSnapshot();
+
+                /// @brief Calls a function for each key, in no particular order, without locking while it is called.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEach(ForEachBody Body);
+                /// @brief Calls a function for each key, in no particular order, without locking while it is called.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEach(ForEachBodyWithBreakBool Body);
+                /// @brief Calls a function for each key, in no particular order, without locking while it is called.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEach(ForEachBodyWithBreakFunction Body);
+                /// @brief Calls a function for each key-value, in no particular order, without locking while it is called.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEach(ForEachBodyWithValue Body);
+                /// @brief Calls a function for each key-value, in no particular order, without locking while it is called.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEach(ForEachBodyWithValueWithBreakBool Body);
+                /// @brief Calls a function for each key-value, in no particular order, without locking while it is called.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEach(ForEachBodyWithValueWithBreakFunction Body);
+
+                /// @brief Names the mutexes of the stripes in the reports of the LockProfiler and the LockOrderChecker,
+                ///        like "Name[0]".
+                ///
+                /// Does nothing unless ENGINE_LOCK_PROFILING or ENGINE_LOCK_ORDER_CHECKING is defined.
+                void SetMutexName(std::string Name);
+            private:
+                class LoopBreaker {};
+
+                // On its own cache line, so the threads that use different stripes do not share one
+                struct alignas(64) Stripe
+                {
+                    RecursiveMutex<true, false> Mutex;
+                    HashDictionary<KeyType, ValueType, false, HashType> Items;
+                };
+
+                Stripe * Stripes;
+                int StripesCount;
+                /// @brief 64 - log2(StripesCount).
+                int StripeShift;
+                HashType Hasher;
+
+                inline Stripe& GetStripe(const KeyType& Key);
+                /// @brief Copies a stripe with its mutex shared-locked.
+                SnapshotType CopyStripe(int Index);
+                /// @brief Shared-locks all stripes, then copies them.
+                void CopyStripes(SnapshotType& Snapshot);
+            };
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ConcurrentDictionary<KeyType, ValueType, HashType>::ConcurrentDictionary(int StripesCount)
+            {
+                if (StripesCount <= 0)
+                    StripesCount = std::max(16, 4 * (int)std::thread::hardware_concurrency());
+                this->StripesCount = 1;
+                StripeShift = 64;
+                while (this->StripesCount < StripesCount)
+                {
+                    this->StripesCount *= 2;
+                    StripeShift--;
+                }
+                Stripes = new Stripe[this->StripesCount];
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ConcurrentDictionary<KeyType, ValueType, HashType>::~ConcurrentDictionary()
+            {
+                delete[] Stripes;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::SetValue(KeyType Key, ValueType Value)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetLock();
+                stripe.Items.SetValue(Key, Value);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::Remove(KeyType Key)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetLock();
+                stripe.Items.Remove(Key);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ConcurrentDictionary<KeyType, ValueType, HashType>::TryRemove(KeyType Key)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetLock();
+                if (!stripe.Items.Contains(Key))
+                    return false;
+                stripe.Items.Remove(Key);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ConcurrentDictionary<KeyType, ValueType, HashType>::TryRemove(KeyType Key, ValueType& ValueOut)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetLock();
+                if (!stripe.Items.TryGetValue(Key, ValueOut))
+                    return false;
+                stripe.Items.Remove(Key);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::Clear()
+            {
+                for (int i = 0; i < StripesCount; i++)
+                {
+                    auto guard = Stripes[i].Mutex.GetLock();
+                    Stripes[i].Items.Clear();
+                }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ValueType ConcurrentDictionary<KeyType, ValueType, HashType>::GetOrAdd(KeyType Key, ValueType Value)
+            {
+                Stripe& stripe = GetStripe(Key);
+                ValueType value;
+                {
+                    auto guard = stripe.Mutex.GetSharedLock();
+                    if (stripe.Items.TryGetValue(Key, value))
+                        return value;
+                }
+
+                auto guard = stripe.Mutex.GetLock();
+                // May have been added since the shared lock
+                if (stripe.Items.TryGetValue(Key, value))
+                    return value;
+                stripe.Items.SetValue(Key, Value);
+                return Value;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ValueType ConcurrentDictionary<KeyType, ValueType, HashType>::GetOrAdd(KeyType Key, AddFunction Add)
+            {
+                Stripe& stripe = GetStripe(Key);
+                ValueType value;
+                {
+                    auto guard = stripe.Mutex.GetSharedLock();
+                    if (stripe.Items.TryGetValue(Key, value))
+                        return value;
+                }
+
+                auto guard = stripe.Mutex.GetLock();
+                // May have been added since the shared lock
+                if (stripe.Items.TryGetValue(Key, value))
+                    return value;
+                value = Add(Key);
+                stripe.Items.SetValue(Key, value);
+                return value;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ValueType ConcurrentDictionary<KeyType, ValueType, HashType>::AddOrUpdate(KeyType Key, ValueType AddValue, UpdateFunction Update)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetLock();
+                ValueType value;
+                if (stripe.Items.TryGetValue(Key, value))
+                    value = Update(Key, value);
+                else
+                    value = AddValue;
+                stripe.Items.SetValue(Key, value);
+                return value;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ValueType ConcurrentDictionary<KeyType, ValueType, HashType>::GetValue(KeyType Key)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetSharedLock();
+                return stripe.Items.GetValue(Key);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ConcurrentDictionary<KeyType, ValueType, HashType>::TryGetValue(KeyType Key, ValueType& ValueOut)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetSharedLock();
+                return stripe.Items.TryGetValue(Key, ValueOut);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ConcurrentDictionary<KeyType, ValueType, HashType>::Contains(KeyType Key)
+            {
+                Stripe& stripe = GetStripe(Key);
+                auto guard = stripe.Mutex.GetSharedLock();
+                return stripe.Items.Contains(Key);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            int ConcurrentDictionary<KeyType, ValueType, HashType>::GetCount()
+            {
+                int count = 0;
+                for (int i = 0; i < StripesCount; i++)
+                {
+                    auto guard = Stripes[i].Mutex.GetSharedLock();
+                    count += Stripes[i].Items.GetCount();
+                }
+                return count;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ConcurrentDictionary<KeyType, ValueType, HashType>::IsEmpty()
+            {
+                for (int i = 0; i < StripesCount; i++)
+                {
+                    auto guard = Stripes[i].Mutex.GetSharedLock();
+                    if (!Stripes[i].Items.IsEmpty())
+                        return false;
+                }
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            int ConcurrentDictionary<KeyType, ValueType, HashType>::GetStripesCount()
+            {
+                return StripesCount;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            typename ConcurrentDictionary<KeyType, ValueType, HashType>::SnapshotType
+            ConcurrentDictionary<KeyType, ValueType, HashType>::GetSnapshot()
+            {
+                SnapshotType snapshot;
+                CopyStripes(snapshot);
+                return snapshot;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::ForEach(ForEachBody Body)
+            {
+                for (int i = 0; i < StripesCount; i++)
+                    CopyStripe(i).ForEach(Body);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::ForEach(ForEachBodyWithBreakBool Body)
+            {
+                bool ShouldBreak = false;
+                for (int i = 0; i < StripesCount && !ShouldBreak; i++)
+                    CopyStripe(i).ForEach(typename SnapshotType::ForEachBodyWithBreakBool([&](KeyType Key, bool& BreakLoop) {
+                        Body(Key, ShouldBreak);
+                        BreakLoop = ShouldBreak;
+                    }));
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::ForEach(ForEachBodyWithBreakFunction Body)
+            {
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                try
+                {
+                    for (int i = 0; i < StripesCount; i++)
+                        CopyStripe(i).ForEach(typename SnapshotType::ForEachBody([&](KeyType Key) { Body(Key, BreakFunction); }));
+                }
+                catch (LoopBreaker&) {}
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::ForEach(ForEachBodyWithValue Body)
+            {
+                for (int i = 0; i < StripesCount; i++)
+                    CopyStripe(i).ForEach(Body);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::ForEach(ForEachBodyWithValueWithBreakBool Body)
+            {
+                bool ShouldBreak = false;
+                for (int i = 0; i < StripesCount && !ShouldBreak; i++)
+                    CopyStripe(i).ForEach(typename SnapshotType::ForEachBodyWithValueWithBreakBool([&](KeyType Key, ValueType Value, bool& BreakLoop) {
+                        Body(Key, Value, ShouldBreak);
+                        BreakLoop = ShouldBreak;
+                    }));
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::ForEach(ForEachBodyWithValueWithBreakFunction Body)
+            {
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                try
+                {
+                    for (int i = 0; i < StripesCount; i++)
+                        CopyStripe(i).ForEach(typename SnapshotType::ForEachBodyWithValue([&](KeyType Key, ValueType Value) {
+                            Body(Key, Value, BreakFunction);
+                        }));
+                }
+                catch (LoopBreaker&) {}
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::SetMutexName(std::string Name)
+            {
+                for (int i = 0; i < StripesCount; i++)
+                    Stripes[i].Mutex.SetName(Name + '[' + std::to_string(i) + ']');
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            typename ConcurrentDictionary<KeyType, ValueType, HashType>::Stripe&
+            ConcurrentDictionary<KeyType, ValueType, HashType>::GetStripe(const KeyType& Key)
+            {
+                // The top bits of another multiplier than the one of HashDictionary,
+                // so the keys of a stripe still spread over its table
+                std::uint64_t hash = (std::uint64_t)Hasher(Key) * 0xC2B2AE3D27D4EB4Full;
+                return Stripes[StripeShift == 64 ? 0 : (int)(hash >> StripeShift)];
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            typename ConcurrentDictionary<KeyType, ValueType, HashType>::SnapshotType
+            ConcurrentDictionary<KeyType, ValueType, HashType>::CopyStripe(int Index)
+            {
+                auto guard = Stripes[Index].Mutex.GetSharedLock();
+                return SnapshotType(Stripes[Index].Items);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ConcurrentDictionary<KeyType, ValueType, HashType>::CopyStripes(SnapshotType& Snapshot)
+            {
+                // Always locked in the order of the stripes, so two snapshots cannot deadlock
+                std::unique_ptr<typename RecursiveMutex<true, false>::SharedLockGuard[]> guards(
+                    new typename RecursiveMutex<true, false>::SharedLockGuard[StripesCount]
+                );
+                int count = 0;
+                for (int i = 0; i < StripesCount; i++)
+                {
+                    guards[i] = Stripes[i].Mutex.GetSharedLock();
+                    count += Stripes[i].Items.GetCount();
+                }
+
+                Snapshot.Reserve(count);
+                for (int i = 0; i < StripesCount; i++)
+                    Stripes[i].Items.ForEach(typename SnapshotType::ForEachBodyWithValue([&](KeyType Key, ValueType Value) {
+                        Snapshot.SetValue(Key, Value);
+                    }));
+            }
+        }
+    }
+}
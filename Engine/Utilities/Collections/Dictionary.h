@@ -22,7 +22,7 @@ namespace Engine
     {
         namespace Collections
         {
-            // TODO: Switch to a tree structure (low priority)
+            // OrderedDictionary is the tree alternative, for many keys or range queries
             template <typename KeyType, typename ValueType>
             class ENGINE_DICTIONARY_CLASS_NAME final ENGINE_DICTIONARY_DERIVATION
             {
@@ -54,6 +54,12 @@ namespace Engine
                 void SetValue(KeyType Key, ValueType Value);
                 /// @brief Removes a key-value pair.
                 void Remove(KeyType Key);
+                /// @brief Assigns a value to a key, unless the lock is not acquired before the Deadline.
+                /// @return Whether the value was assigned.
+                bool TrySetValueUntil(KeyType Key, ValueType Value, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Removes a key-value pair, unless the lock is not acquired before the Deadline.
+                /// @return Whether the pair was removed.
+                bool TryRemoveUntil(KeyType Key, std::chrono::steady_clock::time_point Deadline);
                 /// @brief Clears the key-value pairs.
                 void Clear();
 
@@ -107,9 +113,14 @@ namespace Engine
 #ifdef ENGINE_DICTIONARY_USE_MUTEX
     #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock();
     #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock();
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) \
+        RecursiveMutex<true, false>::LockGuard guard; \
+        if (!Mutex.TryGetLockUntil(guard, Deadline)) \
+            return false;
 #else
     #define ENGINE_COLLECTION_WRITE_ACCESS ;
     #define ENGINE_COLLECTION_READ_ACCESS ;
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) (void)(Deadline);
 #endif
 
 namespace Engine
@@ -206,12 +217,12 @@ namespace Engine
                 while (s < e)
                 {
                     int c = (s + e) / 2;
-                    if (Key == PairsRef->GetItem(c).first) { s = c; break; }
-                    else if (Key < PairsRef->GetItem(c).first) e = c;
+                    if (Key == PairsRef->GetItemRef(c).first) { s = c; break; }
+                    else if (Key < PairsRef->GetItemRef(c).first) e = c;
                     else s = c + 1;
                 }
 
-                if (Count == 0 || s >= Count || PairsRef->GetItem(s).first != Key)
+                if (Count == 0 || s >= Count || PairsRef->GetItemRef(s).first != Key)
                 {
                     while (Count >= PairsRef->GetLength())
                         if (PairsRef->GetLength() > 0)
@@ -220,7 +231,7 @@ namespace Engine
                             PairsRef->Resize(1);
 
                     for (int i = Count; i > s; i--)
-                        PairsRef->SetItem(i, PairsRef->GetItem(i - 1));
+                        PairsRef->GetItemRef(i) = std::move(PairsRef->GetItemRef(i - 1));
                     Count++;
                 }
 
@@ -233,13 +244,31 @@ namespace Engine
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 for (int i = Find(Key) + 1; i < Count; i++)
-                    PairsRef->SetItem(i - 1, PairsRef->GetItem(i));
+                    PairsRef->GetItemRef(i - 1) = std::move(PairsRef->GetItemRef(i));
                 Count--;
 
                 if (Count < PairsRef->GetLength() / 2)
                     PairsRef->Resize(PairsRef->GetLength() / 2);
             }
 
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_DICTIONARY_CLASS_NAME::TrySetValueUntil(KeyType Key, ValueType Value, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                SetValue(Key, Value);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_DICTIONARY_CLASS_NAME::TryRemoveUntil(KeyType Key, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                Remove(Key);
+                return true;
+            }
+
             template <typename KeyType, typename ValueType>
             void ENGINE_DICTIONARY_CLASS_NAME::Clear()
             {
@@ -254,7 +283,7 @@ namespace Engine
             {
                 ENGINE_COLLECTION_READ_ACCESS;
 
-                return PairsRef->GetItem(Find(Key)).second;
+                return PairsRef->GetItemRef(Find(Key)).second;
             }
 
             template <typename KeyType, typename ValueType>
@@ -269,12 +298,12 @@ namespace Engine
                 while (s < e)
                 {
                     int c = (s + e) / 2;
-                    if (Key == PairsRef->GetItem(c).first) { s = c; break; }
-                    else if (Key < PairsRef->GetItem(c).first) e = c - 1;
+                    if (Key == PairsRef->GetItemRef(c).first) { s = c; break; }
+                    else if (Key < PairsRef->GetItemRef(c).first) e = c - 1;
                     else s = c + 1;
                 }
 
-                if (PairsRef->GetItem(s).first != Key)
+                if (PairsRef->GetItemRef(s).first != Key)
                     return false;
 
                 return true;
@@ -302,7 +331,7 @@ namespace Engine
                 ENGINE_COLLECTION_READ_ACCESS;
 
                 for (int i = 0; i < Count; i++)
-                    Body(PairsRef->GetItem(i).first);
+                    Body(PairsRef->GetItemRef(i).first);
             }
 
             template <typename KeyType, typename ValueType>
@@ -313,7 +342,7 @@ namespace Engine
                 bool ShouldBreak = false;
                 for (int i = 0; i < Count; i++)
                 {
-                    Body(PairsRef->GetItem(i).first, ShouldBreak);
+                    Body(PairsRef->GetItemRef(i).first, ShouldBreak);
                     if (ShouldBreak) break;
                 }
             }
@@ -326,7 +355,7 @@ namespace Engine
                 std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
                 for (int i = 0; i < Count; i++) try
                 {
-                    Body(PairsRef->GetItem(i).first, BreakFunction);
+                    Body(PairsRef->GetItemRef(i).first, BreakFunction);
                 }
                 catch (LoopBreaker&) { break; }
             }
@@ -337,7 +366,7 @@ namespace Engine
                 ENGINE_COLLECTION_READ_ACCESS;
 
                 for (int i = 0; i < Count; i++)
-                    Body(PairsRef->GetItem(i).first, PairsRef->GetItem(i).second);
+                    Body(PairsRef->GetItemRef(i).first, PairsRef->GetItemRef(i).second);
             }
 
             template <typename KeyType, typename ValueType>
@@ -348,7 +377,7 @@ namespace Engine
                 bool ShouldBreak = false;
                 for (int i = 0; i < Count; i++)
                 {
-                    Body(PairsRef->GetItem(i).first, PairsRef->GetItem(i).second, ShouldBreak);
+                    Body(PairsRef->GetItemRef(i).first, PairsRef->GetItemRef(i).second, ShouldBreak);
                     if (ShouldBreak) break;
                 }
             }
@@ -361,7 +390,7 @@ namespace Engine
                 std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
                 for (int i = 0; i < Count; i++) try
                 {
-                    Body(PairsRef->GetItem(i).first, PairsRef->GetItem(i).second, BreakFunction);
+                    Body(PairsRef->GetItemRef(i).first, PairsRef->GetItemRef(i).second, BreakFunction);
                 }
                 catch (LoopBreaker&) { break; }
             }
@@ -377,12 +406,12 @@ namespace Engine
                 while (s < e)
                 {
                     int c = (s + e) / 2;
-                    if (Key == PairsRef->GetItem(c).first) { s = c; break; }
-                    else if (Key < PairsRef->GetItem(c).first) e = c - 1;
+                    if (Key == PairsRef->GetItemRef(c).first) { s = c; break; }
+                    else if (Key < PairsRef->GetItemRef(c).first) e = c - 1;
                     else s = c + 1;
                 }
 
-                if (PairsRef->GetItem(s).first != Key)
+                if (PairsRef->GetItemRef(s).first != Key)
                     throw std::domain_error("Key not found.");
 
                 return s;
@@ -393,6 +422,7 @@ namespace Engine
 
 #undef ENGINE_COLLECTION_WRITE_ACCESS
 #undef ENGINE_COLLECTION_READ_ACCESS
+#undef ENGINE_COLLECTION_TIMED_WRITE_ACCESS
 
 #undef ENGINE_DICTIONARY_CLASS_NAME
 #undef ENGINE_DICTIONARY_DERIVATION
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../../Engine.dec.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// Decides when and how much the array-backed collections reallocate.
+            ///
+            /// The shrink threshold is below the inverse of the growth factor, and a shrink leaves room to grow by the growth factor,
+            /// so after any reallocation the count must change by a factor before the next one,
+            /// and a count that oscillates around a threshold does not reallocate every few operations.
+            struct GrowthPolicy final
+            {
+                /// @brief The factor the capacity is multiplied by when it is full, greater than 1.
+                double GrowthFactor = 2;
+                /// @brief The fraction of the capacity that the count must drop below to shrink,
+                ///        less than 1 / GrowthFactor, 0 to never shrink automatically, even on clearing.
+                double ShrinkThreshold = 0.25;
+                /// @brief The capacity that shrinking and clearing keep.
+                int MinimumCapacity = 0;
+                /// @brief Whether the automatic shrinks wait for a call of Trim, instead of happening on removing.
+                ///
+                /// For the collections that grow and drain every frame, and can give the memory back at an idle time.
+                bool DeferShrink = false;
+
+                /// @brief Throws std::invalid_argument if a field is out of its range.
+                void Validate() const
+                {
+                    if (!(GrowthFactor > 1))
+                        throw std::invalid_argument("The growth factor is not greater than 1.");
+                    if (!(ShrinkThreshold >= 0 && ShrinkThreshold * GrowthFactor < 1))
+                        throw std::invalid_argument("The shrink threshold is not in [0, 1 / GrowthFactor).");
+                    if (MinimumCapacity < 0)
+                        throw std::invalid_argument("The minimum capacity is less than zero.");
+                }
+
+                /// @brief Gets the capacity to grow to, to hold at least Required items.
+                int GetGrownCapacity(int Capacity, int Required) const
+                {
+                    double grown = Capacity * GrowthFactor;
+                    int capacity = grown >= INT_MAX ? INT_MAX : (int)grown;
+                    if (capacity <= Capacity && Capacity < INT_MAX)
+                        capacity = Capacity + 1;
+                    return std::max(capacity, std::max(Required, MinimumCapacity));
+                }
+
+                /// @brief Gets the capacity to shrink to, or Capacity if the Count is not below the threshold.
+                int GetShrunkCapacity(int Count, int Capacity) const
+                {
+                    if (Capacity <= MinimumCapacity || !(Count < Capacity * ShrinkThreshold))
+                        return Capacity;
+
+                    int capacity = std::max((int)std::ceil(Count * GrowthFactor), MinimumCapacity);
+                    return capacity < Capacity ? capacity : Capacity;
+                }
+            };
+        }
+    }
+}
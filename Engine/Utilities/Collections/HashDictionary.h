@@ -0,0 +1,652 @@
+#ifndef ENGINE_HASH_DICTIONARY_INCLUDED
+
+#ifdef ENGINE_HASH_DICTIONARY_USE_MUTEX
+    #define ENGINE_HASH_DICTIONARY_INCLUDED
+#endif
+
+#include "../../Engine.dec.h"
+
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#ifdef ENGINE_HASH_DICTIONARY_USE_MUTEX
+    #include "../MutexContained.h"
+    #define ENGINE_HASH_DICTIONARY_CLASS_NAME HashDictionary<KeyType, ValueType, true, HashType>
+    #define ENGINE_HASH_DICTIONARY_DERIVATION : public MutexContained<true, false>
+#else
+    #define ENGINE_HASH_DICTIONARY_CLASS_NAME HashDictionary<KeyType, ValueType, false, HashType>
+    #define ENGINE_HASH_DICTIONARY_DERIVATION
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// The slots are split in groups of 16, each slot has a control byte:
+            /// empty, deleted, or 7 bits of the hash of its key if it is full.
+            /// A key is searched group by group from the group its hash points to,
+            /// the control bytes of a whole group are compared at once (with SSE2 if available),
+            /// so the keys are only compared in the slots whose 7 bits match.
+            /// The search stops at the first group that has an empty slot.
+            ///
+            /// The table grows by doubling when it is 7/8 full, it does not shrink until it is cleared.
+            template <typename KeyType, typename ValueType, typename HashType>
+            class ENGINE_HASH_DICTIONARY_CLASS_NAME final ENGINE_HASH_DICTIONARY_DERIVATION
+            {
+#ifdef ENGINE_HASH_DICTIONARY_USE_MUTEX
+                friend HashDictionary<KeyType, ValueType, false, HashType>;
+#else
+                friend HashDictionary<KeyType, ValueType, true, HashType>;
+#endif
+            public:
+                typedef std::function<void(KeyType Key)> ForEachBody;
+                typedef std::function<void(KeyType Key, bool& BreakLoop)> ForEachBodyWithBreakBool;
+                typedef std::function<void(KeyType Key, std::function<void()> Break)> ForEachBodyWithBreakFunction;
+                typedef std::function<void(KeyType Key, ValueType Value)> ForEachBodyWithValue;
+                typedef std::function<void(KeyType Key, ValueType Value, bool& BreakLoop)> ForEachBodyWithValueWithBreakBool;
+                typedef std::function<void(KeyType Key, ValueType Value, std::function<void()> Break)> ForEachBodyWithValueWithBreakFunction;
+
+                HashDictionary();
+                ~HashDictionary();
+
+                HashDictionary(HashDictionary<KeyType, ValueType, true, HashType>&) noexcept;
+                HashDictionary(HashDictionary<KeyType, ValueType, true, HashType>&&) noexcept;
+                HashDictionary(HashDictionary<KeyType, ValueType, false, HashType>&) noexcept;
+                HashDictionary(HashDictionary<KeyType, ValueType, false, HashType>&&) noexcept;
+
+                HashDictionary& operator=(HashDictionary<KeyType, ValueType, true, HashType>) noexcept;
+                HashDictionary& operator=(HashDictionary<KeyType, ValueType, false, HashType>) noexcept;
+
+                /// @brief Assigns a value to a key.
+                void SetValue(KeyType Key, ValueType Value);
+                /// @brief Removes a key-value pair.
+                void Remove(KeyType Key);
+                /// @brief Assigns a value to a key, unless the lock is not acquired before the Deadline.
+                /// @return Whether the value was assigned.
+                bool TrySetValueUntil(KeyType Key, ValueType Value, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Removes a key-value pair, unless the lock is not acquired before the Deadline.
+                /// @return Whether the pair was removed.
+                bool TryRemoveUntil(KeyType Key, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Clears the key-value pairs and frees the table.
+                void Clear();
+                /// @brief Grows the table so that Count key-value pairs fit without growing again.
+                void Reserve(int Count);
+
+                /// @brief Gets the value that is assigned to a key.
+                ValueType GetValue(KeyType Key);
+                /// @brief Gets the value that is assigned to a key, if any.
+                /// @param ValueOut The value, if the key exists.
+                /// @return True if the key exists in the dictionary.
+                bool TryGetValue(KeyType Key, ValueType& ValueOut);
+                /// @brief Checks if a key exists in the dictionary.
+                /// @param Key The search subject.
+                /// @return True if the key exists in the dictionary.
+                bool Contains(KeyType Key);
+                /// @brief Gets the items count.
+                int GetCount();
+                /// @brief Checks whether the dictionary is empty.
+                bool IsEmpty();
+                /// @brief Gets the number of slots of the table.
+                int GetCapacity();
+
+                /// @brief Calls a function for each key, in no particular order.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEach(ForEachBody Body);
+                /// @brief Calls a function for each key, in no particular order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEach(ForEachBodyWithBreakBool Body);
+                /// @brief Calls a function for each key, in no particular order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEach(ForEachBodyWithBreakFunction Body);
+                /// @brief Calls a function for each key-value, in no particular order.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEach(ForEachBodyWithValue Body);
+                /// @brief Calls a function for each key-value, in no particular order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEach(ForEachBodyWithValueWithBreakBool Body);
+                /// @brief Calls a function for each key-value, in no particular order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEach(ForEachBodyWithValueWithBreakFunction Body);
+            private:
+                class LoopBreaker {};
+
+                typedef std::pair<KeyType, ValueType> PairType;
+
+                static constexpr int GroupWidth = 16;
+                static constexpr std::int8_t EmptyControl = -128;
+                static constexpr std::int8_t DeletedControl = -2;
+
+                /// @brief Capacity control bytes, the full ones are >= 0.
+                std::int8_t * Controls;
+                /// @brief Capacity uninitialized slots, only the full ones are constructed.
+                PairType * Slots;
+                /// @brief 0 or a power of 2 multiple of GroupWidth.
+                int Capacity;
+                int Count;
+                /// @brief The number of empty slots that can be filled before the table must grow.
+                int GrowthLeft;
+                HashType Hasher;
+
+                /// @brief Spreads the bits of the hash, as std::hash of an integer is usually the integer itself.
+                std::size_t Hash(const KeyType& Key);
+                /// @brief Gets the bit mask of the slots of the group whose control byte is Control.
+                static unsigned MatchControl(const std::int8_t * Group, std::int8_t Control);
+                /// @brief Gets the bit mask of the empty or deleted slots of the group.
+                static unsigned MatchEmptyOrDeleted(const std::int8_t * Group);
+
+                /// @return The slot of the key, -1 if not found.
+                inline int Find(const KeyType& Key, std::size_t Hash);
+                /// @brief Finds the first empty or deleted slot on the search path of the hash.
+                inline int FindInsertSlot(std::size_t Hash);
+                /// @brief Moves the key-value pairs to a new table, dropping the deleted slots.
+                void Rehash(int NewCapacity);
+                void Allocate(int NewCapacity);
+                /// @brief Destroys the key-value pairs and frees the table.
+                void Free();
+                template <typename OtherType>
+                void CopyFrom(OtherType& Op);
+            };
+        }
+    }
+}
+
+// DEFINITION ----------------------------------------------------------------
+
+#ifdef ENGINE_HASH_DICTIONARY_USE_MUTEX
+    #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock();
+    #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock();
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) \
+        RecursiveMutex<true, false>::LockGuard guard; \
+        if (!Mutex.TryGetLockUntil(guard, Deadline)) \
+            return false;
+#else
+    #define ENGINE_COLLECTION_WRITE_ACCESS ;
+    #define ENGINE_COLLECTION_READ_ACCESS ;
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) (void)(Deadline);
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME::HashDictionary()
+                : Controls(nullptr), Slots(nullptr), Capacity(0), Count(0), GrowthLeft(0) {}
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME::~HashDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Free();
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME::HashDictionary(HashDictionary<KeyType, ValueType, true, HashType>& Op) noexcept : HashDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetSharedLock();
+
+                CopyFrom(Op);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME::HashDictionary(HashDictionary<KeyType, ValueType, true, HashType>&& Op) noexcept : HashDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetLock();
+
+                std::swap(Controls, Op.Controls);
+                std::swap(Slots, Op.Slots);
+                std::swap(Capacity, Op.Capacity);
+                std::swap(Count, Op.Count);
+                std::swap(GrowthLeft, Op.GrowthLeft);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME::HashDictionary(HashDictionary<KeyType, ValueType, false, HashType>& Op) noexcept : HashDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                CopyFrom(Op);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME::HashDictionary(HashDictionary<KeyType, ValueType, false, HashType>&& Op) noexcept : HashDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                std::swap(Controls, Op.Controls);
+                std::swap(Slots, Op.Slots);
+                std::swap(Capacity, Op.Capacity);
+                std::swap(Count, Op.Count);
+                std::swap(GrowthLeft, Op.GrowthLeft);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME& ENGINE_HASH_DICTIONARY_CLASS_NAME::operator=(HashDictionary<KeyType, ValueType, true, HashType> Op) noexcept
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetLock();
+
+                std::swap(Controls, Op.Controls);
+                std::swap(Slots, Op.Slots);
+                std::swap(Capacity, Op.Capacity);
+                std::swap(Count, Op.Count);
+                std::swap(GrowthLeft, Op.GrowthLeft);
+
+                return *this;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ENGINE_HASH_DICTIONARY_CLASS_NAME& ENGINE_HASH_DICTIONARY_CLASS_NAME::operator=(HashDictionary<KeyType, ValueType, false, HashType> Op) noexcept
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                std::swap(Controls, Op.Controls);
+                std::swap(Slots, Op.Slots);
+                std::swap(Capacity, Op.Capacity);
+                std::swap(Count, Op.Count);
+                std::swap(GrowthLeft, Op.GrowthLeft);
+
+                return *this;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::SetValue(KeyType Key, ValueType Value)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                std::size_t hash = Hash(Key);
+                int slot = Find(Key, hash);
+                if (slot >= 0)
+                {
+                    Slots[slot].second = Value;
+                    return;
+                }
+
+                slot = Capacity > 0 ? FindInsertSlot(hash) : -1;
+                // A deleted slot can be reused without growing
+                if (slot < 0 || (GrowthLeft == 0 && Controls[slot] == EmptyControl))
+                {
+                    if (Capacity == 0)
+                        Rehash(GroupWidth);
+                    // Mostly deleted slots, rehashing in place is enough
+                    else if ((long long)Count * 32 <= (long long)Capacity * 25)
+                        Rehash(Capacity);
+                    else
+                        Rehash(Capacity * 2);
+                    slot = FindInsertSlot(hash);
+                }
+
+                if (Controls[slot] == EmptyControl)
+                    GrowthLeft--;
+                new (&Slots[slot]) PairType(Key, Value);
+                Controls[slot] = (std::int8_t)(hash & 0x7F);
+                Count++;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::Remove(KeyType Key)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                int slot = Find(Key, Hash(Key));
+                if (slot < 0)
+                    throw std::domain_error("Key not found.");
+
+                Slots[slot].~PairType();
+                Count--;
+                // The searches stop at a group that has an empty slot, so none went past this group
+                // if it has one. Otherwise, the slot must stay on the search paths as deleted.
+                if (MatchControl(Controls + slot / GroupWidth * GroupWidth, EmptyControl) != 0)
+                {
+                    Controls[slot] = EmptyControl;
+                    GrowthLeft++;
+                }
+                else
+                    Controls[slot] = DeletedControl;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ENGINE_HASH_DICTIONARY_CLASS_NAME::TrySetValueUntil(KeyType Key, ValueType Value, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                SetValue(Key, Value);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ENGINE_HASH_DICTIONARY_CLASS_NAME::TryRemoveUntil(KeyType Key, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                Remove(Key);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::Clear()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Free();
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::Reserve(int Count)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                int capacity = GroupWidth;
+                while (capacity - capacity / 8 < Count)
+                    capacity *= 2;
+                if (capacity > Capacity)
+                    Rehash(capacity);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            ValueType ENGINE_HASH_DICTIONARY_CLASS_NAME::GetValue(KeyType Key)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                int slot = Find(Key, Hash(Key));
+                if (slot < 0)
+                    throw std::domain_error("Key not found.");
+                return Slots[slot].second;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ENGINE_HASH_DICTIONARY_CLASS_NAME::TryGetValue(KeyType Key, ValueType& ValueOut)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                int slot = Find(Key, Hash(Key));
+                if (slot < 0)
+                    return false;
+                ValueOut = Slots[slot].second;
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ENGINE_HASH_DICTIONARY_CLASS_NAME::Contains(KeyType Key)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Find(Key, Hash(Key)) >= 0;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            int ENGINE_HASH_DICTIONARY_CLASS_NAME::GetCount()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Count;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            bool ENGINE_HASH_DICTIONARY_CLASS_NAME::IsEmpty()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Count == 0;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            int ENGINE_HASH_DICTIONARY_CLASS_NAME::GetCapacity()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Capacity;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::ForEach(ForEachBody Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                for (int i = 0; i < Capacity; i++)
+                    if (Controls[i] >= 0)
+                        Body(Slots[i].first);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithBreakBool Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                bool ShouldBreak = false;
+                for (int i = 0; i < Capacity; i++)
+                {
+                    if (Controls[i] < 0)
+                        continue;
+                    Body(Slots[i].first, ShouldBreak);
+                    if (ShouldBreak) break;
+                }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithBreakFunction Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                for (int i = 0; i < Capacity; i++) try
+                {
+                    if (Controls[i] >= 0)
+                        Body(Slots[i].first, BreakFunction);
+                }
+                catch (LoopBreaker&) { break; }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithValue Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                for (int i = 0; i < Capacity; i++)
+                    if (Controls[i] >= 0)
+                        Body(Slots[i].first, Slots[i].second);
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithValueWithBreakBool Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                bool ShouldBreak = false;
+                for (int i = 0; i < Capacity; i++)
+                {
+                    if (Controls[i] < 0)
+                        continue;
+                    Body(Slots[i].first, Slots[i].second, ShouldBreak);
+                    if (ShouldBreak) break;
+                }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithValueWithBreakFunction Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                for (int i = 0; i < Capacity; i++) try
+                {
+                    if (Controls[i] >= 0)
+                        Body(Slots[i].first, Slots[i].second, BreakFunction);
+                }
+                catch (LoopBreaker&) { break; }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            std::size_t ENGINE_HASH_DICTIONARY_CLASS_NAME::Hash(const KeyType& Key)
+            {
+                std::uint64_t hash = (std::uint64_t)Hasher(Key) * 0x9E3779B97F4A7C15ull;
+                return (std::size_t)(hash ^ (hash >> 32));
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            unsigned ENGINE_HASH_DICTIONARY_CLASS_NAME::MatchControl(const std::int8_t * Group, std::int8_t Control)
+            {
+#ifdef __SSE2__
+                __m128i group = _mm_load_si128(reinterpret_cast<const __m128i*>(Group));
+                return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(Control)));
+#else
+                unsigned mask = 0;
+                for (int i = 0; i < GroupWidth; i++)
+                    if (Group[i] == Control)
+                        mask |= 1u << i;
+                return mask;
+#endif
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            unsigned ENGINE_HASH_DICTIONARY_CLASS_NAME::MatchEmptyOrDeleted(const std::int8_t * Group)
+            {
+                // Only the empty and deleted control bytes are negative
+#ifdef __SSE2__
+                return (unsigned)_mm_movemask_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(Group)));
+#else
+                unsigned mask = 0;
+                for (int i = 0; i < GroupWidth; i++)
+                    if (Group[i] < 0)
+                        mask |= 1u << i;
+                return mask;
+#endif
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            int ENGINE_HASH_DICTIONARY_CLASS_NAME::Find(const KeyType& Key, std::size_t Hash)
+            {
+                if (Capacity == 0)
+                    return -1;
+
+                std::int8_t control = (std::int8_t)(Hash & 0x7F);
+                int groups_mask = Capacity / GroupWidth - 1;
+                int group = (int)((Hash >> 7) & groups_mask);
+                // Triangular steps visit every group once, as the number of groups is a power of 2
+                for (int step = 1; ; step++)
+                {
+                    const std::int8_t * controls = Controls + group * GroupWidth;
+                    for (unsigned mask = MatchControl(controls, control); mask != 0; mask &= mask - 1)
+                    {
+                        int slot = group * GroupWidth + __builtin_ctz(mask);
+                        if (Slots[slot].first == Key)
+                            return slot;
+                    }
+                    if (MatchControl(controls, EmptyControl) != 0)
+                        return -1;
+                    group = (group + step) & groups_mask;
+                }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            int ENGINE_HASH_DICTIONARY_CLASS_NAME::FindInsertSlot(std::size_t Hash)
+            {
+                int groups_mask = Capacity / GroupWidth - 1;
+                int group = (int)((Hash >> 7) & groups_mask);
+                for (int step = 1; ; step++)
+                {
+                    unsigned mask = MatchEmptyOrDeleted(Controls + group * GroupWidth);
+                    if (mask != 0)
+                        return group * GroupWidth + __builtin_ctz(mask);
+                    group = (group + step) & groups_mask;
+                }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::Rehash(int NewCapacity)
+            {
+                std::int8_t * prev_controls = Controls;
+                PairType * prev_slots = Slots;
+                int prev_capacity = Capacity;
+
+                Allocate(NewCapacity);
+                GrowthLeft -= Count;
+                for (int i = 0; i < prev_capacity; i++)
+                {
+                    if (prev_controls[i] < 0)
+                        continue;
+                    std::size_t hash = Hash(prev_slots[i].first);
+                    int slot = FindInsertSlot(hash);
+                    new (&Slots[slot]) PairType(std::move(prev_slots[i]));
+                    Controls[slot] = (std::int8_t)(hash & 0x7F);
+                    prev_slots[i].~PairType();
+                }
+
+                if (prev_capacity > 0)
+                {
+                    ::operator delete(prev_controls, std::align_val_t(GroupWidth));
+                    ::operator delete(prev_slots, std::align_val_t(alignof(PairType)));
+                }
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::Allocate(int NewCapacity)
+            {
+                Controls = static_cast<std::int8_t*>(::operator new(NewCapacity, std::align_val_t(GroupWidth)));
+                Slots = static_cast<PairType*>(::operator new(sizeof(PairType) * NewCapacity, std::align_val_t(alignof(PairType))));
+                std::memset(Controls, (unsigned char)EmptyControl, NewCapacity);
+                Capacity = NewCapacity;
+                GrowthLeft = NewCapacity - NewCapacity / 8;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::Free()
+            {
+                if (Capacity == 0)
+                    return;
+                for (int i = 0; i < Capacity; i++)
+                    if (Controls[i] >= 0)
+                        Slots[i].~PairType();
+                ::operator delete(Controls, std::align_val_t(GroupWidth));
+                ::operator delete(Slots, std::align_val_t(alignof(PairType)));
+                Controls = nullptr;
+                Slots = nullptr;
+                Capacity = 0;
+                Count = 0;
+                GrowthLeft = 0;
+            }
+
+            template <typename KeyType, typename ValueType, typename HashType>
+            template <typename OtherType>
+            void ENGINE_HASH_DICTIONARY_CLASS_NAME::CopyFrom(OtherType& Op)
+            {
+                if (Op.Capacity == 0)
+                    return;
+                Allocate(Op.Capacity);
+                std::memcpy(Controls, Op.Controls, Capacity);
+                for (int i = 0; i < Capacity; i++)
+                    if (Controls[i] >= 0)
+                        new (&Slots[i]) PairType(Op.Slots[i]);
+                Count = Op.Count;
+                GrowthLeft = Op.GrowthLeft;
+            }
+        }
+    }
+}
+
+#undef ENGINE_COLLECTION_WRITE_ACCESS
+#undef ENGINE_COLLECTION_READ_ACCESS
+#undef ENGINE_COLLECTION_TIMED_WRITE_ACCESS
+
+#undef ENGINE_HASH_DICTIONARY_CLASS_NAME
+#undef ENGINE_HASH_DICTIONARY_DERIVATION
+
+#ifndef ENGINE_HASH_DICTIONARY_USE_MUTEX
+    #define ENGINE_HASH_DICTIONARY_USE_MUTEX
+    #include "HashDictionary.h"
+    #undef ENGINE_HASH_DICTIONARY_USE_MUTEX
+#endif
+
+#endif // Include Guard
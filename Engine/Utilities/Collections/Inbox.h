@@ -0,0 +1,225 @@
+#pragma once
+
+#include "../../Engine.dec.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// Any thread may push, only one thread may pop at a time.
+            /// Pushing is a single atomic exchange and never waits for the consumer or the other producers.
+            ///
+            /// The popped nodes are recycled by the next pushes, so the inbox allocates only while growing
+            /// past its previous peak count, or when another producer is taking a recycled node.
+            /// The recycled nodes are deleted with the inbox.
+            template <typename ItemsType>
+            class Inbox final
+            {
+            public:
+                /// @param Capacity The maximum number of items, 0 for no limit.
+                Inbox(int Capacity = 0);
+                ~Inbox();
+
+                Inbox(const Inbox&) = delete;
+                Inbox& operator=(const Inbox&) = delete;
+
+                /// @brief Pushes an item to the back. Can be called by any thread.
+                /// @return false if the inbox is full.
+                bool TryPush(ItemsType Item);
+                /// @brief Pops the first/front item. Should only be called by the consumer thread.
+                /// @param ItemOut The popped item, if any.
+                /// @return Whether there was an item to pop.
+                bool TryPop(ItemsType& ItemOut);
+                /// @brief Pops the items pushed before the call and passes them to Body in order.
+                ///
+                /// Should only be called by the consumer thread.
+                /// The items pushed while draining are left for the next drain.
+                ///
+                /// @param Body Is called as Body(ItemsType&) for each item.
+                /// @return The number of drained items.
+                template <typename DrainBody>
+                int Drain(DrainBody Body);
+                /// @brief Pops and destructs all items. Should only be called by the consumer thread.
+                void Clear();
+
+                /// @brief Sets the maximum number of items, 0 for no limit.
+                ///
+                /// Does not remove the items already in the inbox.
+                void SetCapacity(int Capacity);
+                /// @brief Gets the maximum number of items, 0 for no limit.
+                int GetCapacity();
+                /// @brief Gets the number of items.
+                ///
+                /// Is an approximation while other threads are pushing or popping.
+                int GetCount();
+                /// @brief Checks if there is no item to pop. Should only be called by the consumer thread.
+                bool IsEmpty();
+            private:
+                struct Node
+                {
+                    std::atomic<Node*> Next;
+                    ItemsType Item;
+                };
+
+                /// @brief Pops a recycled node, or allocates one. Can be called by any thread.
+                Node * TakeNode();
+                /// @brief Pushes a popped node to the recycled ones. Should only be called by the consumer thread.
+                void RecycleNode(Node * Recycled);
+
+                /// @brief The last pushed node, exchanged by the producers.
+                alignas(64) std::atomic<Node*> Head;
+                /// @brief The node before the first item, owned by the consumer.
+                alignas(64) Node * Tail;
+
+                alignas(64) std::atomic<int> Count;
+                std::atomic<int> Capacity;
+
+                /// @brief The stack of recycled nodes, linked by their Next.
+                alignas(64) std::atomic<Node*> FreeNodes;
+                /// @brief Whether a producer is popping FreeNodes.
+                std::atomic<bool> IsTakingNode;
+            };
+
+            template <typename ItemsType>
+            Inbox<ItemsType>::Inbox(int Capacity) : Count(0), Capacity(0), FreeNodes(nullptr), IsTakingNode(false)
+            {
+                SetCapacity(Capacity);
+                Tail = new Node();
+                Tail->Next.store(nullptr, std::memory_order_relaxed);
+                Head.store(Tail, std::memory_order_relaxed);
+            }
+
+            template <typename ItemsType>
+            Inbox<ItemsType>::~Inbox()
+            {
+                Clear();
+                delete Tail;
+                Node * node = FreeNodes.load(std::memory_order_acquire);
+                while (node != nullptr)
+                {
+                    Node * next = node->Next.load(std::memory_order_relaxed);
+                    delete node;
+                    node = next;
+                }
+            }
+
+            template <typename ItemsType>
+            typename Inbox<ItemsType>::Node * Inbox<ItemsType>::TakeNode()
+            {
+                // A single producer pops at a time and the consumer only pushes,
+                // so the popped node cannot be popped and pushed back meanwhile (ABA).
+                // The other producers allocate instead of waiting for it.
+                if (FreeNodes.load(std::memory_order_relaxed) != nullptr
+                    && !IsTakingNode.exchange(true, std::memory_order_acquire))
+                {
+                    Node * node = FreeNodes.load(std::memory_order_acquire);
+                    while (node != nullptr && !FreeNodes.compare_exchange_weak(
+                        node, node->Next.load(std::memory_order_relaxed),
+                        std::memory_order_acquire, std::memory_order_acquire));
+                    IsTakingNode.store(false, std::memory_order_release);
+                    if (node != nullptr)
+                        return node;
+                }
+                return new Node();
+            }
+
+            template <typename ItemsType>
+            void Inbox<ItemsType>::RecycleNode(Node * Recycled)
+            {
+                Node * head = FreeNodes.load(std::memory_order_relaxed);
+                do Recycled->Next.store(head, std::memory_order_relaxed);
+                while (!FreeNodes.compare_exchange_weak(head, Recycled, std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            template <typename ItemsType>
+            bool Inbox<ItemsType>::TryPush(ItemsType Item)
+            {
+                int capacity = Capacity.load(std::memory_order_relaxed);
+                if (capacity > 0)
+                {
+                    if (Count.fetch_add(1, std::memory_order_relaxed) >= capacity)
+                    {
+                        Count.fetch_sub(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                }
+                else Count.fetch_add(1, std::memory_order_relaxed);
+
+                Node * node = TakeNode();
+                node->Next.store(nullptr, std::memory_order_relaxed);
+                node->Item = std::move(Item);
+
+                // The node is visible to the consumer once the previous node links to it
+                Node * prev = Head.exchange(node, std::memory_order_acq_rel);
+                prev->Next.store(node, std::memory_order_release);
+                return true;
+            }
+
+            template <typename ItemsType>
+            bool Inbox<ItemsType>::TryPop(ItemsType& ItemOut)
+            {
+                Node * next = Tail->Next.load(std::memory_order_acquire);
+                if (next == nullptr)
+                    return false; // Empty, or a producer is between the exchange and the link
+
+                ItemOut = std::move(next->Item);
+                next->Item = ItemsType();
+                RecycleNode(Tail);
+                Tail = next;
+                Count.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            template <typename ItemsType>
+            template <typename DrainBody>
+            int Inbox<ItemsType>::Drain(DrainBody Body)
+            {
+                int count = Count.load(std::memory_order_relaxed);
+                int drained = 0;
+                ItemsType item;
+                while (drained < count && TryPop(item))
+                {
+                    drained++;
+                    Body(item);
+                }
+                return drained;
+            }
+
+            template <typename ItemsType>
+            void Inbox<ItemsType>::Clear()
+            {
+                ItemsType item;
+                while (TryPop(item));
+            }
+
+            template <typename ItemsType>
+            void Inbox<ItemsType>::SetCapacity(int Capacity)
+            {
+                if (Capacity < 0)
+                    throw std::domain_error("Capacity is less than zero.");
+                this->Capacity.store(Capacity, std::memory_order_relaxed);
+            }
+
+            template <typename ItemsType>
+            int Inbox<ItemsType>::GetCapacity()
+            {
+                return Capacity.load(std::memory_order_relaxed);
+            }
+
+            template <typename ItemsType>
+            int Inbox<ItemsType>::GetCount()
+            {
+                int count = Count.load(std::memory_order_relaxed);
+                return count > 0 ? count : 0;
+            }
+
+            template <typename ItemsType>
+            bool Inbox<ItemsType>::IsEmpty()
+            {
+                return Tail->Next.load(std::memory_order_acquire) == nullptr;
+            }
+        }
+    }
+}
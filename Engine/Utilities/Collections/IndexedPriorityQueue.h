@@ -0,0 +1,634 @@
+#ifndef ENGINE_INDEXED_PRIORITY_QUEUE_INCLUDED
+
+#ifdef ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+    #define ENGINE_INDEXED_PRIORITY_QUEUE_INCLUDED
+#endif
+
+#include "../../Engine.dec.h"
+#include "ResizableArray.h"
+
+#ifdef ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+    #include "../MutexContained.h"
+    #define ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity>
+    #define ENGINE_INDEXED_PRIORITY_QUEUE_DERIVATION : public MutexContained<true, false>
+#else
+    #define ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity>
+    #define ENGINE_INDEXED_PRIORITY_QUEUE_DERIVATION
+#endif
+
+#ifndef ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// @brief The heap entries and the handle slots of an IndexedPriorityQueue.
+            template <typename ItemsType, typename PriorityType>
+            struct IndexedPriorityQueueNodes
+            {
+                struct Entry
+                {
+                    ItemsType Item;
+                    PriorityType Priority;
+                    /// @brief The order of the pushes and priority updates, for the items of equal priority.
+                    long long Sequence;
+                    int Slot;
+                };
+
+                struct Slot
+                {
+                    /// @brief The index of the entry in the heap, -1 if the slot is free.
+                    int HeapIndex;
+                    /// @brief The next free slot, -1 if none.
+                    int NextFree;
+                    /// @brief Is incremented when the slot is freed, so the handles of the previous entries do not match it.
+                    ///
+                    /// Stays in [1, 2^31), so the handles, which hold it in their high 32 bits, are positive.
+                    std::uint32_t Generation;
+                };
+            };
+        }
+    }
+}
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// A d-ary heap like PriorityQueue, whose entries also have a slot that keeps their heap index.
+            /// A handle is a slot and its generation, so reaching an entry from its handle takes O(1),
+            /// and updating its priority or removing it takes O(log N).
+            ///
+            /// The items of equal priority pop in the order they were pushed or last had their priority updated.
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            class ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME final ENGINE_INDEXED_PRIORITY_QUEUE_DERIVATION
+            {
+#ifdef ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+                friend IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity>;
+#else
+                friend IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity>;
+#endif
+                static_assert(Arity >= 2, "A heap node must have at least 2 children.");
+            public:
+                /// @brief Identifies a pushed item until it is popped or removed, never 0.
+                typedef std::int64_t Handle;
+
+                IndexedPriorityQueue(int InitialCapacity = 0);
+                ~IndexedPriorityQueue();
+
+                /// Copies keep the handles of the copied items.
+                IndexedPriorityQueue(IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity>&) noexcept;
+                IndexedPriorityQueue(IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity>&&) noexcept;
+                IndexedPriorityQueue(IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity>&) noexcept;
+                IndexedPriorityQueue(IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity>&&) noexcept;
+
+                IndexedPriorityQueue& operator=(IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity>) noexcept;
+                IndexedPriorityQueue& operator=(IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity>) noexcept;
+
+                /// @brief Inserts an item to the back of its priority group.
+                /// @return The handle of the item.
+                Handle Push(ItemsType Item, PriorityType Priority);
+                /// @brief Pops the first item.
+                /// @return The popped item.
+                ItemsType Pop();
+                /// @brief Pops the first item.
+                /// @param ItemOut The popped item, if any.
+                /// @return Whether there was an item to pop.
+                bool Pop(ItemsType& ItemOut);
+                /// @brief Pops the first item.
+                /// @param ItemOut The popped item, if any.
+                /// @param PriorityOut The popped item priority, if any.
+                /// @return Whether there was an item to pop.
+                bool Pop(ItemsType& ItemOut, PriorityType& PriorityOut);
+                /// @brief Moves an item to the back of the group of its new priority.
+                void UpdatePriority(Handle ItemHandle, PriorityType Priority);
+                /// @brief Removes an item.
+                void Remove(Handle ItemHandle);
+                /// @brief Removes an item, if it is in the queue.
+                /// @return Whether the item was in the queue.
+                bool TryRemove(Handle ItemHandle);
+                /// @brief Clears the priority queue, the handles of the items become invalid.
+                void Clear();
+
+                /// @brief Gets the first item, without popping it.
+                ItemsType GetFirstItem();
+                /// @brief Gets the first item priority, without popping the item.
+                PriorityType GetFirstPriority();
+                /// @brief Gets the first item handle, without popping the item.
+                Handle GetFirstHandle();
+                /// @brief Gets an item by its handle.
+                ItemsType GetItem(Handle ItemHandle);
+                /// @brief Gets the priority of an item by its handle.
+                PriorityType GetPriority(Handle ItemHandle);
+                /// @brief Checks if an item is still in the priority queue.
+                /// @return False if the item was popped or removed.
+                bool Contains(Handle ItemHandle);
+                /// @brief Gets the items count.
+                int GetCount();
+                /// @brief Checks whether the priority queue is empty.
+                bool IsEmpty();
+                /// @brief Gets the current capacity of the allocated memory.
+                int GetCapacity();
+            private:
+                // Shared by the two variants, so they can copy their arrays to each other
+                typedef typename IndexedPriorityQueueNodes<ItemsType, PriorityType>::Entry Entry;
+                typedef typename IndexedPriorityQueueNodes<ItemsType, PriorityType>::Slot Slot;
+
+                /// @brief The heap, the children of Entries[i] are Entries[i * Arity + 1] to Entries[i * Arity + Arity].
+                ResizableArray<Entry, false> * EntriesRef;
+                ResizableArray<Slot, false> * SlotsRef;
+                int Count;
+                /// @brief The number of used slots of SlotsRef, free or not.
+                int SlotsCount;
+                int FirstFreeSlot;
+                long long NextSequence;
+
+                /// @brief Checks whether A pops before B.
+                static inline bool Precedes(const Entry& A, const Entry& B);
+                /// @return The heap index of the item, -1 if it is not in the queue.
+                int Find(Handle ItemHandle);
+                /// @brief Puts an entry in the heap and records its index in its slot.
+                void Place(int Index, Entry&& Value);
+                void SiftUp(int Index, Entry Value);
+                void SiftDown(int Index, Entry Value);
+                /// @brief Puts Value at Index, up or down the heap as it fits.
+                void Replace(int Index, Entry Value);
+                /// @brief Removes the entry at Index.
+                void RemoveAt(int Index);
+                void FreeSlot(int SlotIndex);
+            };
+        }
+    }
+}
+
+// DEFINITION ----------------------------------------------------------------
+
+#ifdef ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+    #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock();
+    #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock();
+#else
+    #define ENGINE_COLLECTION_WRITE_ACCESS ;
+    #define ENGINE_COLLECTION_READ_ACCESS ;
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::IndexedPriorityQueue(int InitialCapacity)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                EntriesRef = new ResizableArray<Entry, false>(InitialCapacity);
+                SlotsRef = new ResizableArray<Slot, false>(InitialCapacity);
+                Count = 0;
+                SlotsCount = 0;
+                FirstFreeSlot = -1;
+                NextSequence = 0;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::~IndexedPriorityQueue()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                delete EntriesRef;
+                delete SlotsRef;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::IndexedPriorityQueue(
+                IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity>& Op
+                ) noexcept : IndexedPriorityQueue()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetSharedLock();
+
+                *EntriesRef = *(Op.EntriesRef);
+                *SlotsRef = *(Op.SlotsRef);
+                Count = Op.Count;
+                SlotsCount = Op.SlotsCount;
+                FirstFreeSlot = Op.FirstFreeSlot;
+                NextSequence = Op.NextSequence;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::IndexedPriorityQueue(
+                IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity>&& Op
+                ) noexcept : IndexedPriorityQueue()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetLock();
+
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(SlotsRef, Op.SlotsRef);
+                std::swap(Count, Op.Count);
+                std::swap(SlotsCount, Op.SlotsCount);
+                std::swap(FirstFreeSlot, Op.FirstFreeSlot);
+                std::swap(NextSequence, Op.NextSequence);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::IndexedPriorityQueue(
+                IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity>& Op
+                ) noexcept : IndexedPriorityQueue()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                *EntriesRef = *(Op.EntriesRef);
+                *SlotsRef = *(Op.SlotsRef);
+                Count = Op.Count;
+                SlotsCount = Op.SlotsCount;
+                FirstFreeSlot = Op.FirstFreeSlot;
+                NextSequence = Op.NextSequence;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::IndexedPriorityQueue(
+                IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity>&& Op
+                ) noexcept : IndexedPriorityQueue()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(SlotsRef, Op.SlotsRef);
+                std::swap(Count, Op.Count);
+                std::swap(SlotsCount, Op.SlotsCount);
+                std::swap(FirstFreeSlot, Op.FirstFreeSlot);
+                std::swap(NextSequence, Op.NextSequence);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME& ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::operator=(
+                IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity> Op
+                ) noexcept
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetLock();
+
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(SlotsRef, Op.SlotsRef);
+                std::swap(Count, Op.Count);
+                std::swap(SlotsCount, Op.SlotsCount);
+                std::swap(FirstFreeSlot, Op.FirstFreeSlot);
+                std::swap(NextSequence, Op.NextSequence);
+
+                return *this;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME& ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::operator=(
+                IndexedPriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity> Op
+                ) noexcept
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(SlotsRef, Op.SlotsRef);
+                std::swap(Count, Op.Count);
+                std::swap(SlotsCount, Op.SlotsCount);
+                std::swap(FirstFreeSlot, Op.FirstFreeSlot);
+                std::swap(NextSequence, Op.NextSequence);
+
+                return *this;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            typename ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Handle ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Push(ItemsType Item, PriorityType Priority)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Count >= EntriesRef->GetLength())
+                    EntriesRef->Resize(EntriesRef->GetLength() > 0 ? EntriesRef->GetLength() * 2 : 1);
+
+                Slot slot;
+                int slot_index = FirstFreeSlot;
+                if (slot_index >= 0)
+                {
+                    slot = SlotsRef->GetItemRef(slot_index);
+                    FirstFreeSlot = slot.NextFree;
+                }
+                else
+                {
+                    if (SlotsCount >= SlotsRef->GetLength())
+                        SlotsRef->Resize(SlotsRef->GetLength() > 0 ? SlotsRef->GetLength() * 2 : 1);
+                    slot_index = SlotsCount++;
+                    slot.Generation = 1;
+                }
+                slot.NextFree = -1;
+                SlotsRef->GetItemRef(slot_index) = slot;
+
+                Entry entry;
+                entry.Item = Item;
+                entry.Priority = Priority;
+                entry.Sequence = NextSequence++;
+                entry.Slot = slot_index;
+                Count++;
+                SiftUp(Count - 1, std::move(entry));
+
+                return ((Handle)slot.Generation << 32) | (Handle)slot_index;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ItemsType ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Pop()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Count <= 0)
+                    throw std::logic_error("Cannot pop from an empty priority queue.");
+
+                ItemsType Item = std::move(EntriesRef->GetItemRef(0).Item);
+                RemoveAt(0);
+                return Item;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            bool ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Pop(ItemsType& ItemOut)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Count <= 0)
+                    return false;
+
+                ItemOut = std::move(EntriesRef->GetItemRef(0).Item);
+                RemoveAt(0);
+                return true;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            bool ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Pop(ItemsType& ItemOut, PriorityType& PriorityOut)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Count <= 0)
+                    return false;
+
+                Entry& first = EntriesRef->GetItemRef(0);
+                ItemOut = std::move(first.Item);
+                PriorityOut = std::move(first.Priority);
+                RemoveAt(0);
+                return true;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::UpdatePriority(Handle ItemHandle, PriorityType Priority)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                int index = Find(ItemHandle);
+                if (index < 0)
+                    throw std::domain_error("Handle not found.");
+
+                Entry entry = std::move(EntriesRef->GetItemRef(index));
+                entry.Priority = Priority;
+                entry.Sequence = NextSequence++;
+                Replace(index, std::move(entry));
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Remove(Handle ItemHandle)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                int index = Find(ItemHandle);
+                if (index < 0)
+                    throw std::domain_error("Handle not found.");
+
+                RemoveAt(index);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            bool ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::TryRemove(Handle ItemHandle)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                int index = Find(ItemHandle);
+                if (index < 0)
+                    return false;
+
+                RemoveAt(index);
+                return true;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Clear()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                for (int i = 0; i < Count; i++)
+                    FreeSlot(EntriesRef->GetItemRef(i).Slot);
+                Count = 0;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ItemsType ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::GetFirstItem()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                if (Count <= 0)
+                    throw std::logic_error("Cannot get the first item of an empty priority queue.");
+
+                return EntriesRef->GetItemRef(0).Item;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            PriorityType ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::GetFirstPriority()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                if (Count <= 0)
+                    throw std::logic_error("Cannot get the first priority of an empty priority queue.");
+
+                return EntriesRef->GetItemRef(0).Priority;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            typename ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Handle ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::GetFirstHandle()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                if (Count <= 0)
+                    throw std::logic_error("Cannot get the first handle of an empty priority queue.");
+
+                int slot_index = EntriesRef->GetItemRef(0).Slot;
+                return ((Handle)SlotsRef->GetItemRef(slot_index).Generation << 32) | (Handle)slot_index;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            ItemsType ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::GetItem(Handle ItemHandle)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                int index = Find(ItemHandle);
+                if (index < 0)
+                    throw std::domain_error("Handle not found.");
+
+                return EntriesRef->GetItemRef(index).Item;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            PriorityType ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::GetPriority(Handle ItemHandle)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                int index = Find(ItemHandle);
+                if (index < 0)
+                    throw std::domain_error("Handle not found.");
+
+                return EntriesRef->GetItemRef(index).Priority;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            bool ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Contains(Handle ItemHandle)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Find(ItemHandle) >= 0;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            int ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::GetCount()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Count;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            bool ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::IsEmpty()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Count == 0;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            int ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::GetCapacity()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return EntriesRef->GetLength();
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            bool ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Precedes(const Entry& A, const Entry& B)
+            {
+                if (LessPriorityFirst ? A.Priority < B.Priority : B.Priority < A.Priority)
+                    return true;
+                if (LessPriorityFirst ? B.Priority < A.Priority : A.Priority < B.Priority)
+                    return false;
+                return A.Sequence < B.Sequence;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            int ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Find(Handle ItemHandle)
+            {
+                int slot_index = (int)(ItemHandle & 0xFFFFFFFF);
+                if (ItemHandle <= 0 || slot_index < 0 || slot_index >= SlotsCount)
+                    return -1;
+                Slot& slot = SlotsRef->GetItemRef(slot_index);
+                if (slot.Generation != (std::uint32_t)(ItemHandle >> 32))
+                    return -1;
+                return slot.HeapIndex;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Place(int Index, Entry&& Value)
+            {
+                SlotsRef->GetItemRef(Value.Slot).HeapIndex = Index;
+                EntriesRef->GetItemRef(Index) = std::move(Value);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::SiftUp(int Index, Entry Value)
+            {
+                while (Index > 0)
+                {
+                    int parent = (Index - 1) / Arity;
+                    Entry& parent_entry = EntriesRef->GetItemRef(parent);
+                    if (!Precedes(Value, parent_entry))
+                        break;
+                    Place(Index, std::move(parent_entry));
+                    Index = parent;
+                }
+                Place(Index, std::move(Value));
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::SiftDown(int Index, Entry Value)
+            {
+                while (true)
+                {
+                    int first_child = Index * Arity + 1;
+                    if (first_child >= Count)
+                        break;
+
+                    int best = first_child;
+                    int last_child = std::min(first_child + Arity, Count);
+                    for (int i = first_child + 1; i < last_child; i++)
+                        if (Precedes(EntriesRef->GetItemRef(i), EntriesRef->GetItemRef(best)))
+                            best = i;
+
+                    Entry& best_entry = EntriesRef->GetItemRef(best);
+                    if (!Precedes(best_entry, Value))
+                        break;
+                    Place(Index, std::move(best_entry));
+                    Index = best;
+                }
+                Place(Index, std::move(Value));
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::Replace(int Index, Entry Value)
+            {
+                if (Index > 0 && Precedes(Value, EntriesRef->GetItemRef((Index - 1) / Arity)))
+                    SiftUp(Index, std::move(Value));
+                else
+                    SiftDown(Index, std::move(Value));
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::RemoveAt(int Index)
+            {
+                FreeSlot(EntriesRef->GetItemRef(Index).Slot);
+                Count--;
+                // The last entry fills the hole
+                if (Index < Count)
+                    Replace(Index, std::move(EntriesRef->GetItemRef(Count)));
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity>
+            void ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME::FreeSlot(int SlotIndex)
+            {
+                Slot& slot = SlotsRef->GetItemRef(SlotIndex);
+                slot.HeapIndex = -1;
+                slot.NextFree = FirstFreeSlot;
+                // Wraps to 1 before the sign bit of the handles, so no handle is 0 or negative
+                if (++slot.Generation == 0x80000000u)
+                    slot.Generation = 1;
+                FirstFreeSlot = SlotIndex;
+            }
+        }
+    }
+}
+
+#undef ENGINE_COLLECTION_WRITE_ACCESS
+#undef ENGINE_COLLECTION_READ_ACCESS
+
+#undef ENGINE_INDEXED_PRIORITY_QUEUE_CLASS_NAME
+#undef ENGINE_INDEXED_PRIORITY_QUEUE_DERIVATION
+
+#ifndef ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+    #define ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+    #include "IndexedPriorityQueue.h"
+    #undef ENGINE_INDEXED_PRIORITY_QUEUE_USE_MUTEX
+#endif
+
+#endif // Include Guard
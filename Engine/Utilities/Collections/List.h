@@ -6,6 +6,7 @@
 
 #include "../../Engine.dec.h"
 #include "ResizableArray.h"
+#include "GrowthPolicy.h"
 
 #ifdef ENGINE_LIST_USE_MUTEX
     #include "../MutexContained.h"
@@ -114,6 +115,16 @@ namespace Engine
                 /// @brief Removes an item at a specified index.
                 ///        Behavior might vary based on the interface that is used to access the list.
                 void RemoveByIndex(int Index);
+                /// @brief Adds/appends an item to the end of the list by default,
+                ///        unless the lock is not acquired before the Deadline.
+                ///        Behavior might vary based on the interface that is used to access the list.
+                /// @return Whether the item was added.
+                bool TryAddUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Removes the first found item that is equal to the Item parameter,
+                ///        unless the lock is not acquired before the Deadline.
+                ///        Behavior might vary based on the interface that is used to access the list.
+                /// @return Whether the lock was acquired in time and an item was found to be removed.
+                bool TryRemoveUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline);
                 /// @brief Clears the list's items.
                 ///        Behavior might vary based on the interface that is used to access the list.
                 void Clear();
@@ -134,6 +145,15 @@ namespace Engine
                 ///
                 /// Set the value using SetAutoShrink(bool).
                 bool IsAutoShrink();
+                /// @brief Sets how the allocated memory grows and shrinks automatically.
+                void SetGrowthPolicy(GrowthPolicy Policy);
+                /// @brief Gets how the allocated memory grows and shrinks automatically.
+                GrowthPolicy GetGrowthPolicy();
+                /// @brief Shrinks the allocated memory as far as the growth policy allows.
+                ///
+                /// Also applies when the policy defers shrinking or the AutoShrink is off,
+                /// for idle times like the end of a frame.
+                void Trim();
 
                 /// @brief Gets an item at a specified index.
                 ItemsType GetItem(int Index);
@@ -167,6 +187,8 @@ namespace Engine
                 int GetCount();
                 /// @brief Gets the current capacity of the allocated memory.
                 int GetCapacity();
+                /// @brief Gets the number of times the allocated memory was reallocated.
+                long long GetReallocationsCount();
                 /// @brief Calls a function for each item.
                 /// @param Body The foreach body function, can be a lambda.
                 void ForEach(ForEachBody Body);
@@ -184,6 +206,8 @@ namespace Engine
                 ResizableArray<ItemsType, false> * ItemsRef;
                 int * CountRef;
                 bool * AutoShrinkRef;
+                GrowthPolicy * PolicyRef;
+                long long * ReallocationsCountRef;
 
                 ENGINE_LIST_CLASS_NAME * Parent;
                 ResizableArray<ENGINE_LIST_CLASS_NAME*, false> * Children; // Objects to destruct when destructed
@@ -202,6 +226,9 @@ namespace Engine
                     OnRemoveCallback OnRemove,
                     OnClearCallback OnClear);
                 void DestructChildren();
+                void Resize(int NewCapacity);
+                /// @brief Shrinks the allocated memory if the count dropped below the threshold of the growth policy.
+                void ShrinkByPolicy();
             };
         }
     }
@@ -213,10 +240,16 @@ namespace Engine
     #define ENGINE_COLLECTION_STRUCTURE_ACCESS auto guard = Mutex.GetLock();
     #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock(); if (IsParentDestructed) throw std::logic_error("The parent is destructed!");
     #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock(); if (IsParentDestructed) throw std::logic_error("The parent is destructed!");
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) \
+        RecursiveMutex<true, false>::LockGuard guard; \
+        if (!Mutex.TryGetLockUntil(guard, Deadline)) \
+            return false; \
+        if (IsParentDestructed) throw std::logic_error("The parent is destructed!");
 #else
     #define ENGINE_COLLECTION_STRUCTURE_ACCESS ;
     #define ENGINE_COLLECTION_WRITE_ACCESS if (IsParentDestructed) throw std::logic_error("The parent is destructed!");
     #define ENGINE_COLLECTION_READ_ACCESS if (IsParentDestructed) throw std::logic_error("The parent is destructed!");
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) (void)(Deadline); if (IsParentDestructed) throw std::logic_error("The parent is destructed!");
 #endif
 
 #define ENGINE_COLLECTION_OPERAND_ACCESS if (Op.IsParentDestructed) throw std::logic_error("The operand's parent is destructed!");
@@ -241,20 +274,19 @@ namespace Engine
                 ItemsRef = new ResizableArray<ItemsType, false>(InitialCapacity);
                 CountRef = new int(0);
                 AutoShrinkRef = new bool(true);
+                PolicyRef = new GrowthPolicy();
+                ReallocationsCountRef = new long long(0);
 
                 OnAdd = [this](ENGINE_LIST_CLASS_NAME * Parent, ItemsType& Item, int& Index) {
                     if (Index > *CountRef || Index < 0)
                         throw std::out_of_range("Index is out of range.");
 
-                    while (*CountRef >= ItemsRef->GetLength())
-                        if (ItemsRef->GetLength() > 0)
-                            ItemsRef->Resize(ItemsRef->GetLength() * 2);
-                        else
-                            ItemsRef->Resize(1);
+                    if (*CountRef >= ItemsRef->GetLength())
+                        Resize(PolicyRef->GetGrownCapacity(ItemsRef->GetLength(), *CountRef + 1));
 
                     for (int i = *CountRef; i > Index; i--)
-                        ItemsRef->SetItem(i, ItemsRef->GetItem(i - 1));
-                    ItemsRef->SetItem(Index, Item);
+                        ItemsRef->GetItemRef(i) = std::move(ItemsRef->GetItemRef(i - 1));
+                    ItemsRef->SetItem(Index, std::move(Item));
 
                     (*CountRef)++;
                 };
@@ -263,7 +295,7 @@ namespace Engine
                     if (Index >= *CountRef || Index < 0)
                         throw std::out_of_range("Index is out of range.");
 
-                    ItemsRef->SetItem(Index, Value);
+                    ItemsRef->SetItem(Index, std::move(Value));
                 };
 
                 OnRemove = [this](ENGINE_LIST_CLASS_NAME * Parent, int& Index) {
@@ -271,17 +303,18 @@ namespace Engine
                         throw std::out_of_range("Index is out of range.");
 
                     for (int i = Index + 1; i < *CountRef; i++)
-                        ItemsRef->SetItem(i - 1, ItemsRef->GetItem(i));
+                        ItemsRef->GetItemRef(i - 1) = std::move(ItemsRef->GetItemRef(i));
                     (*CountRef)--;
 
-                    if (*AutoShrinkRef && *CountRef < ItemsRef->GetLength() / 2)
-                        ItemsRef->Resize(ItemsRef->GetLength() / 2);
+                    if (*AutoShrinkRef && !PolicyRef->DeferShrink)
+                        ShrinkByPolicy();
                 };
 
                 OnClear = [this](ENGINE_LIST_CLASS_NAME * Parent) {
                     *CountRef = 0;
-                    if (*AutoShrinkRef)
-                        ItemsRef->Resize(0);
+                    if (*AutoShrinkRef && !PolicyRef->DeferShrink && PolicyRef->ShrinkThreshold > 0
+                        && ItemsRef->GetLength() > PolicyRef->MinimumCapacity)
+                        Resize(PolicyRef->MinimumCapacity);
                 };
             }
 
@@ -310,6 +343,8 @@ namespace Engine
                 ItemsRef = Parent->ItemsRef;
                 CountRef = Parent->CountRef;
                 AutoShrinkRef = Parent->AutoShrinkRef;
+                PolicyRef = Parent->PolicyRef;
+                ReallocationsCountRef = Parent->ReallocationsCountRef;
 
                 IsParentDestructed = false;
 
@@ -336,6 +371,8 @@ namespace Engine
                     delete ItemsRef;
                     delete CountRef;
                     delete AutoShrinkRef;
+                    delete PolicyRef;
+                    delete ReallocationsCountRef;
                 }
                 delete Children;
             }
@@ -561,7 +598,7 @@ namespace Engine
                 if (IsRoot)
                 {
                     if (ItemsRef->GetLength() < (*CountRef) + (*Op.CountRef))
-                        ItemsRef->Resize((*CountRef) + (*Op.CountRef));
+                        Resize((*CountRef) + (*Op.CountRef));
                     for (int i = 0; i < *Op.CountRef; i++)
                         ItemsRef->SetItem((*CountRef) + i, Op.ItemsRef->GetItem(i));
                     *CountRef += *Op.CountRef;
@@ -588,7 +625,7 @@ namespace Engine
                 if (IsRoot)
                 {
                     if (ItemsRef->GetLength() < (*CountRef) + (*Op.CountRef))
-                        ItemsRef->Resize((*CountRef) + (*Op.CountRef));
+                        Resize((*CountRef) + (*Op.CountRef));
                     for (int i = 0; i < *Op.CountRef; i++)
                         ItemsRef->SetItem((*CountRef) + i, Op.ItemsRef->GetItem(i));
                     *CountRef += *Op.CountRef;
@@ -615,7 +652,7 @@ namespace Engine
                 if (IsRoot)
                 {
                     if (ItemsRef->GetLength() < (*CountRef) + (*Op.CountRef))
-                        ItemsRef->Resize((*CountRef) + (*Op.CountRef));
+                        Resize((*CountRef) + (*Op.CountRef));
                     for (int i = 0; i < *Op.CountRef; i++)
                         ItemsRef->SetItem((*CountRef) + i, Op.ItemsRef->GetItem(i));
                     *CountRef += *Op.CountRef;
@@ -642,7 +679,7 @@ namespace Engine
                 if (IsRoot)
                 {
                     if (ItemsRef->GetLength() < (*CountRef) + (*Op.CountRef))
-                        ItemsRef->Resize((*CountRef) + (*Op.CountRef));
+                        Resize((*CountRef) + (*Op.CountRef));
                     for (int i = 0; i < *Op.CountRef; i++)
                         ItemsRef->SetItem((*CountRef) + i, Op.ItemsRef->GetItem(i));
                     *CountRef += *Op.CountRef;
@@ -721,7 +758,7 @@ namespace Engine
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 for (int i = 0; i < *CountRef; i++)
-                    if (ItemsRef->GetItem(i) == Item)
+                    if (ItemsRef->GetItemRef(i) == Item)
                     {
                         OnRemove(Parent, i);
                         return true;
@@ -737,6 +774,23 @@ namespace Engine
                 OnRemove(Parent, Index);
             }
 
+            template <typename ItemsType>
+            bool ENGINE_LIST_CLASS_NAME::TryAddUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                Add(Item);
+                return true;
+            }
+
+            template <typename ItemsType>
+            bool ENGINE_LIST_CLASS_NAME::TryRemoveUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                return Remove(Item);
+            }
+
             template <typename ItemsType>
             void ENGINE_LIST_CLASS_NAME::Clear()
             {
@@ -753,7 +807,7 @@ namespace Engine
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 if (Space >= 0)
-                    ItemsRef->Resize(ItemsRef->GetLength() + Space);
+                    Resize(ItemsRef->GetLength() + Space);
                 else
                     throw std::domain_error("Space is less than zero.");
             }
@@ -764,7 +818,7 @@ namespace Engine
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 if (AdditionalSpace >= 0)
-                    ItemsRef->Resize(*CountRef + AdditionalSpace);
+                    Resize(*CountRef + AdditionalSpace);
                 else
                     throw std::domain_error("AdditionalSpace is less than zero.");
             }
@@ -785,6 +839,31 @@ namespace Engine
                 return *AutoShrinkRef;
             }
 
+            template <typename ItemsType>
+            void ENGINE_LIST_CLASS_NAME::SetGrowthPolicy(GrowthPolicy Policy)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Policy.Validate();
+                *PolicyRef = Policy;
+            }
+
+            template <typename ItemsType>
+            GrowthPolicy ENGINE_LIST_CLASS_NAME::GetGrowthPolicy()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return *PolicyRef;
+            }
+
+            template <typename ItemsType>
+            void ENGINE_LIST_CLASS_NAME::Trim()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                ShrinkByPolicy();
+            }
+
 
 
             template <typename ItemsType>
@@ -806,7 +885,7 @@ namespace Engine
                 if (FromIndex < 0)
                     throw std::out_of_range("FromIndex cannot be less than zero.");
                 for (int i = FromIndex; i < *CountRef; i++)
-                    if (ItemsRef->GetItem(i) == Item)
+                    if (ItemsRef->GetItemRef(i) == Item)
                         return i;
                 return -1;
             }
@@ -817,7 +896,7 @@ namespace Engine
                 ENGINE_COLLECTION_READ_ACCESS;
 
                 for (int i = 0; i < *CountRef; i++)
-                    if (ItemsRef->GetItem(i) == Item)
+                    if (ItemsRef->GetItemRef(i) == Item)
                         return true;
                 return false;
             }
@@ -830,7 +909,7 @@ namespace Engine
                 if (FromIndex < 0)
                     throw std::out_of_range("FromIndex cannot be less than zero.");
                 for (int i = FromIndex; i < *CountRef; i++)
-                    if (P(ItemsRef->GetItem(i)))
+                    if (P(ItemsRef->GetItemRef(i)))
                         return i;
                 return -1;
             }
@@ -841,7 +920,7 @@ namespace Engine
                 ENGINE_COLLECTION_READ_ACCESS;
 
                 for (int i = 0; i < *CountRef; i++)
-                    if (P(ItemsRef->GetItem(i)))
+                    if (P(ItemsRef->GetItemRef(i)))
                         return true;
                 return false;
             }
@@ -862,6 +941,14 @@ namespace Engine
                 return ItemsRef->GetLength();
             }
 
+            template <typename ItemsType>
+            long long ENGINE_LIST_CLASS_NAME::GetReallocationsCount()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return *ReallocationsCountRef;
+            }
+
             template <typename ItemsType>
             void ENGINE_LIST_CLASS_NAME::ForEach(ForEachBody Body)
             {
@@ -915,6 +1002,8 @@ namespace Engine
                 ItemsRef = Parent->ItemsRef;
                 CountRef = Parent->CountRef;
                 AutoShrinkRef = Parent->AutoShrinkRef;
+                PolicyRef = Parent->PolicyRef;
+                ReallocationsCountRef = Parent->ReallocationsCountRef;
 
                 IsParentDestructed = false;
 
@@ -936,6 +1025,23 @@ namespace Engine
                         Children->GetItem(i)->DestructChildren();
                 IsParentDestructed = true;
             }
+
+            template <typename ItemsType>
+            void ENGINE_LIST_CLASS_NAME::Resize(int NewCapacity)
+            {
+                if (NewCapacity == ItemsRef->GetLength())
+                    return;
+                (*ReallocationsCountRef)++;
+                ItemsRef->Resize(NewCapacity);
+            }
+
+            template <typename ItemsType>
+            void ENGINE_LIST_CLASS_NAME::ShrinkByPolicy()
+            {
+                int capacity = PolicyRef->GetShrunkCapacity(*CountRef, ItemsRef->GetLength());
+                if (capacity < ItemsRef->GetLength())
+                    Resize(capacity);
+            }
         }
     }
 }
@@ -943,6 +1049,7 @@ namespace Engine
 #undef ENGINE_COLLECTION_STRUCTURE_ACCESS
 #undef ENGINE_COLLECTION_WRITE_ACCESS
 #undef ENGINE_COLLECTION_READ_ACCESS
+#undef ENGINE_COLLECTION_TIMED_WRITE_ACCESS
 
 #undef ENGINE_LIST_CLASS_NAME
 #undef ENGINE_LIST_DERIVATION
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "../../Engine.dec.h"
+#include "RingQueueSignal.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// A fixed-capacity ring buffer that any thread may push to and pop from.
+            /// Each cell has a sequence number that tells which lap of the ring may use it next:
+            /// a producer claims a cell by a compare-exchange of the enqueue position, fills it,
+            /// then publishes it by setting its sequence, and a consumer does the same on the other side.
+            /// No thread waits for another between a claim and a publication, except the thread of the next lap.
+            template <typename ItemsType>
+            class MpmcRingQueue final
+            {
+            public:
+                /// @param Capacity The maximum number of items, rounded up to a power of 2.
+                MpmcRingQueue(int Capacity);
+                ~MpmcRingQueue();
+
+                MpmcRingQueue(const MpmcRingQueue&) = delete;
+                MpmcRingQueue& operator=(const MpmcRingQueue&) = delete;
+
+                /// @brief Pushes an item to the back. Can be called by any thread.
+                /// @return false if the queue is full.
+                bool TryPush(ItemsType Item);
+                /// @brief Pushes as many items as fit, in order, claiming their cells at once.
+                ///
+                /// The items may interleave with the items of other producers. The pushed items are moved from.
+                ///
+                /// @return The number of pushed items.
+                int TryPush(ItemsType * Items, int Count);
+                /// @brief Pushes an item to the back, waiting while the queue is full.
+                void Push(ItemsType Item);
+                /// @brief Pushes an item to the back, unless the queue is still full at the Deadline.
+                /// @return Whether the item is pushed.
+                bool TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Pops the first/front item. Can be called by any thread.
+                /// @param ItemOut The popped item, if any.
+                /// @return Whether there was an item to pop.
+                bool TryPop(ItemsType& ItemOut);
+                /// @brief Pops up to Count consecutive items, claiming their cells at once.
+                /// @return The number of popped items.
+                int TryPop(ItemsType * ItemsOut, int Count);
+                /// @brief Pops the first/front item, waiting while the queue is empty.
+                ItemsType Pop();
+                /// @brief Pops the first/front item, unless the queue is still empty at the Deadline.
+                /// @return Whether there was an item to pop.
+                bool TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Pops and destructs the items until the queue is empty.
+                void Clear();
+
+                /// @brief Gets the maximum number of items.
+                int GetCapacity();
+                /// @brief Gets the number of items.
+                ///
+                /// Is an approximation while other threads are pushing or popping.
+                int GetCount();
+                /// @brief Checks if there is no item to pop.
+                ///
+                /// Is an approximation while other threads are pushing or popping.
+                bool IsEmpty();
+            private:
+                struct Cell
+                {
+                    /// @brief The position that may push to the cell, or the position + 1 that may pop from it.
+                    std::atomic<std::size_t> Sequence;
+                    ItemsType Item;
+                };
+
+                Cell * Cells;
+                std::size_t Mask;
+
+                /// @brief The position of the next push, claimed by the producers.
+                alignas(64) std::atomic<std::size_t> EnqueuePosition;
+                /// @brief The position of the next pop, claimed by the consumers.
+                alignas(64) std::atomic<std::size_t> DequeuePosition;
+
+                alignas(64) RingQueueSignal NotEmpty;
+                alignas(64) RingQueueSignal NotFull;
+            };
+
+            template <typename ItemsType>
+            MpmcRingQueue<ItemsType>::MpmcRingQueue(int Capacity) : EnqueuePosition(0), DequeuePosition(0)
+            {
+                if (Capacity <= 0)
+                    throw std::domain_error("Capacity is less than or equal to zero.");
+                if (Capacity > (1 << 30))
+                    throw std::domain_error("Capacity is greater than 2^30.");
+
+                std::size_t capacity = 1;
+                while (capacity < (std::size_t)Capacity)
+                    capacity <<= 1;
+                Cells = new Cell[capacity];
+                for (std::size_t i = 0; i < capacity; i++)
+                    Cells[i].Sequence.store(i, std::memory_order_relaxed);
+                Mask = capacity - 1;
+            }
+
+            template <typename ItemsType>
+            MpmcRingQueue<ItemsType>::~MpmcRingQueue()
+            {
+                delete[] Cells;
+            }
+
+            template <typename ItemsType>
+            bool MpmcRingQueue<ItemsType>::TryPush(ItemsType Item)
+            {
+                return TryPush(&Item, 1) == 1;
+            }
+
+            template <typename ItemsType>
+            int MpmcRingQueue<ItemsType>::TryPush(ItemsType * Items, int Count)
+            {
+                if (Count <= 0)
+                    return 0;
+
+                std::size_t position = EnqueuePosition.load(std::memory_order_relaxed);
+                int count;
+                while (true)
+                {
+                    // Counts the free cells of this lap from the position
+                    count = 0;
+                    while (count < Count)
+                    {
+                        std::size_t sequence = Cells[(position + count) & Mask].Sequence.load(std::memory_order_acquire);
+                        if (sequence != position + count)
+                            break;
+                        count++;
+                    }
+
+                    if (count == 0)
+                    {
+                        std::size_t sequence = Cells[position & Mask].Sequence.load(std::memory_order_acquire);
+                        if ((std::ptrdiff_t)(sequence - position) < 0)
+                            return 0; // Full, the cell still holds the item of the previous lap
+                        position = EnqueuePosition.load(std::memory_order_relaxed); // Claimed by another producer
+                        continue;
+                    }
+
+                    if (EnqueuePosition.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+                        break;
+                }
+
+                for (int i = 0; i < count; i++)
+                {
+                    Cell& cell = Cells[(position + i) & Mask];
+                    cell.Item = std::move(Items[i]);
+                    cell.Sequence.store(position + i + 1, std::memory_order_release);
+                }
+
+                NotEmpty.Notify(count);
+                return count;
+            }
+
+            template <typename ItemsType>
+            void MpmcRingQueue<ItemsType>::Push(ItemsType Item)
+            {
+                NotFull.Wait([&] { return TryPush(&Item, 1) == 1; });
+            }
+
+            template <typename ItemsType>
+            bool MpmcRingQueue<ItemsType>::TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline)
+            {
+                return NotFull.WaitUntil([&] { return TryPush(&Item, 1) == 1; }, Deadline);
+            }
+
+            template <typename ItemsType>
+            bool MpmcRingQueue<ItemsType>::TryPop(ItemsType& ItemOut)
+            {
+                return TryPop(&ItemOut, 1) == 1;
+            }
+
+            template <typename ItemsType>
+            int MpmcRingQueue<ItemsType>::TryPop(ItemsType * ItemsOut, int Count)
+            {
+                if (Count <= 0)
+                    return 0;
+
+                std::size_t position = DequeuePosition.load(std::memory_order_relaxed);
+                int count;
+                while (true)
+                {
+                    // Counts the published cells from the position
+                    count = 0;
+                    while (count < Count)
+                    {
+                        std::size_t sequence = Cells[(position + count) & Mask].Sequence.load(std::memory_order_acquire);
+                        if (sequence != position + count + 1)
+                            break;
+                        count++;
+                    }
+
+                    if (count == 0)
+                    {
+                        std::size_t sequence = Cells[position & Mask].Sequence.load(std::memory_order_acquire);
+                        if ((std::ptrdiff_t)(sequence - (position + 1)) < 0)
+                            return 0; // Empty, or the producer of the cell has not published it yet
+                        position = DequeuePosition.load(std::memory_order_relaxed); // Claimed by another consumer
+                        continue;
+                    }
+
+                    if (DequeuePosition.compare_exchange_weak(position, position + count, std::memory_order_relaxed))
+                        break;
+                }
+
+                for (int i = 0; i < count; i++)
+                {
+                    Cell& cell = Cells[(position + i) & Mask];
+                    ItemsOut[i] = std::move(cell.Item);
+                    cell.Item = ItemsType();
+                    // Frees the cell for the next lap
+                    cell.Sequence.store(position + i + Mask + 1, std::memory_order_release);
+                }
+
+                NotFull.Notify(count);
+                return count;
+            }
+
+            template <typename ItemsType>
+            ItemsType MpmcRingQueue<ItemsType>::Pop()
+            {
+                ItemsType item;
+                NotEmpty.Wait([&] { return TryPop(&item, 1) == 1; });
+                return item;
+            }
+
+            template <typename ItemsType>
+            bool MpmcRingQueue<ItemsType>::TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline)
+            {
+                return NotEmpty.WaitUntil([&] { return TryPop(&ItemOut, 1) == 1; }, Deadline);
+            }
+
+            template <typename ItemsType>
+            void MpmcRingQueue<ItemsType>::Clear()
+            {
+                ItemsType item;
+                while (TryPop(&item, 1) == 1);
+            }
+
+            template <typename ItemsType>
+            int MpmcRingQueue<ItemsType>::GetCapacity()
+            {
+                return (int)(Mask + 1);
+            }
+
+            template <typename ItemsType>
+            int MpmcRingQueue<ItemsType>::GetCount()
+            {
+                // The dequeue position first, so the difference does not underflow
+                std::size_t dequeue_position = DequeuePosition.load(std::memory_order_acquire);
+                std::size_t enqueue_position = EnqueuePosition.load(std::memory_order_acquire);
+                std::ptrdiff_t count = (std::ptrdiff_t)(enqueue_position - dequeue_position);
+                if (count < 0)
+                    return 0;
+                return count > (std::ptrdiff_t)(Mask + 1) ? (int)(Mask + 1) : (int)count;
+            }
+
+            template <typename ItemsType>
+            bool MpmcRingQueue<ItemsType>::IsEmpty()
+            {
+                return GetCount() == 0;
+            }
+        }
+    }
+}
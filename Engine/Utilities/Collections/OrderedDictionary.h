@@ -0,0 +1,1031 @@
+#ifndef ENGINE_ORDERED_DICTIONARY_INCLUDED
+
+#ifdef ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+    #define ENGINE_ORDERED_DICTIONARY_INCLUDED
+#endif
+
+#include "../../Engine.dec.h"
+
+#ifdef ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+    #include "../MutexContained.h"
+    #define ENGINE_ORDERED_DICTIONARY_CLASS_NAME OrderedDictionary<KeyType, ValueType, true>
+    #define ENGINE_ORDERED_DICTIONARY_DERIVATION : public MutexContained<true, false>
+#else
+    #define ENGINE_ORDERED_DICTIONARY_CLASS_NAME OrderedDictionary<KeyType, ValueType, false>
+    #define ENGINE_ORDERED_DICTIONARY_DERIVATION
+#endif
+
+#ifndef ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// @brief The nodes of the B+-tree of an OrderedDictionary.
+            template <typename KeyType, typename ValueType>
+            struct OrderedDictionaryNodes
+            {
+                /// @brief The size of the keys of a node, 4 cache lines.
+                static constexpr int NodeKeysSize = 256;
+                static constexpr int LeafCapacity = std::max<int>(4, NodeKeysSize / sizeof(KeyType));
+                static constexpr int InnerCapacity = std::max<int>(4, NodeKeysSize / sizeof(KeyType));
+                /// @brief The least count of a leaf or an inner node other than the root, less than that is merged.
+                static constexpr int MinLeafCount = LeafCapacity / 2;
+                static constexpr int MinInnerCount = (InnerCapacity - 1) / 2;
+
+                struct Node
+                {
+                    bool IsLeaf;
+                    /// @brief The number of keys.
+                    int Count;
+                };
+
+                struct Leaf : Node
+                {
+                    Leaf * Next;
+                    KeyType Keys[LeafCapacity];
+                    ValueType Values[LeafCapacity];
+                };
+
+                /// The keys of Children[i] are less than Keys[i], those of Children[i + 1] are not.
+                struct Inner : Node
+                {
+                    KeyType Keys[InnerCapacity];
+                    Node * Children[InnerCapacity + 1];
+                };
+            };
+        }
+    }
+}
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// The pairs are kept in the leaves of a B+-tree, in order, and the leaves are linked,
+            /// so a range is scanned from its first key without going back up the tree.
+            /// The keys of a node fill a few cache lines, so the tree is shallow
+            /// and a search loads few lines per level.
+            ///
+            /// The keys only need the < operator, like those of Dictionary.
+            template <typename KeyType, typename ValueType>
+            class ENGINE_ORDERED_DICTIONARY_CLASS_NAME final ENGINE_ORDERED_DICTIONARY_DERIVATION
+            {
+#ifdef ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+                friend OrderedDictionary<KeyType, ValueType, false>;
+#else
+                friend OrderedDictionary<KeyType, ValueType, true>;
+#endif
+            public:
+                typedef std::function<void(KeyType Key)> ForEachBody;
+                typedef std::function<void(KeyType Key, bool& BreakLoop)> ForEachBodyWithBreakBool;
+                typedef std::function<void(KeyType Key, std::function<void()> Break)> ForEachBodyWithBreakFunction;
+                typedef std::function<void(KeyType Key, ValueType Value)> ForEachBodyWithValue;
+                typedef std::function<void(KeyType Key, ValueType Value, bool& BreakLoop)> ForEachBodyWithValueWithBreakBool;
+                typedef std::function<void(KeyType Key, ValueType Value, std::function<void()> Break)> ForEachBodyWithValueWithBreakFunction;
+
+                OrderedDictionary();
+                ~OrderedDictionary();
+
+                OrderedDictionary(OrderedDictionary<KeyType, ValueType, true>&) noexcept;
+                OrderedDictionary(OrderedDictionary<KeyType, ValueType, true>&&) noexcept;
+                OrderedDictionary(OrderedDictionary<KeyType, ValueType, false>&) noexcept;
+                OrderedDictionary(OrderedDictionary<KeyType, ValueType, false>&&) noexcept;
+
+                OrderedDictionary& operator=(OrderedDictionary<KeyType, ValueType, true>) noexcept;
+                OrderedDictionary& operator=(OrderedDictionary<KeyType, ValueType, false>) noexcept;
+
+                /// @brief Assigns a value to a key.
+                void SetValue(KeyType Key, ValueType Value);
+                /// @brief Removes a key-value pair.
+                void Remove(KeyType Key);
+                /// @brief Assigns a value to a key, unless the lock is not acquired before the Deadline.
+                /// @return Whether the value was assigned.
+                bool TrySetValueUntil(KeyType Key, ValueType Value, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Removes a key-value pair, unless the lock is not acquired before the Deadline.
+                /// @return Whether the pair was removed.
+                bool TryRemoveUntil(KeyType Key, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Clears the key-value pairs.
+                void Clear();
+                /// @brief Replaces the key-value pairs with sorted ones, in linear time.
+                ///
+                /// The leaves are filled instead of half-filled as by the splits of SetValue.
+                /// @param Keys Count keys in ascending order, without duplicates.
+                /// @param Values The values of the keys.
+                void BulkLoad(const KeyType * Keys, const ValueType * Values, int Count);
+
+                /// @brief Gets the value that is assigned to a key.
+                ValueType GetValue(KeyType Key);
+                /// @brief Gets the value that is assigned to a key, if any.
+                /// @param ValueOut The value, if the key exists.
+                /// @return True if the key exists in the dictionary.
+                bool TryGetValue(KeyType Key, ValueType& ValueOut);
+                /// @brief Checks if a key exists in the dictionary.
+                /// @param Key The search subject.
+                /// @return True if the key exists in the dictionary.
+                bool Contains(KeyType Key);
+                /// @brief Gets the items count.
+                int GetCount();
+                /// @brief Checks whether the dictionary is empty.
+                bool IsEmpty();
+
+                /// @brief Gets the first key-value whose key is not less than Key.
+                /// @return Whether there is such a key.
+                bool LowerBound(KeyType Key, KeyType& KeyOut, ValueType& ValueOut);
+                /// @brief Gets the first key-value whose key is greater than Key.
+                /// @return Whether there is such a key.
+                bool UpperBound(KeyType Key, KeyType& KeyOut, ValueType& ValueOut);
+
+                /// @brief Calls a function for each key, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEach(ForEachBody Body);
+                /// @brief Calls a function for each key, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEach(ForEachBodyWithBreakBool Body);
+                /// @brief Calls a function for each key, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEach(ForEachBodyWithBreakFunction Body);
+                /// @brief Calls a function for each key-value, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEach(ForEachBodyWithValue Body);
+                /// @brief Calls a function for each key-value, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEach(ForEachBodyWithValueWithBreakBool Body);
+                /// @brief Calls a function for each key-value, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEach(ForEachBodyWithValueWithBreakFunction Body);
+
+                /// @brief Calls a function for each key from From, included, to To, excluded, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEachInRange(KeyType From, KeyType To, ForEachBody Body);
+                /// @brief Calls a function for each key from From, included, to To, excluded, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEachInRange(KeyType From, KeyType To, ForEachBodyWithBreakBool Body);
+                /// @brief Calls a function for each key from From, included, to To, excluded, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEachInRange(KeyType From, KeyType To, ForEachBodyWithBreakFunction Body);
+                /// @brief Calls a function for each key-value from From, included, to To, excluded, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                void ForEachInRange(KeyType From, KeyType To, ForEachBodyWithValue Body);
+                /// @brief Calls a function for each key-value from From, included, to To, excluded, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Set BreakLoop boolean provided by the parameters to true to break the loop.
+                void ForEachInRange(KeyType From, KeyType To, ForEachBodyWithValueWithBreakBool Body);
+                /// @brief Calls a function for each key-value from From, included, to To, excluded, in ascending order.
+                /// @param Body The foreach body function, can be a lambda.
+                ///        Call Break function provided by the parameters to break the loop.
+                void ForEachInRange(KeyType From, KeyType To, ForEachBodyWithValueWithBreakFunction Body);
+            private:
+                class LoopBreaker {};
+
+                // Shared by the two variants, so they can move their trees to each other
+                typedef OrderedDictionaryNodes<KeyType, ValueType> Nodes;
+                typedef typename Nodes::Node Node;
+                typedef typename Nodes::Leaf Leaf;
+                typedef typename Nodes::Inner Inner;
+                static constexpr int LeafCapacity = Nodes::LeafCapacity;
+                static constexpr int InnerCapacity = Nodes::InnerCapacity;
+                static constexpr int MinLeafCount = Nodes::MinLeafCount;
+                static constexpr int MinInnerCount = Nodes::MinInnerCount;
+
+                /// @brief nullptr if empty.
+                Node * Root;
+                Leaf * FirstLeaf;
+                int Count;
+
+                static Leaf * NewLeaf();
+                static Inner * NewInner();
+                static void Free(Node * Subtree);
+
+                /// @brief Finds the leaf that has or would have the key.
+                inline Leaf * FindLeaf(const KeyType& Key);
+                /// @return The value of the key, nullptr if not found.
+                inline ValueType * Find(const KeyType& Key);
+                /// @brief Finds the position of the first key that is not less than Key, or greater than Key if Greater.
+                /// @param LeafOut nullptr if there is no such key.
+                void FindBound(const KeyType& Key, bool Greater, Leaf *& LeafOut, int& IndexOut);
+                /// @return Whether the key was added rather than assigned.
+                /// @param SplitNode Is set to the new right sibling of Subtree if it was split,
+                ///        whose least key is SplitKey.
+                bool Insert(Node * Subtree, const KeyType& Key, const ValueType& Value, KeyType& SplitKey, Node *& SplitNode);
+                /// @return Whether the key was found.
+                bool Erase(Node * Subtree, const KeyType& Key);
+                /// @brief Fills the Index child of Parent up to its least count, from a sibling or by merging them.
+                void Rebalance(Inner * Parent, int Index);
+                /// @brief Builds the tree from the pairs that NextPair(KeyType&, ValueType&) sets in ascending order.
+                template <typename NextPairType>
+                void Build(int Count, NextPairType NextPair);
+                template <typename OtherType>
+                void CopyFrom(OtherType& Op);
+                /// @brief Calls Body(KeyType&, ValueType&) for each key from the position, until it returns false
+                ///        or the key is not less than *To.
+                /// @param To nullptr for no end.
+                template <typename BodyType>
+                static void Scan(Leaf * From, int Index, const KeyType * To, BodyType Body);
+            };
+        }
+    }
+}
+
+// DEFINITION ----------------------------------------------------------------
+
+#ifdef ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+    #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock();
+    #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock();
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) \
+        RecursiveMutex<true, false>::LockGuard guard; \
+        if (!Mutex.TryGetLockUntil(guard, Deadline)) \
+            return false;
+#else
+    #define ENGINE_COLLECTION_WRITE_ACCESS ;
+    #define ENGINE_COLLECTION_READ_ACCESS ;
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) (void)(Deadline);
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME::OrderedDictionary() : Root(nullptr), FirstLeaf(nullptr), Count(0) {}
+
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME::~OrderedDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Free(Root);
+            }
+
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME::OrderedDictionary(OrderedDictionary<KeyType, ValueType, true>& Op) noexcept : OrderedDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetSharedLock();
+
+                CopyFrom(Op);
+            }
+
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME::OrderedDictionary(OrderedDictionary<KeyType, ValueType, true>&& Op) noexcept : OrderedDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetLock();
+
+                std::swap(Root, Op.Root);
+                std::swap(FirstLeaf, Op.FirstLeaf);
+                std::swap(Count, Op.Count);
+            }
+
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME::OrderedDictionary(OrderedDictionary<KeyType, ValueType, false>& Op) noexcept : OrderedDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                CopyFrom(Op);
+            }
+
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME::OrderedDictionary(OrderedDictionary<KeyType, ValueType, false>&& Op) noexcept : OrderedDictionary()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                std::swap(Root, Op.Root);
+                std::swap(FirstLeaf, Op.FirstLeaf);
+                std::swap(Count, Op.Count);
+            }
+
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME& ENGINE_ORDERED_DICTIONARY_CLASS_NAME::operator=(OrderedDictionary<KeyType, ValueType, true> Op) noexcept
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+                auto OpGuard = Op.Mutex.GetLock();
+
+                std::swap(Root, Op.Root);
+                std::swap(FirstLeaf, Op.FirstLeaf);
+                std::swap(Count, Op.Count);
+
+                return *this;
+            }
+
+            template <typename KeyType, typename ValueType>
+            ENGINE_ORDERED_DICTIONARY_CLASS_NAME& ENGINE_ORDERED_DICTIONARY_CLASS_NAME::operator=(OrderedDictionary<KeyType, ValueType, false> Op) noexcept
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                std::swap(Root, Op.Root);
+                std::swap(FirstLeaf, Op.FirstLeaf);
+                std::swap(Count, Op.Count);
+
+                return *this;
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::SetValue(KeyType Key, ValueType Value)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Root == nullptr)
+                {
+                    FirstLeaf = NewLeaf();
+                    Root = FirstLeaf;
+                }
+
+                KeyType split_key;
+                Node * split_node = nullptr;
+                if (Insert(Root, Key, Value, split_key, split_node))
+                    Count++;
+                if (split_node != nullptr)
+                {
+                    Inner * root = NewInner();
+                    root->Count = 1;
+                    root->Keys[0] = std::move(split_key);
+                    root->Children[0] = Root;
+                    root->Children[1] = split_node;
+                    Root = root;
+                }
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Remove(KeyType Key)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Root == nullptr || !Erase(Root, Key))
+                    throw std::domain_error("Key not found.");
+                Count--;
+
+                if (!Root->IsLeaf && Root->Count == 0)
+                {
+                    Inner * root = static_cast<Inner*>(Root);
+                    Root = root->Children[0];
+                    delete root;
+                }
+                if (Count == 0)
+                {
+                    Free(Root);
+                    Root = nullptr;
+                    FirstLeaf = nullptr;
+                }
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::TrySetValueUntil(KeyType Key, ValueType Value, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                SetValue(Key, Value);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::TryRemoveUntil(KeyType Key, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                Remove(Key);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Clear()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Free(Root);
+                Root = nullptr;
+                FirstLeaf = nullptr;
+                Count = 0;
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::BulkLoad(const KeyType * Keys, const ValueType * Values, int Count)
+            {
+                if (Count < 0)
+                    throw std::domain_error("Count is less than zero.");
+                for (int i = 1; i < Count; i++)
+                    if (!(Keys[i - 1] < Keys[i]))
+                        throw std::invalid_argument("The keys are not in ascending order.");
+
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                int i = 0;
+                Build(Count, [&](KeyType& KeyOut, ValueType& ValueOut) {
+                    KeyOut = Keys[i];
+                    ValueOut = Values[i];
+                    i++;
+                });
+            }
+
+            template <typename KeyType, typename ValueType>
+            ValueType ENGINE_ORDERED_DICTIONARY_CLASS_NAME::GetValue(KeyType Key)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                ValueType * value = Find(Key);
+                if (value == nullptr)
+                    throw std::domain_error("Key not found.");
+                return *value;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::TryGetValue(KeyType Key, ValueType& ValueOut)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                ValueType * value = Find(Key);
+                if (value == nullptr)
+                    return false;
+                ValueOut = *value;
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Contains(KeyType Key)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Find(Key) != nullptr;
+            }
+
+            template <typename KeyType, typename ValueType>
+            int ENGINE_ORDERED_DICTIONARY_CLASS_NAME::GetCount()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Count;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::IsEmpty()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Count == 0;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::LowerBound(KeyType Key, KeyType& KeyOut, ValueType& ValueOut)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(Key, false, leaf, i);
+                if (leaf == nullptr)
+                    return false;
+                KeyOut = leaf->Keys[i];
+                ValueOut = leaf->Values[i];
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::UpperBound(KeyType Key, KeyType& KeyOut, ValueType& ValueOut)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(Key, true, leaf, i);
+                if (leaf == nullptr)
+                    return false;
+                KeyOut = leaf->Keys[i];
+                ValueOut = leaf->Values[i];
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEach(ForEachBody Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Scan(FirstLeaf, 0, nullptr, [&](KeyType& Key, ValueType&) { Body(Key); return true; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithBreakBool Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                bool ShouldBreak = false;
+                Scan(FirstLeaf, 0, nullptr, [&](KeyType& Key, ValueType&) { Body(Key, ShouldBreak); return !ShouldBreak; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithBreakFunction Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                try
+                {
+                    Scan(FirstLeaf, 0, nullptr, [&](KeyType& Key, ValueType&) { Body(Key, BreakFunction); return true; });
+                }
+                catch (LoopBreaker&) {}
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithValue Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Scan(FirstLeaf, 0, nullptr, [&](KeyType& Key, ValueType& Value) { Body(Key, Value); return true; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithValueWithBreakBool Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                bool ShouldBreak = false;
+                Scan(FirstLeaf, 0, nullptr, [&](KeyType& Key, ValueType& Value) { Body(Key, Value, ShouldBreak); return !ShouldBreak; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEach(ForEachBodyWithValueWithBreakFunction Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                try
+                {
+                    Scan(FirstLeaf, 0, nullptr, [&](KeyType& Key, ValueType& Value) { Body(Key, Value, BreakFunction); return true; });
+                }
+                catch (LoopBreaker&) {}
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEachInRange(KeyType From, KeyType To, ForEachBody Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(From, false, leaf, i);
+                Scan(leaf, i, &To, [&](KeyType& Key, ValueType&) { Body(Key); return true; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEachInRange(KeyType From, KeyType To, ForEachBodyWithBreakBool Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(From, false, leaf, i);
+                bool ShouldBreak = false;
+                Scan(leaf, i, &To, [&](KeyType& Key, ValueType&) { Body(Key, ShouldBreak); return !ShouldBreak; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEachInRange(KeyType From, KeyType To, ForEachBodyWithBreakFunction Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(From, false, leaf, i);
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                try
+                {
+                    Scan(leaf, i, &To, [&](KeyType& Key, ValueType&) { Body(Key, BreakFunction); return true; });
+                }
+                catch (LoopBreaker&) {}
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEachInRange(KeyType From, KeyType To, ForEachBodyWithValue Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(From, false, leaf, i);
+                Scan(leaf, i, &To, [&](KeyType& Key, ValueType& Value) { Body(Key, Value); return true; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEachInRange(KeyType From, KeyType To, ForEachBodyWithValueWithBreakBool Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(From, false, leaf, i);
+                bool ShouldBreak = false;
+                Scan(leaf, i, &To, [&](KeyType& Key, ValueType& Value) { Body(Key, Value, ShouldBreak); return !ShouldBreak; });
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::ForEachInRange(KeyType From, KeyType To, ForEachBodyWithValueWithBreakFunction Body)
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                Leaf * leaf;
+                int i;
+                FindBound(From, false, leaf, i);
+                std::function<void()> BreakFunction = []() { throw LoopBreaker(); };
+                try
+                {
+                    Scan(leaf, i, &To, [&](KeyType& Key, ValueType& Value) { Body(Key, Value, BreakFunction); return true; });
+                }
+                catch (LoopBreaker&) {}
+            }
+
+            template <typename KeyType, typename ValueType>
+            typename ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Leaf * ENGINE_ORDERED_DICTIONARY_CLASS_NAME::NewLeaf()
+            {
+                Leaf * leaf = new Leaf();
+                leaf->IsLeaf = true;
+                leaf->Count = 0;
+                leaf->Next = nullptr;
+                return leaf;
+            }
+
+            template <typename KeyType, typename ValueType>
+            typename ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Inner * ENGINE_ORDERED_DICTIONARY_CLASS_NAME::NewInner()
+            {
+                Inner * inner = new Inner();
+                inner->IsLeaf = false;
+                inner->Count = 0;
+                return inner;
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Free(Node * Subtree)
+            {
+                if (Subtree == nullptr)
+                    return;
+                if (Subtree->IsLeaf)
+                {
+                    delete static_cast<Leaf*>(Subtree);
+                    return;
+                }
+                Inner * inner = static_cast<Inner*>(Subtree);
+                for (int i = 0; i <= inner->Count; i++)
+                    Free(inner->Children[i]);
+                delete inner;
+            }
+
+            template <typename KeyType, typename ValueType>
+            typename ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Leaf * ENGINE_ORDERED_DICTIONARY_CLASS_NAME::FindLeaf(const KeyType& Key)
+            {
+                Node * node = Root;
+                while (!node->IsLeaf)
+                {
+                    Inner * inner = static_cast<Inner*>(node);
+                    node = inner->Children[std::upper_bound(inner->Keys, inner->Keys + inner->Count, Key) - inner->Keys];
+                }
+                return static_cast<Leaf*>(node);
+            }
+
+            template <typename KeyType, typename ValueType>
+            ValueType * ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Find(const KeyType& Key)
+            {
+                if (Root == nullptr)
+                    return nullptr;
+                Leaf * leaf = FindLeaf(Key);
+                int i = std::lower_bound(leaf->Keys, leaf->Keys + leaf->Count, Key) - leaf->Keys;
+                if (i == leaf->Count || Key < leaf->Keys[i])
+                    return nullptr;
+                return &leaf->Values[i];
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::FindBound(const KeyType& Key, bool Greater, Leaf *& LeafOut, int& IndexOut)
+            {
+                LeafOut = nullptr;
+                IndexOut = 0;
+                if (Root == nullptr)
+                    return;
+
+                Leaf * leaf = FindLeaf(Key);
+                KeyType * bound = Greater
+                    ? std::upper_bound(leaf->Keys, leaf->Keys + leaf->Count, Key)
+                    : std::lower_bound(leaf->Keys, leaf->Keys + leaf->Count, Key);
+                IndexOut = bound - leaf->Keys;
+                // The keys of the next leaves are not less than the separator that led to this leaf, so greater than Key
+                if (IndexOut == leaf->Count)
+                {
+                    leaf = leaf->Next;
+                    IndexOut = 0;
+                }
+                LeafOut = leaf;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Insert(Node * Subtree, const KeyType& Key, const ValueType& Value, KeyType& SplitKey, Node *& SplitNode)
+            {
+                if (Subtree->IsLeaf)
+                {
+                    Leaf * leaf = static_cast<Leaf*>(Subtree);
+                    int i = std::lower_bound(leaf->Keys, leaf->Keys + leaf->Count, Key) - leaf->Keys;
+                    if (i < leaf->Count && !(Key < leaf->Keys[i]))
+                    {
+                        leaf->Values[i] = Value;
+                        return false;
+                    }
+
+                    if (leaf->Count == LeafCapacity)
+                    {
+                        const int half = LeafCapacity / 2;
+                        Leaf * right = NewLeaf();
+                        std::move(leaf->Keys + half, leaf->Keys + LeafCapacity, right->Keys);
+                        std::move(leaf->Values + half, leaf->Values + LeafCapacity, right->Values);
+                        right->Count = LeafCapacity - half;
+                        leaf->Count = half;
+                        right->Next = leaf->Next;
+                        leaf->Next = right;
+                        SplitNode = right;
+                        if (i > half)
+                        {
+                            leaf = right;
+                            i -= half;
+                        }
+                    }
+
+                    std::move_backward(leaf->Keys + i, leaf->Keys + leaf->Count, leaf->Keys + leaf->Count + 1);
+                    std::move_backward(leaf->Values + i, leaf->Values + leaf->Count, leaf->Values + leaf->Count + 1);
+                    leaf->Keys[i] = Key;
+                    leaf->Values[i] = Value;
+                    leaf->Count++;
+                    if (SplitNode != nullptr)
+                        SplitKey = static_cast<Leaf*>(SplitNode)->Keys[0];
+                    return true;
+                }
+
+                Inner * inner = static_cast<Inner*>(Subtree);
+                int i = std::upper_bound(inner->Keys, inner->Keys + inner->Count, Key) - inner->Keys;
+                KeyType child_split_key;
+                Node * child_split_node = nullptr;
+                bool added = Insert(inner->Children[i], Key, Value, child_split_key, child_split_node);
+                if (child_split_node == nullptr)
+                    return added;
+
+                if (inner->Count == InnerCapacity)
+                {
+                    // The middle key moves up, between the two halves
+                    const int middle = InnerCapacity / 2;
+                    Inner * right = NewInner();
+                    SplitKey = std::move(inner->Keys[middle]);
+                    std::move(inner->Keys + middle + 1, inner->Keys + InnerCapacity, right->Keys);
+                    std::copy(inner->Children + middle + 1, inner->Children + InnerCapacity + 1, right->Children);
+                    right->Count = InnerCapacity - middle - 1;
+                    inner->Count = middle;
+                    SplitNode = right;
+                    if (i > middle)
+                    {
+                        inner = right;
+                        i -= middle + 1;
+                    }
+                }
+
+                std::move_backward(inner->Keys + i, inner->Keys + inner->Count, inner->Keys + inner->Count + 1);
+                std::copy_backward(inner->Children + i + 1, inner->Children + inner->Count + 1, inner->Children + inner->Count + 2);
+                inner->Keys[i] = std::move(child_split_key);
+                inner->Children[i + 1] = child_split_node;
+                inner->Count++;
+                return added;
+            }
+
+            template <typename KeyType, typename ValueType>
+            bool ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Erase(Node * Subtree, const KeyType& Key)
+            {
+                if (Subtree->IsLeaf)
+                {
+                    Leaf * leaf = static_cast<Leaf*>(Subtree);
+                    int i = std::lower_bound(leaf->Keys, leaf->Keys + leaf->Count, Key) - leaf->Keys;
+                    if (i == leaf->Count || Key < leaf->Keys[i])
+                        return false;
+                    std::move(leaf->Keys + i + 1, leaf->Keys + leaf->Count, leaf->Keys + i);
+                    std::move(leaf->Values + i + 1, leaf->Values + leaf->Count, leaf->Values + i);
+                    leaf->Count--;
+                    return true;
+                }
+
+                Inner * inner = static_cast<Inner*>(Subtree);
+                int i = std::upper_bound(inner->Keys, inner->Keys + inner->Count, Key) - inner->Keys;
+                if (!Erase(inner->Children[i], Key))
+                    return false;
+                Node * child = inner->Children[i];
+                if (child->Count < (child->IsLeaf ? MinLeafCount : MinInnerCount))
+                    Rebalance(inner, i);
+                return true;
+            }
+
+            template <typename KeyType, typename ValueType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Rebalance(Inner * Parent, int Index)
+            {
+                // A parent other than the root has at least one key, and the root too, so there is a sibling
+                if (Parent->Children[Index]->IsLeaf)
+                {
+                    Leaf * leaf = static_cast<Leaf*>(Parent->Children[Index]);
+                    Leaf * left = Index > 0 ? static_cast<Leaf*>(Parent->Children[Index - 1]) : nullptr;
+                    Leaf * right = Index < Parent->Count ? static_cast<Leaf*>(Parent->Children[Index + 1]) : nullptr;
+
+                    if (left != nullptr && left->Count > MinLeafCount)
+                    {
+                        std::move_backward(leaf->Keys, leaf->Keys + leaf->Count, leaf->Keys + leaf->Count + 1);
+                        std::move_backward(leaf->Values, leaf->Values + leaf->Count, leaf->Values + leaf->Count + 1);
+                        left->Count--;
+                        leaf->Keys[0] = std::move(left->Keys[left->Count]);
+                        leaf->Values[0] = std::move(left->Values[left->Count]);
+                        leaf->Count++;
+                        Parent->Keys[Index - 1] = leaf->Keys[0];
+                        return;
+                    }
+                    if (right != nullptr && right->Count > MinLeafCount)
+                    {
+                        leaf->Keys[leaf->Count] = std::move(right->Keys[0]);
+                        leaf->Values[leaf->Count] = std::move(right->Values[0]);
+                        leaf->Count++;
+                        std::move(right->Keys + 1, right->Keys + right->Count, right->Keys);
+                        std::move(right->Values + 1, right->Values + right->Count, right->Values);
+                        right->Count--;
+                        Parent->Keys[Index] = right->Keys[0];
+                        return;
+                    }
+
+                    // Merges into the left one of the two, so the first leaf is never deleted
+                    if (left == nullptr)
+                    {
+                        left = leaf;
+                        leaf = right;
+                        Index++;
+                    }
+                    std::move(leaf->Keys, leaf->Keys + leaf->Count, left->Keys + left->Count);
+                    std::move(leaf->Values, leaf->Values + leaf->Count, left->Values + left->Count);
+                    left->Count += leaf->Count;
+                    left->Next = leaf->Next;
+                    delete leaf;
+                }
+                else
+                {
+                    Inner * inner = static_cast<Inner*>(Parent->Children[Index]);
+                    Inner * left = Index > 0 ? static_cast<Inner*>(Parent->Children[Index - 1]) : nullptr;
+                    Inner * right = Index < Parent->Count ? static_cast<Inner*>(Parent->Children[Index + 1]) : nullptr;
+
+                    // Rotates a child through the separator of the parent
+                    if (left != nullptr && left->Count > MinInnerCount)
+                    {
+                        std::move_backward(inner->Keys, inner->Keys + inner->Count, inner->Keys + inner->Count + 1);
+                        std::copy_backward(inner->Children, inner->Children + inner->Count + 1, inner->Children + inner->Count + 2);
+                        inner->Keys[0] = std::move(Parent->Keys[Index - 1]);
+                        inner->Children[0] = left->Children[left->Count];
+                        inner->Count++;
+                        left->Count--;
+                        Parent->Keys[Index - 1] = std::move(left->Keys[left->Count]);
+                        return;
+                    }
+                    if (right != nullptr && right->Count > MinInnerCount)
+                    {
+                        inner->Keys[inner->Count] = std::move(Parent->Keys[Index]);
+                        inner->Children[inner->Count + 1] = right->Children[0];
+                        inner->Count++;
+                        Parent->Keys[Index] = std::move(right->Keys[0]);
+                        std::move(right->Keys + 1, right->Keys + right->Count, right->Keys);
+                        std::copy(right->Children + 1, right->Children + right->Count + 1, right->Children);
+                        right->Count--;
+                        return;
+                    }
+
+                    if (left == nullptr)
+                    {
+                        left = inner;
+                        inner = right;
+                        Index++;
+                    }
+                    left->Keys[left->Count] = std::move(Parent->Keys[Index - 1]);
+                    std::move(inner->Keys, inner->Keys + inner->Count, left->Keys + left->Count + 1);
+                    std::copy(inner->Children, inner->Children + inner->Count + 1, left->Children + left->Count + 1);
+                    left->Count += inner->Count + 1;
+                    delete inner;
+                }
+
+                // Removes the separator of the merged pair and the right one
+                std::move(Parent->Keys + Index, Parent->Keys + Parent->Count, Parent->Keys + Index - 1);
+                std::copy(Parent->Children + Index + 1, Parent->Children + Parent->Count + 1, Parent->Children + Index);
+                Parent->Count--;
+            }
+
+            template <typename KeyType, typename ValueType>
+            template <typename NextPairType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Build(int Count, NextPairType NextPair)
+            {
+                Free(Root);
+                Root = nullptr;
+                FirstLeaf = nullptr;
+                this->Count = Count;
+                if (Count == 0)
+                    return;
+
+                // The nodes of the level being built and their least keys, the parents replace them in place
+                int nodes_count = (Count + LeafCapacity - 1) / LeafCapacity;
+                Node ** nodes = new Node*[nodes_count];
+                KeyType * least_keys = new KeyType[nodes_count];
+
+                // Spread evenly, so the last node is not nearly empty
+                Leaf * previous = nullptr;
+                for (int i = 0; i < nodes_count; i++)
+                {
+                    Leaf * leaf = NewLeaf();
+                    leaf->Count = Count / nodes_count + (i < Count % nodes_count ? 1 : 0);
+                    for (int j = 0; j < leaf->Count; j++)
+                        NextPair(leaf->Keys[j], leaf->Values[j]);
+                    if (previous != nullptr)
+                        previous->Next = leaf;
+                    previous = leaf;
+                    nodes[i] = leaf;
+                    least_keys[i] = leaf->Keys[0];
+                }
+                FirstLeaf = static_cast<Leaf*>(nodes[0]);
+
+                while (nodes_count > 1)
+                {
+                    int parents_count = (nodes_count + InnerCapacity) / (InnerCapacity + 1);
+                    int child = 0;
+                    for (int i = 0; i < parents_count; i++)
+                    {
+                        Inner * inner = NewInner();
+                        int children_count = nodes_count / parents_count + (i < nodes_count % parents_count ? 1 : 0);
+                        KeyType least_key = least_keys[child];
+                        inner->Children[0] = nodes[child];
+                        for (int j = 1; j < children_count; j++)
+                        {
+                            inner->Keys[j - 1] = least_keys[child + j];
+                            inner->Children[j] = nodes[child + j];
+                        }
+                        inner->Count = children_count - 1;
+                        child += children_count;
+                        nodes[i] = inner;
+                        least_keys[i] = std::move(least_key);
+                    }
+                    nodes_count = parents_count;
+                }
+
+                Root = nodes[0];
+                delete[] nodes;
+                delete[] least_keys;
+            }
+
+            template <typename KeyType, typename ValueType>
+            template <typename OtherType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::CopyFrom(OtherType& Op)
+            {
+                auto leaf = Op.FirstLeaf;
+                int i = 0;
+                Build(Op.Count, [&](KeyType& KeyOut, ValueType& ValueOut) {
+                    if (i == leaf->Count)
+                    {
+                        leaf = leaf->Next;
+                        i = 0;
+                    }
+                    KeyOut = leaf->Keys[i];
+                    ValueOut = leaf->Values[i];
+                    i++;
+                });
+            }
+
+            template <typename KeyType, typename ValueType>
+            template <typename BodyType>
+            void ENGINE_ORDERED_DICTIONARY_CLASS_NAME::Scan(Leaf * From, int Index, const KeyType * To, BodyType Body)
+            {
+                for (Leaf * leaf = From; leaf != nullptr; leaf = leaf->Next, Index = 0)
+                    for (; Index < leaf->Count; Index++)
+                    {
+                        if (To != nullptr && !(leaf->Keys[Index] < *To))
+                            return;
+                        if (!Body(leaf->Keys[Index], leaf->Values[Index]))
+                            return;
+                    }
+            }
+        }
+    }
+}
+
+#undef ENGINE_COLLECTION_WRITE_ACCESS
+#undef ENGINE_COLLECTION_READ_ACCESS
+#undef ENGINE_COLLECTION_TIMED_WRITE_ACCESS
+
+#undef ENGINE_ORDERED_DICTIONARY_CLASS_NAME
+#undef ENGINE_ORDERED_DICTIONARY_DERIVATION
+
+#ifndef ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+    #define ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+    #include "OrderedDictionary.h"
+    #undef ENGINE_ORDERED_DICTIONARY_USE_MUTEX
+#endif
+
+#endif // Include Guard
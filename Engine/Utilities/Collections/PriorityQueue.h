@@ -6,44 +6,86 @@
 
 #include "../../Engine.dec.h"
 #include "ResizableArray.h"
+#include "GrowthPolicy.h"
 
 #ifdef ENGINE_PRIORITY_QUEUE_USE_MUTEX
     #include "../MutexContained.h"
-    #define ENGINE_PRIORITY_QUEUE_CLASS_NAME PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true>
+    #define ENGINE_PRIORITY_QUEUE_CLASS_NAME PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder>
     #define ENGINE_PRIORITY_QUEUE_DERIVATION : public MutexContained<true, false>
 #else
-    #define ENGINE_PRIORITY_QUEUE_CLASS_NAME PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false>
+    #define ENGINE_PRIORITY_QUEUE_CLASS_NAME PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder>
     #define ENGINE_PRIORITY_QUEUE_DERIVATION
 #endif
 
+#ifndef ENGINE_PRIORITY_QUEUE_USE_MUTEX
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// @brief An item of a PriorityQueue, with the order it was pushed in if the queue is stable.
+            template <typename ItemsType, typename PriorityType, bool StableOrder>
+            struct PriorityQueueEntry
+            {
+                ItemsType Item;
+                PriorityType Priority;
+                long long Sequence;
+            };
+
+            template <typename ItemsType, typename PriorityType>
+            struct PriorityQueueEntry<ItemsType, PriorityType, false>
+            {
+                ItemsType Item;
+                PriorityType Priority;
+            };
+        }
+    }
+}
+#endif
+
 namespace Engine
 {
     namespace Utilities
     {
         namespace Collections
         {
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            /// The items are kept in an implicit heap where each node has Arity children,
+            /// so pushing and popping move O(log N) items.
+            /// A wider heap is shallower, pushing is faster and popping compares more children per level.
+            ///
+            /// With StableOrder, the items of equal priority pop in the order they were pushed,
+            /// at the cost of a push counter per item. Otherwise their order is unspecified.
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             class ENGINE_PRIORITY_QUEUE_CLASS_NAME final ENGINE_PRIORITY_QUEUE_DERIVATION
             {
 #ifdef ENGINE_PRIORITY_QUEUE_USE_MUTEX
-                friend PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false>;
+                friend PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder>;
 #else
-                friend PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true>;
+                friend PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder>;
 #endif
+                static_assert(Arity >= 2, "A heap node must have at least 2 children.");
             public:
                 PriorityQueue(int InitialCapacity = 0);
                 ~PriorityQueue();
 
-                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true>&) noexcept;
-                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true>&&) noexcept;
-                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false>&) noexcept;
-                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false>&&) noexcept;
+                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder>&) noexcept;
+                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder>&&) noexcept;
+                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder>&) noexcept;
+                PriorityQueue(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder>&&) noexcept;
 
-                PriorityQueue& operator=(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true>) noexcept;
-                PriorityQueue& operator=(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false>) noexcept;
+                PriorityQueue& operator=(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder>) noexcept;
+                PriorityQueue& operator=(PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder>) noexcept;
 
                 /// @brief Inserts an item to the back of its priority group.
                 void Push(ItemsType Item, PriorityType Priority);
+                /// @brief Inserts items to the back of their priority groups, in order.
+                ///
+                /// Rebuilds the heap in O(N) rather than pushing one by one
+                /// if there are at least as many new items as queued ones.
+                /// @param Items Count items.
+                /// @param Priorities The priorities of the items.
+                void Push(const ItemsType * Items, const PriorityType * Priorities, int Count);
                 /// @brief Pops the first item.
                 /// @return The popped item.
                 ItemsType Pop();
@@ -56,7 +98,16 @@ namespace Engine
                 /// @param PriorityOut The popped item priority, if any.
                 /// @return Whether there was an item to pop.
                 bool Pop(ItemsType& ItemOut, PriorityType& PriorityOut);
+                /// @brief Inserts an item to the back of its priority group, unless the lock is not acquired before the Deadline.
+                /// @return Whether the item was pushed.
+                bool TryPushUntil(ItemsType Item, PriorityType Priority, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Pops the first item, unless the lock is not acquired before the Deadline.
+                /// @param ItemOut The popped item, if any.
+                /// @return Whether the lock was acquired in time and there was an item to pop.
+                bool TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline);
                 /// @brief Clears the priority queue.
+                ///
+                /// Shrinks to the MinimumCapacity of the growth policy, unless its ShrinkThreshold is 0.
                 void Clear();
 
                 /// @brief Expands the allocated memory.
@@ -75,12 +126,23 @@ namespace Engine
                 ///
                 /// Set the value using SetAutoShrink(bool).
                 bool IsAutoShrink();
+                /// @brief Sets how the allocated memory grows and shrinks automatically.
+                void SetGrowthPolicy(GrowthPolicy Policy);
+                /// @brief Gets how the allocated memory grows and shrinks automatically.
+                GrowthPolicy GetGrowthPolicy();
+                /// @brief Shrinks the allocated memory as far as the growth policy allows.
+                ///
+                /// Also applies when the policy defers shrinking or the AutoShrink is off,
+                /// for idle times like the end of a frame.
+                void Trim();
 
                 /// @brief Gets the first item, without popping it.
                 ItemsType GetFirstItem();
                 /// @brief Gets the first item priority, without popping the item.
                 PriorityType GetFirstPriority();
                 /// @brief Gets the 0-based depth of the first matching item.
+                ///
+                /// Counts the items that pop before each matching item, so it takes O(N) per matching item.
                 /// @param Item The search subject.
                 /// @param FromDepth The start depth for searching.
                 /// @return The 0-based depth of the matching item if found,
@@ -96,11 +158,32 @@ namespace Engine
                 bool IsEmpty();
                 /// @brief Gets the current capacity of the allocated memory.
                 int GetCapacity();
+                /// @brief Gets the number of times the allocated memory was reallocated.
+                long long GetReallocationsCount();
             private:
-                ResizableArray<ItemsType, false> * ItemsRef;
-                ResizableArray<PriorityType, false> * PrioritiesRef;
+                // Shared by the two variants, so they can copy their arrays to each other
+                typedef PriorityQueueEntry<ItemsType, PriorityType, StableOrder> Entry;
+
+                /// @brief The heap, the children of Entries[i] are Entries[i * Arity + 1] to Entries[i * Arity + Arity].
+                ResizableArray<Entry, false> * EntriesRef;
                 int Count;
                 bool AutoShrink;
+                GrowthPolicy Policy;
+                long long ReallocationsCount;
+                /// @brief The sequence of the next pushed item, if StableOrder.
+                long long NextSequence;
+
+                /// @brief Checks whether A pops before B.
+                static inline bool Precedes(const Entry& A, const Entry& B);
+                /// @brief Moves the entries above Index down until Value fits, and puts it there.
+                void SiftUp(int Index, Entry Value);
+                /// @brief Moves the entries below Index up until Value fits, and puts it there.
+                void SiftDown(int Index, Entry Value);
+                /// @brief Makes room for Space more entries.
+                void Reserve(int Space);
+                void Resize(int NewCapacity);
+                /// @brief Shrinks the allocated memory if the count dropped below the threshold of the growth policy.
+                void ShrinkByPolicy();
             };
         }
     }
@@ -111,9 +194,14 @@ namespace Engine
 #ifdef ENGINE_PRIORITY_QUEUE_USE_MUTEX
     #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock();
     #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock();
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) \
+        RecursiveMutex<true, false>::LockGuard guard; \
+        if (!Mutex.TryGetLockUntil(guard, Deadline)) \
+            return false;
 #else
     #define ENGINE_COLLECTION_WRITE_ACCESS ;
     #define ENGINE_COLLECTION_READ_ACCESS ;
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) (void)(Deadline);
 #endif
 
 namespace Engine
@@ -122,146 +210,151 @@ namespace Engine
     {
         namespace Collections
         {
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME::PriorityQueue(int InitialCapacity)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                ItemsRef = new ResizableArray<ItemsType, false>(InitialCapacity);
-                PrioritiesRef = new ResizableArray<PriorityType, false>(InitialCapacity);
+                EntriesRef = new ResizableArray<Entry, false>(InitialCapacity);
                 Count = 0;
                 AutoShrink = true;
+                ReallocationsCount = 0;
+                NextSequence = 0;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME::~PriorityQueue()
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                delete ItemsRef;
-                delete PrioritiesRef;
+                delete EntriesRef;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME::PriorityQueue(
-                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true>& Op
+                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder>& Op
                 ) noexcept : PriorityQueue()
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 auto OpGuard = Op.Mutex.GetSharedLock();
 
                 Count = Op.Count;
-                *ItemsRef = *(Op.ItemsRef);
-                *PrioritiesRef = *(Op.PrioritiesRef);
+                NextSequence = Op.NextSequence;
+                *EntriesRef = *(Op.EntriesRef);
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME::PriorityQueue(
-                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true>&& Op
+                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder>&& Op
                 ) noexcept : PriorityQueue()
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 auto OpGuard = Op.Mutex.GetSharedLock();
 
                 std::swap(Count, Op.Count);
-                std::swap(ItemsRef, Op.ItemsRef);
-                std::swap(PrioritiesRef, Op.PrioritiesRef);
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(NextSequence, Op.NextSequence);
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME::PriorityQueue(
-                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false>& Op
+                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder>& Op
                 ) noexcept : PriorityQueue()
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 Count = Op.Count;
-                *ItemsRef = *(Op.ItemsRef);
-                *PrioritiesRef = *(Op.PrioritiesRef);
+                NextSequence = Op.NextSequence;
+                *EntriesRef = *(Op.EntriesRef);
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME::PriorityQueue(
-                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false>&& Op
+                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder>&& Op
                 ) noexcept : PriorityQueue()
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 std::swap(Count, Op.Count);
-                std::swap(ItemsRef, Op.ItemsRef);
-                std::swap(PrioritiesRef, Op.PrioritiesRef);
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(NextSequence, Op.NextSequence);
             }
-            
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME& ENGINE_PRIORITY_QUEUE_CLASS_NAME::operator=(
-                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true> Op
+                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, true, Arity, StableOrder> Op
                 ) noexcept
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 auto OpGuard = Op.Mutex.GetSharedLock();
 
                 std::swap(Count, Op.Count);
-                std::swap(ItemsRef, Op.ItemsRef);
-                std::swap(PrioritiesRef, Op.PrioritiesRef);
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(NextSequence, Op.NextSequence);
 
                 return *this;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ENGINE_PRIORITY_QUEUE_CLASS_NAME& ENGINE_PRIORITY_QUEUE_CLASS_NAME::operator=(
-                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false> Op
+                PriorityQueue<ItemsType, PriorityType, LessPriorityFirst, false, Arity, StableOrder> Op
                 ) noexcept
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 std::swap(Count, Op.Count);
-                std::swap(ItemsRef, Op.ItemsRef);
-                std::swap(PrioritiesRef, Op.PrioritiesRef);
+                std::swap(EntriesRef, Op.EntriesRef);
+                std::swap(NextSequence, Op.NextSequence);
 
                 return *this;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Push(ItemsType Item, PriorityType Priority)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                while (Count >= ItemsRef->GetLength())
-                    if (ItemsRef->GetLength() > 0)
-                        ItemsRef->Resize(ItemsRef->GetLength() * 2);
-                    else
-                        ItemsRef->Resize(1);
+                Reserve(1);
+                Entry entry;
+                entry.Item = Item;
+                entry.Priority = Priority;
+                if constexpr (StableOrder)
+                    entry.Sequence = NextSequence++;
+                Count++;
+                SiftUp(Count - 1, entry);
+            }
 
-                while (Count >= PrioritiesRef->GetLength())
-                    if (PrioritiesRef->GetLength() > 0)
-                        PrioritiesRef->Resize(PrioritiesRef->GetLength() * 2);
-                    else
-                        PrioritiesRef->Resize(1);
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Push(const ItemsType * Items, const PriorityType * Priorities, int Count)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Count < 0)
+                    throw std::domain_error("Count is less than zero.");
 
-                int s = 0;
-                int e = Count;
-                while (s < e)
+                Reserve(Count);
+                bool rebuild = Count >= this->Count;
+                for (int i = 0; i < Count; i++)
                 {
-                    int c = (s + e) / 2;
-                    if (LessPriorityFirst)
-                        if (Priority < PrioritiesRef->GetItem(c)) s = c + 1;
-                        else e = c;
+                    Entry entry;
+                    entry.Item = Items[i];
+                    entry.Priority = Priorities[i];
+                    if constexpr (StableOrder)
+                        entry.Sequence = NextSequence++;
+                    this->Count++;
+                    if (rebuild)
+                        EntriesRef->GetItemRef(this->Count - 1) = std::move(entry);
                     else
-                        if (PrioritiesRef->GetItem(c) < Priority) s = c + 1;
-                        else e = c;
+                        SiftUp(this->Count - 1, std::move(entry));
                 }
 
-                for (int i = Count; i > s; i--)
-                {
-                    ItemsRef->SetItem(i, ItemsRef->GetItem(i - 1));
-                    PrioritiesRef->SetItem(i, PrioritiesRef->GetItem(i - 1));
-                }
-                ItemsRef->SetItem(s, Item);
-                PrioritiesRef->SetItem(s, Priority);
-                Count++;
+                // Floyd's heap construction, from the last parent up
+                if (rebuild && this->Count > 1)
+                    for (int i = (this->Count - 2) / Arity; i >= 0; i--)
+                        SiftDown(i, std::move(EntriesRef->GetItemRef(i)));
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ItemsType ENGINE_PRIORITY_QUEUE_CLASS_NAME::Pop()
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
@@ -269,16 +362,18 @@ namespace Engine
                 if (Count <= 0)
                     throw std::logic_error("Cannot pop from an empty priority queue.");
 
+                ItemsType Item = std::move(EntriesRef->GetItemRef(0).Item);
                 Count--;
-                ItemsType Item = ItemsRef->GetItem(Count);
+                if (Count > 0)
+                    SiftDown(0, std::move(EntriesRef->GetItemRef(Count)));
 
-                if (AutoShrink && Count < ItemsRef->GetLength() / 2)
-                    ItemsRef->Resize(ItemsRef->GetLength() / 2);
+                if (AutoShrink && !Policy.DeferShrink)
+                    ShrinkByPolicy();
 
                 return Item;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::Pop(ItemsType& ItemOut)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
@@ -286,16 +381,18 @@ namespace Engine
                 if (Count <= 0)
                     return false;
 
+                ItemOut = std::move(EntriesRef->GetItemRef(0).Item);
                 Count--;
-                ItemOut = ItemsRef->GetItem(Count);
+                if (Count > 0)
+                    SiftDown(0, std::move(EntriesRef->GetItemRef(Count)));
 
-                if (AutoShrink && Count < ItemsRef->GetLength() / 2)
-                    ItemsRef->Resize(ItemsRef->GetLength() / 2);
+                if (AutoShrink && !Policy.DeferShrink)
+                    ShrinkByPolicy();
 
                 return true;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::Pop(ItemsType& ItemOut, PriorityType& PriorityOut)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
@@ -303,27 +400,48 @@ namespace Engine
                 if (Count <= 0)
                     return false;
 
+                Entry& first = EntriesRef->GetItemRef(0);
+                ItemOut = std::move(first.Item);
+                PriorityOut = std::move(first.Priority);
                 Count--;
-                ItemOut = ItemsRef->GetItem(Count);
-                PriorityOut = PrioritiesRef->GetItem(Count);
+                if (Count > 0)
+                    SiftDown(0, std::move(EntriesRef->GetItemRef(Count)));
+
+                if (AutoShrink && !Policy.DeferShrink)
+                    ShrinkByPolicy();
+
+                return true;
+            }
 
-                if (AutoShrink && Count < ItemsRef->GetLength() / 2)
-                    ItemsRef->Resize(ItemsRef->GetLength() / 2);
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::TryPushUntil(ItemsType Item, PriorityType Priority, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
 
+                Push(Item, Priority);
                 return true;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                return Pop(ItemOut);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Clear()
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 Count = 0;
-                if (AutoShrink)
-                    ItemsRef->Resize(0);
+                NextSequence = 0;
+                if (AutoShrink && !Policy.DeferShrink && Policy.ShrinkThreshold > 0 && EntriesRef->GetLength() > Policy.MinimumCapacity)
+                    Resize(Policy.MinimumCapacity);
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Expand(int Space)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
@@ -331,10 +449,10 @@ namespace Engine
                 if (Space < 0)
                     throw std::domain_error("Space is less than zero.");
 
-                ItemsRef->Resize(ItemsRef->GetLength() + Space);
+                Resize(EntriesRef->GetLength() + Space);
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Shrink(int AdditionalSpace)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
@@ -342,10 +460,10 @@ namespace Engine
                 if (AdditionalSpace < 0)
                     throw std::domain_error("AdditionalSpace is less than zero.");
 
-                ItemsRef->Resize(Count + AdditionalSpace);
+                Resize(Count + AdditionalSpace);
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             void ENGINE_PRIORITY_QUEUE_CLASS_NAME::SetAutoShrink(bool Value)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
@@ -353,7 +471,7 @@ namespace Engine
                 AutoShrink = Value;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::IsAutoShrink()
             {
                 ENGINE_COLLECTION_READ_ACCESS;
@@ -361,7 +479,32 @@ namespace Engine
                 return AutoShrink;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::SetGrowthPolicy(GrowthPolicy Policy)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Policy.Validate();
+                this->Policy = Policy;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            GrowthPolicy ENGINE_PRIORITY_QUEUE_CLASS_NAME::GetGrowthPolicy()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Policy;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Trim()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                ShrinkByPolicy();
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             ItemsType ENGINE_PRIORITY_QUEUE_CLASS_NAME::GetFirstItem()
             {
                 ENGINE_COLLECTION_READ_ACCESS;
@@ -369,10 +512,10 @@ namespace Engine
                 if (Count <= 0)
                     throw std::logic_error("Cannot get the first item of an empty priority queue.");
 
-                return ItemsRef->GetItem(Count - 1);
+                return EntriesRef->GetItemRef(0).Item;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             PriorityType ENGINE_PRIORITY_QUEUE_CLASS_NAME::GetFirstPriority()
             {
                 ENGINE_COLLECTION_READ_ACCESS;
@@ -380,34 +523,49 @@ namespace Engine
                 if (Count <= 0)
                     throw std::logic_error("Cannot get the first priority of an empty priority queue.");
 
-                return PrioritiesRef->GetItem(Count - 1);
+                return EntriesRef->GetItemRef(0).Priority;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             int ENGINE_PRIORITY_QUEUE_CLASS_NAME::GetDepthOf(ItemsType Item, int FromDepth)
             {
                 ENGINE_COLLECTION_READ_ACCESS;
 
-                for (int i = Count - 1 - FromDepth; i >= 0; i--)
-                    if (ItemsRef->GetItem(i) == Item)
-                        return (Count - 1) - i;
+                int depth = -1;
+                for (int i = 0; i < Count; i++)
+                {
+                    Entry& entry = EntriesRef->GetItemRef(i);
+                    if (!(entry.Item == Item))
+                        continue;
+
+                    // The unordered equal priorities are ordered by index
+                    int entry_depth = 0;
+                    for (int j = 0; j < Count; j++)
+                    {
+                        Entry& other = EntriesRef->GetItemRef(j);
+                        if (Precedes(other, entry) || (j < i && !Precedes(entry, other)))
+                            entry_depth++;
+                    }
+                    if (entry_depth >= FromDepth && (depth == -1 || entry_depth < depth))
+                        depth = entry_depth;
+                }
 
-                return -1;
+                return depth;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::Contains(ItemsType Item)
             {
                 ENGINE_COLLECTION_READ_ACCESS;
 
-                for (int i = Count - 1; i >= 0; i--)
-                    if (ItemsRef->GetItem(i) == Item)
+                for (int i = 0; i < Count; i++)
+                    if (EntriesRef->GetItemRef(i).Item == Item)
                         return true;
 
                 return false;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             int ENGINE_PRIORITY_QUEUE_CLASS_NAME::GetCount()
             {
                 ENGINE_COLLECTION_READ_ACCESS;
@@ -415,7 +573,7 @@ namespace Engine
                 return Count;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::IsEmpty()
             {
                 ENGINE_COLLECTION_READ_ACCESS;
@@ -423,12 +581,94 @@ namespace Engine
                 return Count == 0;
             }
 
-            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst>
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
             int ENGINE_PRIORITY_QUEUE_CLASS_NAME::GetCapacity()
             {
                 ENGINE_COLLECTION_READ_ACCESS;
 
-                return ItemsRef->GetLength();
+                return EntriesRef->GetLength();
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            long long ENGINE_PRIORITY_QUEUE_CLASS_NAME::GetReallocationsCount()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return ReallocationsCount;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            bool ENGINE_PRIORITY_QUEUE_CLASS_NAME::Precedes(const Entry& A, const Entry& B)
+            {
+                if (LessPriorityFirst ? A.Priority < B.Priority : B.Priority < A.Priority)
+                    return true;
+                if constexpr (StableOrder)
+                    if (!(LessPriorityFirst ? B.Priority < A.Priority : A.Priority < B.Priority))
+                        return A.Sequence < B.Sequence;
+                return false;
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::SiftUp(int Index, Entry Value)
+            {
+                while (Index > 0)
+                {
+                    int parent = (Index - 1) / Arity;
+                    Entry& parent_entry = EntriesRef->GetItemRef(parent);
+                    if (!Precedes(Value, parent_entry))
+                        break;
+                    EntriesRef->GetItemRef(Index) = std::move(parent_entry);
+                    Index = parent;
+                }
+                EntriesRef->GetItemRef(Index) = std::move(Value);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::SiftDown(int Index, Entry Value)
+            {
+                while (true)
+                {
+                    int first_child = Index * Arity + 1;
+                    if (first_child >= Count)
+                        break;
+
+                    int best = first_child;
+                    int last_child = std::min(first_child + Arity, Count);
+                    for (int i = first_child + 1; i < last_child; i++)
+                        if (Precedes(EntriesRef->GetItemRef(i), EntriesRef->GetItemRef(best)))
+                            best = i;
+
+                    Entry& best_entry = EntriesRef->GetItemRef(best);
+                    if (!Precedes(best_entry, Value))
+                        break;
+                    EntriesRef->GetItemRef(Index) = std::move(best_entry);
+                    Index = best;
+                }
+                EntriesRef->GetItemRef(Index) = std::move(Value);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Reserve(int Space)
+            {
+                if (Count + Space > EntriesRef->GetLength())
+                    Resize(Policy.GetGrownCapacity(EntriesRef->GetLength(), Count + Space));
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::Resize(int NewCapacity)
+            {
+                if (NewCapacity == EntriesRef->GetLength())
+                    return;
+                ReallocationsCount++;
+                EntriesRef->Resize(NewCapacity);
+            }
+
+            template <typename ItemsType, typename PriorityType, bool LessPriorityFirst, int Arity, bool StableOrder>
+            void ENGINE_PRIORITY_QUEUE_CLASS_NAME::ShrinkByPolicy()
+            {
+                int capacity = Policy.GetShrunkCapacity(Count, EntriesRef->GetLength());
+                if (capacity < EntriesRef->GetLength())
+                    Resize(capacity);
             }
         }
     }
@@ -436,6 +676,7 @@ namespace Engine
 
 #undef ENGINE_COLLECTION_WRITE_ACCESS
 #undef ENGINE_COLLECTION_READ_ACCESS
+#undef ENGINE_COLLECTION_TIMED_WRITE_ACCESS
 
 #undef ENGINE_PRIORITY_QUEUE_CLASS_NAME
 #undef ENGINE_PRIORITY_QUEUE_DERIVATION
@@ -6,6 +6,7 @@
 
 #include "../../Engine.dec.h"
 #include "ResizableArray.h"
+#include "GrowthPolicy.h"
 
 #ifdef ENGINE_QUEUE_USE_MUTEX
     #include "../MutexContained.h"
@@ -51,7 +52,16 @@ namespace Engine
                 /// @param ItemOut The popped item, if any.
                 /// @return Whether there was an item to pop.
                 bool Pop(ItemsType& ItemOut);
+                /// @brief Pushes an item to the back, unless the lock is not acquired before the Deadline.
+                /// @return Whether the item was pushed.
+                bool TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Pops the first/front item, unless the lock is not acquired before the Deadline.
+                /// @param ItemOut The popped item, if any.
+                /// @return Whether the lock was acquired in time and there was an item to pop.
+                bool TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline);
                 /// @brief Clears the queue.
+                ///
+                /// Shrinks to the MinimumCapacity of the growth policy, unless its ShrinkThreshold is 0.
                 void Clear();
 
                 /// @brief Expands the allocated memory.
@@ -70,6 +80,15 @@ namespace Engine
                 ///
                 /// Set the value using SetAutoShrink(bool).
                 bool IsAutoShrink();
+                /// @brief Sets how the allocated memory grows and shrinks automatically.
+                void SetGrowthPolicy(GrowthPolicy Policy);
+                /// @brief Gets how the allocated memory grows and shrinks automatically.
+                GrowthPolicy GetGrowthPolicy();
+                /// @brief Shrinks the allocated memory as far as the growth policy allows.
+                ///
+                /// Also applies when the policy defers shrinking or the AutoShrink is off,
+                /// for idle times like the end of a frame.
+                void Trim();
 
                 /// @brief Gets the first item, without popping it.
                 ItemsType GetFirst();
@@ -89,13 +108,19 @@ namespace Engine
                 bool IsEmpty();
                 /// @brief Gets the current capacity of the allocated memory.
                 int GetCapacity();
+                /// @brief Gets the number of times the allocated memory was reallocated.
+                long long GetReallocationsCount();
             private:
                 ResizableArray<ItemsType, false> * ItemsRef;
                 int First;
                 int Count;
                 bool AutoShrink;
+                GrowthPolicy Policy;
+                long long ReallocationsCount;
 
                 void Resize(int NewCapacity);
+                /// @brief Shrinks the allocated memory if the count dropped below the threshold of the growth policy.
+                void ShrinkByPolicy();
             };
         }
     }
@@ -106,9 +131,14 @@ namespace Engine
 #ifdef ENGINE_QUEUE_USE_MUTEX
     #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock();
     #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock();
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) \
+        RecursiveMutex<true, false>::LockGuard guard; \
+        if (!Mutex.TryGetLockUntil(guard, Deadline)) \
+            return false;
 #else
     #define ENGINE_COLLECTION_WRITE_ACCESS ;
     #define ENGINE_COLLECTION_READ_ACCESS ;
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) (void)(Deadline);
 #endif
 
 namespace Engine
@@ -126,6 +156,7 @@ namespace Engine
                 First = 0;
                 Count = 0;
                 AutoShrink = true;
+                ReallocationsCount = 0;
             }
 
             template <typename ItemsType>
@@ -208,13 +239,10 @@ namespace Engine
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                while (Count >= ItemsRef->GetLength())
-                    if (ItemsRef->GetLength() > 0)
-                        Resize(ItemsRef->GetLength() * 2);
-                    else
-                        Resize(1);
+                if (Count >= ItemsRef->GetLength())
+                    Resize(Policy.GetGrownCapacity(ItemsRef->GetLength(), Count + 1));
 
-                ItemsRef->SetItem((First + Count) % ItemsRef->GetLength(), Item);
+                ItemsRef->SetItem((First + Count) % ItemsRef->GetLength(), std::move(Item));
                 Count++;
             }
 
@@ -226,12 +254,12 @@ namespace Engine
                 if (Count <= 0)
                     throw std::logic_error("Cannot pop from an empty queue.");
 
-                ItemsType Item = ItemsRef->GetItem(First);
+                ItemsType Item = std::move(ItemsRef->GetItemRef(First));
                 First = (First + 1) % ItemsRef->GetLength();
                 Count--;
 
-                if (AutoShrink && Count < ItemsRef->GetLength() / 2)
-                    Resize(ItemsRef->GetLength() / 2);
+                if (AutoShrink && !Policy.DeferShrink)
+                    ShrinkByPolicy();
 
                 return Item;
             }
@@ -244,16 +272,33 @@ namespace Engine
                 if (Count <= 0)
                     return false;
 
-                ItemOut = ItemsRef->GetItem(First);
+                ItemOut = std::move(ItemsRef->GetItemRef(First));
                 First = (First + 1) % ItemsRef->GetLength();
                 Count--;
 
-                if (AutoShrink && Count < ItemsRef->GetLength() / 2)
-                    Resize(ItemsRef->GetLength() / 2);
+                if (AutoShrink && !Policy.DeferShrink)
+                    ShrinkByPolicy();
+
+                return true;
+            }
+
+            template <typename ItemsType>
+            bool ENGINE_QUEUE_CLASS_NAME::TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
 
+                Push(Item);
                 return true;
             }
 
+            template <typename ItemsType>
+            bool ENGINE_QUEUE_CLASS_NAME::TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                return Pop(ItemOut);
+            }
+
             template <typename ItemsType>
             void ENGINE_QUEUE_CLASS_NAME::Clear()
             {
@@ -261,8 +306,8 @@ namespace Engine
 
                 First = 0;
                 Count = 0;
-                if (AutoShrink)
-                    ItemsRef->Resize(0);
+                if (AutoShrink && !Policy.DeferShrink && Policy.ShrinkThreshold > 0 && ItemsRef->GetLength() > Policy.MinimumCapacity)
+                    Resize(Policy.MinimumCapacity);
             }
 
             template <typename ItemsType>
@@ -303,6 +348,31 @@ namespace Engine
                 return AutoShrink;
             }
 
+            template <typename ItemsType>
+            void ENGINE_QUEUE_CLASS_NAME::SetGrowthPolicy(GrowthPolicy Policy)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Policy.Validate();
+                this->Policy = Policy;
+            }
+
+            template <typename ItemsType>
+            GrowthPolicy ENGINE_QUEUE_CLASS_NAME::GetGrowthPolicy()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Policy;
+            }
+
+            template <typename ItemsType>
+            void ENGINE_QUEUE_CLASS_NAME::Trim()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                ShrinkByPolicy();
+            }
+
             template <typename ItemsType>
             ItemsType ENGINE_QUEUE_CLASS_NAME::GetFirst()
             {
@@ -328,16 +398,16 @@ namespace Engine
                 if (From <= Last)
                 {
                     for (int i = From; i <= Last; i++)
-                        if (ItemsRef->GetItem(i) == Item)
+                        if (ItemsRef->GetItemRef(i) == Item)
                             return i - First;
                 }
                 else
                 {
                     for (int i = From; i < ItemsRef->GetLength(); i++)
-                        if (ItemsRef->GetItem(i) == Item)
+                        if (ItemsRef->GetItemRef(i) == Item)
                             return i - First;
                     for (int i = 0; i <= Last; i++)
-                        if (ItemsRef->GetItem(i) == Item)
+                        if (ItemsRef->GetItemRef(i) == Item)
                             return (ItemsRef->GetLength() - First) + i;
                 }
 
@@ -357,16 +427,16 @@ namespace Engine
                 if (First <= Last)
                 {
                     for (int i = First; i <= Last; i++)
-                        if (ItemsRef->GetItem(i) == Item)
+                        if (ItemsRef->GetItemRef(i) == Item)
                             return true;
                 }
                 else
                 {
                     for (int i = First; i < ItemsRef->GetLength(); i++)
-                        if (ItemsRef->GetItem(i) == Item)
+                        if (ItemsRef->GetItemRef(i) == Item)
                             return true;
                     for (int i = 0; i <= Last; i++)
-                        if (ItemsRef->GetItem(i) == Item)
+                        if (ItemsRef->GetItemRef(i) == Item)
                             return true;
                 }
 
@@ -397,30 +467,54 @@ namespace Engine
                 return ItemsRef->GetLength();
             }
 
+            template <typename ItemsType>
+            long long ENGINE_QUEUE_CLASS_NAME::GetReallocationsCount()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return ReallocationsCount;
+            }
+
             template <typename ItemsType>
             void ENGINE_QUEUE_CLASS_NAME::Resize(int NewCapacity)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
+                if (NewCapacity == ItemsRef->GetLength())
+                    return;
+                ReallocationsCount++;
+
                 if (First == 0 || Count == 0)
+                {
                     ItemsRef->Resize(NewCapacity);
+                    First = 0;
+                }
                 else
                 {
                     ResizableArray<ItemsType, false> * PrevItems = ItemsRef;
                     int prev_capacity = PrevItems->GetLength();
                     ItemsRef = new ResizableArray<ItemsType, false>(NewCapacity);
                     for (int i = 0; i < Count; i++)
-                        ItemsRef->SetItem(i, PrevItems->GetItem((First + i) % prev_capacity));
+                        ItemsRef->GetItemRef(i) = std::move(PrevItems->GetItemRef((First + i) % prev_capacity));
                     First = 0;
                     delete PrevItems;
                 }
             }
+
+            template <typename ItemsType>
+            void ENGINE_QUEUE_CLASS_NAME::ShrinkByPolicy()
+            {
+                int capacity = Policy.GetShrunkCapacity(Count, ItemsRef->GetLength());
+                if (capacity < ItemsRef->GetLength())
+                    Resize(capacity);
+            }
         }
     }
 }
 
 #undef ENGINE_COLLECTION_WRITE_ACCESS
 #undef ENGINE_COLLECTION_READ_ACCESS
+#undef ENGINE_COLLECTION_TIMED_WRITE_ACCESS
 
 #undef ENGINE_QUEUE_CLASS_NAME
 #undef ENGINE_QUEUE_DERIVATION
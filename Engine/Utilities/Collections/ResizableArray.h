@@ -27,12 +27,14 @@ namespace Engine
                 friend ResizableArray<ItemsType, true>;
 #endif
             public:
+                /// @param Length The number of value-initialized items,
+                ///        more than 0 throws std::logic_error if the items are not default-constructible.
                 ResizableArray(int Length = 0);
                 ~ResizableArray();
 
-                ResizableArray(ResizableArray<ItemsType, true>&) noexcept;
+                ResizableArray(ResizableArray<ItemsType, true>&);
                 ResizableArray(ResizableArray<ItemsType, true>&&) noexcept;
-                ResizableArray(ResizableArray<ItemsType, false>&) noexcept;
+                ResizableArray(ResizableArray<ItemsType, false>&);
                 ResizableArray(ResizableArray<ItemsType, false>&&) noexcept;
 
                 ResizableArray& operator=(ResizableArray<ItemsType, true>) noexcept;
@@ -40,21 +42,61 @@ namespace Engine
 
                 /// @brief Gets an item at a specified index.
                 ItemsType GetItem(int Index);
+#ifndef ENGINE_RESIZABLE_ARRAY_USE_MUTEX
+                /// @brief Gets a reference to an item at a specified index, to access it without a copy.
+                ///
+                /// Is invalidated by Resize. The array with a mutex has no reference accessor, as the reference would outlive the lock.
+                ItemsType& GetItemRef(int Index);
+#endif
                 /// @brief Sets an item at a specified index.
                 void SetItem(int Index, ItemsType Value);
+                /// @brief Replaces an item at a specified index by one constructed in place from the Arguments.
+                template <typename... ArgumentsTypes>
+                void Emplace(int Index, ArgumentsTypes&&... Arguments);
+                /// @brief Constructs an item in place after the last one, growing the storage if it is full.
+                ///
+                /// Unlike Resize, does not need the items to be default-constructible.
+                template <typename... ArgumentsTypes>
+                void Append(ArgumentsTypes&&... Arguments);
+                /// @brief Makes room for at least Capacity items without constructing them, so the next appends do not reallocate.
+                void Reserve(int Capacity);
                 /// @brief Gets the current length of the array.
                 int GetLength();
+                /// @brief Gets the number of items the storage can hold without reallocating.
+                int GetCapacity();
                 /// @brief Sets the new length of the array.
                 ///
-                /// Some array items will be removed if NewLength < current length.
-                /// This function reallocates the whole array over.
+                /// Some array items will be removed if NewLength < current length,
+                /// and the added items are value-initialized, so growing throws std::logic_error
+                /// if the items are not default-constructible.
+                /// This function reallocates the whole array over, moving the items if their move cannot throw,
+                /// else copying them, so the array is left unchanged if an exception is thrown,
+                /// unless the items can only be moved and their move throws.
                 void Resize(int NewLength);
             private:
+                /// @brief Whether the items can be moved by copying their bytes, with realloc.
+                static constexpr bool IsTriviallyRelocatable =
+                    std::is_trivially_copyable<ItemsType>::value && alignof(ItemsType) <= alignof(std::max_align_t);
+
 #ifdef ENGINE_RESIZABLE_ARRAY_USE_MUTEX
                 std::shared_mutex Mutex;
 #endif
+                /// @brief Raw storage, its items are constructed in place.
                 ItemsType * Array;
                 int Length;
+                int Capacity;
+
+                /// @brief Allocates the storage of Length items, without constructing them.
+                static ItemsType * Allocate(int Length);
+                static void Deallocate(ItemsType * Array);
+                static void Destruct(ItemsType * Array, int Length);
+                /// @brief Constructs the first Count items of the raw To storage from the items of From,
+                ///        moving them if their move cannot throw, else copying them.
+                ///
+                /// Leaves no item of To constructed if an exception is thrown.
+                static void Relocate(ItemsType * From, int Count, ItemsType * To);
+                /// @brief Moves the items to a storage of NewCapacity items, NewCapacity >= Length.
+                void Reallocate(int NewCapacity);
             };
         }
     }
@@ -81,17 +123,28 @@ namespace Engine
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                if (Length > 0)
-                {
-                    Array = new ItemsType[Length];
-                    this->Length = Length;
-                }
-                else if (Length == 0)
+                if (Length < 0)
+                    throw std::domain_error("Length is less than zero.");
+
+                if constexpr (!std::is_default_constructible<ItemsType>::value)
+                    if (Length > 0)
+                        throw std::logic_error("The items are not default-constructible.");
+
+                Array = Allocate(Length);
+                if constexpr (std::is_default_constructible<ItemsType>::value)
                 {
-                    Array = nullptr;
-                    this->Length = 0;
+                    try
+                    {
+                        std::uninitialized_value_construct(Array, Array + Length);
+                    }
+                    catch (...)
+                    {
+                        Deallocate(Array);
+                        throw;
+                    }
                 }
-                else throw std::domain_error("Length is less than zero.");
+                this->Length = Length;
+                Capacity = Length;
             }
 
             template <typename ItemsType>
@@ -99,22 +152,27 @@ namespace Engine
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                if (Array != nullptr)
-                    delete[] Array;
+                Destruct(Array, Length);
+                Deallocate(Array);
             }
 
             template <typename ItemsType>
-            ENGINE_RESIZABLE_ARRAY_CLASS_NAME::ResizableArray(ResizableArray<ItemsType, true>& Op) noexcept
+            ENGINE_RESIZABLE_ARRAY_CLASS_NAME::ResizableArray(ResizableArray<ItemsType, true>& Op)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 std::shared_lock<std::shared_mutex> op_guard(Op.Mutex);
-                Length = Op.Length;
-                if (Op.Length == 0) Array = nullptr;
-                else
+                Array = Allocate(Op.Length);
+                try
                 {
-                    Array = new ItemsType[Op.Length];
-                    std::copy(Op.Array, Op.Array + Op.Length, Array);
+                    std::uninitialized_copy(Op.Array, Op.Array + Op.Length, Array);
                 }
+                catch (...)
+                {
+                    Deallocate(Array);
+                    throw;
+                }
+                Length = Op.Length;
+                Capacity = Op.Length;
             }
 
             template <typename ItemsType>
@@ -123,20 +181,26 @@ namespace Engine
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 std::shared_lock<std::shared_mutex> op_guard(Op.Mutex);
                 std::swap(Length, Op.Length);
+                std::swap(Capacity, Op.Capacity);
                 std::swap(Array, Op.Array);
             }
 
             template <typename ItemsType>
-            ENGINE_RESIZABLE_ARRAY_CLASS_NAME::ResizableArray(ResizableArray<ItemsType, false>& Op) noexcept
+            ENGINE_RESIZABLE_ARRAY_CLASS_NAME::ResizableArray(ResizableArray<ItemsType, false>& Op)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
-                Length = Op.Length;
-                if (Op.Length == 0) Array = nullptr;
-                else
+                Array = Allocate(Op.Length);
+                try
+                {
+                    std::uninitialized_copy(Op.Array, Op.Array + Op.Length, Array);
+                }
+                catch (...)
                 {
-                    Array = new ItemsType[Op.Length];
-                    std::copy(Op.Array, Op.Array + Op.Length, Array);
+                    Deallocate(Array);
+                    throw;
                 }
+                Length = Op.Length;
+                Capacity = Op.Length;
             }
 
             template <typename ItemsType>
@@ -144,6 +208,7 @@ namespace Engine
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 std::swap(Length, Op.Length);
+                std::swap(Capacity, Op.Capacity);
                 std::swap(Array, Op.Array);
             }
 
@@ -153,6 +218,7 @@ namespace Engine
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 std::shared_lock<std::shared_mutex> op_guard(Op.Mutex);
                 std::swap(Length, Op.Length);
+                std::swap(Capacity, Op.Capacity);
                 std::swap(Array, Op.Array);
                 return *this;
             }
@@ -162,6 +228,7 @@ namespace Engine
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
                 std::swap(Length, Op.Length);
+                std::swap(Capacity, Op.Capacity);
                 std::swap(Array, Op.Array);
                 return *this;
             }
@@ -176,17 +243,75 @@ namespace Engine
                 throw std::out_of_range("Index is out of range.");
             }
 
+#ifndef ENGINE_RESIZABLE_ARRAY_USE_MUTEX
+            template <typename ItemsType>
+            ItemsType& ENGINE_RESIZABLE_ARRAY_CLASS_NAME::GetItemRef(int Index)
+            {
+                if (Index >= 0 && Index < Length)
+                    return Array[Index];
+                throw std::out_of_range("Index is out of range.");
+            }
+#endif
+
             template <typename ItemsType>
             void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::SetItem(int Index, ItemsType Value)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 if (Index >= 0 && Index < Length)
-                    Array[Index] = Value;
+                    Array[Index] = std::move(Value);
                 else
                     throw std::out_of_range("Index is out of range.");
             }
 
+            template <typename ItemsType>
+            template <typename... ArgumentsTypes>
+            void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Emplace(int Index, ArgumentsTypes&&... Arguments)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Index < 0 || Index >= Length)
+                    throw std::out_of_range("Index is out of range.");
+
+                if constexpr (std::is_nothrow_constructible<ItemsType, ArgumentsTypes&&...>::value)
+                {
+                    Array[Index].~ItemsType();
+                    new (Array + Index) ItemsType(std::forward<ArgumentsTypes>(Arguments)...);
+                }
+                else // The old item is kept if the construction throws
+                    Array[Index] = ItemsType(std::forward<ArgumentsTypes>(Arguments)...);
+            }
+
+            template <typename ItemsType>
+            template <typename... ArgumentsTypes>
+            void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Append(ArgumentsTypes&&... Arguments)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Length == Capacity)
+                {
+                    if (Capacity == INT_MAX)
+                        throw std::length_error("The array is at its maximum length.");
+                    int capacity = Capacity > INT_MAX / 2 ? INT_MAX : (Capacity == 0 ? 1 : Capacity * 2);
+                    // The item is constructed first, as the Arguments may refer to an item of the old storage
+                    ItemsType item(std::forward<ArgumentsTypes>(Arguments)...);
+                    Reallocate(capacity);
+                    new (Array + Length) ItemsType(std::move(item));
+                }
+                else
+                    new (Array + Length) ItemsType(std::forward<ArgumentsTypes>(Arguments)...);
+                Length++;
+            }
+
+            template <typename ItemsType>
+            void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Reserve(int Capacity)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                if (Capacity > this->Capacity)
+                    Reallocate(Capacity);
+            }
+
             template <typename ItemsType>
             int ENGINE_RESIZABLE_ARRAY_CLASS_NAME::GetLength()
             {
@@ -194,33 +319,160 @@ namespace Engine
 
                 return Length;
             }
+
+            template <typename ItemsType>
+            int ENGINE_RESIZABLE_ARRAY_CLASS_NAME::GetCapacity()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Capacity;
+            }
+
             template <typename ItemsType>
             void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Resize(int NewLength)
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                if (NewLength > 0)
+                if (NewLength < 0)
+                    throw std::domain_error("NewLength is less than zero.");
+                if (NewLength == Length && NewLength == Capacity)
+                    return;
+                if constexpr (!std::is_default_constructible<ItemsType>::value)
+                    if (NewLength > Length)
+                        throw std::logic_error("The items are not default-constructible.");
+
+                if constexpr (IsTriviallyRelocatable)
+                {
+                    if (NewLength == 0)
+                    {
+                        std::free(Array);
+                        Array = nullptr;
+                    }
+                    else
+                    {
+                        // May extend the block in place, else copies the bytes
+                        void * new_array = std::realloc(Array, sizeof(ItemsType) * NewLength);
+                        if (new_array == nullptr)
+                            throw std::bad_alloc();
+                        Array = (ItemsType*)new_array;
+                        Capacity = NewLength;
+                        if constexpr (std::is_default_constructible<ItemsType>::value)
+                            if (NewLength > Length)
+                                std::uninitialized_value_construct(Array + Length, Array + NewLength);
+                    }
+                }
+                else
                 {
-                    ItemsType * NewArray = new ItemsType[NewLength];
-                    int MinimumLength = NewLength > Length ? Length : NewLength;
+                    ItemsType * new_array = Allocate(NewLength);
+                    int minimum_length = NewLength > Length ? Length : NewLength;
+                    try
+                    {
+                        // The added items first, so the old items are only moved from when nothing else can throw
+                        if constexpr (std::is_default_constructible<ItemsType>::value)
+                            std::uninitialized_value_construct(new_array + minimum_length, new_array + NewLength);
+                        try
+                        {
+                            Relocate(Array, minimum_length, new_array);
+                        }
+                        catch (...)
+                        {
+                            Destruct(new_array + minimum_length, NewLength - minimum_length);
+                            throw;
+                        }
+                    }
+                    catch (...)
+                    {
+                        Deallocate(new_array);
+                        throw;
+                    }
+
+                    Destruct(Array, Length);
+                    Deallocate(Array);
+                    Array = new_array;
+                }
+                Length = NewLength;
+                Capacity = NewLength;
+            }
 
-                    for (int i = 0; i < MinimumLength; i++)
-                        NewArray[i] = Array[i];
+            template <typename ItemsType>
+            void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Reallocate(int NewCapacity)
+            {
+                if constexpr (IsTriviallyRelocatable)
+                {
+                    void * new_array = std::realloc(Array, sizeof(ItemsType) * NewCapacity);
+                    if (new_array == nullptr)
+                        throw std::bad_alloc();
+                    Array = (ItemsType*)new_array;
+                }
+                else
+                {
+                    ItemsType * new_array = Allocate(NewCapacity);
+                    try
+                    {
+                        Relocate(Array, Length, new_array);
+                    }
+                    catch (...)
+                    {
+                        Deallocate(new_array);
+                        throw;
+                    }
+
+                    Destruct(Array, Length);
+                    Deallocate(Array);
+                    Array = new_array;
+                }
+                Capacity = NewCapacity;
+            }
 
-                    if (Array != nullptr)
-                        delete[] Array;
+            template <typename ItemsType>
+            ItemsType * ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Allocate(int Length)
+            {
+                if (Length == 0)
+                    return nullptr;
 
-                    Array = NewArray;
-                    Length = NewLength;
+                if constexpr (IsTriviallyRelocatable)
+                {
+                    void * array = std::malloc(sizeof(ItemsType) * Length);
+                    if (array == nullptr)
+                        throw std::bad_alloc();
+                    return (ItemsType*)array;
                 }
-                else if (NewLength == 0)
+                else
+                    return (ItemsType*)::operator new(sizeof(ItemsType) * Length, std::align_val_t(alignof(ItemsType)));
+            }
+
+            template <typename ItemsType>
+            void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Deallocate(ItemsType * Array)
+            {
+                if (Array == nullptr)
+                    return;
+
+                if constexpr (IsTriviallyRelocatable)
+                    std::free(Array);
+                else
+                    ::operator delete(Array, std::align_val_t(alignof(ItemsType)));
+            }
+
+            template <typename ItemsType>
+            void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Destruct(ItemsType * Array, int Length)
+            {
+                if constexpr (!std::is_trivially_destructible<ItemsType>::value)
+                    for (int i = 0; i < Length; i++)
+                        Array[i].~ItemsType();
+            }
+
+            template <typename ItemsType>
+            void ENGINE_RESIZABLE_ARRAY_CLASS_NAME::Relocate(ItemsType * From, int Count, ItemsType * To)
+            {
+                if constexpr (std::is_nothrow_move_constructible<ItemsType>::value)
                 {
-                    if (Array != nullptr)
-                        delete[] Array;
-                    Array = nullptr;
-                    Length = 0;
+                    for (int i = 0; i < Count; i++)
+                        new (To + i) ItemsType(std::move(From[i]));
                 }
-                else throw std::domain_error("NewLength is less than zero.");
+                else if constexpr (std::is_copy_constructible<ItemsType>::value)
+                    std::uninitialized_copy(From, From + Count, To);
+                else // A throwing move of a move-only item leaves the moved items moved from
+                    std::uninitialized_move(From, From + Count, To);
             }
         }
     }
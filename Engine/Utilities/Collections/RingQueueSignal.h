@@ -0,0 +1,122 @@
+#pragma once
+
+#include "../../Engine.dec.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// Parks the threads that wait for a ring queue to be pushed to or popped from.
+            /// Notify only takes the mutex when a thread is parked, so the operations that do not wait stay lock-free.
+            class RingQueueSignal final
+            {
+            public:
+                RingQueueSignal() : Epoch(0), Waiters(0) { }
+
+                RingQueueSignal(const RingQueueSignal&) = delete;
+                RingQueueSignal& operator=(const RingQueueSignal&) = delete;
+
+                /// @brief Calls TryOperation until it returns true, spinning first then parking between the calls.
+                template <typename TryFunction>
+                void Wait(TryFunction TryOperation);
+                /// @brief Calls TryOperation until it returns true or the Deadline passes.
+                /// @return The last result of TryOperation.
+                template <typename TryFunction>
+                bool WaitUntil(TryFunction TryOperation, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Wakes the parked threads, to retry their operation.
+                /// @param Count The number of items made available, to wake up to as many threads.
+                void Notify(int Count = 1);
+            private:
+                /// @brief The calls of TryOperation before parking, a handoff usually takes less.
+                static constexpr int SpinsCount = 64;
+
+                /// @brief Sleeps until a notification after the SeenEpoch.
+                ///
+                /// The operations are retried without the mutex, so the signals of a queue never hold each other's mutex.
+                ///
+                /// @return false if the Deadline passed first.
+                bool Park(std::uint32_t SeenEpoch, const std::chrono::steady_clock::time_point * Deadline);
+
+                /// @brief Is incremented by each notification, so a waiter can tell whether one came after its last try.
+                std::atomic<std::uint32_t> Epoch;
+                std::atomic<int> Waiters;
+                std::mutex Mutex;
+                std::condition_variable Condition;
+            };
+
+            template <typename TryFunction>
+            void RingQueueSignal::Wait(TryFunction TryOperation)
+            {
+                for (int i = 0; i < SpinsCount; i++)
+                {
+                    if (TryOperation())
+                        return;
+                    std::this_thread::yield();
+                }
+
+                while (true)
+                {
+                    std::uint32_t epoch = Epoch.load(std::memory_order_acquire);
+                    if (TryOperation())
+                        return;
+                    Park(epoch, nullptr);
+                }
+            }
+
+            template <typename TryFunction>
+            bool RingQueueSignal::WaitUntil(TryFunction TryOperation, std::chrono::steady_clock::time_point Deadline)
+            {
+                for (int i = 0; i < SpinsCount; i++)
+                {
+                    if (TryOperation())
+                        return true;
+                    if (std::chrono::steady_clock::now() >= Deadline)
+                        return false;
+                    std::this_thread::yield();
+                }
+
+                while (true)
+                {
+                    std::uint32_t epoch = Epoch.load(std::memory_order_acquire);
+                    if (TryOperation())
+                        return true;
+                    if (!Park(epoch, &Deadline))
+                        return TryOperation();
+                }
+            }
+
+            inline void RingQueueSignal::Notify(int Count)
+            {
+                Epoch.fetch_add(1, std::memory_order_seq_cst);
+                if (Waiters.load(std::memory_order_seq_cst) == 0)
+                    return;
+
+                // A parking thread holds the mutex from its epoch check to its wait, so the notification is not missed
+                std::lock_guard<std::mutex> guard(Mutex);
+                if (Count > 1)
+                    Condition.notify_all();
+                else
+                    Condition.notify_one();
+            }
+
+            inline bool RingQueueSignal::Park(std::uint32_t SeenEpoch, const std::chrono::steady_clock::time_point * Deadline)
+            {
+                std::unique_lock<std::mutex> guard(Mutex);
+                Waiters.fetch_add(1, std::memory_order_seq_cst);
+
+                // Either the epoch changed since the failed try, or the notifier sees this waiter
+                auto changed = [&] { return Epoch.load(std::memory_order_seq_cst) != SeenEpoch; };
+                bool result = true;
+                if (Deadline == nullptr)
+                    Condition.wait(guard, changed);
+                else
+                    result = Condition.wait_until(guard, *Deadline, changed);
+
+                Waiters.fetch_sub(1, std::memory_order_relaxed);
+                return result;
+            }
+        }
+    }
+}
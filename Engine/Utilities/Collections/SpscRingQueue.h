@@ -0,0 +1,228 @@
+#pragma once
+
+#include "../../Engine.dec.h"
+#include "RingQueueSignal.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        namespace Collections
+        {
+            /// A fixed-capacity ring buffer between one producer thread and one consumer thread.
+            /// The producer only writes the tail index and the consumer only writes the head index,
+            /// each on its own cache line, so pushing and popping are a load and a store without locks.
+            /// Each side caches the index of the other and only reloads it when the buffer looks full or empty.
+            template <typename ItemsType>
+            class SpscRingQueue final
+            {
+            public:
+                /// @param Capacity The maximum number of items, rounded up to a power of 2.
+                SpscRingQueue(int Capacity);
+                ~SpscRingQueue();
+
+                SpscRingQueue(const SpscRingQueue&) = delete;
+                SpscRingQueue& operator=(const SpscRingQueue&) = delete;
+
+                /// @brief Pushes an item to the back. Should only be called by the producer thread.
+                /// @return false if the queue is full.
+                bool TryPush(ItemsType Item);
+                /// @brief Pushes as many items as fit, in order, and publishes them at once.
+                ///
+                /// Should only be called by the producer thread. The pushed items are moved from.
+                ///
+                /// @return The number of pushed items.
+                int TryPush(ItemsType * Items, int Count);
+                /// @brief Pushes an item to the back, waiting while the queue is full.
+                void Push(ItemsType Item);
+                /// @brief Pushes an item to the back, unless the queue is still full at the Deadline.
+                /// @return Whether the item is pushed.
+                bool TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Pops the first/front item. Should only be called by the consumer thread.
+                /// @param ItemOut The popped item, if any.
+                /// @return Whether there was an item to pop.
+                bool TryPop(ItemsType& ItemOut);
+                /// @brief Pops up to Count items, in order, and releases their room at once.
+                ///
+                /// Should only be called by the consumer thread.
+                ///
+                /// @return The number of popped items.
+                int TryPop(ItemsType * ItemsOut, int Count);
+                /// @brief Pops the first/front item, waiting while the queue is empty.
+                ItemsType Pop();
+                /// @brief Pops the first/front item, unless the queue is still empty at the Deadline.
+                /// @return Whether there was an item to pop.
+                bool TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Pops and destructs all items. Should only be called by the consumer thread.
+                void Clear();
+
+                /// @brief Gets the maximum number of items.
+                int GetCapacity();
+                /// @brief Gets the number of items.
+                ///
+                /// Is an approximation while the other thread is pushing or popping.
+                int GetCount();
+                /// @brief Checks if there is no item to pop. Should only be called by the consumer thread.
+                bool IsEmpty();
+            private:
+                ItemsType * Items;
+                std::size_t Mask;
+
+                /// @brief The index of the next push, written by the producer.
+                alignas(64) std::atomic<std::size_t> Tail;
+                /// @brief The last head index loaded by the producer.
+                std::size_t CachedHead;
+
+                /// @brief The index of the next pop, written by the consumer.
+                alignas(64) std::atomic<std::size_t> Head;
+                /// @brief The last tail index loaded by the consumer.
+                std::size_t CachedTail;
+
+                alignas(64) RingQueueSignal NotEmpty;
+                alignas(64) RingQueueSignal NotFull;
+            };
+
+            template <typename ItemsType>
+            SpscRingQueue<ItemsType>::SpscRingQueue(int Capacity) : Tail(0), CachedHead(0), Head(0), CachedTail(0)
+            {
+                if (Capacity <= 0)
+                    throw std::domain_error("Capacity is less than or equal to zero.");
+                if (Capacity > (1 << 30))
+                    throw std::domain_error("Capacity is greater than 2^30.");
+
+                std::size_t capacity = 1;
+                while (capacity < (std::size_t)Capacity)
+                    capacity <<= 1;
+                Items = new ItemsType[capacity];
+                Mask = capacity - 1;
+            }
+
+            template <typename ItemsType>
+            SpscRingQueue<ItemsType>::~SpscRingQueue()
+            {
+                delete[] Items;
+            }
+
+            template <typename ItemsType>
+            bool SpscRingQueue<ItemsType>::TryPush(ItemsType Item)
+            {
+                return TryPush(&Item, 1) == 1;
+            }
+
+            template <typename ItemsType>
+            int SpscRingQueue<ItemsType>::TryPush(ItemsType * Items, int Count)
+            {
+                if (Count <= 0)
+                    return 0;
+
+                std::size_t tail = Tail.load(std::memory_order_relaxed);
+                std::size_t room = Mask + 1 - (tail - CachedHead);
+                if (room < (std::size_t)Count)
+                {
+                    CachedHead = Head.load(std::memory_order_acquire);
+                    room = Mask + 1 - (tail - CachedHead);
+                }
+
+                int count = (std::size_t)Count < room ? Count : (int)room;
+                if (count == 0)
+                    return 0;
+                for (int i = 0; i < count; i++)
+                    this->Items[(tail + i) & Mask] = std::move(Items[i]);
+                Tail.store(tail + count, std::memory_order_release);
+
+                NotEmpty.Notify(count);
+                return count;
+            }
+
+            template <typename ItemsType>
+            void SpscRingQueue<ItemsType>::Push(ItemsType Item)
+            {
+                NotFull.Wait([&] { return TryPush(&Item, 1) == 1; });
+            }
+
+            template <typename ItemsType>
+            bool SpscRingQueue<ItemsType>::TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline)
+            {
+                return NotFull.WaitUntil([&] { return TryPush(&Item, 1) == 1; }, Deadline);
+            }
+
+            template <typename ItemsType>
+            bool SpscRingQueue<ItemsType>::TryPop(ItemsType& ItemOut)
+            {
+                return TryPop(&ItemOut, 1) == 1;
+            }
+
+            template <typename ItemsType>
+            int SpscRingQueue<ItemsType>::TryPop(ItemsType * ItemsOut, int Count)
+            {
+                if (Count <= 0)
+                    return 0;
+
+                std::size_t head = Head.load(std::memory_order_relaxed);
+                std::size_t available = CachedTail - head;
+                if (available < (std::size_t)Count)
+                {
+                    CachedTail = Tail.load(std::memory_order_acquire);
+                    available = CachedTail - head;
+                }
+
+                int count = (std::size_t)Count < available ? Count : (int)available;
+                if (count == 0)
+                    return 0;
+                for (int i = 0; i < count; i++)
+                {
+                    ItemsType& item = Items[(head + i) & Mask];
+                    ItemsOut[i] = std::move(item);
+                    item = ItemsType();
+                }
+                Head.store(head + count, std::memory_order_release);
+
+                NotFull.Notify(count);
+                return count;
+            }
+
+            template <typename ItemsType>
+            ItemsType SpscRingQueue<ItemsType>::Pop()
+            {
+                ItemsType item;
+                NotEmpty.Wait([&] { return TryPop(&item, 1) == 1; });
+                return item;
+            }
+
+            template <typename ItemsType>
+            bool SpscRingQueue<ItemsType>::TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline)
+            {
+                return NotEmpty.WaitUntil([&] { return TryPop(&ItemOut, 1) == 1; }, Deadline);
+            }
+
+            template <typename ItemsType>
+            void SpscRingQueue<ItemsType>::Clear()
+            {
+                ItemsType item;
+                while (TryPop(&item, 1) == 1);
+            }
+
+            template <typename ItemsType>
+            int SpscRingQueue<ItemsType>::GetCapacity()
+            {
+                return (int)(Mask + 1);
+            }
+
+            template <typename ItemsType>
+            int SpscRingQueue<ItemsType>::GetCount()
+            {
+                // The head first, so the difference does not underflow
+                std::size_t head = Head.load(std::memory_order_acquire);
+                std::size_t tail = Tail.load(std::memory_order_acquire);
+                std::size_t count = tail - head;
+                return count > Mask + 1 ? (int)(Mask + 1) : (int)count;
+            }
+
+            template <typename ItemsType>
+            bool SpscRingQueue<ItemsType>::IsEmpty()
+            {
+                return Tail.load(std::memory_order_acquire) == Head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+}
@@ -6,6 +6,7 @@
 
 #include "../../Engine.dec.h"
 #include "ResizableArray.h"
+#include "GrowthPolicy.h"
 
 #ifdef ENGINE_STACK_USE_MUTEX
     #include "../MutexContained.h"
@@ -51,9 +52,18 @@ namespace Engine
                 /// @param ItemOut The popped item, if any.
                 /// @return Whether there was an item to pop.
                 bool Pop(ItemsType& ItemOut);
+                /// @brief Pushes an item to the top, unless the lock is not acquired before the Deadline.
+                /// @return Whether the item was pushed.
+                bool TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline);
+                /// @brief Pops the top item, unless the lock is not acquired before the Deadline.
+                /// @param ItemOut The popped item, if any.
+                /// @return Whether the lock was acquired in time and there was an item to pop.
+                bool TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline);
                 /// @brief Sets the top item.
                 void SetTop(ItemsType Value);
                 /// @brief Clears the stack.
+                ///
+                /// Shrinks to the MinimumCapacity of the growth policy, unless its ShrinkThreshold is 0.
                 void Clear();
 
                 /// @brief Expands the allocated memory.
@@ -72,6 +82,15 @@ namespace Engine
                 ///
                 /// Set the value using SetAutoShrink(bool).
                 bool IsAutoShrink();
+                /// @brief Sets how the allocated memory grows and shrinks automatically.
+                void SetGrowthPolicy(GrowthPolicy Policy);
+                /// @brief Gets how the allocated memory grows and shrinks automatically.
+                GrowthPolicy GetGrowthPolicy();
+                /// @brief Shrinks the allocated memory as far as the growth policy allows.
+                ///
+                /// Also applies when the policy defers shrinking or the AutoShrink is off,
+                /// for idle times like the end of a frame.
+                void Trim();
 
                 /// @brief Gets the top item, without popping it.
                 ItemsType GetTop();
@@ -91,10 +110,18 @@ namespace Engine
                 bool IsEmpty();
                 /// @brief Gets the current capacity of the allocated memory.
                 int GetCapacity();
+                /// @brief Gets the number of times the allocated memory was reallocated.
+                long long GetReallocationsCount();
             private:
                 ResizableArray<ItemsType, false> * ItemsRef;
                 int Count;
                 bool AutoShrink;
+                GrowthPolicy Policy;
+                long long ReallocationsCount;
+
+                void Resize(int NewCapacity);
+                /// @brief Shrinks the allocated memory if the count dropped below the threshold of the growth policy.
+                void ShrinkByPolicy();
             };
         }
     }
@@ -105,9 +132,14 @@ namespace Engine
 #ifdef ENGINE_STACK_USE_MUTEX
     #define ENGINE_COLLECTION_WRITE_ACCESS auto guard = Mutex.GetLock();
     #define ENGINE_COLLECTION_READ_ACCESS auto guard = Mutex.GetSharedLock();
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) \
+        RecursiveMutex<true, false>::LockGuard guard; \
+        if (!Mutex.TryGetLockUntil(guard, Deadline)) \
+            return false;
 #else
     #define ENGINE_COLLECTION_WRITE_ACCESS ;
     #define ENGINE_COLLECTION_READ_ACCESS ;
+    #define ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline) (void)(Deadline);
 #endif
 
 namespace Engine
@@ -124,6 +156,7 @@ namespace Engine
                 ItemsRef = new ResizableArray<ItemsType, false>(InitialCapacity);
                 Count = 0;
                 AutoShrink = true;
+                ReallocationsCount = 0;
             }
 
             template <typename ItemsType>
@@ -200,13 +233,10 @@ namespace Engine
             {
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
-                while (Count >= ItemsRef->GetLength())
-                    if (ItemsRef->GetLength() > 0)
-                        ItemsRef->Resize(ItemsRef->GetLength() * 2);
-                    else
-                        ItemsRef->Resize(1);
+                if (Count >= ItemsRef->GetLength())
+                    Resize(Policy.GetGrownCapacity(ItemsRef->GetLength(), Count + 1));
 
-                ItemsRef->SetItem(Count, Item);
+                ItemsRef->SetItem(Count, std::move(Item));
                 Count++;
             }
 
@@ -219,10 +249,10 @@ namespace Engine
                     throw std::logic_error("Cannot pop from an empty stack.");
 
                 Count--;
-                ItemsType Item = ItemsRef->GetItem(Count);
+                ItemsType Item = std::move(ItemsRef->GetItemRef(Count));
 
-                if (AutoShrink && Count < ItemsRef->GetLength() / 2)
-                    ItemsRef->Resize(ItemsRef->GetLength() / 2);
+                if (AutoShrink && !Policy.DeferShrink)
+                    ShrinkByPolicy();
 
                 return Item;
             }
@@ -236,14 +266,31 @@ namespace Engine
                     return false;
 
                 Count--;
-                ItemOut = ItemsRef->GetItem(Count);
+                ItemOut = std::move(ItemsRef->GetItemRef(Count));
+
+                if (AutoShrink && !Policy.DeferShrink)
+                    ShrinkByPolicy();
+
+                return true;
+            }
 
-                if (AutoShrink && Count < ItemsRef->GetLength() / 2)
-                    ItemsRef->Resize(ItemsRef->GetLength() / 2);
+            template <typename ItemsType>
+            bool ENGINE_STACK_CLASS_NAME::TryPushUntil(ItemsType Item, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
 
+                Push(Item);
                 return true;
             }
 
+            template <typename ItemsType>
+            bool ENGINE_STACK_CLASS_NAME::TryPopUntil(ItemsType& ItemOut, std::chrono::steady_clock::time_point Deadline)
+            {
+                ENGINE_COLLECTION_TIMED_WRITE_ACCESS(Deadline);
+
+                return Pop(ItemOut);
+            }
+
             template <typename ItemsType>
             void ENGINE_STACK_CLASS_NAME::SetTop(ItemsType Value)
             {
@@ -252,7 +299,7 @@ namespace Engine
                 if (Count <= 0)
                     throw std::logic_error("Cannot set the top element of an empty stack.");
 
-                ItemsRef->SetItem(Count - 1, Value);
+                ItemsRef->SetItem(Count - 1, std::move(Value));
             }
 
             template <typename ItemsType>
@@ -261,8 +308,8 @@ namespace Engine
                 ENGINE_COLLECTION_WRITE_ACCESS;
 
                 Count = 0;
-                if (AutoShrink)
-                    ItemsRef->Resize(0);
+                if (AutoShrink && !Policy.DeferShrink && Policy.ShrinkThreshold > 0 && ItemsRef->GetLength() > Policy.MinimumCapacity)
+                    Resize(Policy.MinimumCapacity);
             }
 
             template <typename ItemsType>
@@ -273,7 +320,7 @@ namespace Engine
                 if (Space < 0)
                     throw std::domain_error("Space is less than zero.");
 
-                ItemsRef->Resize(ItemsRef->GetLength() + Space);
+                Resize(ItemsRef->GetLength() + Space);
             }
 
             template <typename ItemsType>
@@ -284,7 +331,7 @@ namespace Engine
                 if (AdditionalSpace < 0)
                     throw std::domain_error("AdditionalSpace is less than zero.");
 
-                ItemsRef->Resize(Count + AdditionalSpace);
+                Resize(Count + AdditionalSpace);
             }
 
             template <typename ItemsType>
@@ -303,6 +350,31 @@ namespace Engine
                 return AutoShrink;
             }
 
+            template <typename ItemsType>
+            void ENGINE_STACK_CLASS_NAME::SetGrowthPolicy(GrowthPolicy Policy)
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                Policy.Validate();
+                this->Policy = Policy;
+            }
+
+            template <typename ItemsType>
+            GrowthPolicy ENGINE_STACK_CLASS_NAME::GetGrowthPolicy()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return Policy;
+            }
+
+            template <typename ItemsType>
+            void ENGINE_STACK_CLASS_NAME::Trim()
+            {
+                ENGINE_COLLECTION_WRITE_ACCESS;
+
+                ShrinkByPolicy();
+            }
+
             template <typename ItemsType>
             ItemsType ENGINE_STACK_CLASS_NAME::GetTop()
             {
@@ -320,7 +392,7 @@ namespace Engine
                 ENGINE_COLLECTION_READ_ACCESS;
 
                 for (int i = Count - 1 - FromDepth; i >= 0; i--)
-                    if (ItemsRef->GetItem(i) == Item)
+                    if (ItemsRef->GetItemRef(i) == Item)
                         return (Count - 1) - i;
 
                 return -1;
@@ -332,7 +404,7 @@ namespace Engine
                 ENGINE_COLLECTION_READ_ACCESS;
 
                 for (int i = Count - 1; i >= 0; i--)
-                    if (ItemsRef->GetItem(i) == Item)
+                    if (ItemsRef->GetItemRef(i) == Item)
                         return true;
 
                 return false;
@@ -361,12 +433,38 @@ namespace Engine
 
                 return ItemsRef->GetLength();
             }
+
+            template <typename ItemsType>
+            long long ENGINE_STACK_CLASS_NAME::GetReallocationsCount()
+            {
+                ENGINE_COLLECTION_READ_ACCESS;
+
+                return ReallocationsCount;
+            }
+
+            template <typename ItemsType>
+            void ENGINE_STACK_CLASS_NAME::Resize(int NewCapacity)
+            {
+                if (NewCapacity == ItemsRef->GetLength())
+                    return;
+                ReallocationsCount++;
+                ItemsRef->Resize(NewCapacity);
+            }
+
+            template <typename ItemsType>
+            void ENGINE_STACK_CLASS_NAME::ShrinkByPolicy()
+            {
+                int capacity = Policy.GetShrunkCapacity(Count, ItemsRef->GetLength());
+                if (capacity < ItemsRef->GetLength())
+                    Resize(capacity);
+            }
         }
     }
 }
 
 #undef ENGINE_COLLECTION_WRITE_ACCESS
 #undef ENGINE_COLLECTION_READ_ACCESS
+#undef ENGINE_COLLECTION_TIMED_WRITE_ACCESS
 
 #undef ENGINE_STACK_CLASS_NAME
 #undef ENGINE_STACK_DERIVATION
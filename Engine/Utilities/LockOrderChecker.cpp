@@ -0,0 +1,364 @@
+#include "../Engine.h"
+
+#if __has_include(<execinfo.h>)
+    #include <execinfo.h>
+    #include <cstdlib>
+    #define ENGINE_LOCK_ORDER_HAS_BACKTRACE
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        /// @brief Where an order was recorded.
+        struct LockOrderStack
+        {
+            static constexpr int MaxFramesCount = 32;
+
+            std::thread::id Thread;
+            /// @brief The mutexes held by the thread, the first acquired first.
+            std::string HeldLocks;
+            void * Frames[MaxFramesCount];
+            int FramesCount = 0;
+        };
+
+        /// @brief The From mutex was held while the To mutex was acquired.
+        struct LockOrderEdge
+        {
+            LockOrderNode * From;
+            LockOrderNode * To;
+            LockOrderEdge * NextOut;
+            LockOrderEdge * NextIn;
+            LockOrderStack Stack;
+        };
+
+        struct LockOrderNode
+        {
+            // Guarded by the mutex of the graph
+            std::string Name;
+            const void * Mutex;
+            LockOrderEdge * FirstOut = nullptr;
+            LockOrderEdge * FirstIn = nullptr;
+            // The search for a path
+            long long VisitId = 0;
+            /// @brief The edge the search reached the node by.
+            LockOrderEdge * VisitEdge = nullptr;
+        };
+
+        struct HeldLock
+        {
+            LockOrderNode * Node;
+            RecursiveMutexLockKind Kind;
+        };
+
+        // Is zero-initialized and trivially destructible, so no access needs an initialization check
+        struct HeldLocks
+        {
+            static constexpr int Capacity = 64;
+
+            HeldLock Locks[Capacity];
+            int Count;
+            /// @brief The held mutexes that did not fit in Locks, not checked.
+            int DroppedCount;
+        };
+
+        static thread_local HeldLocks ThreadHeldLocks;
+
+        static constexpr int MaxKeptReportsCount = 64;
+
+        // The graph is never deleted, a static mutex may be destroyed after it otherwise
+        struct LockOrderGraph
+        {
+            std::mutex Mutex;
+            long long LastVisitId = 0;
+            Collections::List<std::string, false> Reports;
+            long long ReportsCount = 0;
+            // Is held while the handler is called, a report of the handler itself calls it again
+            std::recursive_mutex HandlerMutex;
+            Task<void(const std::string&)> ReportHandler;
+        };
+
+        static LockOrderGraph& GetGraph()
+        {
+            static LockOrderGraph * graph = new LockOrderGraph();
+            return *graph;
+        }
+
+        static const char * GetKindName(RecursiveMutexLockKind Kind)
+        {
+            switch (Kind)
+            {
+                case ExclusiveLockKind: return "lock";
+                case SharedLockKind: return "shared-lock";
+                default: return "upgradable-shared-lock";
+            }
+        }
+
+        // The mutex of the graph must be locked
+        static void WriteName(std::ostream& Stream, LockOrderNode * Node)
+        {
+            if (!Node->Name.empty())
+                Stream << Node->Name;
+            else
+                Stream << "RecursiveMutex@" << Node->Mutex;
+        }
+
+        // The mutex of the graph must be locked
+        static void CaptureStack(LockOrderStack& Stack)
+        {
+            Stack.Thread = std::this_thread::get_id();
+            std::ostringstream held;
+            for (int i = 0; i < ThreadHeldLocks.Count; i++)
+            {
+                if (i > 0)
+                    held << ", ";
+                WriteName(held, ThreadHeldLocks.Locks[i].Node);
+                held << " (" << GetKindName(ThreadHeldLocks.Locks[i].Kind) << ')';
+            }
+            if (ThreadHeldLocks.DroppedCount > 0)
+                held << " and " << ThreadHeldLocks.DroppedCount << " more";
+            Stack.HeldLocks = held.str();
+#ifdef ENGINE_LOCK_ORDER_HAS_BACKTRACE
+            Stack.FramesCount = backtrace(Stack.Frames, LockOrderStack::MaxFramesCount);
+#endif
+        }
+
+        static void WriteStack(std::ostream& Stream, const LockOrderStack& Stack)
+        {
+            Stream << "    thread " << Stack.Thread << " holding: " << Stack.HeldLocks << '\n';
+#ifdef ENGINE_LOCK_ORDER_HAS_BACKTRACE
+            char ** symbols = backtrace_symbols(Stack.Frames, Stack.FramesCount);
+            if (symbols != nullptr)
+            {
+                for (int i = 0; i < Stack.FramesCount; i++)
+                    Stream << "      " << symbols[i] << '\n';
+                free(symbols);
+            }
+#endif
+        }
+
+        // The mutex of the graph must be locked
+        static LockOrderEdge * FindEdge(LockOrderNode * From, LockOrderNode * To)
+        {
+            for (LockOrderEdge * edge = From->FirstOut; edge != nullptr; edge = edge->NextOut)
+                if (edge->To == To)
+                    return edge;
+            return nullptr;
+        }
+
+        // Searches breadth-first, so the reported path is a shortest one.
+        // The VisitEdge of the nodes leads back from To to From.
+        // The mutex of the graph must be locked.
+        static bool FindPath(LockOrderGraph& Graph, LockOrderNode * From, LockOrderNode * To)
+        {
+            long long visit_id = ++Graph.LastVisitId;
+            Collections::List<LockOrderNode*, false> frontier;
+            From->VisitId = visit_id;
+            From->VisitEdge = nullptr;
+            frontier.Add(From);
+            for (int i = 0; i < frontier.GetCount(); i++)
+            {
+                for (LockOrderEdge * edge = frontier.GetItem(i)->FirstOut; edge != nullptr; edge = edge->NextOut)
+                {
+                    if (edge->To->VisitId == visit_id)
+                        continue;
+                    edge->To->VisitId = visit_id;
+                    edge->To->VisitEdge = edge;
+                    if (edge->To == To)
+                        return true;
+                    frontier.Add(edge->To);
+                }
+            }
+            return false;
+        }
+
+        static void SendReport(const std::string& Text)
+        {
+            LockOrderGraph& graph = GetGraph();
+            {
+                std::lock_guard<std::mutex> guard(graph.Mutex);
+                graph.ReportsCount++;
+                if (graph.Reports.GetCount() < MaxKeptReportsCount)
+                    graph.Reports.Add(Text);
+            }
+
+            std::lock_guard<std::recursive_mutex> guard(graph.HandlerMutex);
+            if (graph.ReportHandler)
+                graph.ReportHandler(Text);
+            else
+                std::cerr << Text << std::flush;
+        }
+
+// -------- GRAPH -------- //
+
+        LockOrderNode * LockOrderChecker::Register(const void * Mutex)
+        {
+            LockOrderNode * node = new LockOrderNode();
+            node->Mutex = Mutex;
+            return node;
+        }
+
+        void LockOrderChecker::Unregister(LockOrderNode * Node)
+        {
+            std::lock_guard<std::mutex> guard(GetGraph().Mutex);
+            while (Node->FirstOut != nullptr)
+            {
+                LockOrderEdge * edge = Node->FirstOut;
+                Node->FirstOut = edge->NextOut;
+                LockOrderEdge ** in = &edge->To->FirstIn;
+                while (*in != edge)
+                    in = &(*in)->NextIn;
+                *in = edge->NextIn;
+                delete edge;
+            }
+            while (Node->FirstIn != nullptr)
+            {
+                LockOrderEdge * edge = Node->FirstIn;
+                Node->FirstIn = edge->NextIn;
+                LockOrderEdge ** out = &edge->From->FirstOut;
+                while (*out != edge)
+                    out = &(*out)->NextOut;
+                *out = edge->NextOut;
+                delete edge;
+            }
+            delete Node;
+        }
+
+        void LockOrderChecker::SetName(LockOrderNode * Node, std::string Name)
+        {
+            std::lock_guard<std::mutex> guard(GetGraph().Mutex);
+            Node->Name = std::move(Name);
+        }
+
+// -------- CHECKS -------- //
+
+        void LockOrderChecker::BeforeAcquire(LockOrderNode * Node, RecursiveMutexLockKind Kind)
+        {
+            HeldLocks& held = ThreadHeldLocks;
+            if (held.Count == 0)
+                return;
+
+            LockOrderGraph& graph = GetGraph();
+            std::ostringstream report;
+            {
+                std::lock_guard<std::mutex> guard(graph.Mutex);
+                LockOrderStack * current = nullptr;
+                for (int i = 0; i < held.Count; i++)
+                {
+                    LockOrderNode * from = held.Locks[i].Node;
+                    if (from == Node)
+                    {
+                        // Would wait for itself, RecursiveMutex throws after this
+                        if (Kind != SharedLockKind && held.Locks[i].Kind == SharedLockKind)
+                        {
+                            LockOrderStack stack;
+                            CaptureStack(stack);
+                            report << "Deadlock: " << GetKindName(Kind) << " of ";
+                            WriteName(report, Node);
+                            report << " after its shared-lock in the same thread, use upgradable-shared-lock instead\n";
+                            WriteStack(report, stack);
+                        }
+                        continue;
+                    }
+                    if (FindEdge(from, Node) != nullptr)
+                        continue;
+
+                    if (current == nullptr)
+                    {
+                        current = new LockOrderStack();
+                        CaptureStack(*current);
+                    }
+                    LockOrderEdge * edge = new LockOrderEdge{ from, Node, from->FirstOut, Node->FirstIn, *current };
+
+                    // The held mutex may already be acquired while holding the acquired one, maybe indirectly
+                    if (FindPath(graph, Node, from))
+                    {
+                        report << "Potential deadlock: lock-order inversion\n  ";
+                        WriteName(report, Node);
+                        report << " (" << GetKindName(Kind) << ") is acquired while holding ";
+                        WriteName(report, from);
+                        report << ":\n";
+                        WriteStack(report, *current);
+                        report << "  but it was acquired in the opposite order before:\n";
+                        Collections::List<LockOrderEdge*, false> path;
+                        for (LockOrderEdge * step = from->VisitEdge; step != nullptr; step = step->From->VisitEdge)
+                            path.Add(step, 0);
+                        path.ForEach([&](LockOrderEdge * Step) {
+                            report << "  ";
+                            WriteName(report, Step->To);
+                            report << " acquired while holding ";
+                            WriteName(report, Step->From);
+                            report << ":\n";
+                            WriteStack(report, Step->Stack);
+                        });
+                    }
+
+                    from->FirstOut = edge;
+                    Node->FirstIn = edge;
+                }
+                delete current;
+            }
+
+            std::string text = report.str();
+            if (!text.empty())
+                SendReport(text);
+        }
+
+        void LockOrderChecker::Acquired(LockOrderNode * Node, RecursiveMutexLockKind Kind)
+        {
+            HeldLocks& held = ThreadHeldLocks;
+            if (held.Count == HeldLocks::Capacity)
+                held.DroppedCount++;
+            else
+                held.Locks[held.Count++] = { Node, Kind };
+        }
+
+        void LockOrderChecker::Released(LockOrderNode * Node, RecursiveMutexLockKind Kind)
+        {
+            // The guards are usually released in the reverse order
+            HeldLocks& held = ThreadHeldLocks;
+            for (int i = held.Count - 1; i >= 0; i--)
+                if (held.Locks[i].Node == Node && held.Locks[i].Kind == Kind)
+                {
+                    std::copy(held.Locks + i + 1, held.Locks + held.Count, held.Locks + i);
+                    held.Count--;
+                    return;
+                }
+            if (held.DroppedCount > 0)
+                held.DroppedCount--;
+        }
+
+// -------- REPORTS -------- //
+
+        void LockOrderChecker::SetReportHandler(Task<void(const std::string&)> Handler)
+        {
+            LockOrderGraph& graph = GetGraph();
+            std::lock_guard<std::recursive_mutex> guard(graph.HandlerMutex);
+            graph.ReportHandler = std::move(Handler);
+        }
+
+        long long LockOrderChecker::GetReportsCount()
+        {
+            LockOrderGraph& graph = GetGraph();
+            std::lock_guard<std::mutex> guard(graph.Mutex);
+            return graph.ReportsCount;
+        }
+
+        void LockOrderChecker::ExportText(std::ostream& Stream)
+        {
+            LockOrderGraph& graph = GetGraph();
+            std::lock_guard<std::mutex> guard(graph.Mutex);
+            graph.Reports.ForEach([&](std::string Report) { Stream << Report << '\n'; });
+            if (graph.ReportsCount > graph.Reports.GetCount())
+                Stream << graph.ReportsCount - graph.Reports.GetCount() << " more reports were not kept\n";
+        }
+
+        void LockOrderChecker::Reset()
+        {
+            LockOrderGraph& graph = GetGraph();
+            std::lock_guard<std::mutex> guard(graph.Mutex);
+            graph.Reports.Clear();
+            graph.ReportsCount = 0;
+        }
+    }
+}
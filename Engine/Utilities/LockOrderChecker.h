@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../Engine.dec.h"
+
+// Instrumentation macro of RecursiveMutex, compiles to nothing unless ENGINE_LOCK_ORDER_CHECKING is defined.
+#ifdef ENGINE_LOCK_ORDER_CHECKING
+    #define ENGINE_LOCK_ORDER_CHECK(...) __VA_ARGS__
+#else
+    #define ENGINE_LOCK_ORDER_CHECK(...)
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        /// Each thread keeps the stack of the mutexes it holds. Before a thread waits for a mutex,
+        /// an edge is added to a global graph from each mutex it holds to the waited one,
+        /// with the call stack and the held mutexes of the acquisition.
+        /// A new edge that closes a cycle is an order that can deadlock with the recorded ones,
+        /// even if the threads never met at the wrong time, and is reported with the stacks of the cycle.
+        ///
+        /// Locking or upgradable-shared-locking a mutex that the thread shared-locks is reported too,
+        /// before the RecursiveMutex throws.
+        ///
+        /// The try-locks do not wait and the timed locks give up at their deadline, so they add no edge,
+        /// but the edges of the next acquisitions start from them.
+        class LockOrderChecker final
+        {
+        public:
+            LockOrderChecker() = delete;
+
+            /// @brief Adds a mutex to the graph, until it is unregistered.
+            static LockOrderNode * Register(const void * Mutex);
+            /// @brief Removes a mutex and its edges from the graph.
+            static void Unregister(LockOrderNode * Node);
+            /// @brief Names the mutex of the node in the reports, like "Loop.Modules".
+            static void SetName(LockOrderNode * Node, std::string Name);
+
+            /// @brief Records the order of the acquisition that may wait, and reports it if it may deadlock.
+            ///
+            /// Is called before waiting, so the report comes before the deadlock.
+            static void BeforeAcquire(LockOrderNode * Node, RecursiveMutexLockKind Kind);
+            /// @brief Pushes the mutex on the stack of the mutexes held by the calling thread.
+            static void Acquired(LockOrderNode * Node, RecursiveMutexLockKind Kind);
+            /// @brief Removes the mutex from the stack of the mutexes held by the calling thread.
+            static void Released(LockOrderNode * Node, RecursiveMutexLockKind Kind);
+
+            /// @brief Sets the function called with each report, instead of writing it to std::cerr.
+            ///
+            /// Is called by the thread that is about to acquire the mutex, with no lock of the graph, one report at a time.
+            /// Throwing an exception from it cancels the acquisition.
+            static void SetReportHandler(Task<void(const std::string&)> Handler);
+            /// @brief Gets the number of reports since the start or the last Reset.
+            static long long GetReportsCount();
+            /// @brief Writes the first reports since the start or the last Reset.
+            static void ExportText(std::ostream& Stream);
+            /// @brief Forgets the reports.
+            ///
+            /// The recorded orders are kept, so the same inversions are not reported again.
+            static void Reset();
+        };
+    }
+}
@@ -0,0 +1,409 @@
+#include "../Engine.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        /// @brief The statistics of a mutex copied for a report.
+        struct LockStatsSnapshot
+        {
+            std::string Name;
+            const void * Mutex;
+            long long Acquisitions[3];
+            long long ContendedAcquisitions;
+            long long TimedOutAcquisitions;
+            long long WaitTime;
+            long long MaxWaitTime;
+            long long HoldTimes[3][LockStats::HoldTimeBucketsCount];
+            std::thread::id Owners[LockStats::OwnersCount];
+            long long OwnerContentions[LockStats::OwnersCount];
+            long long OtherOwnerContentions;
+        };
+
+        // The registry is never deleted, a static mutex may be destroyed after it otherwise
+        struct LockProfilerRegistry
+        {
+            std::mutex Mutex;
+            /// @brief The statistics of the live mutexes, linked by their Prev and Next.
+            LockStats * First = nullptr;
+            /// @brief The merged statistics of the destroyed mutexes by name, "" for the unnamed ones.
+            Collections::Dictionary<std::string, LockStats*, false> Destroyed;
+        };
+
+        static const std::chrono::steady_clock::time_point LockProfilerEpoch = std::chrono::steady_clock::now();
+
+        static LockProfilerRegistry& GetRegistry()
+        {
+            static LockProfilerRegistry * registry = new LockProfilerRegistry();
+            return *registry;
+        }
+
+        // The OwnersMutex of Stats must be locked
+        static void AddOwnerContentions(LockStats * Stats, std::thread::id Owner, long long Count)
+        {
+            for (int i = 0; i < LockStats::OwnersCount; i++)
+                if (Stats->OwnerContentions[i] > 0 && Stats->Owners[i] == Owner)
+                {
+                    Stats->OwnerContentions[i] += Count;
+                    return;
+                }
+            for (int i = 0; i < LockStats::OwnersCount; i++)
+                if (Stats->OwnerContentions[i] == 0)
+                {
+                    Stats->Owners[i] = Owner;
+                    Stats->OwnerContentions[i] = Count;
+                    return;
+                }
+            Stats->OtherOwnerContentions += Count;
+        }
+
+        static void UpdateMaxWaitTime(LockStats * Stats, long long WaitTime)
+        {
+            long long max = Stats->MaxWaitTime.load(std::memory_order_relaxed);
+            while (WaitTime > max && !Stats->MaxWaitTime.compare_exchange_weak(max, WaitTime, std::memory_order_relaxed)) {}
+        }
+
+        static void MergeLockStats(LockStats * Into, LockStats * From)
+        {
+            for (int kind = 0; kind < 3; kind++)
+            {
+                Into->Acquisitions[kind].fetch_add(From->Acquisitions[kind].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                for (int i = 0; i < LockStats::HoldTimeBucketsCount; i++)
+                    Into->HoldTimes[kind][i].fetch_add(From->HoldTimes[kind][i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+            Into->ContendedAcquisitions.fetch_add(From->ContendedAcquisitions.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            Into->TimedOutAcquisitions.fetch_add(From->TimedOutAcquisitions.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            Into->WaitTime.fetch_add(From->WaitTime.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            UpdateMaxWaitTime(Into, From->MaxWaitTime.load(std::memory_order_relaxed));
+
+            std::lock_guard<std::mutex> into_guard(Into->OwnersMutex);
+            std::lock_guard<std::mutex> from_guard(From->OwnersMutex);
+            for (int i = 0; i < LockStats::OwnersCount; i++)
+                if (From->OwnerContentions[i] > 0)
+                    AddOwnerContentions(Into, From->Owners[i], From->OwnerContentions[i]);
+            Into->OtherOwnerContentions += From->OtherOwnerContentions;
+        }
+
+        static void ClearLockStats(LockStats * Stats)
+        {
+            for (int kind = 0; kind < 3; kind++)
+            {
+                Stats->Acquisitions[kind].store(0, std::memory_order_relaxed);
+                for (int i = 0; i < LockStats::HoldTimeBucketsCount; i++)
+                    Stats->HoldTimes[kind][i].store(0, std::memory_order_relaxed);
+            }
+            Stats->ContendedAcquisitions.store(0, std::memory_order_relaxed);
+            Stats->TimedOutAcquisitions.store(0, std::memory_order_relaxed);
+            Stats->WaitTime.store(0, std::memory_order_relaxed);
+            Stats->MaxWaitTime.store(0, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> guard(Stats->OwnersMutex);
+            for (int i = 0; i < LockStats::OwnersCount; i++)
+                Stats->OwnerContentions[i] = 0;
+            Stats->OtherOwnerContentions = 0;
+        }
+
+        // The registry mutex must be locked
+        static LockStatsSnapshot * TakeSnapshot(LockStats * Stats)
+        {
+            LockStatsSnapshot * snapshot = new LockStatsSnapshot();
+            snapshot->Name = Stats->Name;
+            snapshot->Mutex = Stats->Mutex;
+            for (int kind = 0; kind < 3; kind++)
+            {
+                snapshot->Acquisitions[kind] = Stats->Acquisitions[kind].load(std::memory_order_relaxed);
+                for (int i = 0; i < LockStats::HoldTimeBucketsCount; i++)
+                    snapshot->HoldTimes[kind][i] = Stats->HoldTimes[kind][i].load(std::memory_order_relaxed);
+            }
+            snapshot->ContendedAcquisitions = Stats->ContendedAcquisitions.load(std::memory_order_relaxed);
+            snapshot->TimedOutAcquisitions = Stats->TimedOutAcquisitions.load(std::memory_order_relaxed);
+            snapshot->WaitTime = Stats->WaitTime.load(std::memory_order_relaxed);
+            snapshot->MaxWaitTime = Stats->MaxWaitTime.load(std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> guard(Stats->OwnersMutex);
+            for (int i = 0; i < LockStats::OwnersCount; i++)
+            {
+                snapshot->Owners[i] = Stats->Owners[i];
+                snapshot->OwnerContentions[i] = Stats->OwnerContentions[i];
+            }
+            snapshot->OtherOwnerContentions = Stats->OtherOwnerContentions;
+            return snapshot;
+        }
+
+        // The caller deletes the snapshots, which are sorted by wait time, then by acquisitions.
+        // The mutexes that were neither acquired nor waited for are left out.
+        static void TakeSnapshots(Collections::List<LockStatsSnapshot*, false>& Snapshots)
+        {
+            auto insert = [&](LockStatsSnapshot * Snapshot) {
+                long long acquisitions = Snapshot->Acquisitions[0] + Snapshot->Acquisitions[1] + Snapshot->Acquisitions[2];
+                if (acquisitions + Snapshot->ContendedAcquisitions == 0)
+                {
+                    delete Snapshot;
+                    return;
+                }
+                int index = Snapshots.Find([&](LockStatsSnapshot * Other) {
+                    long long other_acquisitions = Other->Acquisitions[0] + Other->Acquisitions[1] + Other->Acquisitions[2];
+                    return Other->WaitTime < Snapshot->WaitTime
+                           || (Other->WaitTime == Snapshot->WaitTime && other_acquisitions < acquisitions);
+                });
+                Snapshots.Add(Snapshot, index >= 0 ? index : Snapshots.GetCount());
+            };
+
+            LockProfilerRegistry& registry = GetRegistry();
+            std::lock_guard<std::mutex> guard(registry.Mutex);
+            for (LockStats * stats = registry.First; stats != nullptr; stats = stats->Next)
+                insert(TakeSnapshot(stats));
+            registry.Destroyed.ForEach([&](std::string, LockStats * Stats) { insert(TakeSnapshot(Stats)); });
+        }
+
+        static void WriteName(std::ostream& Stream, const LockStatsSnapshot * Snapshot)
+        {
+            if (!Snapshot->Name.empty())
+                Stream << Snapshot->Name;
+            else if (Snapshot->Mutex != nullptr)
+                Stream << "RecursiveMutex@" << Snapshot->Mutex;
+            else
+                Stream << "(destroyed unnamed mutexes)";
+        }
+
+        static void WriteJsonString(std::ostream& Stream, const std::string& String)
+        {
+            Stream << '"';
+            for (char c : String)
+            {
+                if (c == '"' || c == '\\')
+                    Stream << '\\' << c;
+                else if ((unsigned char)c < 0x20)
+                    Stream << ' ';
+                else
+                    Stream << c;
+            }
+            Stream << '"';
+        }
+
+        static std::string FormatDuration(long long Nanoseconds)
+        {
+            if (Nanoseconds < 10000)
+                return std::to_string(Nanoseconds) + "ns";
+            if (Nanoseconds < 10000000)
+                return std::to_string(Nanoseconds / 1000) + "us";
+            return std::to_string(Nanoseconds / 1000000) + "ms";
+        }
+
+        // Gets the upper bound of the bucket that holds the Percentile of the holds of the given types
+        static long long GetHoldTimePercentile(const LockStatsSnapshot * Snapshot, int FirstKind, int LastKind, int Percentile)
+        {
+            long long total = 0;
+            for (int kind = FirstKind; kind <= LastKind; kind++)
+                for (int i = 0; i < LockStats::HoldTimeBucketsCount; i++)
+                    total += Snapshot->HoldTimes[kind][i];
+            if (total == 0)
+                return 0;
+
+            long long rank = (total * Percentile + 99) / 100;
+            long long count = 0;
+            for (int i = 0; i < LockStats::HoldTimeBucketsCount; i++)
+            {
+                for (int kind = FirstKind; kind <= LastKind; kind++)
+                    count += Snapshot->HoldTimes[kind][i];
+                if (count >= rank)
+                    return 1LL << (i + 1);
+            }
+            return 1LL << LockStats::HoldTimeBucketsCount;
+        }
+
+// -------- REGISTRY -------- //
+
+        LockStats * LockProfiler::Register(const void * Mutex)
+        {
+            LockStats * stats = new LockStats();
+            stats->Mutex = Mutex;
+
+            LockProfilerRegistry& registry = GetRegistry();
+            std::lock_guard<std::mutex> guard(registry.Mutex);
+            stats->Next = registry.First;
+            if (registry.First != nullptr)
+                registry.First->Prev = stats;
+            registry.First = stats;
+            return stats;
+        }
+
+        void LockProfiler::Unregister(LockStats * Stats)
+        {
+            LockProfilerRegistry& registry = GetRegistry();
+            std::lock_guard<std::mutex> guard(registry.Mutex);
+            if (Stats->Prev == nullptr)
+                registry.First = Stats->Next;
+            else
+                Stats->Prev->Next = Stats->Next;
+            if (Stats->Next != nullptr)
+                Stats->Next->Prev = Stats->Prev;
+
+            // A mutex that was never locked nor waited for adds nothing to the reports
+            if (Stats->Acquisitions[ExclusiveLockKind].load() + Stats->Acquisitions[SharedLockKind].load()
+                + Stats->Acquisitions[UpgradableSharedLockKind].load() + Stats->ContendedAcquisitions.load() > 0)
+            {
+                if (!registry.Destroyed.Contains(Stats->Name))
+                {
+                    LockStats * destroyed = new LockStats();
+                    destroyed->Name = Stats->Name;
+                    registry.Destroyed.SetValue(Stats->Name, destroyed);
+                }
+                MergeLockStats(registry.Destroyed.GetValue(Stats->Name), Stats);
+            }
+            delete Stats;
+        }
+
+        void LockProfiler::SetName(LockStats * Stats, std::string Name)
+        {
+            std::lock_guard<std::mutex> guard(GetRegistry().Mutex);
+            Stats->Name = std::move(Name);
+        }
+
+// -------- RECORDING -------- //
+
+        long long LockProfiler::Now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - LockProfilerEpoch).count();
+        }
+
+        void LockProfiler::RecordAcquisition(LockStats * Stats, RecursiveMutexLockKind Kind)
+        {
+            Stats->Acquisitions[Kind].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void LockProfiler::RecordContention(LockStats * Stats, long long WaitTime, std::thread::id Owner, bool Acquired)
+        {
+            Stats->ContendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+            if (!Acquired)
+                Stats->TimedOutAcquisitions.fetch_add(1, std::memory_order_relaxed);
+            Stats->WaitTime.fetch_add(WaitTime, std::memory_order_relaxed);
+            UpdateMaxWaitTime(Stats, WaitTime);
+
+            std::lock_guard<std::mutex> guard(Stats->OwnersMutex);
+            AddOwnerContentions(Stats, Owner, 1);
+        }
+
+        void LockProfiler::RecordHoldTime(LockStats * Stats, RecursiveMutexLockKind Kind, long long HoldTime)
+        {
+            int bucket = 0;
+            while (bucket + 1 < LockStats::HoldTimeBucketsCount && (HoldTime >> (bucket + 1)) != 0)
+                bucket++;
+            Stats->HoldTimes[Kind][bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+// -------- REPORTS -------- //
+
+        void LockProfiler::ExportText(std::ostream& Stream)
+        {
+            Collections::List<LockStatsSnapshot*, false> snapshots;
+            TakeSnapshots(snapshots);
+
+            Stream << std::left << std::setw(40) << "Mutex" << std::right
+                   << std::setw(12) << "Locks" << std::setw(12) << "Shared" << std::setw(12) << "Upgradable"
+                   << std::setw(12) << "Contended" << std::setw(12) << "Timed out" << std::setw(12) << "Wait" << std::setw(12) << "Max wait"
+                   << std::setw(12) << "Hold p50" << std::setw(12) << "Hold p99" << std::setw(14) << "Shared p99" << '\n';
+            snapshots.ForEach([&](LockStatsSnapshot * Snapshot) {
+                std::ostringstream name;
+                WriteName(name, Snapshot);
+                Stream << std::left << std::setw(40) << name.str() << std::right
+                       << std::setw(12) << Snapshot->Acquisitions[ExclusiveLockKind]
+                       << std::setw(12) << Snapshot->Acquisitions[SharedLockKind]
+                       << std::setw(12) << Snapshot->Acquisitions[UpgradableSharedLockKind]
+                       << std::setw(12) << Snapshot->ContendedAcquisitions
+                       << std::setw(12) << Snapshot->TimedOutAcquisitions
+                       << std::setw(12) << FormatDuration(Snapshot->WaitTime)
+                       << std::setw(12) << FormatDuration(Snapshot->MaxWaitTime)
+                       << std::setw(12) << FormatDuration(GetHoldTimePercentile(Snapshot, ExclusiveLockKind, ExclusiveLockKind, 50))
+                       << std::setw(12) << FormatDuration(GetHoldTimePercentile(Snapshot, ExclusiveLockKind, ExclusiveLockKind, 99))
+                       << std::setw(14) << FormatDuration(GetHoldTimePercentile(Snapshot, SharedLockKind, UpgradableSharedLockKind, 99))
+                       << '\n';
+
+                if (Snapshot->ContendedAcquisitions > 0)
+                {
+                    Stream << "    waited for:";
+                    for (int i = 0; i < LockStats::OwnersCount; i++)
+                    {
+                        if (Snapshot->OwnerContentions[i] == 0)
+                            continue;
+                        if (Snapshot->Owners[i] == std::thread::id())
+                            Stream << " no lock owner";
+                        else
+                            Stream << " thread " << Snapshot->Owners[i];
+                        Stream << " x" << Snapshot->OwnerContentions[i] << ',';
+                    }
+                    Stream << " other threads x" << Snapshot->OtherOwnerContentions << '\n';
+                }
+                delete Snapshot;
+            });
+        }
+
+        void LockProfiler::ExportJson(std::ostream& Stream)
+        {
+            static const char * KindNames[3] = { "lock", "sharedLock", "upgradableSharedLock" };
+
+            Collections::List<LockStatsSnapshot*, false> snapshots;
+            TakeSnapshots(snapshots);
+
+            Stream << "{\"mutexes\":[";
+            bool first = true;
+            snapshots.ForEach([&](LockStatsSnapshot * Snapshot) {
+                if (!first)
+                    Stream << ',';
+                first = false;
+
+                std::ostringstream name;
+                WriteName(name, Snapshot);
+                Stream << "\n{\"name\":";
+                WriteJsonString(Stream, name.str());
+                Stream << ",\"destroyed\":" << (Snapshot->Mutex == nullptr ? "true" : "false");
+                Stream << ",\"acquisitions\":{";
+                for (int kind = 0; kind < 3; kind++)
+                    Stream << (kind > 0 ? "," : "") << '"' << KindNames[kind] << "\":" << Snapshot->Acquisitions[kind];
+                Stream << "},\"contendedAcquisitions\":" << Snapshot->ContendedAcquisitions
+                       << ",\"timedOutAcquisitions\":" << Snapshot->TimedOutAcquisitions
+                       << ",\"waitTimeNs\":" << Snapshot->WaitTime
+                       << ",\"maxWaitTimeNs\":" << Snapshot->MaxWaitTime;
+
+                // Bucket i counts the holds of 2^i to 2^(i+1) nanoseconds
+                Stream << ",\"holdTimeLog2NsHistograms\":{";
+                for (int kind = 0; kind < 3; kind++)
+                {
+                    Stream << (kind > 0 ? "," : "") << '"' << KindNames[kind] << "\":[";
+                    for (int i = 0; i < LockStats::HoldTimeBucketsCount; i++)
+                        Stream << (i > 0 ? "," : "") << Snapshot->HoldTimes[kind][i];
+                    Stream << ']';
+                }
+
+                // The contentions while no thread had the lock are written with a null thread
+                Stream << "},\"ownersAtContention\":[";
+                bool first_owner = true;
+                for (int i = 0; i < LockStats::OwnersCount; i++)
+                {
+                    if (Snapshot->OwnerContentions[i] == 0)
+                        continue;
+                    Stream << (first_owner ? "" : ",") << "{\"thread\":";
+                    first_owner = false;
+                    if (Snapshot->Owners[i] == std::thread::id())
+                        Stream << "null";
+                    else
+                        Stream << '"' << Snapshot->Owners[i] << '"';
+                    Stream << ",\"contentions\":" << Snapshot->OwnerContentions[i] << '}';
+                }
+                Stream << "],\"otherOwnerContentions\":" << Snapshot->OtherOwnerContentions << '}';
+                delete Snapshot;
+            });
+            Stream << "\n]}\n";
+        }
+
+        void LockProfiler::Reset()
+        {
+            LockProfilerRegistry& registry = GetRegistry();
+            std::lock_guard<std::mutex> guard(registry.Mutex);
+            for (LockStats * stats = registry.First; stats != nullptr; stats = stats->Next)
+                ClearLockStats(stats);
+            registry.Destroyed.ForEach([](std::string, LockStats * Stats) { delete Stats; });
+            registry.Destroyed.Clear();
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "../Engine.dec.h"
+
+// Instrumentation macro of RecursiveMutex, compiles to nothing unless ENGINE_LOCK_PROFILING is defined.
+#ifdef ENGINE_LOCK_PROFILING
+    #define ENGINE_LOCK_PROFILE(...) __VA_ARGS__
+#else
+    #define ENGINE_LOCK_PROFILE(...)
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        struct LockStats
+        {
+            static constexpr int HoldTimeBucketsCount = 32;
+            static constexpr int OwnersCount = 4;
+
+            /// @brief The locks, shared-locks and upgradable-shared-locks, nested ones excluded.
+            std::atomic<long long> Acquisitions[3] = {};
+            /// @brief The acquisitions that could not proceed at once.
+            std::atomic<long long> ContendedAcquisitions = {0};
+            /// @brief The contended timed acquisitions that gave up at their deadline, not counted in Acquisitions.
+            std::atomic<long long> TimedOutAcquisitions = {0};
+            /// @brief In nanoseconds, the sum of the waits of the contended acquisitions.
+            std::atomic<long long> WaitTime = {0};
+            std::atomic<long long> MaxWaitTime = {0};
+            /// @brief HoldTimes[Kind][i] counts the holds of 2^i to 2^(i+1) nanoseconds,
+            ///        the last bucket also counts the longer ones.
+            std::atomic<long long> HoldTimes[3][HoldTimeBucketsCount] = {};
+
+            // Guards the owners at contention
+            std::mutex OwnersMutex;
+            /// @brief The lock owners that the contended acquisitions waited for, in the order they were met.
+            ///
+            /// The default id stands for the acquisitions that waited while no thread had the lock,
+            /// for the shared owners or for the waiting writers.
+            std::thread::id Owners[OwnersCount];
+            long long OwnerContentions[OwnersCount] = {};
+            /// @brief The contentions on owners that did not fit in Owners.
+            long long OtherOwnerContentions = 0;
+
+            // Guarded by the registry of the LockProfiler
+            std::string Name;
+            /// @brief nullptr for the merged statistics of destroyed mutexes.
+            const void * Mutex = nullptr;
+            LockStats * Prev = nullptr;
+            LockStats * Next = nullptr;
+        };
+
+        /// Each mutex counts its own statistics with relaxed atomics,
+        /// only the owners at contention are guarded by a mutex.
+        ///
+        /// The statistics of a destroyed mutex are merged with those of the destroyed mutexes of the same name,
+        /// so the mutexes of short-lived collections do not grow the reports.
+        class LockProfiler final
+        {
+        public:
+            LockProfiler() = delete;
+
+            /// @brief Creates the statistics of a mutex, reported until it is unregistered.
+            static LockStats * Register(const void * Mutex);
+            /// @brief Merges the statistics into those of the destroyed mutexes and deletes them.
+            static void Unregister(LockStats * Stats);
+            /// @brief Names the mutex of the statistics in the reports, like "Loop.Modules".
+            static void SetName(LockStats * Stats, std::string Name);
+
+            /// @brief Gets the current time in nanoseconds.
+            static long long Now();
+            static void RecordAcquisition(LockStats * Stats, RecursiveMutexLockKind Kind);
+            /// @brief Records an acquisition that waited for WaitTime nanoseconds, while Owner had the lock.
+            /// @param Acquired Whether the acquisition succeeded rather than timed out.
+            static void RecordContention(LockStats * Stats, long long WaitTime, std::thread::id Owner, bool Acquired);
+            static void RecordHoldTime(LockStats * Stats, RecursiveMutexLockKind Kind, long long HoldTime);
+
+            /// @brief Writes a table of the mutexes, the most waited for first.
+            ///
+            /// Can be called by any thread while the mutexes are used.
+            static void ExportText(std::ostream& Stream);
+            /// @brief Writes the statistics of the mutexes as a JSON object, with the full hold-time histograms.
+            ///
+            /// Can be called by any thread while the mutexes are used.
+            static void ExportJson(std::ostream& Stream);
+            /// @brief Clears the statistics of the live mutexes and forgets the destroyed ones.
+            static void Reset();
+        };
+    }
+}
@@ -14,6 +14,30 @@ namespace Engine
             Process();
         }
 
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
+        bool MutexContained<SupportsSharedLock, SupportsUpgradableSharedLock>::TryLockAndDoUntil(
+                std::function<void()> Process, std::chrono::steady_clock::time_point Deadline
+        ) {
+            typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard guard;
+            if (!Mutex.TryGetLockUntil(guard, Deadline))
+                return false;
+            Process();
+            return true;
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
+        bool MutexContained<SupportsSharedLock, SupportsUpgradableSharedLock>::TryLockAndDoFor(
+                std::function<void()> Process, std::chrono::steady_clock::duration Timeout
+        ) {
+            return TryLockAndDoUntil(std::move(Process), std::chrono::steady_clock::now() + Timeout);
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
+        void MutexContained<SupportsSharedLock, SupportsUpgradableSharedLock>::SetMutexName(std::string Name)
+        {
+            Mutex.SetName(std::move(Name));
+        }
+
         template class MutexContained<false, false>;
         template class MutexContained<true, false>;
         template class MutexContained<true, true>;
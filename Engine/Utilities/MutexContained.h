@@ -14,6 +14,18 @@ namespace Engine
             virtual ~MutexContained();
             /// @brief Calls the passed function while locking the object's mutex.
             void LockAndDo(std::function<void()> Process);
+            /// @brief Calls the passed function while locking the object's mutex,
+            ///        unless the mutex is not locked before the Deadline.
+            /// @return Whether the function was called.
+            bool TryLockAndDoUntil(std::function<void()> Process, std::chrono::steady_clock::time_point Deadline);
+            /// @brief Calls the passed function while locking the object's mutex,
+            ///        unless locking takes longer than Timeout.
+            /// @return Whether the function was called.
+            bool TryLockAndDoFor(std::function<void()> Process, std::chrono::steady_clock::duration Timeout);
+            /// @brief Names the object's mutex in the reports of the LockProfiler and the LockOrderChecker.
+            ///
+            /// Does nothing unless ENGINE_LOCK_PROFILING or ENGINE_LOCK_ORDER_CHECKING is defined.
+            void SetMutexName(std::string Name);
         protected:
             RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock> Mutex;
         };
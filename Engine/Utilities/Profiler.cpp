@@ -0,0 +1,236 @@
+#include "../Engine.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        /// @brief The ring buffer of a thread, written by the thread and read by the exporter.
+        struct ProfilerBuffer
+        {
+            Profiler::Event * Events;
+            long long Mask;
+            /// @brief The number of written events, only stored by the owner thread.
+            alignas(64) std::atomic<long long> Head;
+            /// @brief The number of exported events, only stored by the exporter.
+            alignas(64) std::atomic<long long> Tail;
+            std::atomic<long long> DroppedCount;
+            int ThreadIndex;
+            // Guarded by RegistryMutex
+            std::string ThreadName;
+            bool IsOwned;
+        };
+
+        /// @brief Gives the buffer of a thread back to the registry when the thread exits.
+        struct ProfilerBufferOwner
+        {
+            ProfilerBuffer * Buffer = nullptr;
+            ~ProfilerBufferOwner();
+        };
+
+        static const std::chrono::steady_clock::time_point Epoch = std::chrono::steady_clock::now();
+
+        // The buffers are never deleted, a thread may record while the program exits.
+        // The buffers of the exited threads are reused by the new ones.
+        static std::mutex RegistryMutex;
+        static Collections::List<ProfilerBuffer*, false> Buffers;
+        static Collections::Dictionary<const void*, std::string, false> SourceNames;
+        static std::atomic<int> BufferCapacity(1 << 16);
+
+        static thread_local ProfilerBufferOwner CurrentBuffer;
+
+        std::atomic<bool> Profiler::Enabled(true);
+
+        ProfilerBufferOwner::~ProfilerBufferOwner()
+        {
+            if (Buffer == nullptr)
+                return;
+            std::lock_guard<std::mutex> guard(RegistryMutex);
+            Buffer->IsOwned = false;
+        }
+
+        static ProfilerBuffer * GetBuffer()
+        {
+            if (CurrentBuffer.Buffer != nullptr)
+                return CurrentBuffer.Buffer;
+
+            std::lock_guard<std::mutex> guard(RegistryMutex);
+            int index = Buffers.Find([](ProfilerBuffer * Buffer) { return !Buffer->IsOwned; });
+            ProfilerBuffer * buffer;
+            if (index >= 0)
+            {
+                buffer = Buffers.GetItem(index);
+                buffer->ThreadName.clear();
+            }
+            else
+            {
+                int capacity = 1;
+                while (capacity < BufferCapacity.load())
+                    capacity *= 2;
+
+                buffer = new ProfilerBuffer();
+                buffer->Events = new Profiler::Event[capacity];
+                buffer->Mask = capacity - 1;
+                buffer->Head = 0;
+                buffer->Tail = 0;
+                buffer->DroppedCount = 0;
+                buffer->ThreadIndex = Buffers.GetCount();
+                Buffers.Add(buffer);
+            }
+            buffer->IsOwned = true;
+            CurrentBuffer.Buffer = buffer;
+            return buffer;
+        }
+
+        static void Record(const Profiler::Event& Event)
+        {
+            ProfilerBuffer * buffer = GetBuffer();
+            long long head = buffer->Head.load(std::memory_order_relaxed);
+            if (head - buffer->Tail.load(std::memory_order_acquire) > buffer->Mask)
+            {
+                buffer->DroppedCount.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            buffer->Events[head & buffer->Mask] = Event;
+            buffer->Head.store(head + 1, std::memory_order_release);
+        }
+
+        static void WriteString(std::ostream& Stream, const std::string& String)
+        {
+            Stream << '"';
+            for (char c : String)
+            {
+                if (c == '"' || c == '\\')
+                    Stream << '\\' << c;
+                else if ((unsigned char)c < 0x20)
+                    Stream << ' ';
+                else
+                    Stream << c;
+            }
+            Stream << '"';
+        }
+
+        // Chrome traces are in microseconds
+        static void WriteMicroseconds(std::ostream& Stream, long long Nanoseconds)
+        {
+            long long remainder = Nanoseconds % 1000;
+            Stream << Nanoseconds / 1000 << '.'
+                   << (char)('0' + remainder / 100) << (char)('0' + remainder / 10 % 10) << (char)('0' + remainder % 10);
+        }
+
+// -------- SCOPE -------- //
+
+        Profiler::Scope::Scope(const char * Name, const void * Source, long long Value)
+            : Name(Name), Source(Source), Value(Value), Start(IsEnabled() ? Now() : -1) {}
+
+        Profiler::Scope::~Scope()
+        {
+            if (Start >= 0)
+                RecordSpan(Name, Source, Start, Now(), Value);
+        }
+
+// -------- PROFILER -------- //
+
+        void Profiler::SetEnabled(bool Enabled)
+        {
+            Profiler::Enabled.store(Enabled, std::memory_order_relaxed);
+        }
+
+        bool Profiler::IsEnabled()
+        {
+            return Enabled.load(std::memory_order_relaxed);
+        }
+
+        void Profiler::SetBufferCapacity(int Capacity)
+        {
+            if (Capacity <= 0)
+                throw std::domain_error("Capacity is not greater than zero.");
+            BufferCapacity = Capacity;
+        }
+
+        void Profiler::SetThreadName(std::string Name)
+        {
+            ProfilerBuffer * buffer = GetBuffer();
+            std::lock_guard<std::mutex> guard(RegistryMutex);
+            buffer->ThreadName = std::move(Name);
+        }
+
+        void Profiler::SetSourceName(const void * Source, std::string Name)
+        {
+            std::lock_guard<std::mutex> guard(RegistryMutex);
+            SourceNames.SetValue(Source, std::move(Name));
+        }
+
+        long long Profiler::Now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - Epoch).count();
+        }
+
+        void Profiler::RecordSpan(const char * Name, const void * Source, long long Start, long long End, long long Value)
+        {
+            if (IsEnabled())
+                Record({ Name, Source, Start, End - Start, Value, EventType::Span });
+        }
+
+        void Profiler::RecordCounter(const char * Name, long long Value)
+        {
+            if (IsEnabled())
+                Record({ Name, nullptr, Now(), 0, Value, EventType::Counter });
+        }
+
+        void Profiler::ExportChromeTrace(std::ostream& Stream)
+        {
+            std::lock_guard<std::mutex> guard(RegistryMutex);
+
+            bool first = true;
+            auto begin_event = [&](const char * Phase, int ThreadIndex) {
+                Stream << (first ? "\n" : ",\n") << "{\"ph\":\"" << Phase << "\",\"pid\":1,\"tid\":" << ThreadIndex;
+                first = false;
+            };
+
+            Stream << "{\"traceEvents\":[";
+            Buffers.ForEach([&](ProfilerBuffer * Buffer) {
+                if (!Buffer->ThreadName.empty())
+                {
+                    begin_event("M", Buffer->ThreadIndex);
+                    Stream << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+                    WriteString(Stream, Buffer->ThreadName);
+                    Stream << "}}";
+                }
+
+                long long head = Buffer->Head.load(std::memory_order_acquire);
+                long long tail = Buffer->Tail.load(std::memory_order_relaxed);
+                for (; tail < head; tail++)
+                {
+                    const Event& event = Buffer->Events[tail & Buffer->Mask];
+                    begin_event(event.Type == EventType::Span ? "X" : "C", Buffer->ThreadIndex);
+                    Stream << ",\"name\":";
+                    if (event.Source != nullptr && SourceNames.Contains(event.Source))
+                        WriteString(Stream, SourceNames.GetValue(event.Source));
+                    else
+                        WriteString(Stream, event.Name != nullptr ? event.Name : "Unknown");
+                    Stream << ",\"ts\":";
+                    WriteMicroseconds(Stream, event.Start);
+                    if (event.Type == EventType::Span)
+                    {
+                        Stream << ",\"dur\":";
+                        WriteMicroseconds(Stream, event.Duration);
+                    }
+                    Stream << ",\"args\":{\"value\":" << event.Value << "}}";
+                }
+                // Frees the exported slots for the owner thread
+                Buffer->Tail.store(head, std::memory_order_release);
+            });
+            Stream << "\n]}\n";
+        }
+
+        long long Profiler::GetDroppedCount()
+        {
+            std::lock_guard<std::mutex> guard(RegistryMutex);
+            long long dropped = 0;
+            Buffers.ForEach([&](ProfilerBuffer * Buffer) {
+                dropped += Buffer->DroppedCount.load(std::memory_order_relaxed);
+            });
+            return dropped;
+        }
+    }
+}
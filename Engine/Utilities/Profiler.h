@@ -0,0 +1,97 @@
+#pragma once
+
+#include "../Engine.dec.h"
+
+// Instrumentation macros, they compile to nothing unless ENGINE_PROFILING is defined.
+#ifdef ENGINE_PROFILING
+    #define ENGINE_PROFILE_CONCAT_INNER(A, B) A##B
+    #define ENGINE_PROFILE_CONCAT(A, B) ENGINE_PROFILE_CONCAT_INNER(A, B)
+    /// @brief Records the rest of the enclosing scope as a span.
+    #define ENGINE_PROFILE_SCOPE(Name, Source, Value) \
+        Engine::Utilities::Profiler::Scope ENGINE_PROFILE_CONCAT(engine_profile_scope_, __LINE__)(Name, Source, Value)
+    #define ENGINE_PROFILE_COUNTER(Name, Value) Engine::Utilities::Profiler::RecordCounter(Name, Value)
+    #define ENGINE_PROFILE_THREAD_NAME(Name) Engine::Utilities::Profiler::SetThreadName(Name)
+    #define ENGINE_PROFILE_SOURCE_NAME(Source, Name) Engine::Utilities::Profiler::SetSourceName(Source, Name)
+#else
+    #define ENGINE_PROFILE_SCOPE(Name, Source, Value)
+    #define ENGINE_PROFILE_COUNTER(Name, Value)
+    #define ENGINE_PROFILE_THREAD_NAME(Name)
+    #define ENGINE_PROFILE_SOURCE_NAME(Source, Name)
+#endif
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        /// Each thread records to its own ring buffer without locking.
+        /// The events that do not fit until the next export are dropped.
+        ///
+        /// The Loop records the ticks, the chunks, the module updates, the scheduled jobs,
+        /// the depths of the schedule queues and the idle time of the workers.
+        class Profiler final
+        {
+        public:
+            enum EventType : std::int_fast8_t { Span = 0, Counter = 1 };
+
+            struct Event
+            {
+                /// @brief A string literal, replaced by the name of the Source if it is set by SetSourceName.
+                const char * Name;
+                const void * Source;
+                /// @brief In nanoseconds since the start of the program.
+                long long Start;
+                /// @brief In nanoseconds, 0 for counters.
+                long long Duration;
+                /// @brief The value of a counter, or the argument of a span.
+                long long Value;
+                EventType Type;
+            };
+
+            /// @brief Records a span from its construction to its destruction.
+            class Scope final
+            {
+            public:
+                Scope(const char * Name, const void * Source = nullptr, long long Value = 0);
+                ~Scope();
+
+                Scope(const Scope&) = delete;
+                Scope& operator=(const Scope&) = delete;
+            private:
+                const char * Name;
+                const void * Source;
+                long long Value;
+                long long Start;
+            };
+
+            Profiler() = delete;
+
+            /// @brief Pauses or resumes the recording. Is enabled by default.
+            static void SetEnabled(bool Enabled);
+            static bool IsEnabled();
+            /// @brief Sets the number of events that the buffer of a thread can hold.
+            ///
+            /// Only affects the threads that record their first event after the call.
+            /// Is rounded up to a power of 2.
+            static void SetBufferCapacity(int Capacity);
+            /// @brief Names the calling thread in the exported traces.
+            static void SetThreadName(std::string Name);
+            /// @brief Names the events recorded with a Source, like a Module.
+            static void SetSourceName(const void * Source, std::string Name);
+
+            /// @brief Gets the current time in nanoseconds since the start of the program.
+            static long long Now();
+            static void RecordSpan(const char * Name, const void * Source, long long Start, long long End, long long Value = 0);
+            static void RecordCounter(const char * Name, long long Value);
+
+            /// @brief Writes the events recorded since the last export in the Chrome trace event format,
+            ///        readable by chrome://tracing and Perfetto.
+            ///
+            /// Can be called by any thread while the others are recording.
+            static void ExportChromeTrace(std::ostream& Stream);
+            /// @brief Gets the number of events dropped because a buffer was full.
+            static long long GetDroppedCount();
+        private:
+            static std::atomic<bool> Enabled;
+        };
+    }
+}
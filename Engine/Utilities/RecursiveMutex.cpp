@@ -4,30 +4,192 @@ namespace Engine
 {
     namespace Utilities
     {
+        struct SharedLockSlot
+        {
+            const void * Mutex;
+            /// @brief The number of shared-lock guards of the thread, 0 while the first one is created.
+            int GuardCount;
+            /// @brief The time of the shared-lock for the LockProfiler.
+            long long HoldStart;
+        };
+
+        // A thread holds shared-locks on a few mutexes at a time, so its inline slots are searched linearly.
+        // Past them, e.g. while a striped dictionary locks all its stripes, the heap slots are found through a hash table.
+        // Is zero-initialized and trivially destructible, so no access needs an initialization check.
+        struct SharedLockSlots
+        {
+            static constexpr int InlineCapacity = 8;
+
+            SharedLockSlot InlineSlots[InlineCapacity];
+            /// @brief nullptr while the inline slots are enough.
+            SharedLockSlot * HeapSlots;
+            /// @brief The linear-probing table of the heap slots, holds their index + 1, or 0 if empty.
+            ///        Has twice the HeapCapacity, which is a power of 2.
+            int * HeapIndex;
+            /// @brief The shift that maps a hash to the HeapIndex.
+            int HeapIndexShift;
+            int HeapCapacity;
+            int Count;
+        };
+
+        static thread_local SharedLockSlots ThreadSharedLocks;
+
+        // Frees the heap slots of a thread when it exits
+        struct SharedLockSlotsOwner
+        {
+            ~SharedLockSlotsOwner()
+            {
+                delete[] ThreadSharedLocks.HeapSlots;
+                delete[] ThreadSharedLocks.HeapIndex;
+            }
+        };
+
+        static thread_local SharedLockSlotsOwner ThreadSharedLocksOwner;
+
+        static inline SharedLockSlot * GetSharedLockSlots()
+        {
+            return ThreadSharedLocks.HeapSlots != nullptr ? ThreadSharedLocks.HeapSlots : ThreadSharedLocks.InlineSlots;
+        }
+
+        static inline int GetSharedLockBucket(const void * Mutex)
+        {
+            return (int)(((std::uint64_t)(std::uintptr_t)Mutex * 0x9E3779B97F4A7C15ull) >> ThreadSharedLocks.HeapIndexShift);
+        }
+
+        /// @brief Finds the HeapIndex bucket of a mutex, -1 if none.
+        static int FindSharedLockBucket(const void * Mutex)
+        {
+            int mask = ThreadSharedLocks.HeapCapacity * 2 - 1;
+            for (int i = GetSharedLockBucket(Mutex); ThreadSharedLocks.HeapIndex[i] != 0; i = (i + 1) & mask)
+                if (ThreadSharedLocks.HeapSlots[ThreadSharedLocks.HeapIndex[i] - 1].Mutex == Mutex)
+                    return i;
+            return -1;
+        }
+
+        static void IndexSharedLockSlot(int Index)
+        {
+            int mask = ThreadSharedLocks.HeapCapacity * 2 - 1;
+            int i = GetSharedLockBucket(ThreadSharedLocks.HeapSlots[Index].Mutex);
+            while (ThreadSharedLocks.HeapIndex[i] != 0)
+                i = (i + 1) & mask;
+            ThreadSharedLocks.HeapIndex[i] = Index + 1;
+        }
+
+        // Shifts the following entries back into the hole when it is between them and their bucket
+        static void UnindexSharedLockBucket(int Bucket)
+        {
+            int mask = ThreadSharedLocks.HeapCapacity * 2 - 1;
+            int hole = Bucket;
+            for (int i = (hole + 1) & mask; ThreadSharedLocks.HeapIndex[i] != 0; i = (i + 1) & mask)
+            {
+                int home = GetSharedLockBucket(ThreadSharedLocks.HeapSlots[ThreadSharedLocks.HeapIndex[i] - 1].Mutex);
+                if (((i - home) & mask) >= ((i - hole) & mask))
+                {
+                    ThreadSharedLocks.HeapIndex[hole] = ThreadSharedLocks.HeapIndex[i];
+                    hole = i;
+                }
+            }
+            ThreadSharedLocks.HeapIndex[hole] = 0;
+        }
+
+        static inline SharedLockSlot * FindSharedLockSlot(const void * Mutex)
+        {
+            if (ThreadSharedLocks.HeapSlots != nullptr)
+            {
+                int bucket = FindSharedLockBucket(Mutex);
+                return bucket >= 0 ? &ThreadSharedLocks.HeapSlots[ThreadSharedLocks.HeapIndex[bucket] - 1] : nullptr;
+            }
+            for (int i = 0; i < ThreadSharedLocks.Count; i++)
+                if (ThreadSharedLocks.InlineSlots[i].Mutex == Mutex)
+                    return &ThreadSharedLocks.InlineSlots[i];
+            return nullptr;
+        }
+
+        static void AddSharedLockSlot(const void * Mutex)
+        {
+            SharedLockSlot * slots = GetSharedLockSlots();
+            int capacity = ThreadSharedLocks.HeapSlots != nullptr ? ThreadSharedLocks.HeapCapacity : SharedLockSlots::InlineCapacity;
+            if (ThreadSharedLocks.Count == capacity)
+            {
+                (void)&ThreadSharedLocksOwner; // Registers its destruction on the exit of the thread
+                SharedLockSlot * heap_slots = new SharedLockSlot[capacity * 2];
+                int * heap_index = new int[capacity * 4]();
+                std::copy(slots, slots + ThreadSharedLocks.Count, heap_slots);
+                delete[] ThreadSharedLocks.HeapSlots;
+                delete[] ThreadSharedLocks.HeapIndex;
+                ThreadSharedLocks.HeapSlots = heap_slots;
+                ThreadSharedLocks.HeapIndex = heap_index;
+                ThreadSharedLocks.HeapCapacity = capacity * 2;
+                ThreadSharedLocks.HeapIndexShift = 64;
+                for (int size = capacity * 4; size > 1; size /= 2)
+                    ThreadSharedLocks.HeapIndexShift--;
+                for (int i = 0; i < ThreadSharedLocks.Count; i++)
+                    IndexSharedLockSlot(i);
+                slots = heap_slots;
+            }
+            slots[ThreadSharedLocks.Count] = { Mutex, 0, 0 };
+            ENGINE_LOCK_PROFILE(slots[ThreadSharedLocks.Count].HoldStart = LockProfiler::Now();)
+            if (ThreadSharedLocks.HeapSlots != nullptr)
+                IndexSharedLockSlot(ThreadSharedLocks.Count);
+            ThreadSharedLocks.Count++;
+        }
+
+        static inline void RemoveSharedLockSlot(SharedLockSlot * Slot)
+        {
+            SharedLockSlot * slots = GetSharedLockSlots();
+            int last = ThreadSharedLocks.Count - 1;
+            if (ThreadSharedLocks.HeapSlots != nullptr)
+            {
+                // The last slot is moved to the removed one, so its entry is updated
+                UnindexSharedLockBucket(FindSharedLockBucket(Slot->Mutex));
+                if (Slot != &slots[last])
+                    ThreadSharedLocks.HeapIndex[FindSharedLockBucket(slots[last].Mutex)] = (int)(Slot - slots) + 1;
+            }
+            *Slot = slots[last];
+            ThreadSharedLocks.Count--;
+        }
+
+        static constexpr int InitialSpinBudget = 128;
+        static constexpr int MinSpinBudget = 16;
+        static constexpr int MaxSpinBudget = 4096;
+        static constexpr int MaxSpinBackoff = 64;
+
+        // Spinning only delays the owner if there is a single hardware thread
+        static const bool CanSpin = std::thread::hardware_concurrency() > 1;
+
+        // Tells the CPU that this is a spin loop, which saves power and lets the other hyper-thread run
+        static inline void CpuPause()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+            __asm__ __volatile__("yield");
+#endif
+        }
 
 // -------- LOCK GUARD -------- //
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::LockGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::LockGuard()
             : m(nullptr) {}
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::LockGuard(const LockGuard& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::LockGuard(const LockGuard& op)
         {
             m = op.m;
             if (m != nullptr)
                 m->LockByGuard();
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::LockGuard(LockGuard&& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::LockGuard(LockGuard&& op)
         {
             m = std::exchange(op.m, nullptr);
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard&
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::operator=(const LockGuard& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard&
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::operator=(const LockGuard& op)
         {
             if (m != nullptr)
                 m->UnlockByGuard();
@@ -37,9 +199,9 @@ namespace Engine
             return *this;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard&
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::operator=(LockGuard&& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard&
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::operator=(LockGuard&& op)
         {
             if (m != nullptr)
                 m->UnlockByGuard();
@@ -47,8 +209,8 @@ namespace Engine
             return *this;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::Unlock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::Unlock()
         {
             if (m != nullptr)
             {
@@ -57,44 +219,55 @@ namespace Engine
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::~LockGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::~LockGuard()
         {
             if (m != nullptr)
                 m->UnlockByGuard();
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard::LockGuard(RecursiveMutex * m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::LockGuard(RecursiveMutex * m)
             : m(m)
         {
             if (m != nullptr)
                 m->LockByGuard();
         }
 
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard::_Downgrade()
+        {
+            if (m == nullptr)
+                throw UnlockedGuardException();
+            SharedLockGuard guard(m);
+            Unlock();
+            return guard;
+        }
+
 // -------- SHARED-LOCK GUARD -------- //
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::SharedLockGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::SharedLockGuard()
             : m(nullptr) {}
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::SharedLockGuard(const SharedLockGuard& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::SharedLockGuard(const SharedLockGuard& op)
         {
             m = op.m;
             if (m != nullptr)
                 m->SharedLockByGuard();
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::SharedLockGuard(SharedLockGuard&& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::SharedLockGuard(SharedLockGuard&& op)
         {
             m = std::exchange(op.m, nullptr);
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard&
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::operator=(const SharedLockGuard& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard&
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::operator=(const SharedLockGuard& op)
         {
             if (m != nullptr)
                 m->SharedUnlockByGuard();
@@ -104,9 +277,9 @@ namespace Engine
             return *this;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard&
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::operator=(SharedLockGuard&& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard&
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::operator=(SharedLockGuard&& op)
         {
             if (m != nullptr)
                 m->SharedUnlockByGuard();
@@ -114,8 +287,8 @@ namespace Engine
             return *this;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::Unlock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::Unlock()
         {
             if (m != nullptr)
             {
@@ -124,15 +297,15 @@ namespace Engine
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::~SharedLockGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::~SharedLockGuard()
         {
             if (m != nullptr)
                 m->SharedUnlockByGuard();
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard::SharedLockGuard(RecursiveMutex * m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard::SharedLockGuard(RecursiveMutex * m)
             : m(m)
         {
             if (m != nullptr)
@@ -141,27 +314,27 @@ namespace Engine
 
 // -------- UPGRADABLE-SHARED-LOCK GUARD -------- //
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::UpgradableSharedLockGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::UpgradableSharedLockGuard()
             : m(nullptr) {}
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::UpgradableSharedLockGuard(const UpgradableSharedLockGuard& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::UpgradableSharedLockGuard(const UpgradableSharedLockGuard& op)
         {
             m = op.m;
             if (m != nullptr)
                 m->UpgradableSharedLockByGuard();
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::UpgradableSharedLockGuard(UpgradableSharedLockGuard&& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::UpgradableSharedLockGuard(UpgradableSharedLockGuard&& op)
         {
             m = std::exchange(op.m, nullptr);
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard&
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::operator=(const UpgradableSharedLockGuard& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard&
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::operator=(const UpgradableSharedLockGuard& op)
         {
             if (m != nullptr)
                 m->UpgradableSharedUnlockByGuard();
@@ -171,9 +344,9 @@ namespace Engine
             return *this;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard&
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::operator=(UpgradableSharedLockGuard&& op)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard&
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::operator=(UpgradableSharedLockGuard&& op)
         {
             if (m != nullptr)
                 m->UpgradableSharedUnlockByGuard();
@@ -181,8 +354,8 @@ namespace Engine
             return *this;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::Unlock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::Unlock()
         {
             if (m != nullptr)
             {
@@ -191,21 +364,33 @@ namespace Engine
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::~UpgradableSharedLockGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::~UpgradableSharedLockGuard()
         {
             if (m != nullptr)
                 m->UpgradableSharedUnlockByGuard();
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard::UpgradableSharedLockGuard(RecursiveMutex * m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::UpgradableSharedLockGuard(RecursiveMutex * m)
             : m(m)
         {
             if (m != nullptr)
                 m->UpgradableSharedLockByGuard();
         }
 
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard::Upgrade()
+        {
+            if (m == nullptr)
+                throw UnlockedGuardException();
+            // Locks while the upgradable-shared-lock keeps the other writers out
+            LockGuard guard(m);
+            Unlock();
+            return guard;
+        }
+
 // -------- EXCEPTIONS -------- //
 
         RecursiveMutexExceptions::InvalidOperation::InvalidOperation(const char * str) : std::runtime_error(str) {}
@@ -227,36 +412,62 @@ namespace Engine
                 "Cannot acquire upgradable-shared-lock after shared-lock in a single thread."
         ) {}
 
+        RecursiveMutexExceptions::UnlockedGuardException::UnlockedGuardException() : InvalidOperation(
+                "Invalid operation: "
+                "Cannot upgrade or downgrade a guard that has no lock."
+        ) {}
+
 // -------- ACTUAL MUTEX -------- //
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::RecursiveMutex() : HasOwner(false), LockGuardCount(0)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::RecursiveMutex()
+            : LockState(0), SpinBudget(InitialSpinBudget), Stats(nullptr), OrderNode(nullptr),
+              Owner(std::thread::id()), LockGuardCount(0), HoldStart(0), WaitingWritersCount(0)
         {
+            ENGINE_LOCK_PROFILE(Stats = LockProfiler::Register(this);)
+            ENGINE_LOCK_ORDER_CHECK(OrderNode = LockOrderChecker::Register(this);)
             if constexpr (SupportsSharedLock)
-                SharedOwnersRef = new Collections::Dictionary<std::thread::id, int, false>();
+                WaitingReadersCount = 0;
+            if constexpr (IsPhaseFair)
+            {
+                ReadersPhase = 0;
+                PhaseReadersCount = 0;
+                PendingReadersCount = 0;
+            }
             if constexpr (SupportsUpgradableSharedLock)
             {
-                HasUpgradableOwner = false;
+                UpgradableOwner.store(std::thread::id());
                 UpgradableLockGuardCount = 0;
+                UpgradableHoldStart = 0;
+                WaitingUpgradablesCount = 0;
+                IsUpgrading = false;
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::~RecursiveMutex()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::~RecursiveMutex()
         {
-            if constexpr (SupportsSharedLock)
-                delete SharedOwnersRef;
+            ENGINE_LOCK_PROFILE(LockProfiler::Unregister(Stats);)
+            ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Unregister(OrderNode);)
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SetName(std::string Name)
+        {
+            (void)Name; // Unused if neither lock profiling nor lock order checking is enabled
+            ENGINE_LOCK_PROFILE(LockProfiler::SetName(Stats, Name);)
+            ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::SetName(OrderNode, Name);)
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockGuard
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::GetLock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockGuard
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::GetLock()
         {
             return LockGuard(this);
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::TryGetLock(LockGuard& GuardOut)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryGetLock(LockGuard& GuardOut)
         {
             if (TryLock() != LockedByOtherThreads)
             {
@@ -266,9 +477,26 @@ namespace Engine
             else return false;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockGuard
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::_GetSharedLock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryGetLockUntil(LockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline)
+        {
+            if (LockOperation(Deadline) != LockedByOtherThreads)
+            {
+                GuardOut = LockGuard(this);
+                return true;
+            }
+            else return false;
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryGetLockFor(LockGuard& GuardOut, std::chrono::steady_clock::duration Timeout)
+        {
+            return TryGetLockUntil(GuardOut, std::chrono::steady_clock::now() + Timeout);
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockGuard
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::_GetSharedLock()
         {
             if constexpr (SupportsSharedLock)
                 return SharedLockGuard(this);
@@ -276,8 +504,8 @@ namespace Engine
                 return SharedLockGuard(nullptr);
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::_TryGetSharedLock(SharedLockGuard& GuardOut)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::_TryGetSharedLock(SharedLockGuard& GuardOut)
         {
             if constexpr (SupportsSharedLock)
             {
@@ -292,9 +520,25 @@ namespace Engine
                 return false;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockGuard
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::_GetUpgradableSharedLock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::_TryGetSharedLockUntil(SharedLockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline)
+        {
+            if constexpr (SupportsSharedLock)
+            {
+                if (SharedLockOperation(Deadline) != LockedByOtherThreads)
+                {
+                    GuardOut = SharedLockGuard(this);
+                    return true;
+                }
+                else return false;
+            }
+            else
+                return false;
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockGuard
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::_GetUpgradableSharedLock()
         {
             if constexpr (SupportsUpgradableSharedLock)
                 return UpgradableSharedLockGuard(this);
@@ -302,8 +546,8 @@ namespace Engine
                 return UpgradableSharedLockGuard(nullptr);
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::_TryGetUpgradableSharedLock(UpgradableSharedLockGuard& GuardOut)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::_TryGetUpgradableSharedLock(UpgradableSharedLockGuard& GuardOut)
         {
             if constexpr (SupportsUpgradableSharedLock)
             {
@@ -318,93 +562,248 @@ namespace Engine
                 return false;
         }
 
-        // Lock - behind the scenes
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::_TryGetUpgradableSharedLockUntil(
+                UpgradableSharedLockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline
+        ) {
+            if constexpr (SupportsUpgradableSharedLock)
+            {
+                if (UpgradableSharedLockOperation(Deadline) != LockedByOtherThreads)
+                {
+                    GuardOut = UpgradableSharedLockGuard(this);
+                    return true;
+                }
+                else return false;
+            }
+            else
+                return false;
+        }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockByGuard()
+        // State - behind the scenes
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::CanLock(std::uint32_t State, bool Upgrading)
         {
-            std::unique_lock<std::mutex> m(StateMutex);
-            LockOperation(m);
-            LockGuardCount++;
+            // The pending readers of a PhaseFair mutex go before the next writer
+            if ((State & (OwnedBit | PendingReadersBit)) != 0 || State >= SharedOwnerUnit)
+                return false;
+            return Upgrading || (State & UpgradableOwnedBit) == 0;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::LockOperation(std::unique_lock<std::mutex>& m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::CanSharedLock(std::uint32_t State, bool IgnoreWaitingWriters)
         {
-            if (HasOwner && (Owner == std::this_thread::get_id()))
+            if ((State & OwnedBit) != 0)
                 return false;
+            // The upgrade waits only for the shared owners that came before it,
+            // but the pending readers of a PhaseFair mutex still go before it
+            if ((State & UpgradingBit) != 0)
+                return IgnoreWaitingWriters;
+            return Fairness == ReaderPreferring || IgnoreWaitingWriters || (State & WritersWaitingBit) == 0;
+        }
 
-            if constexpr (SupportsSharedLock)
-                if (SharedOwnersRef->Contains(std::this_thread::get_id()))
-                    throw LockAfterSharedLockException();
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::CanUpgradableSharedLock(std::uint32_t State)
+        {
+            return (State & (OwnedBit | UpgradableOwnedBit)) == 0;
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::IsOwner()
+        {
+            return Owner.load(std::memory_order_relaxed) == std::this_thread::get_id();
+        }
 
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::IsUpgradableOwner()
+        {
             if constexpr (SupportsUpgradableSharedLock)
+                return UpgradableOwner.load(std::memory_order_relaxed) == std::this_thread::get_id();
+            else
+                return false;
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        template <typename FunctionType>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryChangeState(FunctionType CanChange, std::uint32_t Value)
+        {
+            std::uint32_t state = LockState.load(std::memory_order_relaxed);
+            while (CanChange(state))
+                if (LockState.compare_exchange_weak(state, state + Value, std::memory_order_acquire, std::memory_order_relaxed))
+                    return true;
+            return false;
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        template <typename FunctionType>
+        bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::Spin(FunctionType TryAcquire)
+        {
+            if (!CanSpin)
+                return false;
+            int budget = SpinBudget.load(std::memory_order_relaxed);
+            int backoff = 1;
+            for (int spins = 0; spins < budget; )
             {
-                if (HasUpgradableOwner && (UpgradableOwner == std::this_thread::get_id()))
-                    ConditionVariable.wait(m, [&] {
-                        return !HasOwner && SharedOwnersRef->GetCount() == 0;
-                    });
-                else
-                    ConditionVariable.wait(m, [&] {
-                        return !HasOwner && SharedOwnersRef->GetCount() == 0 && !HasUpgradableOwner;
-                    });
+                for (int i = 0; i < backoff; i++)
+                    CpuPause();
+                spins += backoff;
+                if (TryAcquire())
+                {
+                    // Moves the budget towards twice the pauses needed, so a longer hold still fits
+                    SpinBudget.store(std::clamp(budget + (2 * spins - budget) / 8, MinSpinBudget, MaxSpinBudget), std::memory_order_relaxed);
+                    return true;
+                }
+                backoff = std::min(backoff * 2, MaxSpinBackoff);
             }
+            SpinBudget.store(std::max(budget - budget / 8, MinSpinBudget), std::memory_order_relaxed);
+            return false;
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SetWaitingBit(std::uint32_t Bit, bool Waiting)
+        {
+            if (Waiting)
+                LockState.fetch_or(Bit);
             else
+                LockState.fetch_and(~Bit);
+        }
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        template <typename FunctionType>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::Wait(
+                std::condition_variable& Condition, std::unique_lock<std::mutex>& Lock,
+                std::chrono::steady_clock::time_point Deadline, FunctionType TryAcquire
+        ) {
+            if (Deadline == NoDeadline)
             {
-                if constexpr (SupportsSharedLock)
-                    ConditionVariable.wait(m, [&] {
-                        return !HasOwner && SharedOwnersRef->GetCount() == 0;
-                    });
-                else
-                    ConditionVariable.wait(m, [&] {
-                        return !HasOwner;
-                    });
+                Condition.wait(Lock, TryAcquire);
+                return true;
             }
-
-            // Replaces upgradable-shared-lock with lock if it exists only by this thread
-            Owner = std::this_thread::get_id();
-            HasOwner = true;
-            return true;
+            return Condition.wait_until(Lock, Deadline, TryAcquire);
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::TryResult
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::TryLock()
-        {
-            std::lock_guard<std::mutex> guard(StateMutex);
+        // Lock - behind the scenes
 
-            if (HasOwner)
-                if (Owner == std::this_thread::get_id())
-                    return LockedByThisThread;
-                else
-                    return LockedByOtherThreads;
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockByGuard()
+        {
+            LockOperation();
+            LockGuardCount++;
+        }
 
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryResult
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::LockOperation(std::chrono::steady_clock::time_point Deadline)
+        {
+            if (IsOwner())
+                return LockedByThisThread;
+
+            // A timed acquisition gives up instead of deadlocking
+            ENGINE_LOCK_ORDER_CHECK(
+                if (Deadline == NoDeadline)
+                    LockOrderChecker::BeforeAcquire(OrderNode, ExclusiveLockKind);
+            )
             if constexpr (SupportsSharedLock)
-            {
-                if (SharedOwnersRef->Contains(std::this_thread::get_id()))
-                    throw TryLockAfterSharedLockException();
+                if (FindSharedLockSlot(this) != nullptr)
+                    throw LockAfterSharedLockException();
 
-                if (SharedOwnersRef->GetCount() > 0)
+            // Replaces upgradable-shared-lock with lock if it exists only by this thread
+            bool upgrading = IsUpgradableOwner();
+            auto try_lock = [&] {
+                return TryChangeState([&](std::uint32_t State) { return CanLock(State, upgrading); }, OwnedBit);
+            };
+
+            std::uint32_t state = 0;
+            if (!LockState.compare_exchange_strong(state, OwnedBit, std::memory_order_acquire, std::memory_order_relaxed)
+                && !try_lock())
+            {
+                ENGINE_LOCK_PROFILE(
+                    long long wait_start = LockProfiler::Now();
+                    std::thread::id contended_owner = Owner.load(std::memory_order_relaxed);
+                )
+                // Only the shared owners are left to wait for, the new ones are held back
+                if (upgrading)
+                    LockState.fetch_or(UpgradingBit, std::memory_order_relaxed);
+                bool acquired = true;
+                if (!Spin(try_lock))
+                {
+                    std::unique_lock<std::mutex> m(StateMutex);
+                    WaitingWritersCount++;
+                    SetWaitingBit(WritersWaitingBit, true);
+                    if constexpr (SupportsUpgradableSharedLock)
+                    {
+                        if (upgrading)
+                        {
+                            IsUpgrading = true;
+                            acquired = Wait(UpgradeCondition, m, Deadline, try_lock);
+                            IsUpgrading = false;
+                            SetWaitingBit(UpgradingBit, false);
+                        }
+                        else
+                            acquired = Wait(WritersCondition, m, Deadline, try_lock);
+                    }
+                    else
+                        acquired = Wait(WritersCondition, m, Deadline, try_lock);
+                    WaitingWritersCount--;
+                    if (WaitingWritersCount == 0)
+                        SetWaitingBit(WritersWaitingBit, false);
+                    // The readers may have waited for this writer to go first
+                    bool wake_readers = false;
+                    if constexpr (SupportsSharedLock)
+                        wake_readers = !acquired && WaitingReadersCount > 0 && (WaitingWritersCount == 0 || upgrading);
+                    m.unlock();
+                    if constexpr (SupportsSharedLock)
+                        if (wake_readers)
+                            ReadersCondition.notify_all();
+                }
+                else if (upgrading)
+                    LockState.fetch_and(~UpgradingBit, std::memory_order_relaxed);
+                ENGINE_LOCK_PROFILE(LockProfiler::RecordContention(Stats, LockProfiler::Now() - wait_start, contended_owner, acquired);)
+                if (!acquired)
                     return LockedByOtherThreads;
             }
 
-            if constexpr (SupportsUpgradableSharedLock)
-                if (HasUpgradableOwner && (UpgradableOwner != std::this_thread::get_id()))
-                    return LockedByOtherThreads;
+            Owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            ENGINE_LOCK_PROFILE(
+                LockProfiler::RecordAcquisition(Stats, ExclusiveLockKind);
+                HoldStart = LockProfiler::Now();
+            )
+            ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, ExclusiveLockKind);)
+            return LockSuccessful;
+        }
+
+
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryResult
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryLock()
+        {
+            if (IsOwner())
+                return LockedByThisThread;
+
+            if constexpr (SupportsSharedLock)
+                if (FindSharedLockSlot(this) != nullptr)
+                    throw TryLockAfterSharedLockException();
 
             // Replaces upgradable-shared-lock with lock if it exists only by this thread
-            Owner = std::this_thread::get_id();
-            HasOwner = true;
+            bool upgrading = IsUpgradableOwner();
+            if (!TryChangeState([&](std::uint32_t State) { return CanLock(State, upgrading); }, OwnedBit))
+                return LockedByOtherThreads;
+
+            Owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+            ENGINE_LOCK_PROFILE(
+                LockProfiler::RecordAcquisition(Stats, ExclusiveLockKind);
+                HoldStart = LockProfiler::Now();
+            )
+            ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, ExclusiveLockKind);)
             return LockSuccessful;
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UnlockByGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UnlockByGuard()
         {
-            std::unique_lock<std::mutex> m(StateMutex);
             LockGuardCount--;
             if (LockGuardCount == 0)
-                UnlockOperation(m); // May unlock m before returning
+                UnlockOperation();
             else if (LockGuardCount < 0)
                 throw std::logic_error(
                     "This is a bug if the LockGuardCount member is not modified. Current LockGuardCount value is: "
@@ -412,197 +811,367 @@ namespace Engine
                     );
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UnlockOperation(std::unique_lock<std::mutex>& m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UnlockOperation()
         {
-            if (HasOwner && (Owner == std::this_thread::get_id()))
+            if (!IsOwner())
+                return false;
+            ENGINE_LOCK_PROFILE(LockProfiler::RecordHoldTime(Stats, ExclusiveLockKind, LockProfiler::Now() - HoldStart);)
+            ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Released(OrderNode, ExclusiveLockKind);)
+
+            // Replaces with upgradable-shared-lock if this->UpgradableSharedLock() has been called
+            //                                      and this->UpgradableSharedUnlock() isn't called yet
+            Owner.store(std::thread::id(), std::memory_order_relaxed);
+
+            std::uint32_t state = LockState.load(std::memory_order_relaxed);
+            while ((state & (WritersWaitingBit | ReadersWaitingBit | UpgradablesWaitingBit)) == 0)
+                if (LockState.compare_exchange_weak(state, state - OwnedBit, std::memory_order_release, std::memory_order_relaxed))
+                    return true;
+
+            std::unique_lock<std::mutex> m(StateMutex);
+            bool wake_readers = false;
+            std::uint32_t pending_bit = 0;
+            if constexpr (IsPhaseFair)
             {
-                // Replaces with upgradable-shared-lock if this->UpgradableSharedLock() has been called
-                //                                      and this->UpgradableSharedUnlock() isn't called yet
-                HasOwner = false;
-                m.unlock();
-                ConditionVariable.notify_all(); // worst case: multiple shared-locks waiting
-                                                // all waiting cases: multiple shared-locks
-                                                //                    single lock
-                                                //                    single upgradable-lock
-                return true;
+                // The readers that waited for this writer go before the next one
+                PendingReadersCount += PhaseReadersCount;
+                PhaseReadersCount = 0;
+                ReadersPhase++;
+                wake_readers = PendingReadersCount > 0;
+                if (wake_readers)
+                    pending_bit = PendingReadersBit;
             }
-            return false;
+            else if constexpr (SupportsSharedLock)
+                wake_readers = WaitingReadersCount > 0 && (Fairness == ReaderPreferring || WaitingWritersCount == 0);
+
+            // Blocks the writers for the pending readers in the same step
+            state = LockState.load(std::memory_order_relaxed);
+            while (!LockState.compare_exchange_weak(state, (state - OwnedBit) | pending_bit, std::memory_order_release, std::memory_order_relaxed)) {}
+
+            // Only this thread can have the upgradable-shared-lock while it has the lock
+            bool has_upgradable_owner = (state & UpgradableOwnedBit) != 0;
+            bool wake_writer = (!wake_readers || Fairness == ReaderPreferring) && !has_upgradable_owner && WaitingWritersCount > 0;
+            bool wake_upgradable = false;
+            if constexpr (SupportsUpgradableSharedLock)
+                wake_upgradable = !has_upgradable_owner && WaitingUpgradablesCount > 0;
+
+            m.unlock();
+            if constexpr (SupportsSharedLock)
+                if (wake_readers)
+                    ReadersCondition.notify_all(); // All the waiting readers can shared-lock together
+            if (wake_writer)
+                WritersCondition.notify_one();
+            if constexpr (SupportsUpgradableSharedLock)
+                if (wake_upgradable)
+                    UpgradableCondition.notify_one();
+            return true;
         }
 
         // SharedLock - behind the scenes
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockByGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockByGuard()
         {
             if constexpr (SupportsSharedLock)
             {
-                std::unique_lock<std::mutex> m(StateMutex);
-                SharedLockOperation(m);
-                SharedOwnersRef->SetValue(std::this_thread::get_id(), SharedOwnersRef->GetValue(std::this_thread::get_id()) + 1);
+                // Only the first guard of the thread changes the state of the mutex
+                SharedLockSlot * slot = FindSharedLockSlot(this);
+                if (slot == nullptr)
+                {
+                    SharedLockOperation();
+                    slot = FindSharedLockSlot(this);
+                }
+                slot->GuardCount++;
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedLockOperation(std::unique_lock<std::mutex>& m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryResult
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedLockOperation(std::chrono::steady_clock::time_point Deadline)
         {
             if constexpr (SupportsSharedLock)
             {
-                if (SharedOwnersRef->Contains(std::this_thread::get_id()))
-                    return false;
+                if (FindSharedLockSlot(this) != nullptr)
+                    return LockedByThisThread;
 
-                if (HasOwner && (Owner == std::this_thread::get_id()))
+                if (IsOwner())
                 {
                     // The lock will be replaced by shared-lock on this->Unlock()
-                    SharedOwnersRef->SetValue(std::this_thread::get_id(), 0);
-                    return true;
+                    LockState.fetch_add(SharedOwnerUnit, std::memory_order_relaxed);
+                    AddSharedLockSlot(this);
+                    ENGINE_LOCK_PROFILE(LockProfiler::RecordAcquisition(Stats, SharedLockKind);)
+                    ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, SharedLockKind);)
+                    return LockSuccessful;
                 }
 
-                ConditionVariable.wait(m, [&] { return !HasOwner; });
-                SharedOwnersRef->SetValue(std::this_thread::get_id(), 0);
-                return true;
+                ENGINE_LOCK_ORDER_CHECK(
+                    if (Deadline == NoDeadline)
+                        LockOrderChecker::BeforeAcquire(OrderNode, SharedLockKind);
+                )
+                // The upgradable-shared-lock owner would wait for the writers that wait for it
+                bool ignore_waiting_writers = IsUpgradableOwner();
+                auto try_shared_lock = [&] {
+                    return TryChangeState([&](std::uint32_t State) { return CanSharedLock(State, ignore_waiting_writers); }, SharedOwnerUnit);
+                };
+
+                if (!try_shared_lock())
+                {
+                    ENGINE_LOCK_PROFILE(
+                        long long wait_start = LockProfiler::Now();
+                        std::thread::id contended_owner = Owner.load(std::memory_order_relaxed);
+                    )
+                    bool acquired = true;
+                    if (!Spin(try_shared_lock))
+                    {
+                        std::unique_lock<std::mutex> m(StateMutex);
+                        WaitingReadersCount++;
+                        SetWaitingBit(ReadersWaitingBit, true);
+                        bool wake_writer = false;
+                        if constexpr (IsPhaseFair)
+                        {
+                            unsigned phase = ReadersPhase;
+                            PhaseReadersCount++;
+                            acquired = Wait(ReadersCondition, m, Deadline, [&] {
+                                return TryChangeState([&](std::uint32_t State) {
+                                    return CanSharedLock(State, ignore_waiting_writers || ReadersPhase != phase);
+                                }, SharedOwnerUnit);
+                            });
+                            if (ReadersPhase != phase)
+                            {
+                                PendingReadersCount--;
+                                if (PendingReadersCount == 0)
+                                {
+                                    SetWaitingBit(PendingReadersBit, false);
+                                    // The writers waited for this reader to go first
+                                    wake_writer = !acquired && WaitingWritersCount > 0;
+                                }
+                            }
+                            else
+                                PhaseReadersCount--;
+                        }
+                        else
+                            acquired = Wait(ReadersCondition, m, Deadline, try_shared_lock);
+                        WaitingReadersCount--;
+                        if (WaitingReadersCount == 0)
+                            SetWaitingBit(ReadersWaitingBit, false);
+                        m.unlock();
+                        if (wake_writer)
+                            WritersCondition.notify_one();
+                    }
+                    ENGINE_LOCK_PROFILE(LockProfiler::RecordContention(Stats, LockProfiler::Now() - wait_start, contended_owner, acquired);)
+                    if (!acquired)
+                        return LockedByOtherThreads;
+                }
+
+                AddSharedLockSlot(this);
+                ENGINE_LOCK_PROFILE(LockProfiler::RecordAcquisition(Stats, SharedLockKind);)
+                ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, SharedLockKind);)
+                return LockSuccessful;
             }
-            else return false; // Dummy
+            else return LockedByOtherThreads; // Dummy
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::TryResult
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::TrySharedLock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryResult
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TrySharedLock()
         {
             if constexpr (SupportsSharedLock)
             {
-                std::lock_guard<std::mutex> guard(StateMutex);
-
-                if (SharedOwnersRef->Contains(std::this_thread::get_id()))
+                if (FindSharedLockSlot(this) != nullptr)
                     return LockedByThisThread;
-                if (HasOwner && (Owner != std::this_thread::get_id()))
-                    return LockedByOtherThreads;
 
-                SharedOwnersRef->SetValue(std::this_thread::get_id(), 0);
+                if (IsOwner())
+                    LockState.fetch_add(SharedOwnerUnit, std::memory_order_relaxed);
+                else
+                {
+                    bool ignore_waiting_writers = IsUpgradableOwner();
+                    if (!TryChangeState([&](std::uint32_t State) { return CanSharedLock(State, ignore_waiting_writers); }, SharedOwnerUnit))
+                        return LockedByOtherThreads;
+                }
+
+                AddSharedLockSlot(this);
+                ENGINE_LOCK_PROFILE(LockProfiler::RecordAcquisition(Stats, SharedLockKind);)
+                ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, SharedLockKind);)
                 return LockSuccessful;
             }
             else return LockedByOtherThreads; // Dummy
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedUnlockByGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedUnlockByGuard()
         {
             if constexpr (SupportsSharedLock)
             {
-                std::unique_lock<std::mutex> m(StateMutex);
-                int SharedLockGuardsCount = SharedOwnersRef->GetValue(std::this_thread::get_id());
-                SharedLockGuardsCount--;
-                SharedOwnersRef->SetValue(std::this_thread::get_id(), SharedLockGuardsCount);
-                if (SharedLockGuardsCount == 0)
-                    SharedUnlockOperation(m); // May unlock m before returning
-                else if (SharedLockGuardsCount < 0)
+                SharedLockSlot * slot = FindSharedLockSlot(this);
+                if (slot == nullptr)
+                    throw std::logic_error("This is a bug if the shared-lock slots are not modified. The slot of this thread is missing.");
+                slot->GuardCount--;
+                if (slot->GuardCount == 0)
+                    SharedUnlockOperation();
+                else if (slot->GuardCount < 0)
                     throw std::logic_error(
-                        "This is a bug if the SharedOwners member is not modified. "
-                        "Current SharedOwnersRef->GetValue(std::this_thread::get_id()) value is: "
-                        + std::to_string(SharedLockGuardsCount)
+                        "This is a bug if the shared-lock slots are not modified. Current GuardCount value is: "
+                        + std::to_string(slot->GuardCount)
                         );
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::SharedUnlockOperation(std::unique_lock<std::mutex>& m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::SharedUnlockOperation()
         {
             if constexpr (SupportsSharedLock)
             {
-                if (SharedOwnersRef->Contains(std::this_thread::get_id()))
+                SharedLockSlot * slot = FindSharedLockSlot(this);
+                if (slot == nullptr)
+                    return false;
+                ENGINE_LOCK_PROFILE(LockProfiler::RecordHoldTime(Stats, SharedLockKind, LockProfiler::Now() - slot->HoldStart);)
+                ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Released(OrderNode, SharedLockKind);)
+                RemoveSharedLockSlot(slot);
+
+                // Only the last reader can let a waiting writer in
+                std::uint32_t state = LockState.load(std::memory_order_relaxed);
+                while (state >= 2 * SharedOwnerUnit || (state & WritersWaitingBit) == 0)
+                    if (LockState.compare_exchange_weak(state, state - SharedOwnerUnit, std::memory_order_release, std::memory_order_relaxed))
+                        return true;
+
+                std::unique_lock<std::mutex> m(StateMutex);
+                state = LockState.fetch_sub(SharedOwnerUnit, std::memory_order_release) - SharedOwnerUnit;
+                bool wake_upgrading = false;
+                bool wake_writer = false;
+                if (state < SharedOwnerUnit && (state & OwnedBit) == 0)
                 {
-                    SharedOwnersRef->Remove(std::this_thread::get_id());
-                    m.unlock();
                     if constexpr (SupportsUpgradableSharedLock)
-                        ConditionVariable.notify_all(); // worst case: single lock waiting after upgradable-shared-lock
-                                                        //             while other locks wait (and cannot lock)
-                                                        // other waiting cases: single lock
-                    else
-                        ConditionVariable.notify_one(); // worst case: single lock
-                                                        // all waiting cases: single lock
-                    return true;
+                        wake_upgrading = IsUpgrading;
+                    wake_writer = !wake_upgrading && WaitingWritersCount > 0;
                 }
-                return false;
+
+                m.unlock();
+                if constexpr (SupportsUpgradableSharedLock)
+                    if (wake_upgrading)
+                        UpgradeCondition.notify_one();
+                if (wake_writer)
+                    WritersCondition.notify_one();
+                return true;
             }
             else return false; // Dummy
         }
 
         // UpgradableSharedLock - behind the scenes
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockByGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockByGuard()
         {
             if constexpr (SupportsUpgradableSharedLock)
             {
-                std::unique_lock<std::mutex> m(StateMutex);
-                UpgradableSharedLockOperation(m);
+                UpgradableSharedLockOperation();
                 UpgradableLockGuardCount++;
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedLockOperation(std::unique_lock<std::mutex>& m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryResult
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedLockOperation(std::chrono::steady_clock::time_point Deadline)
         {
             if constexpr (SupportsUpgradableSharedLock)
             {
-                if (HasUpgradableOwner && (UpgradableOwner == std::this_thread::get_id()))
-                    return false;
+                if (IsUpgradableOwner())
+                    return LockedByThisThread;
 
-                if (HasOwner && (Owner == std::this_thread::get_id())) // And of course, && !HasUpgradableOwner
+                if (IsOwner()) // And of course, && !IsUpgradableOwner()
                 {
                     // The lock will be replaced by upgradable-shared-lock on this->Unlock()
-                    UpgradableOwner = std::this_thread::get_id();
-                    HasUpgradableOwner = true;
-                    return true;
+                    LockState.fetch_add(UpgradableOwnedBit, std::memory_order_relaxed);
+                    UpgradableOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                    ENGINE_LOCK_PROFILE(
+                        LockProfiler::RecordAcquisition(Stats, UpgradableSharedLockKind);
+                        UpgradableHoldStart = LockProfiler::Now();
+                    )
+                    ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, UpgradableSharedLockKind);)
+                    return LockSuccessful;
                 }
 
-                if (SharedOwnersRef->Contains(std::this_thread::get_id()))
+                ENGINE_LOCK_ORDER_CHECK(
+                    if (Deadline == NoDeadline)
+                        LockOrderChecker::BeforeAcquire(OrderNode, UpgradableSharedLockKind);
+                )
+                if (FindSharedLockSlot(this) != nullptr)
                     throw UpgradableSharedLockAfterSharedLockException();
 
-                ConditionVariable.wait(m, [&] { return !HasUpgradableOwner && !HasOwner; });
-                UpgradableOwner = std::this_thread::get_id();
-                HasUpgradableOwner = true;
-                return true;
+                auto try_upgradable_shared_lock = [&] { return TryChangeState(CanUpgradableSharedLock, UpgradableOwnedBit); };
+                if (!try_upgradable_shared_lock())
+                {
+                    // Waits either for the owner or for the upgradable-shared-lock owner
+                    ENGINE_LOCK_PROFILE(
+                        long long wait_start = LockProfiler::Now();
+                        std::thread::id contended_owner = Owner.load(std::memory_order_relaxed);
+                        if (contended_owner == std::thread::id())
+                            contended_owner = UpgradableOwner.load(std::memory_order_relaxed);
+                    )
+                    bool acquired = true;
+                    if (!Spin(try_upgradable_shared_lock))
+                    {
+                        std::unique_lock<std::mutex> m(StateMutex);
+                        WaitingUpgradablesCount++;
+                        SetWaitingBit(UpgradablesWaitingBit, true);
+                        acquired = Wait(UpgradableCondition, m, Deadline, try_upgradable_shared_lock);
+                        WaitingUpgradablesCount--;
+                        if (WaitingUpgradablesCount == 0)
+                            SetWaitingBit(UpgradablesWaitingBit, false);
+                    }
+                    ENGINE_LOCK_PROFILE(LockProfiler::RecordContention(Stats, LockProfiler::Now() - wait_start, contended_owner, acquired);)
+                    if (!acquired)
+                        return LockedByOtherThreads;
+                }
+
+                UpgradableOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                ENGINE_LOCK_PROFILE(
+                    LockProfiler::RecordAcquisition(Stats, UpgradableSharedLockKind);
+                    UpgradableHoldStart = LockProfiler::Now();
+                )
+                ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, UpgradableSharedLockKind);)
+                return LockSuccessful;
             }
-            else return false; // Dummy
+            else return LockedByOtherThreads; // Dummy
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::TryResult
-        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::TryUpgradableSharedLock()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        typename RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryResult
+        RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::TryUpgradableSharedLock()
         {
             if constexpr (SupportsUpgradableSharedLock)
             {
-                std::lock_guard<std::mutex> guard(StateMutex);
+                if (IsUpgradableOwner())
+                    return LockedByThisThread;
 
-                if (HasUpgradableOwner)
-                    if (UpgradableOwner == std::this_thread::get_id())
-                        return LockedByThisThread;
-                    else
+                if (IsOwner())
+                    LockState.fetch_add(UpgradableOwnedBit, std::memory_order_relaxed);
+                else
+                {
+                    if (FindSharedLockSlot(this) != nullptr)
+                        throw UpgradableSharedLockAfterSharedLockException();
+                    if (!TryChangeState(CanUpgradableSharedLock, UpgradableOwnedBit))
                         return LockedByOtherThreads;
+                }
 
-                if (HasOwner && (Owner != std::this_thread::get_id()))
-                    return LockedByOtherThreads;
-
-                if (SharedOwnersRef->Contains(std::this_thread::get_id()))
-                    throw UpgradableSharedLockAfterSharedLockException();
-
-                UpgradableOwner = std::this_thread::get_id();
-                HasUpgradableOwner = true;
+                UpgradableOwner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+                ENGINE_LOCK_PROFILE(
+                    LockProfiler::RecordAcquisition(Stats, UpgradableSharedLockKind);
+                    UpgradableHoldStart = LockProfiler::Now();
+                )
+                ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Acquired(OrderNode, UpgradableSharedLockKind);)
                 return LockSuccessful;
             }
             else return LockedByOtherThreads; // Dummy
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedUnlockByGuard()
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        void RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedUnlockByGuard()
         {
             if constexpr (SupportsUpgradableSharedLock)
             {
-                std::unique_lock<std::mutex> m(StateMutex);
                 UpgradableLockGuardCount--;
                 if (UpgradableLockGuardCount == 0)
-                    UpgradableSharedUnlockOperation(m); // May unlock m before returning
+                    UpgradableSharedUnlockOperation();
                 else if (UpgradableLockGuardCount < 0)
                     throw std::logic_error(
                         "This is a bug if the UpgradableLockGuardCount member is not modified. Current UpgradableLockGuardCount value is: "
@@ -611,41 +1180,78 @@ namespace Engine
             }
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
-        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock>::UpgradableSharedUnlockOperation(std::unique_lock<std::mutex>& m)
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
+        inline bool RecursiveMutex<SupportsSharedLock, SupportsUpgradableSharedLock, Fairness>::UpgradableSharedUnlockOperation()
         {
             if constexpr (SupportsUpgradableSharedLock)
             {
-                if (HasUpgradableOwner && (UpgradableOwner == std::this_thread::get_id()))
-                {
-                    HasUpgradableOwner = false;
-                    m.unlock();
-                    ConditionVariable.notify_one(); // worst case: single lock waiting
-                                                    // all waiting cases: single lock
-                                                    //                    single upgradable-shared-lock
-                    return true;
-                }
-                return false;
+                if (!IsUpgradableOwner())
+                    return false;
+                ENGINE_LOCK_PROFILE(
+                    LockProfiler::RecordHoldTime(Stats, UpgradableSharedLockKind, LockProfiler::Now() - UpgradableHoldStart);
+                )
+                ENGINE_LOCK_ORDER_CHECK(LockOrderChecker::Released(OrderNode, UpgradableSharedLockKind);)
+                UpgradableOwner.store(std::thread::id(), std::memory_order_relaxed);
+
+                std::uint32_t state = LockState.load(std::memory_order_relaxed);
+                while ((state & (WritersWaitingBit | UpgradablesWaitingBit)) == 0)
+                    if (LockState.compare_exchange_weak(state, state - UpgradableOwnedBit, std::memory_order_release, std::memory_order_relaxed))
+                        return true;
+
+                std::unique_lock<std::mutex> m(StateMutex);
+                state = LockState.fetch_sub(UpgradableOwnedBit, std::memory_order_release) - UpgradableOwnedBit;
+                // Only this thread can have the lock while it has the upgradable-shared-lock
+                bool has_owner = (state & OwnedBit) != 0;
+                bool wake_upgradable = !has_owner && WaitingUpgradablesCount > 0;
+                bool wake_writer = !has_owner && WaitingWritersCount > 0;
+
+                m.unlock();
+                if (wake_upgradable)
+                    UpgradableCondition.notify_one();
+                if (wake_writer)
+                    WritersCondition.notify_one();
+                return true;
             }
             else return false; // Dummy
         }
 
         // Usable template parameters
 
-        template class RecursiveMutex<false, false>;
-        template class RecursiveMutex<true, false>;
-        template class RecursiveMutex<true, true>;
-
-        // Usable member functions
-
-        template RecursiveMutex<true, false>::SharedLockGuard RecursiveMutex<true, false>::GetSharedLock();
-        template RecursiveMutex<true, true>::SharedLockGuard  RecursiveMutex<true, true>::GetSharedLock();
-
-        template bool RecursiveMutex<true, false>::TryGetSharedLock(RecursiveMutex<true, false>::SharedLockGuard&);
-        template bool RecursiveMutex<true, true>::TryGetSharedLock(RecursiveMutex<true, true>::SharedLockGuard&);
-
-        template RecursiveMutex<true, true>::UpgradableSharedLockGuard RecursiveMutex<true, true>::GetUpgradableSharedLock();
-
-        template bool RecursiveMutex<true, true>::TryGetUpgradableSharedLock(RecursiveMutex<true, true>::UpgradableSharedLockGuard&);
+#define ENGINE_RECURSIVE_MUTEX_INSTANTIATE(Fairness) \
+        template class RecursiveMutex<false, false, Fairness>; \
+        template class RecursiveMutex<true, false, Fairness>; \
+        template class RecursiveMutex<true, true, Fairness>; \
+        \
+        template RecursiveMutex<true, false, Fairness>::SharedLockGuard RecursiveMutex<true, false, Fairness>::GetSharedLock(); \
+        template RecursiveMutex<true, true, Fairness>::SharedLockGuard  RecursiveMutex<true, true, Fairness>::GetSharedLock(); \
+        \
+        template RecursiveMutex<true, false, Fairness>::SharedLockGuard RecursiveMutex<true, false, Fairness>::LockGuard::Downgrade(); \
+        template RecursiveMutex<true, true, Fairness>::SharedLockGuard  RecursiveMutex<true, true, Fairness>::LockGuard::Downgrade(); \
+        \
+        template bool RecursiveMutex<true, false, Fairness>::TryGetSharedLock(RecursiveMutex<true, false, Fairness>::SharedLockGuard&); \
+        template bool RecursiveMutex<true, true, Fairness>::TryGetSharedLock(RecursiveMutex<true, true, Fairness>::SharedLockGuard&); \
+        \
+        template bool RecursiveMutex<true, false, Fairness>::TryGetSharedLockUntil( \
+                RecursiveMutex<true, false, Fairness>::SharedLockGuard&, std::chrono::steady_clock::time_point); \
+        template bool RecursiveMutex<true, true, Fairness>::TryGetSharedLockUntil( \
+                RecursiveMutex<true, true, Fairness>::SharedLockGuard&, std::chrono::steady_clock::time_point); \
+        template bool RecursiveMutex<true, false, Fairness>::TryGetSharedLockFor( \
+                RecursiveMutex<true, false, Fairness>::SharedLockGuard&, std::chrono::steady_clock::duration); \
+        template bool RecursiveMutex<true, true, Fairness>::TryGetSharedLockFor( \
+                RecursiveMutex<true, true, Fairness>::SharedLockGuard&, std::chrono::steady_clock::duration); \
+        \
+        template RecursiveMutex<true, true, Fairness>::UpgradableSharedLockGuard RecursiveMutex<true, true, Fairness>::GetUpgradableSharedLock(); \
+        \
+        template bool RecursiveMutex<true, true, Fairness>::TryGetUpgradableSharedLock(RecursiveMutex<true, true, Fairness>::UpgradableSharedLockGuard&); \
+        template bool RecursiveMutex<true, true, Fairness>::TryGetUpgradableSharedLockUntil( \
+                RecursiveMutex<true, true, Fairness>::UpgradableSharedLockGuard&, std::chrono::steady_clock::time_point); \
+        template bool RecursiveMutex<true, true, Fairness>::TryGetUpgradableSharedLockFor( \
+                RecursiveMutex<true, true, Fairness>::UpgradableSharedLockGuard&, std::chrono::steady_clock::duration);
+
+        ENGINE_RECURSIVE_MUTEX_INSTANTIATE(ReaderPreferring)
+        ENGINE_RECURSIVE_MUTEX_INSTANTIATE(WriterPreferring)
+        ENGINE_RECURSIVE_MUTEX_INSTANTIATE(PhaseFair)
+
+#undef ENGINE_RECURSIVE_MUTEX_INSTANTIATE
     }
 }
@@ -13,39 +13,41 @@ namespace Engine
                 friend LockAfterSharedLockException;
                 friend TryLockAfterSharedLockException;
                 friend UpgradableSharedLockAfterSharedLockException;
+                friend UnlockedGuardException;
             private:
                 InvalidOperation(const char*);
             };
 
             class LockAfterSharedLockException : public InvalidOperation
             {
-                friend RecursiveMutex<false, false>;
-                friend RecursiveMutex<true, false>;
-                friend RecursiveMutex<true, true>;
+                template <bool, bool, RecursiveMutexFairness> friend class Utilities::RecursiveMutex;
             private:
                 LockAfterSharedLockException();
             };
 
             class TryLockAfterSharedLockException : public InvalidOperation
             {
-                friend RecursiveMutex<false, false>;
-                friend RecursiveMutex<true, false>;
-                friend RecursiveMutex<true, true>;
+                template <bool, bool, RecursiveMutexFairness> friend class Utilities::RecursiveMutex;
             private:
                 TryLockAfterSharedLockException();
             };
 
             class UpgradableSharedLockAfterSharedLockException : public InvalidOperation
             {
-                friend RecursiveMutex<false, false>;
-                friend RecursiveMutex<true, false>;
-                friend RecursiveMutex<true, true>;
+                template <bool, bool, RecursiveMutexFairness> friend class Utilities::RecursiveMutex;
             private:
                 UpgradableSharedLockAfterSharedLockException();
             };
+
+            class UnlockedGuardException : public InvalidOperation
+            {
+                template <bool, bool, RecursiveMutexFairness> friend class Utilities::RecursiveMutex;
+            private:
+                UnlockedGuardException();
+            };
         }
 
-        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock>
+        template <bool SupportsSharedLock, bool SupportsUpgradableSharedLock, RecursiveMutexFairness Fairness>
         class RecursiveMutex final
         {
             static_assert(
@@ -53,6 +55,8 @@ namespace Engine
                 "The mutex must support SharedLock in order to support UpgradableSharedLock."
             );
         public:
+            class SharedLockGuard;
+
             /// @brief Unlocks a RecursiveMutex lock on destruction.
             class LockGuard final
             {
@@ -65,10 +69,24 @@ namespace Engine
                 LockGuard& operator=(LockGuard&&);
                 /// @brief Unlocks the guard manually.
                 void Unlock();
+                /// @brief Shared-locks the mutex, then unlocks the guard.
+                ///
+                /// Never waits, as the thread has the lock, so no writer can come in between.
+                /// The readers waiting for the lock proceed together if the thread has no other lock guard.
+                ///
+                /// @return The shared-lock guard.
+                template <bool Dummy = SupportsSharedLock> // So that this is not defined by default
+                SharedLockGuard Downgrade()
+                {
+                    static_assert(SupportsSharedLock, "Shared-lock is not supported for this type.");
+                    return _Downgrade();
+                }
                 ~LockGuard();
             private:
                 LockGuard(RecursiveMutex * m);
                 RecursiveMutex * m;
+
+                SharedLockGuard _Downgrade();
             };
 
             /// @brief Unlocks a RecursiveMutex shared lock on destruction.
@@ -101,6 +119,14 @@ namespace Engine
                 UpgradableSharedLockGuard& operator=(UpgradableSharedLockGuard&&);
                 /// @brief Unlocks the guard manually.
                 void Unlock();
+                /// @brief Locks the mutex, then unlocks the guard.
+                ///
+                /// Waits only for the threads that shared-locked before it:
+                /// no other writer can lock while the guard has the upgradable-shared-lock
+                /// and the new shared-locks wait until the upgrade is done, whatever the Fairness.
+                ///
+                /// @return The lock guard.
+                LockGuard Upgrade();
                 ~UpgradableSharedLockGuard();
             private:
                 UpgradableSharedLockGuard(RecursiveMutex * m);
@@ -121,9 +147,16 @@ namespace Engine
 
             typedef RecursiveMutexExceptions::UpgradableSharedLockAfterSharedLockException UpgradableSharedLockAfterSharedLockException;
 
+            typedef RecursiveMutexExceptions::UnlockedGuardException UnlockedGuardException;
+
             RecursiveMutex();
             ~RecursiveMutex();
 
+            /// @brief Names the mutex in the reports of the LockProfiler and the LockOrderChecker, like "Loop.Modules".
+            ///
+            /// Does nothing unless ENGINE_LOCK_PROFILING or ENGINE_LOCK_ORDER_CHECKING is defined.
+            void SetName(std::string Name);
+
             /// @brief Locks the mutex and returns the lock guard.
             ///
             /// Avoid shared-locking and then locking,
@@ -143,6 +176,20 @@ namespace Engine
             /// @return Whether the mutex was not locked or shared-locked by another thread
             ///         in which case the lock is successful.
             bool TryGetLock(LockGuard& GuardOut);
+            /// @brief Locks the mutex unless the Deadline passes first
+            ///        and sets the GuardOut parameter if successful.
+            ///
+            /// Locking after shared-locking throws like GetLock.
+            ///
+            /// @param GuardOut The lock guard if any.
+            /// @return Whether the mutex was locked before the Deadline.
+            bool TryGetLockUntil(LockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline);
+            /// @brief Locks the mutex unless it takes longer than Timeout
+            ///        and sets the GuardOut parameter if successful.
+            ///
+            /// @param GuardOut The lock guard if any.
+            /// @return Whether the mutex was locked in time.
+            bool TryGetLockFor(LockGuard& GuardOut, std::chrono::steady_clock::duration Timeout);
 
             /// @brief Shared-locks the mutex and returns the lock guard.
             ///
@@ -179,6 +226,28 @@ namespace Engine
                 static_assert(SupportsSharedLock, "Shared-lock is not supported for this type.");
                 return _TryGetSharedLock(GuardOut);
             }
+            /// @brief Shared-locks the mutex unless the Deadline passes first
+            ///        and sets the GuardOut parameter if successful.
+            ///
+            /// @param GuardOut The lock guard if any.
+            /// @return Whether the mutex was shared-locked before the Deadline.
+            template <bool Dummy = SupportsSharedLock> // So that this is not defined by default
+            constexpr bool TryGetSharedLockUntil(SharedLockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline)
+            {
+                static_assert(SupportsSharedLock, "Shared-lock is not supported for this type.");
+                return _TryGetSharedLockUntil(GuardOut, Deadline);
+            }
+            /// @brief Shared-locks the mutex unless it takes longer than Timeout
+            ///        and sets the GuardOut parameter if successful.
+            ///
+            /// @param GuardOut The lock guard if any.
+            /// @return Whether the mutex was shared-locked in time.
+            template <bool Dummy = SupportsSharedLock> // So that this is not defined by default
+            constexpr bool TryGetSharedLockFor(SharedLockGuard& GuardOut, std::chrono::steady_clock::duration Timeout)
+            {
+                static_assert(SupportsSharedLock, "Shared-lock is not supported for this type.");
+                return _TryGetSharedLockUntil(GuardOut, std::chrono::steady_clock::now() + Timeout);
+            }
 
             /// @brief Acquires upgradable-shared-lock on the mutex and returns the lock guard.
             ///
@@ -207,51 +276,131 @@ namespace Engine
                 static_assert(SupportsUpgradableSharedLock, "Upgradable-shared-lock is not supported for this type.");
                 return _TryGetUpgradableSharedLock(GuardOut);
             }
+            /// @brief Acquires upgradable-shared-lock on the mutex unless the Deadline passes first
+            ///        and sets the GuardOut parameter if successful.
+            ///
+            /// @param GuardOut The lock guard if any.
+            /// @return Whether the upgradable-shared-lock was acquired before the Deadline.
+            template <bool Dummy = SupportsUpgradableSharedLock> // So that this is not defined by default
+            constexpr bool TryGetUpgradableSharedLockUntil(
+                    UpgradableSharedLockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline
+            ) {
+                static_assert(SupportsUpgradableSharedLock, "Upgradable-shared-lock is not supported for this type.");
+                return _TryGetUpgradableSharedLockUntil(GuardOut, Deadline);
+            }
+            /// @brief Acquires upgradable-shared-lock on the mutex unless it takes longer than Timeout
+            ///        and sets the GuardOut parameter if successful.
+            ///
+            /// @param GuardOut The lock guard if any.
+            /// @return Whether the upgradable-shared-lock was acquired in time.
+            template <bool Dummy = SupportsUpgradableSharedLock> // So that this is not defined by default
+            constexpr bool TryGetUpgradableSharedLockFor(
+                    UpgradableSharedLockGuard& GuardOut, std::chrono::steady_clock::duration Timeout
+            ) {
+                static_assert(SupportsUpgradableSharedLock, "Upgradable-shared-lock is not supported for this type.");
+                return _TryGetUpgradableSharedLockUntil(GuardOut, std::chrono::steady_clock::now() + Timeout);
+            }
         private:
             SharedLockGuard _GetSharedLock();
             bool _TryGetSharedLock(SharedLockGuard& GuardOut);
+            bool _TryGetSharedLockUntil(SharedLockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline);
             UpgradableSharedLockGuard _GetUpgradableSharedLock();
             bool _TryGetUpgradableSharedLock(UpgradableSharedLockGuard& GuardOut);
+            bool _TryGetUpgradableSharedLockUntil(UpgradableSharedLockGuard& GuardOut, std::chrono::steady_clock::time_point Deadline);
+
+            static constexpr bool IsPhaseFair = SupportsSharedLock && Fairness == PhaseFair;
+
+            /// @brief The deadline of the acquisitions that wait as long as needed.
+            static constexpr std::chrono::steady_clock::time_point NoDeadline = std::chrono::steady_clock::time_point::max();
+
+            // LockState bits, the number of shared owners is stored above them
+            static constexpr std::uint32_t OwnedBit = 1;
+            static constexpr std::uint32_t UpgradableOwnedBit = 1 << 1;
+            static constexpr std::uint32_t WritersWaitingBit = 1 << 2;
+            static constexpr std::uint32_t ReadersWaitingBit = 1 << 3;
+            static constexpr std::uint32_t UpgradablesWaitingBit = 1 << 4;
+            static constexpr std::uint32_t PendingReadersBit = 1 << 5;
+            // The upgradable-shared-lock owner is locking, no new shared-lock is acquired meanwhile
+            static constexpr std::uint32_t UpgradingBit = 1 << 6;
+            static constexpr std::uint32_t SharedOwnerUnit = 1 << 8;
 
+            /// @brief The state checked and changed by a single compare-exchange when there is no waiting thread.
+            ///
+            /// The waiting bits make the unlocks take the StateMutex to wake the waiting threads up.
+            std::atomic<std::uint32_t> LockState;
+            /// @brief The number of pauses to spin before waiting on a condition,
+            ///        following the number of pauses that the recent acquisitions needed.
+            std::atomic<int> SpinBudget;
+
+            // Guards the waiting counts, and the waiting bits of LockState
             std::mutex StateMutex;
-            std::condition_variable ConditionVariable;
 
             class Empty {};
 
+            // Lock profiling, Stats is nullptr unless ENGINE_LOCK_PROFILING is defined
+            LockStats * Stats;
+            // Lock-order checking, OrderNode is nullptr unless ENGINE_LOCK_ORDER_CHECKING is defined
+            LockOrderNode * OrderNode;
+
             // Lock variables
 
-            bool HasOwner;
-            std::thread::id Owner;
+            // Only the owner stores its id, so a thread finds its own id only if it owns the lock
+            std::atomic<std::thread::id> Owner;
+            // Only accessed by the owner
             int LockGuardCount;
+            long long HoldStart;
+            // Each kind of waiter has its own condition, so only the ones that may proceed are woken up
+            std::condition_variable WritersCondition;
+            // Including the upgradable-shared-lock owner waiting to lock
+            int WaitingWritersCount;
 
             // SharedLock variables
 
-            // Values: GuardCount
-            typename std::conditional<
-                SupportsSharedLock,
-                Collections::Dictionary<std::thread::id, int, false>*, // TODO: use map instead?
-                Empty
-            >::type SharedOwnersRef;
+            // Each thread counts its own shared-lock guards in a thread-local slot
+            typename std::conditional<SupportsSharedLock, std::condition_variable, Empty>::type ReadersCondition;
+            typename std::conditional<SupportsSharedLock, int, Empty>::type WaitingReadersCount;
+
+            // PhaseFair variables
+
+            // Incremented on every unlock, the readers that waited in a previous phase go before the next writer
+            typename std::conditional<IsPhaseFair, unsigned, Empty>::type ReadersPhase;
+            // The waiting readers that arrived in the current phase
+            typename std::conditional<IsPhaseFair, int, Empty>::type PhaseReadersCount;
+            // The waiting readers that arrived in a previous phase, no writer can lock until they shared-lock
+            typename std::conditional<IsPhaseFair, int, Empty>::type PendingReadersCount;
 
             // UpgradableSharedLock variables
 
-            typename std::conditional<SupportsUpgradableSharedLock, bool,            Empty>::type HasUpgradableOwner;
-            typename std::conditional<SupportsUpgradableSharedLock, std::thread::id, Empty>::type UpgradableOwner;
+            typename std::conditional<SupportsUpgradableSharedLock, std::atomic<std::thread::id>, Empty>::type UpgradableOwner;
             typename std::conditional<SupportsUpgradableSharedLock, int,             Empty>::type UpgradableLockGuardCount;
+            typename std::conditional<SupportsUpgradableSharedLock, long long,       Empty>::type UpgradableHoldStart;
+            typename std::conditional<SupportsUpgradableSharedLock, std::condition_variable, Empty>::type UpgradableCondition;
+            typename std::conditional<SupportsUpgradableSharedLock, int,             Empty>::type WaitingUpgradablesCount;
+            // The upgradable-shared-lock owner waits alone to lock, as no other writer can lock before it
+            typename std::conditional<SupportsUpgradableSharedLock, std::condition_variable, Empty>::type UpgradeCondition;
+            typename std::conditional<SupportsUpgradableSharedLock, bool,            Empty>::type IsUpgrading;
 
-            bool LockOperation(std::unique_lock<std::mutex>&);
-            bool UnlockOperation(std::unique_lock<std::mutex>&);
-            bool SharedLockOperation(std::unique_lock<std::mutex>&);
-            bool SharedUnlockOperation(std::unique_lock<std::mutex>&);
-            bool UpgradableSharedLockOperation(std::unique_lock<std::mutex>&);
-            bool UpgradableSharedUnlockOperation(std::unique_lock<std::mutex>&);
+            static bool CanLock(std::uint32_t State, bool Upgrading);
+            static bool CanSharedLock(std::uint32_t State, bool IgnoreWaitingWriters);
+            static bool CanUpgradableSharedLock(std::uint32_t State);
+            bool IsOwner();
+            bool IsUpgradableOwner();
 
-            void LockByGuard();
-            void UnlockByGuard();
-            void SharedLockByGuard();
-            void SharedUnlockByGuard();
-            void UpgradableSharedLockByGuard();
-            void UpgradableSharedUnlockByGuard();
+            /// @brief Adds Value to LockState if CanChange accepts it, retrying while LockState changes.
+            template <typename FunctionType>
+            bool TryChangeState(FunctionType CanChange, std::uint32_t Value);
+            /// @brief Calls TryAcquire with an exponential backoff until it succeeds or the spin budget is spent.
+            template <typename FunctionType>
+            bool Spin(FunctionType TryAcquire);
+            /// @brief Sets or clears a waiting bit, while StateMutex is locked.
+            void SetWaitingBit(std::uint32_t Bit, bool Waiting);
+            /// @brief Waits on Condition until TryAcquire succeeds or the Deadline passes.
+            /// @return Whether TryAcquire succeeded.
+            template <typename FunctionType>
+            static bool Wait(
+                    std::condition_variable& Condition, std::unique_lock<std::mutex>& Lock,
+                    std::chrono::steady_clock::time_point Deadline, FunctionType TryAcquire
+            );
 
             enum TryResult : std::int_fast8_t
             {
@@ -260,6 +409,21 @@ namespace Engine
                 LockSuccessful = 1
             };
 
+            // LockedByOtherThreads when the Deadline passed
+            TryResult LockOperation(std::chrono::steady_clock::time_point Deadline = NoDeadline);
+            bool UnlockOperation();
+            TryResult SharedLockOperation(std::chrono::steady_clock::time_point Deadline = NoDeadline);
+            bool SharedUnlockOperation();
+            TryResult UpgradableSharedLockOperation(std::chrono::steady_clock::time_point Deadline = NoDeadline);
+            bool UpgradableSharedUnlockOperation();
+
+            void LockByGuard();
+            void UnlockByGuard();
+            void SharedLockByGuard();
+            void SharedUnlockByGuard();
+            void UpgradableSharedLockByGuard();
+            void UpgradableSharedUnlockByGuard();
+
             TryResult TryLock();
             TryResult TrySharedLock();
             TryResult TryUpgradableSharedLock();
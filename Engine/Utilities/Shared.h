@@ -47,11 +47,62 @@ namespace Engine
             /// @brief Gets the shared variable.
             ///        Can be done by using this variable in an expression.
             Type Get();
+            /// @brief Sets the shared variable to Desired if it is equal to Expected, in one step.
+            /// @param Expected Is set to the current value if they are not equal.
+            /// @return true if the shared variable was set.
+            bool CompareExchange(Type& Expected, const Type& Desired);
+            /// @brief Adds Operand to the shared variable, in one step.
+            /// @return The previous value.
+            Type FetchAdd(const Type& Operand);
+
+#ifndef ENGINE_SHARED_MANUAL
+            /// @brief Checks if Set and Get never lock a mutex.
+            static constexpr bool IsLockFree();
+#endif
         private:
+#ifdef ENGINE_SHARED_MANUAL
             Type Value;
+#else
+            enum StorageType : std::int_fast8_t { AtomicStorage = 0, SequenceLockStorage = 1, MutexStorage = 2 };
 
-#ifndef ENGINE_SHARED_MANUAL
-            std::shared_mutex Mutex;
+            // Does not instantiate std::atomic<T> for the types it does not accept
+            template <typename T, bool = std::is_trivially_copyable<T>::value>
+            struct IsAlwaysLockFree { static constexpr bool Value = false; };
+            template <typename T>
+            struct IsAlwaysLockFree<T, true> { static constexpr bool Value = std::atomic<T>::is_always_lock_free; };
+
+            static constexpr StorageType Storage =
+                IsAlwaysLockFree<Type>::Value ? AtomicStorage
+                : std::is_trivially_copyable<Type>::value && std::is_default_constructible<Type>::value ? SequenceLockStorage
+                : MutexStorage;
+
+            // The value is copied word by word with atomic accesses, a reader retries if a write overlapped
+            struct SequenceLocked
+            {
+                static constexpr int WordsCount = (int)((sizeof(Type) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t));
+
+                /// @brief Odd while a write is in progress.
+                std::atomic<unsigned> Sequence{0};
+                std::atomic<std::uintptr_t> Words[WordsCount];
+            };
+
+            struct MutexLocked
+            {
+                Type Value;
+                std::shared_mutex Mutex;
+            };
+
+            typename std::conditional<Storage == AtomicStorage, std::atomic<Type>,
+                typename std::conditional<Storage == SequenceLockStorage, SequenceLocked, MutexLocked>::type
+            >::type Value;
+
+            Type Load();
+            void Store(const Type&);
+            /// @brief Starts a write of the sequence lock.
+            /// @return The sequence to store when the write is done.
+            unsigned BeginWrite();
+            void WriteWords(const Type&);
+            Type ReadWords();
 #endif
         };
     }
@@ -62,9 +113,6 @@ namespace Engine
 #ifdef ENGINE_SHARED_MANUAL
     #define ENGINE_SHARED_WRITE_ACCESS auto guard = Mutex.GetLock();
     #define ENGINE_SHARED_READ_ACCESS auto guard = Mutex.GetSharedLock();
-#else
-    #define ENGINE_SHARED_WRITE_ACCESS std::lock_guard<std::shared_mutex> guard(Mutex);
-    #define ENGINE_SHARED_READ_ACCESS std::shared_lock<std::shared_mutex> guard(Mutex);
 #endif
 
 namespace Engine
@@ -72,69 +120,55 @@ namespace Engine
     namespace Utilities
     {
         template <typename Type>
-        ENGINE_SHARED_CLASS_NAME::Shared(Shared<Type, false>& Operand)
-        {
-            std::shared_lock<std::shared_mutex> guard_op(Operand.Mutex);
-            Type Value = Operand.Value;
-            guard_op.unlock();
-            ENGINE_SHARED_WRITE_ACCESS;
-            this->Value = Value;
-        }
+        ENGINE_SHARED_CLASS_NAME::Shared(Shared<Type, false>& Operand) : ENGINE_SHARED_CLASS_NAME(Operand.Get()) {}
+
+        template <typename Type>
+        ENGINE_SHARED_CLASS_NAME::Shared(Shared<Type, true>& Operand) : ENGINE_SHARED_CLASS_NAME(Operand.Get()) {}
 
+#ifdef ENGINE_SHARED_MANUAL
         template <typename Type>
-        ENGINE_SHARED_CLASS_NAME::Shared(Shared<Type, true>& Operand)
+        ENGINE_SHARED_CLASS_NAME::Shared(const Type& Value)
         {
-            auto guard_op = Operand.Mutex.GetSharedLock();
-            Type Value = Operand.Value;
-            guard_op.Unlock();
             ENGINE_SHARED_WRITE_ACCESS;
             this->Value = Value;
         }
-
+#else
         template <typename Type>
         ENGINE_SHARED_CLASS_NAME::Shared(const Type& Value)
         {
-            ENGINE_SHARED_WRITE_ACCESS;
-            this->Value = Value;
+            Store(Value);
         }
+#endif
 
         template <typename Type>
         ENGINE_SHARED_CLASS_NAME& ENGINE_SHARED_CLASS_NAME::operator=(Shared<Type, false>& Operand)
         {
-            std::shared_lock<std::shared_mutex> guard_op(Operand.Mutex);
-            Type Value = Operand.Value;
-            guard_op.unlock();
-            ENGINE_SHARED_WRITE_ACCESS;
-            this->Value = Value;
+            Set(Operand.Get());
             return *this;
         }
 
         template <typename Type>
         ENGINE_SHARED_CLASS_NAME& ENGINE_SHARED_CLASS_NAME::operator=(Shared<Type, true>& Operand)
         {
-            auto guard_op = Operand.Mutex.GetSharedLock();
-            Type Value = Operand.Value;
-            guard_op.Unlock();
-            ENGINE_SHARED_WRITE_ACCESS;
-            this->Value = Value;
+            Set(Operand.Get());
             return *this;
         }
 
         template <typename Type>
         ENGINE_SHARED_CLASS_NAME& ENGINE_SHARED_CLASS_NAME::operator=(const Type& Value)
         {
-            ENGINE_SHARED_WRITE_ACCESS;
-            this->Value = Value;
+            Set(Value);
             return *this;
         }
 
         template <typename Type>
         ENGINE_SHARED_CLASS_NAME::operator Type()
         {
-            ENGINE_SHARED_READ_ACCESS;
-            return Value;
+            return Get();
         }
 
+#ifdef ENGINE_SHARED_MANUAL
+
         template <typename Type>
         void ENGINE_SHARED_CLASS_NAME::Set(const Type& Value)
         {
@@ -148,11 +182,203 @@ namespace Engine
             ENGINE_SHARED_READ_ACCESS;
             return Value;
         }
+
+        template <typename Type>
+        bool ENGINE_SHARED_CLASS_NAME::CompareExchange(Type& Expected, const Type& Desired)
+        {
+            ENGINE_SHARED_WRITE_ACCESS;
+            if (Value == Expected)
+            {
+                Value = Desired;
+                return true;
+            }
+            Expected = Value;
+            return false;
+        }
+
+        template <typename Type>
+        Type ENGINE_SHARED_CLASS_NAME::FetchAdd(const Type& Operand)
+        {
+            ENGINE_SHARED_WRITE_ACCESS;
+            Type previous = Value;
+            Value = previous + Operand;
+            return previous;
+        }
+
+#else
+
+        template <typename Type>
+        void ENGINE_SHARED_CLASS_NAME::Set(const Type& Value)
+        {
+            Store(Value);
+        }
+
+        template <typename Type>
+        Type ENGINE_SHARED_CLASS_NAME::Get()
+        {
+            return Load();
+        }
+
+        template <typename Type>
+        bool ENGINE_SHARED_CLASS_NAME::CompareExchange(Type& Expected, const Type& Desired)
+        {
+            if constexpr (Storage == AtomicStorage)
+                return Value.compare_exchange_strong(Expected, Desired);
+            else if constexpr (Storage == SequenceLockStorage)
+            {
+                unsigned sequence = BeginWrite();
+                Type current = ReadWords();
+                bool exchanged = current == Expected;
+                if (exchanged)
+                    WriteWords(Desired);
+                else
+                    Expected = current;
+                Value.Sequence.store(sequence, std::memory_order_release);
+                return exchanged;
+            }
+            else
+            {
+                std::lock_guard<std::shared_mutex> guard(Value.Mutex);
+                if (Value.Value == Expected)
+                {
+                    Value.Value = Desired;
+                    return true;
+                }
+                Expected = Value.Value;
+                return false;
+            }
+        }
+
+        template <typename Type>
+        Type ENGINE_SHARED_CLASS_NAME::FetchAdd(const Type& Operand)
+        {
+            if constexpr (Storage == AtomicStorage)
+            {
+                if constexpr (std::is_integral<Type>::value && !std::is_same<Type, bool>::value)
+                    return Value.fetch_add(Operand);
+                else
+                {
+                    Type previous = Value.load();
+                    while (!Value.compare_exchange_weak(previous, previous + Operand)) {}
+                    return previous;
+                }
+            }
+            else if constexpr (Storage == SequenceLockStorage)
+            {
+                unsigned sequence = BeginWrite();
+                Type previous = ReadWords();
+                WriteWords(previous + Operand);
+                Value.Sequence.store(sequence, std::memory_order_release);
+                return previous;
+            }
+            else
+            {
+                std::lock_guard<std::shared_mutex> guard(Value.Mutex);
+                Type previous = Value.Value;
+                Value.Value = previous + Operand;
+                return previous;
+            }
+        }
+
+        template <typename Type>
+        constexpr bool ENGINE_SHARED_CLASS_NAME::IsLockFree()
+        {
+            return Storage != MutexStorage;
+        }
+
+        template <typename Type>
+        inline Type ENGINE_SHARED_CLASS_NAME::Load()
+        {
+            if constexpr (Storage == AtomicStorage)
+                return Value.load();
+            else if constexpr (Storage == SequenceLockStorage)
+            {
+                for (int attempt = 0; ; attempt++)
+                {
+                    unsigned sequence = Value.Sequence.load(std::memory_order_acquire);
+                    if ((sequence & 1) == 0)
+                    {
+                        Type result = ReadWords();
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        if (Value.Sequence.load(std::memory_order_relaxed) == sequence)
+                            return result;
+                    }
+                    // The writer may have been preempted
+                    if (attempt >= 64)
+                        std::this_thread::yield();
+                }
+            }
+            else
+            {
+                std::shared_lock<std::shared_mutex> guard(Value.Mutex);
+                return Value.Value;
+            }
+        }
+
+        template <typename Type>
+        inline void ENGINE_SHARED_CLASS_NAME::Store(const Type& Value)
+        {
+            if constexpr (Storage == AtomicStorage)
+                this->Value.store(Value);
+            else if constexpr (Storage == SequenceLockStorage)
+            {
+                unsigned sequence = BeginWrite();
+                WriteWords(Value);
+                this->Value.Sequence.store(sequence, std::memory_order_release);
+            }
+            else
+            {
+                std::lock_guard<std::shared_mutex> guard(this->Value.Mutex);
+                this->Value.Value = Value;
+            }
+        }
+
+        template <typename Type>
+        unsigned ENGINE_SHARED_CLASS_NAME::BeginWrite()
+        {
+            for (int attempt = 0; ; attempt++)
+            {
+                unsigned sequence = Value.Sequence.load(std::memory_order_relaxed);
+                if ((sequence & 1) == 0
+                    && Value.Sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire))
+                {
+                    // Keeps the writes of the words after the odd sequence
+                    std::atomic_thread_fence(std::memory_order_release);
+                    return sequence + 2;
+                }
+                if (attempt >= 64)
+                    std::this_thread::yield();
+            }
+        }
+
+        template <typename Type>
+        void ENGINE_SHARED_CLASS_NAME::WriteWords(const Type& Value)
+        {
+            std::uintptr_t words[SequenceLocked::WordsCount] = {};
+            std::memcpy(words, &Value, sizeof(Type));
+            for (int i = 0; i < SequenceLocked::WordsCount; i++)
+                this->Value.Words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        template <typename Type>
+        Type ENGINE_SHARED_CLASS_NAME::ReadWords()
+        {
+            std::uintptr_t words[SequenceLocked::WordsCount];
+            for (int i = 0; i < SequenceLocked::WordsCount; i++)
+                words[i] = Value.Words[i].load(std::memory_order_relaxed);
+            Type result;
+            std::memcpy(&result, words, sizeof(Type));
+            return result;
+        }
+
+#endif
     }
 }
 
-#undef ENGINE_SHARED_WRITE_ACCESS
-#undef ENGINE_SHARED_READ_ACCESS
+#ifdef ENGINE_SHARED_MANUAL
+    #undef ENGINE_SHARED_WRITE_ACCESS
+    #undef ENGINE_SHARED_READ_ACCESS
+#endif
 
 #undef ENGINE_SHARED_CLASS_NAME
 
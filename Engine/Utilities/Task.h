@@ -0,0 +1,271 @@
+#pragma once
+
+#include "../Engine.dec.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        /// Functions that fit in InlineSize bytes and are nothrow movable are stored inline,
+        /// so creating and moving the task does not allocate. Bigger ones are allocated on the heap.
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        class Task<ReturnType(ArgumentsTypes...), InlineSize> final
+        {
+            static_assert(InlineSize >= sizeof(void*), "InlineSize is less than the size of a pointer.");
+
+            template <typename FunctionType>
+            using EnableIfCallable = typename std::enable_if<
+                !std::is_same<typename std::decay<FunctionType>::type, Task>::value
+                && std::is_invocable_r<ReturnType, typename std::decay<FunctionType>::type&, ArgumentsTypes...>::value
+            >::type;
+        public:
+            /// @brief Creates an empty task.
+            Task() noexcept;
+            /// @brief Creates an empty task.
+            Task(std::nullptr_t) noexcept;
+            /// @brief Stores a function, a lambda or any other callable object.
+            ///
+            /// A null function pointer or an empty std::function results in an empty task.
+            template <typename FunctionType, typename = EnableIfCallable<FunctionType>>
+            Task(FunctionType&& Function);
+            ~Task();
+
+            Task(const Task&) = delete;
+            Task& operator=(const Task&) = delete;
+
+            /// @brief Takes the function of Other, leaving it empty.
+            Task(Task&& Other) noexcept;
+            /// @brief Takes the function of Other, leaving it empty.
+            Task& operator=(Task&& Other) noexcept;
+            /// @brief Destroys the function, leaving the task empty.
+            Task& operator=(std::nullptr_t) noexcept;
+
+            /// @brief Calls the stored function.
+            /// @throws std::bad_function_call if the task is empty.
+            ReturnType operator()(ArgumentsTypes... Arguments);
+
+            /// @brief Checks if the task has a function.
+            explicit operator bool() const noexcept;
+            bool operator==(std::nullptr_t) const noexcept;
+            bool operator!=(std::nullptr_t) const noexcept;
+
+            /// @brief Checks if the function is stored without a heap allocation.
+            bool IsInline() const noexcept;
+        private:
+            struct Operations
+            {
+                ReturnType (*Invoke)(void * Storage, ArgumentsTypes&&... Arguments);
+                /// @brief Move-constructs the function in Destination and destroys the one in Source.
+                void (*Relocate)(void * Destination, void * Source) noexcept;
+                void (*Destroy)(void * Storage) noexcept;
+                bool Inline;
+            };
+
+            template <typename FunctionType>
+            struct InlineOperations
+            {
+                static ReturnType Invoke(void * Storage, ArgumentsTypes&&... Arguments);
+                static void Relocate(void * Destination, void * Source) noexcept;
+                static void Destroy(void * Storage) noexcept;
+                static constexpr Operations Value = { Invoke, Relocate, Destroy, true };
+            };
+
+            // The storage only holds a pointer to the function
+            template <typename FunctionType>
+            struct HeapOperations
+            {
+                static ReturnType Invoke(void * Storage, ArgumentsTypes&&... Arguments);
+                static void Relocate(void * Destination, void * Source) noexcept;
+                static void Destroy(void * Storage) noexcept;
+                static constexpr Operations Value = { Invoke, Relocate, Destroy, false };
+            };
+
+            alignas(std::max_align_t) unsigned char Storage[InlineSize];
+            /// @brief nullptr if the task is empty.
+            const Operations * Ops;
+
+            template <typename FunctionType>
+            static bool IsNull(const FunctionType& Function);
+            template <typename Signature>
+            static bool IsNull(const std::function<Signature>& Function);
+        };
+
+// DEFINITION ----------------------------------------------------------------
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::Task() noexcept : Ops(nullptr) {}
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::Task(std::nullptr_t) noexcept : Ops(nullptr) {}
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType, typename>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::Task(FunctionType&& Function) : Ops(nullptr)
+        {
+            typedef typename std::decay<FunctionType>::type StoredType;
+
+            if (IsNull(Function))
+                return;
+            if constexpr (sizeof(StoredType) <= InlineSize
+                          && alignof(StoredType) <= alignof(std::max_align_t)
+                          && std::is_nothrow_move_constructible<StoredType>::value)
+            {
+                new (Storage) StoredType(std::forward<FunctionType>(Function));
+                Ops = &InlineOperations<StoredType>::Value;
+            }
+            else
+            {
+                *reinterpret_cast<StoredType**>(Storage) = new StoredType(std::forward<FunctionType>(Function));
+                Ops = &HeapOperations<StoredType>::Value;
+            }
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::~Task()
+        {
+            if (Ops != nullptr)
+                Ops->Destroy(Storage);
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::Task(Task&& Other) noexcept : Ops(Other.Ops)
+        {
+            if (Ops != nullptr)
+                Ops->Relocate(Storage, Other.Storage);
+            Other.Ops = nullptr;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>&
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::operator=(Task&& Other) noexcept
+        {
+            if (this != &Other)
+            {
+                if (Ops != nullptr)
+                    Ops->Destroy(Storage);
+                Ops = Other.Ops;
+                if (Ops != nullptr)
+                    Ops->Relocate(Storage, Other.Storage);
+                Other.Ops = nullptr;
+            }
+            return *this;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>&
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::operator=(std::nullptr_t) noexcept
+        {
+            if (Ops != nullptr)
+                Ops->Destroy(Storage);
+            Ops = nullptr;
+            return *this;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        ReturnType Task<ReturnType(ArgumentsTypes...), InlineSize>::operator()(ArgumentsTypes... Arguments)
+        {
+            if (Ops == nullptr)
+                throw std::bad_function_call();
+            return Ops->Invoke(Storage, std::forward<ArgumentsTypes>(Arguments)...);
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        Task<ReturnType(ArgumentsTypes...), InlineSize>::operator bool() const noexcept
+        {
+            return Ops != nullptr;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        bool Task<ReturnType(ArgumentsTypes...), InlineSize>::operator==(std::nullptr_t) const noexcept
+        {
+            return Ops == nullptr;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        bool Task<ReturnType(ArgumentsTypes...), InlineSize>::operator!=(std::nullptr_t) const noexcept
+        {
+            return Ops != nullptr;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        bool Task<ReturnType(ArgumentsTypes...), InlineSize>::IsInline() const noexcept
+        {
+            return Ops != nullptr && Ops->Inline;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType>
+        bool Task<ReturnType(ArgumentsTypes...), InlineSize>::IsNull(const FunctionType& Function)
+        {
+            if constexpr (std::is_pointer<FunctionType>::value || std::is_member_pointer<FunctionType>::value)
+                return Function == nullptr;
+            else
+                return false;
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename Signature>
+        bool Task<ReturnType(ArgumentsTypes...), InlineSize>::IsNull(const std::function<Signature>& Function)
+        {
+            return !Function;
+        }
+
+// -------- INLINE OPERATIONS -------- //
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType>
+        ReturnType Task<ReturnType(ArgumentsTypes...), InlineSize>::InlineOperations<FunctionType>::Invoke(
+                void * Storage, ArgumentsTypes&&... Arguments
+        ) {
+            return static_cast<ReturnType>(std::invoke(
+                *static_cast<FunctionType*>(Storage), std::forward<ArgumentsTypes>(Arguments)...
+            ));
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType>
+        void Task<ReturnType(ArgumentsTypes...), InlineSize>::InlineOperations<FunctionType>::Relocate(
+                void * Destination, void * Source
+        ) noexcept {
+            FunctionType * source = static_cast<FunctionType*>(Source);
+            new (Destination) FunctionType(std::move(*source));
+            source->~FunctionType();
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType>
+        void Task<ReturnType(ArgumentsTypes...), InlineSize>::InlineOperations<FunctionType>::Destroy(
+                void * Storage
+        ) noexcept {
+            static_cast<FunctionType*>(Storage)->~FunctionType();
+        }
+
+// -------- HEAP OPERATIONS -------- //
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType>
+        ReturnType Task<ReturnType(ArgumentsTypes...), InlineSize>::HeapOperations<FunctionType>::Invoke(
+                void * Storage, ArgumentsTypes&&... Arguments
+        ) {
+            return static_cast<ReturnType>(std::invoke(
+                **static_cast<FunctionType**>(Storage), std::forward<ArgumentsTypes>(Arguments)...
+            ));
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType>
+        void Task<ReturnType(ArgumentsTypes...), InlineSize>::HeapOperations<FunctionType>::Relocate(
+                void * Destination, void * Source
+        ) noexcept {
+            *static_cast<FunctionType**>(Destination) = *static_cast<FunctionType**>(Source);
+        }
+
+        template <typename ReturnType, typename... ArgumentsTypes, std::size_t InlineSize>
+        template <typename FunctionType>
+        void Task<ReturnType(ArgumentsTypes...), InlineSize>::HeapOperations<FunctionType>::Destroy(
+                void * Storage
+        ) noexcept {
+            delete *static_cast<FunctionType**>(Storage);
+        }
+    }
+}
@@ -0,0 +1,231 @@
+#include "../Engine.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        /// @brief The number of failed attempts to find a job before a thread goes to sleep.
+        constexpr int SpinsBeforeSleeping = 64;
+
+        static thread_local int CurrentWorkerIndex = -1;
+
+// -------- DEQUE -------- //
+
+        WorkStealingPool::Deque::Deque() : Jobs(16), Front(0), Back(0) {}
+
+        inline void WorkStealingPool::Deque::Acquire()
+        {
+            while (Lock.test_and_set(std::memory_order_acquire))
+                std::this_thread::yield();
+        }
+
+        inline void WorkStealingPool::Deque::Release()
+        {
+            Lock.clear(std::memory_order_release);
+        }
+
+        void WorkStealingPool::Deque::PushBack(Job Job)
+        {
+            Acquire();
+            if (Back - Front >= Jobs.GetLength())
+            {
+                // Grow, keeping the jobs in order starting from index 0
+                int Length = Jobs.GetLength();
+                Collections::ResizableArray<WorkStealingPool::Job, false> NewJobs(Length * 2);
+                for (int i = Front; i < Back; i++)
+                    NewJobs.GetItemRef(i - Front) = std::move(Jobs.GetItemRef(i & (Length - 1)));
+                Back -= Front;
+                Front = 0;
+                Jobs = std::move(NewJobs);
+            }
+            Jobs.SetItem(Back & (Jobs.GetLength() - 1), std::move(Job));
+            Back++;
+            Release();
+        }
+
+        bool WorkStealingPool::Deque::PopFront(Job& JobOut)
+        {
+            Acquire();
+            if (Front == Back)
+            {
+                Release();
+                return false;
+            }
+            JobOut = std::move(Jobs.GetItemRef(Front & (Jobs.GetLength() - 1)));
+            Front++;
+            if (Front == Back)
+                Front = Back = 0;
+            Release();
+            return true;
+        }
+
+        bool WorkStealingPool::Deque::PopBack(Job& JobOut)
+        {
+            Acquire();
+            if (Front == Back)
+            {
+                Release();
+                return false;
+            }
+            Back--;
+            JobOut = std::move(Jobs.GetItemRef(Back & (Jobs.GetLength() - 1)));
+            if (Front == Back)
+                Front = Back = 0;
+            Release();
+            return true;
+        }
+
+// -------- POOL -------- //
+
+        WorkStealingPool::WorkStealingPool(int ThreadsCount) : NextDeque(0),
+                                                               PendingCount(0), QueuedCount(0),
+                                                               SleepingCount(0), ShouldTerminate(false),
+                                                               IsWaiterSleeping(false)
+        {
+            if (ThreadsCount < 0)
+                throw std::domain_error("ThreadsCount is less than zero.");
+
+            this->ThreadsCount = ThreadsCount;
+            // There is always a deque, so that Wait can run the jobs without workers.
+            DequesCount = ThreadsCount > 0 ? ThreadsCount : 1;
+            Deques = new Deque[DequesCount];
+            Threads = new std::thread*[ThreadsCount > 0 ? ThreadsCount : 1];
+            for (int i = 0; i < ThreadsCount; i++)
+                Threads[i] = new std::thread([this](int WorkerIndex) { WorkerProcess(WorkerIndex); }, i);
+        }
+
+        WorkStealingPool::~WorkStealingPool()
+        {
+            Wait();
+            {
+                std::lock_guard<std::mutex> guard(SleepMutex);
+                ShouldTerminate = true;
+            }
+            SleepCondition.notify_all();
+            for (int i = 0; i < ThreadsCount; i++)
+            {
+                Threads[i]->join();
+                delete Threads[i];
+            }
+            delete[] Threads;
+            delete[] Deques;
+        }
+
+        void WorkStealingPool::Submit(Job Job)
+        {
+            PendingCount.fetch_add(1);
+            Deques[NextDeque].PushBack(Job);
+            NextDeque = (NextDeque + 1) % DequesCount;
+            QueuedCount.fetch_add(1);
+
+            // Pairs with the SleepingCount increment and the QueuedCount check of the workers
+            if (SleepingCount.load() > 0)
+            {
+                std::lock_guard<std::mutex> guard(SleepMutex);
+                SleepCondition.notify_one();
+            }
+        }
+
+        void WorkStealingPool::Wait()
+        {
+            int spins = 0;
+            Job job;
+            while (PendingCount.load(std::memory_order_acquire) > 0)
+            {
+                if (TakeJob(0, job))
+                {
+                    Execute(job);
+                    spins = 0;
+                    continue;
+                }
+                if (++spins < SpinsBeforeSleeping)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // The remaining jobs are being executed by the workers
+                std::unique_lock<std::mutex> guard(DoneMutex);
+                IsWaiterSleeping = true;
+                DoneCondition.wait(guard, [this] { return PendingCount.load() == 0; });
+                IsWaiterSleeping = false;
+            }
+        }
+
+        int WorkStealingPool::GetThreadsCount()
+        {
+            return ThreadsCount;
+        }
+
+        int WorkStealingPool::GetCurrentWorkerIndex()
+        {
+            return CurrentWorkerIndex;
+        }
+
+        void WorkStealingPool::WorkerProcess(int WorkerIndex)
+        {
+            CurrentWorkerIndex = WorkerIndex;
+            ENGINE_PROFILE_THREAD_NAME("Worker " + std::to_string(WorkerIndex));
+#ifdef ENGINE_PROFILING
+            long long idle_start = -1;
+#endif
+            int spins = 0;
+            Job job;
+            while (true)
+            {
+                if (TakeJob(WorkerIndex, job))
+                {
+#ifdef ENGINE_PROFILING
+                    if (idle_start >= 0)
+                        Profiler::RecordSpan("Idle", nullptr, idle_start, Profiler::Now());
+                    idle_start = -1;
+#endif
+                    Execute(job);
+                    spins = 0;
+                    continue;
+                }
+#ifdef ENGINE_PROFILING
+                if (idle_start < 0)
+                    idle_start = Profiler::Now();
+#endif
+                if (++spins < SpinsBeforeSleeping)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                spins = 0;
+                std::unique_lock<std::mutex> guard(SleepMutex);
+                SleepingCount.fetch_add(1);
+                SleepCondition.wait(guard, [this] { return ShouldTerminate || QueuedCount.load() > 0; });
+                SleepingCount.fetch_sub(1);
+                if (ShouldTerminate && QueuedCount.load() == 0)
+                    return;
+            }
+        }
+
+        inline bool WorkStealingPool::TakeJob(int DequeIndex, Job& JobOut)
+        {
+            if (QueuedCount.load(std::memory_order_acquire) == 0)
+                return false;
+
+            // Own deque first, then steal from the others
+            bool found = Deques[DequeIndex].PopFront(JobOut);
+            for (int i = 1; !found && i < DequesCount; i++)
+                found = Deques[(DequeIndex + i) % DequesCount].PopBack(JobOut);
+
+            if (found)
+                QueuedCount.fetch_sub(1);
+            return found;
+        }
+
+        inline void WorkStealingPool::Execute(Job& Job)
+        {
+            Job.Function(Job.Context, Job.Argument);
+            // Pairs with the IsWaiterSleeping set and the PendingCount check of the waiter
+            if (PendingCount.fetch_sub(1) == 1 && IsWaiterSleeping.load())
+            {
+                std::lock_guard<std::mutex> guard(DoneMutex);
+                DoneCondition.notify_all();
+            }
+        }
+    }
+}
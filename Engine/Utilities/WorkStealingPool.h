@@ -0,0 +1,95 @@
+#pragma once
+
+#include "../Engine.dec.h"
+#include "Collections/ResizableArray.h"
+
+namespace Engine
+{
+    namespace Utilities
+    {
+        class WorkStealingPool final
+        {
+        public:
+            /// @brief A unit of work, executed as Function(Context, Argument).
+            ///
+            /// Kept as plain pointers so that submitting a job never allocates.
+            struct Job
+            {
+                void (*Function)(void * Context, void * Argument);
+                void * Context;
+                void * Argument;
+            };
+
+            /// @param ThreadsCount The number of worker threads to create.
+            ///        The thread that calls Wait executes jobs as well.
+            WorkStealingPool(int ThreadsCount);
+            ~WorkStealingPool();
+
+            WorkStealingPool(const WorkStealingPool&) = delete;
+            WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+            /// @brief Pushes a job to the back of a worker's deque.
+            ///
+            /// Jobs are distributed between the workers in a round-robin manner,
+            /// idle workers steal from the others.
+            /// Should only be called by the thread that feeds the pool.
+            void Submit(Job Job);
+            /// @brief Executes and steals jobs until every submitted job is done.
+            ///
+            /// This is the barrier of the pool and
+            /// should only be called by the thread that feeds the pool.
+            void Wait();
+
+            /// @brief Gets the number of worker threads.
+            int GetThreadsCount();
+            /// @brief Gets the 0-based index of the calling worker thread in its pool.
+            /// @return -1 if the calling thread is not a worker thread.
+            static int GetCurrentWorkerIndex();
+        private:
+            /// @brief A job deque owned by a worker.
+            ///
+            /// The owner pops from the front and keeps the submission order,
+            /// thieves steal from the back.
+            class alignas(64) Deque final
+            {
+            public:
+                Deque();
+                void PushBack(Job Job);
+                bool PopFront(Job& JobOut);
+                bool PopBack(Job& JobOut);
+            private:
+                std::atomic_flag Lock = ATOMIC_FLAG_INIT;
+                Collections::ResizableArray<Job, false> Jobs;
+                int Front;
+                int Back;
+
+                void Acquire();
+                void Release();
+            };
+
+            int ThreadsCount;
+            int DequesCount;
+            Deque * Deques;
+            std::thread ** Threads;
+            int NextDeque;
+
+            /// @brief The submitted jobs that are not done yet.
+            alignas(64) std::atomic<int> PendingCount;
+            /// @brief The jobs that are still waiting in the deques.
+            alignas(64) std::atomic<int> QueuedCount;
+
+            std::mutex SleepMutex;
+            std::condition_variable SleepCondition;
+            std::atomic<int> SleepingCount;
+            bool ShouldTerminate;
+
+            std::mutex DoneMutex;
+            std::condition_variable DoneCondition;
+            std::atomic<bool> IsWaiterSleeping;
+
+            void WorkerProcess(int WorkerIndex);
+            bool TakeJob(int DequeIndex, Job& JobOut);
+            void Execute(Job& Job);
+        };
+    }
+}
@@ -1,10 +1,41 @@
 #include "../../Engine/Engine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define print(context) (std::cout << context << '\n')
 #define input(var) (std::cin >> var)
 
+// Counts the allocations of the whole program, for the allocation tests
+static std::atomic<long long> AllocationsCount(0);
+
+void * operator new(std::size_t Size)
+{
+    AllocationsCount.fetch_add(1, std::memory_order_relaxed);
+    if (void * pointer = std::malloc(Size != 0 ? Size : 1))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void * Pointer) noexcept
+{
+    std::free(Pointer);
+}
+
+void operator delete(void * Pointer, std::size_t) noexcept
+{
+    std::free(Pointer);
+}
+
 class QuitException {};
 class UnknownException {};
 class KnownException : public std::runtime_error
@@ -13,6 +44,7 @@ class KnownException : public std::runtime_error
 };
 
 bool should_quit = false;
+Engine::Utilities::Collections::Dictionary<std::string, Engine::Core::ScheduleHandle> schedules;
 void Prompt(Engine::Core::Loop&);
 
 class PromptModule : public Engine::Core::Module
@@ -95,6 +127,36 @@ public:
     }
 };
 
+class SignalledModule : public TestModule
+{
+public:
+    SignalledModule(std::string Name, int ExecutionChunk) : TestModule(Name, ExecutionChunk) {}
+
+    virtual Engine::Core::UpdateMode GetUpdateMode() override
+    {
+        return Engine::Core::UpdateMode::WhenSignalled;
+    }
+};
+
+class FreeAsyncModule : public TestModule
+{
+public:
+    int SleepTime;
+
+    FreeAsyncModule(std::string Name, int ExecutionChunk, int SleepTime) : TestModule(Name, ExecutionChunk), SleepTime(SleepTime) {}
+
+    virtual void OnUpdate() override
+    {
+        print(GetTime() << ", " << GetTimeDiff() << ": Updating: " << Name);
+        std::this_thread::sleep_for(std::chrono::milliseconds(SleepTime));
+    }
+
+    virtual Engine::Core::ExecutionType GetExecutionType() override
+    {
+        return Engine::Core::ExecutionType::FreeAsync;
+    }
+};
+
 class SchedulerModule : public Engine::Core::Module
 {
 public:
@@ -130,19 +192,234 @@ public:
     }
 };
 
+/// @brief Counts the executions of a job in Argument and of its thread in Context, with a bit of work in between.
+void CountingJob(void * Context, void * Argument)
+{
+    volatile int work = 0;
+    for (int i = 0; i < 1000; i++) work = work + i;
+    (*(std::vector<std::atomic<int>>*)Context)[Engine::Utilities::WorkStealingPool::GetCurrentWorkerIndex() + 1]++;
+    (*(std::atomic<int>*)Argument)++;
+}
+
+/// @brief Submits JobsCount jobs to a pool of ThreadsCount workers, waits for them, and does it again
+///        to check that Wait drains the pool every time and that every job is executed exactly once.
+void WorkStealingPoolTest(int ThreadsCount, int JobsCount)
+{
+    Engine::Utilities::WorkStealingPool pool(ThreadsCount);
+    for (int round = 0; round < 2; round++)
+    {
+        std::vector<std::atomic<int>> executions(JobsCount);
+        std::vector<std::atomic<int>> threads_executions(pool.GetThreadsCount() + 1);
+        for (int i = 0; i < JobsCount; i++)
+            pool.Submit({ CountingJob, &threads_executions, &executions[i] });
+        pool.Wait();
+
+        int executed_once = 0;
+        for (auto& count : executions)
+            if (count == 1) executed_once++;
+        print("Round " << round << ": executed exactly once: " << executed_once << "/" << JobsCount
+            << (executed_once == JobsCount ? "" : " (FAILED)"));
+        std::cout << "  by the waiting thread: " << threads_executions[0] << ", by the workers:";
+        for (int i = 1; i < (int)threads_executions.size(); i++) std::cout << ' ' << threads_executions[i];
+        std::cout << '\n';
+    }
+}
+
+/// @brief Keeps the only worker of a FreeAsyncExecutor busy, submits SubmitsCount tasks of a single source,
+///        then lets them run and prints what the Backpressure did with them.
+void FreeAsyncBackpressureTest(Engine::Core::FreeAsyncBackpressure Backpressure, int QueueCapacity, int SubmitsCount)
+{
+    Engine::Core::FreeAsyncExecutor executor;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool is_blocking = false;
+    bool is_released = false;
+    std::atomic<int> executed(0);
+    int key = 0;
+
+    executor.Start(1, Backpressure, QueueCapacity);
+    executor.Submit(&key, [&]() {
+        std::unique_lock<std::mutex> guard(mutex);
+        is_blocking = true;
+        condition.notify_all();
+        condition.wait(guard, [&]() { return is_released; });
+        executed++;
+    });
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        condition.wait(guard, [&]() { return is_blocking; });
+    }
+
+    int queued = 0;
+    for (int i = 0; i < SubmitsCount; i++)
+        if (executor.Submit(&key, [&]() { executed++; })) queued++;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        is_released = true;
+    }
+    condition.notify_all();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (executed < queued + 1 && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    executor.Stop();
+
+    print("Queued: " << queued << ", Executed: " << executed
+        << ", Dropped: " << executor.GetDroppedCount() << ", Coalesced: " << executor.GetCoalescedCount());
+}
+
+/// @brief Schedules SchedulesCount jobs with a 40-byte capture on a running Loop, waits for them, and does it again,
+///        printing the allocations per Schedule of each round.
+///        Drops to 0 after the first rounds, once the pools have seen the peak number of jobs in flight.
+void ScheduleAllocationsTest(int SchedulesCount)
+{
+    Engine::Core::Loop loop;
+    loop.Modules.Add(new SignalledModule("Idle", 0)); // Keeps the Loop running
+    std::thread runner([&loop]() { loop.Run(); });
+    while (!loop.IsRunning())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::atomic<long long> sum(0);
+    long long values[4] = { 1, 2, 3, 4 };
+    for (int round = 0; round < 8; round++)
+    {
+        sum = 0;
+        long long allocations = AllocationsCount.load();
+        for (int i = 0; i < SchedulesCount; i++)
+            loop.Schedule([&sum, values]() { sum += values[0] + values[1] + values[2] + values[3]; });
+        allocations = AllocationsCount.load() - allocations;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (sum < 10LL * SchedulesCount && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        print("Round " << round << ": executed: " << sum / 10 << "/" << SchedulesCount
+            << ", allocations per Schedule: " << (double)allocations / SchedulesCount);
+    }
+
+    loop.Stop();
+    runner.join();
+}
+
+/// @brief Keeps the only FreeAsync thread of a running Loop busy with a scheduled job, so a second due job is queued
+///        behind it, then reschedules the queued job and a pending one. Reschedule must fail for the queued job,
+///        which still runs at its old time, and succeed for the pending one.
+void RescheduleQueuedTest()
+{
+    Engine::Core::Loop loop;
+    loop.SetFreeAsyncThreadsCount(1);
+    loop.Modules.Add(new SignalledModule("Idle", 0)); // Keeps the Loop running
+    std::thread runner([&loop]() { loop.Run(); });
+    while (!loop.IsRunning())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool is_blocking = false;
+    bool is_released = false;
+    std::atomic<int> queued_executed(0);
+    std::atomic<int> pending_executed(0);
+
+    loop.Schedule(0, Engine::Core::ExecutionType::FreeAsync, [&]() {
+        std::unique_lock<std::mutex> guard(mutex);
+        is_blocking = true;
+        condition.notify_all();
+        condition.wait(guard, [&]() { return is_released; });
+    });
+    {
+        std::unique_lock<std::mutex> guard(mutex);
+        condition.wait(guard, [&]() { return is_blocking; });
+    }
+    Engine::Core::ScheduleHandle queued = loop.Schedule(0, Engine::Core::ExecutionType::FreeAsync, [&]() { queued_executed++; });
+    Engine::Core::ScheduleHandle pending = loop.Schedule(60, Engine::Core::ExecutionType::FreeAsync, [&]() { pending_executed++; });
+    // Lets the Loop hand the due job to the busy thread
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    bool queued_rescheduled = queued.Reschedule(60);
+    bool pending_rescheduled = pending.Reschedule(0);
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        is_released = true;
+    }
+    condition.notify_all();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while ((queued_executed == 0 || pending_executed == 0) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    loop.Stop();
+    runner.join();
+
+    bool passed = !queued_rescheduled && queued_executed == 1 && pending_rescheduled && pending_executed == 1;
+    print("Queued job: rescheduled: " << queued_rescheduled << ", executed: " << queued_executed
+        << "; Pending job: rescheduled: " << pending_rescheduled << ", executed: " << pending_executed
+        << (passed ? "" : " (FAILED)"));
+}
+
+/// @brief Runs and stops a Loop Rounds times while ThreadsCount threads keep scheduling on it,
+///        then counts the handles that are still pending after Run has returned.
+///        Is 0 unless a push lands in the inbox after the stopping Loop has cleared it.
+void StopWhileSchedulingTest(int Rounds, int ThreadsCount)
+{
+    Engine::Core::Loop loop;
+    loop.Modules.Add(new SignalledModule("Idle", 0)); // Keeps the Loop running
+    long long scheduled = 0;
+    long long still_pending = 0;
+    for (int round = 0; round < Rounds; round++)
+    {
+        std::thread runner([&loop]() { loop.Run(); });
+        while (!loop.IsRunning())
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        std::atomic<bool> is_stopped(false);
+        std::vector<std::vector<Engine::Core::ScheduleHandle>> handles(ThreadsCount);
+        std::vector<std::thread> schedulers;
+        for (int t = 0; t < ThreadsCount; t++)
+            schedulers.emplace_back([&, t]() {
+                while (!is_stopped)
+                {
+                    Engine::Core::ScheduleHandle handle = loop.Schedule(1000, []() {});
+                    if (handle)
+                        handles[t].push_back(std::move(handle));
+                }
+            });
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        loop.Stop();
+        runner.join();
+        is_stopped = true;
+        for (auto& scheduler : schedulers)
+            scheduler.join();
+
+        for (auto& thread_handles : handles)
+            for (auto& handle : thread_handles)
+            {
+                scheduled++;
+                if (handle.IsPending())
+                    still_pending++;
+            }
+    }
+    print("Scheduled: " << scheduled << ", Still pending after the stops: " << still_pending
+        << (still_pending == 0 ? "" : " (FAILED)"));
+}
+
 void Prompt(Engine::Core::Loop& loop)
 {
     print("");
     print("add Name ExecutionChunk       => Add a TestModule");
     print("ADD Name ExecutionChunk Index => Add a TestModule");
+    print("adg Name ExecutionChunk       => Add a SignalledModule");
     print("adp Name ExecutionChunk       => Add a PromptModule");
     print("ADP Name ExecutionChunk Index => Add a PromptModule");
     print("ads Name ExecutionChunk       => Add a SchedulerModule");
     print("ADS Name ExecutionChunk Index => Add a SchedulerModule");
+    print("adf Name ExecutionChunk Sleep => Add a FreeAsync TestModule that sleeps Sleep milliseconds per update");
     print("sch Name Time                 => Schedule (BoundedAsync)");
+    print("scu Name Time                 => Schedule a move-only task (BoundedAsync)");
     print("scs Name Time                 => Schedule (SingleThreaded)");
     print("scf Name Time                 => Schedule (FreeAsync)");
+    print("scr Name Period               => Schedule repeating (BoundedAsync, FixedRate)");
+    print("scd Name Period               => Schedule repeating (BoundedAsync, FixedDelay)");
+    print("scc Name                      => Cancel the last schedule by Name");
+    print("scm Name Time                 => Reschedule the last schedule by Name");
     print("rem Name                      => Remove a Module by Name");
+    print("sig Name                      => Signal a Module by Name");
     print("a   Name                      => Enable a Module by Name");
     print("d   Name                      => Disable a Module by Name");
     print("");
@@ -151,6 +428,25 @@ void Prompt(Engine::Core::Loop& loop)
     print("");
     print("f => Loop.Modules.ForEach([](Item) { print(Item.GetName()); })");
     print("");
+    print("prf Path => Export the profiled events as a Chrome trace (needs ENGINE_PROFILING)");
+    print("lck => Print the lock contention report (needs ENGINE_LOCK_PROFILING)");
+    print("lckj Path => Export the lock contention report as JSON (needs ENGINE_LOCK_PROFILING)");
+    print("ord => Print the lock-order reports (needs ENGINE_LOCK_ORDER_CHECKING)");
+    print("");
+    print("tck Policy Frequency => Loop.SetTickPolicy (0: Unthrottled, 1: TargetFrequency, 2: FixedTimestep)");
+    print("");
+    print("fab Policy   => Loop.SetFreeAsyncBackpressure (0: SkipTick, 1: Coalesce, 2: Enqueue)");
+    print("fac Capacity => Loop.SetFreeAsyncQueueCapacity (0: no limit)");
+    print("fat Count    => Loop.SetFreeAsyncThreadsCount (0: hardware concurrency)");
+    print("fas          => Print the FreeAsync dropped and coalesced counts");
+    print("fae Policy Capacity Submits => Test the backpressure of a FreeAsyncExecutor with a busy worker:");
+    print("    1 0 5 => 1 queued, 4 coalesced; 0 0 5 => 5 dropped; 2 3 5 => 3 queued, 2 dropped");
+    print("");
+    print("wsp Threads Jobs => Test the draining and the Wait of a WorkStealingPool");
+    print("stp Rounds Threads => Run and stop a Loop Rounds times while Threads threads schedule, then check no job is left pending");
+    print("rsq              => Test that Reschedule fails once a due job is queued behind a busy FreeAsync thread");
+    print("sca Count        => Count the allocations per Schedule of Count jobs on a running Loop, in 8 rounds");
+    print("");
     print("s => Loop.Run()");
     print("e => Loop.Stop()");
     print("");
@@ -174,6 +470,12 @@ void Prompt(Engine::Core::Loop& loop)
             input(option >> arg1 >> arg2);
             loop.Modules.Add(new TestModule(option, arg1), arg2);
         }
+        else if (option == "adg")
+        {
+            int arg;
+            input(option >> arg);
+            loop.Modules.Add(new SignalledModule(option, arg));
+        }
         else if (option == "adp")
         {
             int arg;
@@ -198,32 +500,80 @@ void Prompt(Engine::Core::Loop& loop)
             input(option >> arg1 >> arg2);
             loop.Modules.Add(new SchedulerModule(option, arg1), arg2);
         }
+        else if (option == "adf")
+        {
+            int arg1, arg2;
+            input(option >> arg1 >> arg2);
+            loop.Modules.Add(new FreeAsyncModule(option, arg1, arg2));
+        }
         else if (option == "sch")
         {
             double arg;
             input(option >> arg);
-            loop.Schedule(arg, Engine::Core::ExecutionType::BoundedAsync, [option] {
+            schedules.SetValue(option, loop.Schedule(arg, Engine::Core::ExecutionType::BoundedAsync, [option] {
                 print("Executing the schedule: " << option);
                 throw KnownException(); // should be ignored
-            });
+            }));
+        }
+        else if (option == "scu")
+        {
+            double arg;
+            input(option >> arg);
+            auto name = std::make_unique<std::string>(option);
+            schedules.SetValue(option, loop.Schedule(arg, Engine::Core::ExecutionType::BoundedAsync, [name = std::move(name)] {
+                print("Executing the move-only schedule: " << *name);
+            }));
         }
         else if (option == "scs")
         {
             double arg;
             input(option >> arg);
-            loop.Schedule(arg, Engine::Core::ExecutionType::SingleThreaded, [option] {
+            schedules.SetValue(option, loop.Schedule(arg, Engine::Core::ExecutionType::SingleThreaded, [option] {
                 print("Executing the schedule: " << option);
                 throw KnownException(); // should be ignored
-            });
+            }));
         }
         else if (option == "scf")
         {
             double arg;
             input(option >> arg);
-            loop.Schedule(arg, Engine::Core::ExecutionType::FreeAsync, [option] {
+            schedules.SetValue(option, loop.Schedule(arg, Engine::Core::ExecutionType::FreeAsync, [option] {
                 print("Executing the schedule: " << option);
                 throw KnownException(); // should be ignored
-            });
+            }));
+        }
+        else if (option == "scr")
+        {
+            double arg;
+            input(option >> arg);
+            schedules.SetValue(option, loop.ScheduleRepeating(arg, Engine::Core::RepeatType::FixedRate, [option] {
+                print("Executing the repeating schedule: " << option);
+            }));
+        }
+        else if (option == "scd")
+        {
+            double arg;
+            input(option >> arg);
+            schedules.SetValue(option, loop.ScheduleRepeating(arg, Engine::Core::RepeatType::FixedDelay, [option] {
+                print("Executing the repeating schedule: " << option);
+            }));
+        }
+        else if (option == "scc")
+        {
+            input(option);
+            if (schedules.Contains(option))
+                print("Cancelled: " << schedules.GetValue(option).Cancel());
+            else
+                print("Schedule with name '" << option << "' doesn't exist.");
+        }
+        else if (option == "scm")
+        {
+            double arg;
+            input(option >> arg);
+            if (schedules.Contains(option))
+                print("Rescheduled: " << schedules.GetValue(option).Reschedule(arg));
+            else
+                print("Schedule with name '" << option << "' doesn't exist.");
         }
         else if (option == "rem")
         {
@@ -233,6 +583,14 @@ void Prompt(Engine::Core::Loop& loop)
                 )); }
             catch (std::out_of_range&) { print("Module with name '" << option << "' doesn't exist."); }
         }
+        else if (option == "sig")
+        {
+            input(option);
+            try{ loop.Modules.GetItem(loop.Modules.Find(
+                [option](Engine::Core::Module * Item)->bool { return option == Item->GetName(); }
+                ))->Signal(); }
+            catch (std::out_of_range&) { print("Module with name '" << option << "' doesn't exist."); }
+        }
         else if (option == "a")
         {
             input(option);
@@ -261,6 +619,80 @@ void Prompt(Engine::Core::Loop& loop)
         {
             loop.Modules.ForEach([](Engine::Core::Module * Item) { print(Item->GetName()); });
         }
+        else if (option == "prf")
+        {
+            input(option);
+            std::ofstream file(option);
+            Engine::Utilities::Profiler::ExportChromeTrace(file);
+            print("Dropped events: " << Engine::Utilities::Profiler::GetDroppedCount());
+        }
+        else if (option == "lck")
+            Engine::Utilities::LockProfiler::ExportText(std::cout);
+        else if (option == "lckj")
+        {
+            input(option);
+            std::ofstream file(option);
+            Engine::Utilities::LockProfiler::ExportJson(file);
+        }
+        else if (option == "ord")
+            Engine::Utilities::LockOrderChecker::ExportText(std::cout);
+        else if (option == "tck")
+        {
+            int arg1;
+            double arg2;
+            input(arg1 >> arg2);
+            loop.SetTickPolicy((Engine::Core::TickPolicy)arg1, arg2);
+        }
+        else if (option == "fab")
+        {
+            int arg1;
+            input(arg1);
+            loop.SetFreeAsyncBackpressure((Engine::Core::FreeAsyncBackpressure)arg1);
+        }
+        else if (option == "fac")
+        {
+            int arg1;
+            input(arg1);
+            loop.SetFreeAsyncQueueCapacity(arg1);
+        }
+        else if (option == "fat")
+        {
+            int arg1;
+            input(arg1);
+            loop.SetFreeAsyncThreadsCount(arg1);
+        }
+        else if (option == "fas")
+        {
+            print("Dropped: " << loop.GetFreeAsyncDroppedCount() << ", Coalesced: " << loop.GetFreeAsyncCoalescedCount());
+        }
+        else if (option == "fae")
+        {
+            int arg1, arg2, arg3;
+            input(arg1 >> arg2 >> arg3);
+            FreeAsyncBackpressureTest((Engine::Core::FreeAsyncBackpressure)arg1, arg2, arg3);
+        }
+        else if (option == "wsp")
+        {
+            int arg1, arg2;
+            input(arg1 >> arg2);
+            WorkStealingPoolTest(arg1, arg2);
+        }
+        else if (option == "stp")
+        {
+            int arg1, arg2;
+            input(arg1 >> arg2);
+            StopWhileSchedulingTest(arg1, arg2);
+        }
+        else if (option == "rsq")
+        {
+            RescheduleQueuedTest();
+        }
+        else if (option == "sca")
+        {
+            int arg;
+            input(arg);
+            ScheduleAllocationsTest(arg);
+        }
         else if (option == "s")
         {
             loop.Run();
@@ -1,6 +1,9 @@
 #include "../../Engine/Engine.h"
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <string>
+#include <thread>
 
 // To check the compilation errors
 template class Engine::Utilities::Collections::ResizableArray<int, true>;
@@ -13,8 +16,19 @@ template class Engine::Utilities::Collections::Queue<int, true>;
 template class Engine::Utilities::Collections::Queue<int, false>;
 template class Engine::Utilities::Collections::PriorityQueue<int, int, true, true>;
 template class Engine::Utilities::Collections::PriorityQueue<int, int, true, false>;
+template class Engine::Utilities::Collections::PriorityQueue<int, int, false, false, 2, false>;
+template class Engine::Utilities::Collections::IndexedPriorityQueue<int, int, true, true>;
+template class Engine::Utilities::Collections::IndexedPriorityQueue<int, int, false, false, 2>;
 template class Engine::Utilities::Collections::Dictionary<int, int, true>;
 template class Engine::Utilities::Collections::Dictionary<int, int, false>;
+template class Engine::Utilities::Collections::OrderedDictionary<int, int, true>;
+template class Engine::Utilities::Collections::OrderedDictionary<int, int, false>;
+template class Engine::Utilities::Collections::HashDictionary<int, int, true>;
+template class Engine::Utilities::Collections::HashDictionary<int, int, false>;
+template class Engine::Utilities::Collections::ConcurrentDictionary<int, int>;
+template class Engine::Utilities::Collections::Inbox<int>;
+template class Engine::Utilities::Collections::SpscRingQueue<int>;
+template class Engine::Utilities::Collections::MpmcRingQueue<int>;
 
 #define print(context) (std::cout << context << '\n')
 #define input(var) (std::cin >> var)
@@ -22,28 +36,45 @@ template class Engine::Utilities::Collections::Dictionary<int, int, false>;
 #define KEY_TYPE std::string
 #define VALUE_TYPE std::string
 
+void TestResizableArray();
 void TestList();
 void TestStack();
 void TestQueue();
 void TestPriorityQueue();
+void TestIndexedPriorityQueue();
 void TestDictionary();
+void TestOrderedDictionary();
+void TestHashDictionary();
+void TestConcurrentDictionary();
+void TestInbox();
+template <typename QueueType>
+void TestRingQueue(const char * Name, bool MultipleThreads);
 
 void TestMultipleLists();
 void TestMultipleStacks();
 void TestMultipleQueues();
 void TestMultiplePriorityQueues();
 void TestMultipleDictionaries();
+void TestGrowthPolicies();
 
 int main()
 {
     while (true)
     {
         print("");
+        print("a => Test ResizableArray");
         print("l => Test List");
         print("s => Test Stack");
         print("q => Test Queue");
         print("p => Test PriorityQueue");
+        print("x => Test IndexedPriorityQueue");
         print("d => Test Dictionary");
+        print("o => Test OrderedDictionary");
+        print("h => Test HashDictionary");
+        print("c => Test ConcurrentDictionary");
+        print("i => Test Inbox");
+        print("r => Test SpscRingQueue");
+        print("m => Test MpmcRingQueue");
         print("");
         print("L => Test Multiple Lists");
         print("S => Test Multiple Stacks");
@@ -51,12 +82,17 @@ int main()
         print("P => Test Multiple PriorityQueues");
         print("D => Test Multiple Dictionaries");
         print("");
+        print("g => Test the GrowthPolicy of Clear on List, Stack, Queue and PriorityQueue");
+        print("");
 
         char option;
         input(option);
 
         switch (option)
         {
+        case 'a':
+            TestResizableArray();
+            break;
         case 'l':
             TestList();
             break;
@@ -69,9 +105,30 @@ int main()
         case 'p':
             TestPriorityQueue();
             break;
+        case 'x':
+            TestIndexedPriorityQueue();
+            break;
         case 'd':
             TestDictionary();
             break;
+        case 'o':
+            TestOrderedDictionary();
+            break;
+        case 'h':
+            TestHashDictionary();
+            break;
+        case 'c':
+            TestConcurrentDictionary();
+            break;
+        case 'i':
+            TestInbox();
+            break;
+        case 'r':
+            TestRingQueue<Engine::Utilities::Collections::SpscRingQueue<ITEMS_TYPE>>("SpscRingQueue", false);
+            break;
+        case 'm':
+            TestRingQueue<Engine::Utilities::Collections::MpmcRingQueue<ITEMS_TYPE>>("MpmcRingQueue", true);
+            break;
         case 'L':
             TestMultipleLists();
             break;
@@ -87,6 +144,9 @@ int main()
         case 'D':
             TestMultipleDictionaries();
             break;
+        case 'g':
+            TestGrowthPolicies();
+            break;
         default:
             break;
         }
@@ -95,6 +155,242 @@ int main()
     return 0;
 }
 
+// Throws on the copy after CopiesBeforeThrow copies, to check that a Resize that copies leaves the array unchanged
+struct ThrowingCopy
+{
+    static int CopiesBeforeThrow;
+    static int Instances;
+
+    std::string Value;
+
+    ThrowingCopy() { Instances++; }
+    ThrowingCopy(const ThrowingCopy& Op) : Value(Op.Value)
+    {
+        if (CopiesBeforeThrow == 0)
+            throw std::runtime_error("Copy failed.");
+        CopiesBeforeThrow--;
+        Instances++;
+    }
+    // Not noexcept, so Resize copies
+    ThrowingCopy(ThrowingCopy&& Op) : Value(std::move(Op.Value)) { Instances++; }
+    ThrowingCopy& operator=(const ThrowingCopy&) = default;
+    ~ThrowingCopy() { Instances--; }
+};
+int ThrowingCopy::CopiesBeforeThrow = -1;
+int ThrowingCopy::Instances = 0;
+
+struct alignas(64) OverAligned
+{
+    int Value;
+};
+
+void TestResizableArray()
+{
+    Engine::Utilities::Collections::ResizableArray<ITEMS_TYPE, false> * array = new Engine::Utilities::Collections::ResizableArray<ITEMS_TYPE, false>();
+    while (true) try
+    {
+        print("");
+        print("r Length           => Resize(Length)");
+        print("g Index            => GetItem(Index)");
+        print("s Index Item       => SetItem(Index, Item)");
+        print("G Index Item       => GetItemRef(Index) += Item");
+        print("e Index Count Char => Emplace(Index, Count, Char)");
+        print("a Item             => Append(Item)");
+        print("v Capacity         => Reserve(Capacity)");
+        print("L                  => GetLength()");
+        print("K                  => GetCapacity()");
+        print("F                  => Print all items");
+        print("");
+        print("m Times => Append then Resize Times move-only items and check them");
+        print("t Times => Grow and shrink an int array and an over-aligned array by realloc Times times and check them");
+        print("x Times => Grow an array whose copy throws on the Times-th copy and check it is unchanged");
+        print("");
+        print("q => Quit ResizableArray Test");
+        print("");
+
+        char func;
+        int arg_int1;
+        int arg_int2;
+        char arg_char;
+        ITEMS_TYPE arg;
+        input(func);
+
+        switch (func)
+        {
+        case 'r':
+            input(arg_int1);
+            array->Resize(arg_int1);
+            break;
+        case 'g':
+            input(arg_int1);
+            print(array->GetItem(arg_int1));
+            break;
+        case 's':
+            input(arg_int1);
+            input(arg);
+            array->SetItem(arg_int1, arg);
+            break;
+        case 'G':
+            input(arg_int1);
+            input(arg);
+            array->GetItemRef(arg_int1) += arg;
+            print(array->GetItemRef(arg_int1));
+            break;
+        case 'e':
+            input(arg_int1);
+            input(arg_int2);
+            input(arg_char);
+            array->Emplace(arg_int1, (std::size_t)arg_int2, arg_char);
+            break;
+        case 'a':
+            input(arg);
+            array->Append(arg);
+            break;
+        case 'v':
+            input(arg_int1);
+            array->Reserve(arg_int1);
+            break;
+        case 'L':
+            print(array->GetLength());
+            break;
+        case 'K':
+            print(array->GetCapacity());
+            break;
+        case 'F':
+            for (int i = 0; i < array->GetLength(); i++)
+                print(i << ": " << array->GetItemRef(i));
+            break;
+        case 'm':
+        {
+            input(arg_int1);
+            Engine::Utilities::Collections::ResizableArray<std::unique_ptr<int>, false> pointers;
+            for (int i = 0; i < arg_int1; i++)
+                pointers.Append(new int(i));
+            pointers.Resize(arg_int1 * 2);
+            pointers.Emplace(arg_int1, new int(arg_int1));
+            bool valid = pointers.GetItemRef(arg_int1) != nullptr && *pointers.GetItemRef(arg_int1) == arg_int1;
+            pointers.Resize(arg_int1);
+            for (int i = 0; i < arg_int1; i++)
+                valid = valid && pointers.GetItemRef(i) != nullptr && *pointers.GetItemRef(i) == i;
+            print("Length: " << pointers.GetLength() << ", Capacity: " << pointers.GetCapacity() << ", Valid: " << valid);
+            break;
+        }
+        case 't':
+        {
+            input(arg_int1);
+            Engine::Utilities::Collections::ResizableArray<int, false> ints(1);
+            Engine::Utilities::Collections::ResizableArray<OverAligned, false> aligned(1);
+            ints.SetItem(0, -1);
+            aligned.GetItemRef(0).Value = -1;
+            bool valid = true;
+            for (int i = 1; i <= arg_int1; i++)
+            {
+                int length = (i % 2 == 0) ? i * 8 : i;
+                ints.Resize(length);
+                aligned.Resize(length);
+                valid = valid && ints.GetItem(0) == -1 && ints.GetItem(length - 1) == (length == 1 ? -1 : 0);
+                valid = valid && aligned.GetItemRef(0).Value == -1 && ((std::uintptr_t)&aligned.GetItemRef(0)) % alignof(OverAligned) == 0;
+            }
+            print("Valid: " << valid);
+            break;
+        }
+        case 'x':
+        {
+            input(arg_int1);
+            {
+                Engine::Utilities::Collections::ResizableArray<ThrowingCopy, false> items(4);
+                for (int i = 0; i < 4; i++)
+                    items.GetItemRef(i).Value = std::to_string(i);
+                ThrowingCopy::CopiesBeforeThrow = arg_int1;
+                bool thrown = false;
+                try { items.Resize(8); }
+                catch (std::runtime_error&) { thrown = true; }
+                ThrowingCopy::CopiesBeforeThrow = -1;
+                bool unchanged = true;
+                for (int i = 0; i < 4; i++)
+                    unchanged = unchanged && items.GetItemRef(i).Value == std::to_string(i);
+                print("Thrown: " << thrown << ", Length: " << items.GetLength() << ", Unchanged: " << unchanged << ", Instances: " << ThrowingCopy::Instances);
+            }
+            print("Instances after destruction: " << ThrowingCopy::Instances);
+            break;
+        }
+        case 'q':
+            delete array;
+            return;
+        default:
+            break;
+        }
+    }
+    catch (std::exception& e) { print("Exception: " << e.what()); }
+}
+
+/// @brief Locks the collection on another thread for Hold milliseconds and calls Try meanwhile.
+/// @return The result of Try.
+template <typename CollectionType, typename TryType>
+bool TryWhileLocked(CollectionType * Collection, int Hold, TryType Try)
+{
+    std::atomic<bool> is_locked(false);
+    std::thread holder([&]() {
+        Collection->LockAndDo([&]() {
+            is_locked = true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(Hold));
+        });
+    });
+    while (!is_locked)
+        std::this_thread::yield();
+    try
+    {
+        bool result = Try();
+        holder.join();
+        return result;
+    }
+    catch (...)
+    {
+        holder.join();
+        throw;
+    }
+}
+
+/// @brief Fills a collection with 1000 items, clears and refills it with ShrinkThreshold 0, then with the default policy,
+///        and prints the reallocations of each Clear and refill: 0 with ShrinkThreshold 0, as Clear keeps the capacity.
+template <typename CollectionType, typename FillType>
+void TestClearCapacity(const char * Name, FillType Fill)
+{
+    Engine::Utilities::Collections::GrowthPolicy keeping_policy;
+    keeping_policy.ShrinkThreshold = 0;
+    Engine::Utilities::Collections::GrowthPolicy policies[] = { keeping_policy, Engine::Utilities::Collections::GrowthPolicy() };
+    for (int i = 0; i < 2; i++)
+    {
+        CollectionType collection;
+        collection.SetGrowthPolicy(policies[i]);
+        Fill(collection);
+        long long reallocations = collection.GetReallocationsCount();
+        int capacity = collection.GetCapacity();
+        collection.Clear();
+        Fill(collection);
+        reallocations = collection.GetReallocationsCount() - reallocations;
+        print(Name << ", ShrinkThreshold " << policies[i].ShrinkThreshold << ": capacity " << capacity
+            << ", reallocations after Clear: " << reallocations << (i == 0 && reallocations != 0 ? " (FAILED)" : ""));
+    }
+}
+
+void TestGrowthPolicies()
+{
+    TestClearCapacity<Engine::Utilities::Collections::List<int, false>>("List", [](Engine::Utilities::Collections::List<int, false>& List) {
+        for (int i = 0; i < 1000; i++) List.Add(i);
+    });
+    TestClearCapacity<Engine::Utilities::Collections::Stack<int, false>>("Stack", [](Engine::Utilities::Collections::Stack<int, false>& Stack) {
+        for (int i = 0; i < 1000; i++) Stack.Push(i);
+    });
+    TestClearCapacity<Engine::Utilities::Collections::Queue<int, false>>("Queue", [](Engine::Utilities::Collections::Queue<int, false>& Queue) {
+        for (int i = 0; i < 1000; i++) Queue.Push(i);
+    });
+    TestClearCapacity<Engine::Utilities::Collections::PriorityQueue<int, int, false, false, 2, false>>("PriorityQueue",
+        [](Engine::Utilities::Collections::PriorityQueue<int, int, false, false, 2, false>& Queue) {
+            for (int i = 0; i < 1000; i++) Queue.Push(i, i);
+        });
+}
+
 void TestList()
 {
     
@@ -106,6 +402,8 @@ void TestList()
         print("p Item Index  => Add(Item, Index)");
         print("r Index       => RemoveByIndex(Index)");
         print("R Item        => Remove(Item)");
+        print("w Item Wait Hold => TryAddUntil(Item, now + Wait) while another thread locks the list for Hold milliseconds");
+        print("W Item Wait Hold => TryRemoveUntil(Item, now + Wait) while another thread locks the list for Hold milliseconds");
         print("s Index Value => SetItem(Index, Value)");
         print("c             => Clear()");
         print("g Index       => GetItem(Index)");
@@ -121,6 +419,9 @@ void TestList()
         print("E Space           => Expand(Space)");
         print("S AdditionalSpace => Shrink(AdditionalSpace)");
         print("L                 => GetCapacity()");
+        print("P Factor Threshold Minimum Defer => SetGrowthPolicy(GrowthPolicy{ Factor, Threshold, Minimum, Defer })");
+        print("T                 => Trim()");
+        print("N                 => GetReallocationsCount()");
         print("");
         print("q => Quit List Test");
         print("");
@@ -152,6 +453,20 @@ void TestList()
                 input(arg_item);
                 print(list->Remove(arg_item));
                 break;
+            case 'w':
+            {
+                int wait, hold;
+                input(arg_item >> wait >> hold);
+                print(TryWhileLocked(list, hold, [&]() { return list->TryAddUntil(arg_item, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
+                break;
+            }
+            case 'W':
+            {
+                int wait, hold;
+                input(arg_item >> wait >> hold);
+                print(TryWhileLocked(list, hold, [&]() { return list->TryRemoveUntil(arg_item, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
+                break;
+            }
             case 's':
                 input(arg_int);
                 input(arg_item);
@@ -204,6 +519,22 @@ void TestList()
             case 'L':
                 print(list->GetCapacity());
                 break;
+            case 'P':
+            {
+                Engine::Utilities::Collections::GrowthPolicy policy;
+                input(policy.GrowthFactor);
+                input(policy.ShrinkThreshold);
+                input(policy.MinimumCapacity);
+                input(policy.DeferShrink);
+                list->SetGrowthPolicy(policy);
+                break;
+            }
+            case 'T':
+                list->Trim();
+                break;
+            case 'N':
+                print(list->GetReallocationsCount());
+                break;
             case 'q':
                 delete list;
                 return;
@@ -347,75 +678,120 @@ void TestQueue()
     catch (std::exception& e) { print("Exception: " << e.what()); }
 }
 
-void TestPriorityQueue()
+void TestOrderedDictionary()
 {
-    Engine::Utilities::Collections::PriorityQueue<ITEMS_TYPE> * queue = new Engine::Utilities::Collections::PriorityQueue<ITEMS_TYPE>();
+    Engine::Utilities::Collections::OrderedDictionary<KEY_TYPE, VALUE_TYPE> * dict = new Engine::Utilities::Collections::OrderedDictionary<KEY_TYPE, VALUE_TYPE>();
     while (true) try
     {
         print("");
-        print("p Item Priority => Push(Item, Priority)");
-        print("Pr              => Pop()");
-        print("Po              => Pop(ItemOut, PriorityOut)");
-        print("c               => Clear()");
+        print("s Key Value => SetValue(Key, Value)");
+        print("r Key       => Remove(Key)");
+        print("w Key Value Wait Hold => TrySetValueUntil(Key, Value, now + Wait) while another thread locks the dictionary for Hold milliseconds");
+        print("W Key Wait Hold       => TryRemoveUntil(Key, now + Wait) while another thread locks the dictionary for Hold milliseconds");
+        print("c           => Clear()");
+        print("b Count     => BulkLoad(Count keys \"0000\", \"0001\"... with their index as value)");
         print("");
-        print("g      => GetFirstItem()");
-        print("G      => GetFirstPriority()");
-        print("d Item => GetDepthOf(Item)");
-        print("e Item => Contains(Item)");
-        print("C      => GetCount()");
-        print("E      => IsEmpty()");
+        print("g Key     => GetValue(Key)");
+        print("l Key     => LowerBound(Key)");
+        print("u Key     => UpperBound(Key)");
+        print("e         => IsEmpty()");
+        print("C         => GetCount()");
+        print("f         => ForEach([](Key) { print(Key); })");
+        print("F         => ForEach([](Key, Value) { print(Key => Value); })");
+        print("R From To => ForEachInRange(From, To, [](Key, Value) { print(Key => Value); })");
         print("");
-        print("q => Quit PriorityQueue Test");
+        print("q => Quit OrderedDictionary Test");
         print("");
 
         char func;
-        ITEMS_TYPE arg;
         int arg_int;
+        KEY_TYPE arg_key;
+        KEY_TYPE arg_key_2;
+        VALUE_TYPE arg_value;
         input(func);
 
         switch (func)
         {
-        case 'p':
-            input(arg);
-            input(arg_int);
-            queue->Push(arg, arg_int);
+        case 's':
+            input(arg_key);
+            input(arg_value);
+            dict->SetValue(arg_key, arg_value);
             break;
-        case 'P':
-            input(func);
-            if (func == 'r')
-                print(queue->Pop());
-            else if (func == 'o')
-                print(
-                    "return value: " << queue->Pop(arg, arg_int)
-                    << "\nItemOut=" << arg
-                    << "\nPriorityOut=" << arg_int
-                );
+        case 'r':
+            input(arg_key);
+            dict->Remove(arg_key);
+            break;
+        case 'w':
+        {
+            int wait, hold;
+            input(arg_key >> arg_value >> wait >> hold);
+            print(TryWhileLocked(dict, hold, [&]() { return dict->TrySetValueUntil(arg_key, arg_value, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
+            break;
+        }
+        case 'W':
+        {
+            int wait, hold;
+            input(arg_key >> wait >> hold);
+            print(TryWhileLocked(dict, hold, [&]() { return dict->TryRemoveUntil(arg_key, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
             break;
+        }
         case 'c':
-            queue->Clear();
+            dict->Clear();
+            break;
+        case 'b':
+        {
+            input(arg_int);
+            KEY_TYPE * keys = new KEY_TYPE[arg_int];
+            VALUE_TYPE * values = new VALUE_TYPE[arg_int];
+            for (int i = 0; i < arg_int; i++)
+            {
+                std::ostringstream key;
+                key << std::setw(4) << std::setfill('0') << i;
+                keys[i] = key.str();
+                values[i] = std::to_string(i);
+            }
+            dict->BulkLoad(keys, values, arg_int);
+            delete[] keys;
+            delete[] values;
             break;
+        }
         case 'g':
-            print(queue->GetFirstItem());
+            input(arg_key);
+            print(dict->GetValue(arg_key));
             break;
-        case 'G':
-            print(queue->GetFirstPriority());
+        case 'l':
+            input(arg_key);
+            if (dict->LowerBound(arg_key, arg_key_2, arg_value))
+                print(arg_key_2 << "\t=>\t" << arg_value);
+            else
+                print("None");
             break;
-        case 'd':
-            input(arg);
-            print(queue->GetDepthOf(arg));
+        case 'u':
+            input(arg_key);
+            if (dict->UpperBound(arg_key, arg_key_2, arg_value))
+                print(arg_key_2 << "\t=>\t" << arg_value);
+            else
+                print("None");
             break;
         case 'e':
-            input(arg);
-            print(queue->Contains(arg));
+            print(dict->IsEmpty());
             break;
         case 'C':
-            print(queue->GetCount());
+            print(dict->GetCount());
             break;
-        case 'E':
-            print(queue->IsEmpty());
+        case 'f':
+            dict->ForEach([](KEY_TYPE Key) { print(Key); });
+            break;
+        case 'F':
+            dict->ForEach([](KEY_TYPE Key, VALUE_TYPE Value) { print(Key << "\t=>\t" << Value); });
+            break;
+        case 'R':
+            input(arg_key);
+            input(arg_key_2);
+            dict->ForEachInRange(arg_key, arg_key_2, [](KEY_TYPE Key, VALUE_TYPE Value) { print(Key << "\t=>\t" << Value); });
             break;
         case 'q':
-            delete queue;
+            delete dict;
             return;
         default:
             break;
@@ -424,25 +800,33 @@ void TestPriorityQueue()
     catch (std::exception& e) { print("Exception: " << e.what()); }
 }
 
-void TestDictionary()
+void TestHashDictionary()
 {
-    Engine::Utilities::Collections::Dictionary<KEY_TYPE, VALUE_TYPE> * dict = new Engine::Utilities::Collections::Dictionary<KEY_TYPE, VALUE_TYPE>();
+    Engine::Utilities::Collections::HashDictionary<KEY_TYPE, VALUE_TYPE> * dict = new Engine::Utilities::Collections::HashDictionary<KEY_TYPE, VALUE_TYPE>();
     while (true) try
     {
         print("");
         print("s Key Value => SetValue(Key, Value)");
         print("r Key       => Remove(Key)");
+        print("w Key Value Wait Hold => TrySetValueUntil(Key, Value, now + Wait) while another thread locks the dictionary for Hold milliseconds");
+        print("W Key Wait Hold       => TryRemoveUntil(Key, now + Wait) while another thread locks the dictionary for Hold milliseconds");
         print("c           => Clear()");
+        print("R Count     => Reserve(Count)");
         print("");
         print("g Key => GetValue(Key)");
+        print("t Key => TryGetValue(Key, Value)");
+        print("x Key => Contains(Key)");
         print("e     => IsEmpty()");
+        print("C     => GetCount()");
+        print("L     => GetCapacity()");
         print("f     => ForEach([](Key) { print(Key); })");
         print("F     => ForEach([](Key, Value) { print(Key => Value); })");
         print("");
-        print("q => Quit Dictionary Test");
+        print("q => Quit HashDictionary Test");
         print("");
 
         char func;
+        int arg_int;
         KEY_TYPE arg_key;
         VALUE_TYPE arg_value;
         input(func);
@@ -458,6 +842,723 @@ void TestDictionary()
             input(arg_key);
             dict->Remove(arg_key);
             break;
+        case 'w':
+        {
+            int wait, hold;
+            input(arg_key >> arg_value >> wait >> hold);
+            print(TryWhileLocked(dict, hold, [&]() { return dict->TrySetValueUntil(arg_key, arg_value, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
+            break;
+        }
+        case 'W':
+        {
+            int wait, hold;
+            input(arg_key >> wait >> hold);
+            print(TryWhileLocked(dict, hold, [&]() { return dict->TryRemoveUntil(arg_key, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
+            break;
+        }
+        case 'c':
+            dict->Clear();
+            break;
+        case 'R':
+            input(arg_int);
+            dict->Reserve(arg_int);
+            break;
+        case 'g':
+            input(arg_key);
+            print(dict->GetValue(arg_key));
+            break;
+        case 't':
+            input(arg_key);
+            if (dict->TryGetValue(arg_key, arg_value))
+                print(arg_value);
+            else
+                print("Not found");
+            break;
+        case 'x':
+            input(arg_key);
+            print(dict->Contains(arg_key));
+            break;
+        case 'e':
+            print(dict->IsEmpty());
+            break;
+        case 'C':
+            print(dict->GetCount());
+            break;
+        case 'L':
+            print(dict->GetCapacity());
+            break;
+        case 'f':
+            dict->ForEach([](KEY_TYPE Key) { print(Key); });
+            break;
+        case 'F':
+            dict->ForEach([](KEY_TYPE Key, VALUE_TYPE Value) { print(Key << "\t=>\t" << Value); });
+            break;
+        case 'q':
+            delete dict;
+            return;
+        default:
+            break;
+        }
+    }
+    catch (std::exception& e) { print("Exception: " << e.what()); }
+}
+
+void TestConcurrentDictionary()
+{
+    Engine::Utilities::Collections::ConcurrentDictionary<KEY_TYPE, VALUE_TYPE> * dict = new Engine::Utilities::Collections::ConcurrentDictionary<KEY_TYPE, VALUE_TYPE>();
+    while (true) try
+    {
+        print("");
+        print("s Key Value => SetValue(Key, Value)");
+        print("r Key       => TryRemove(Key)");
+        print("c           => Clear()");
+        print("o Key Value => GetOrAdd(Key, Value)");
+        print("u Key Value => AddOrUpdate(Key, Value, [](Key, Old) { return Old + Value; })");
+        print("");
+        print("g Key => GetValue(Key)");
+        print("x Key => Contains(Key)");
+        print("e     => IsEmpty()");
+        print("C     => GetCount()");
+        print("f     => ForEach([](Key) { print(Key); })");
+        print("F     => ForEach([](Key, Value) { print(Key => Value); })");
+        print("n     => GetSnapshot().ForEach([](Key, Value) { print(Key => Value); })");
+        print("");
+        print("d StripesCount => delete dict; dict = new ConcurrentDictionary(StripesCount)");
+        print("");
+        print("N StripesCount Count => Fill a ConcurrentDictionary(StripesCount) with Count keys, then GetSnapshot on a new thread and check it");
+        print("");
+        print("q => Quit ConcurrentDictionary Test");
+        print("");
+
+        char func;
+        int arg_int;
+        KEY_TYPE arg_key;
+        VALUE_TYPE arg_value;
+        input(func);
+
+        switch (func)
+        {
+        case 's':
+            input(arg_key);
+            input(arg_value);
+            dict->SetValue(arg_key, arg_value);
+            break;
+        case 'r':
+            input(arg_key);
+            print(dict->TryRemove(arg_key));
+            break;
+        case 'c':
+            dict->Clear();
+            break;
+        case 'o':
+            input(arg_key);
+            input(arg_value);
+            print(dict->GetOrAdd(arg_key, arg_value));
+            break;
+        case 'u':
+            input(arg_key);
+            input(arg_value);
+            print(dict->AddOrUpdate(arg_key, arg_value, [arg_value](KEY_TYPE, VALUE_TYPE Value) { return Value + arg_value; }));
+            break;
+        case 'g':
+            input(arg_key);
+            print(dict->GetValue(arg_key));
+            break;
+        case 'x':
+            input(arg_key);
+            print(dict->Contains(arg_key));
+            break;
+        case 'e':
+            print(dict->IsEmpty());
+            break;
+        case 'C':
+            print(dict->GetCount());
+            break;
+        case 'f':
+            dict->ForEach([](KEY_TYPE Key) { print(Key); });
+            break;
+        case 'F':
+            dict->ForEach([](KEY_TYPE Key, VALUE_TYPE Value) { print(Key << "\t=>\t" << Value); });
+            break;
+        case 'n':
+            dict->GetSnapshot().ForEach([](KEY_TYPE Key, VALUE_TYPE Value) { print(Key << "\t=>\t" << Value); });
+            break;
+        case 'd':
+            input(arg_int);
+            delete dict;
+            dict = new Engine::Utilities::Collections::ConcurrentDictionary<KEY_TYPE, VALUE_TYPE>(arg_int);
+            print(dict->GetStripesCount());
+            break;
+        case 'N':
+        {
+            input(arg_int);
+            int count;
+            input(count);
+            Engine::Utilities::Collections::ConcurrentDictionary<int, std::string> numbers(arg_int);
+            for (int i = 0; i < count; i++)
+                numbers.SetValue(i, std::to_string(i));
+
+            // The snapshot locks every stripe, its stack depth must not grow with them
+            int snapshot_count = 0;
+            bool matching = true;
+            auto start = std::chrono::steady_clock::now();
+            std::thread snapshotter([&]() {
+                numbers.GetSnapshot().ForEach([&](int Key, std::string Value) {
+                    snapshot_count++;
+                    if (Value != std::to_string(Key)) matching = false;
+                });
+            });
+            snapshotter.join();
+            long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            print("Stripes: " << numbers.GetStripesCount() << ", Snapshot count: " << snapshot_count << "/" << count
+                << ", Matching: " << matching << ", Time: " << milliseconds << " ms");
+            break;
+        }
+        case 'q':
+            delete dict;
+            return;
+        default:
+            break;
+        }
+    }
+    catch (std::exception& e) { print("Exception: " << e.what()); }
+}
+
+void TestInbox()
+{
+    Engine::Utilities::Collections::Inbox<ITEMS_TYPE> * inbox = new Engine::Utilities::Collections::Inbox<ITEMS_TYPE>();
+    while (true) try
+    {
+        print("");
+        print("p Item     => TryPush(Item)");
+        print("P          => TryPop(ItemOut)");
+        print("D          => Drain([](Item) { print(Item); })");
+        print("c          => Clear()");
+        print("");
+        print("k Capacity => SetCapacity(Capacity)");
+        print("K          => GetCapacity()");
+        print("C          => GetCount()");
+        print("E          => IsEmpty()");
+        print("");
+        print("t Threads Times => Threads push Times items each while draining, then check the order");
+        print("");
+        print("q => Quit Inbox Test");
+        print("");
+
+        char func;
+        int arg_int1;
+        int arg_int2;
+        ITEMS_TYPE arg;
+        input(func);
+
+        switch (func)
+        {
+        case 'p':
+            input(arg);
+            print(inbox->TryPush(arg));
+            break;
+        case 'P':
+            if (inbox->TryPop(arg))
+                print(arg);
+            else
+                print("Empty");
+            break;
+        case 'D':
+            print("Drained: " << inbox->Drain([](ITEMS_TYPE& Item) { print(Item); }));
+            break;
+        case 'c':
+            inbox->Clear();
+            break;
+        case 'k':
+            input(arg_int1);
+            inbox->SetCapacity(arg_int1);
+            break;
+        case 'K':
+            print(inbox->GetCapacity());
+            break;
+        case 'C':
+            print(inbox->GetCount());
+            break;
+        case 'E':
+            print(inbox->IsEmpty());
+            break;
+        case 't':
+        {
+            input(arg_int1);
+            input(arg_int2);
+            std::thread ** threads = new std::thread*[arg_int1];
+            int pushed = 0;
+            std::mutex pushed_mutex;
+            std::atomic<int> running(arg_int1);
+            for (int i = 0; i < arg_int1; i++)
+                threads[i] = new std::thread([&](int Index) {
+                    int local_pushed = 0;
+                    for (int j = 0; j < arg_int2; j++)
+                        if (inbox->TryPush(std::to_string(Index) + ":" + std::to_string(j)))
+                            local_pushed++;
+                    std::lock_guard<std::mutex> guard(pushed_mutex);
+                    pushed += local_pushed;
+                    running--;
+                }, i);
+
+            // Drains while pushing, so the pushes reuse the drained nodes.
+            // The items of each thread must be drained in the order they are pushed.
+            int * next = new int[arg_int1]();
+            bool ordered = true;
+            int drained = 0;
+            auto check = [&](ITEMS_TYPE& Item) {
+                int thread_index = std::stoi(Item.substr(0, Item.find(':')));
+                int item_index = std::stoi(Item.substr(Item.find(':') + 1));
+                if (item_index < next[thread_index])
+                    ordered = false;
+                next[thread_index] = item_index + 1;
+            };
+            while (running > 0)
+                drained += inbox->Drain(check);
+            for (int i = 0; i < arg_int1; i++)
+            {
+                threads[i]->join();
+                delete threads[i];
+            }
+            delete[] threads;
+            drained += inbox->Drain(check);
+            delete[] next;
+            print("Pushed: " << pushed << ", Drained: " << drained << ", Ordered: " << ordered);
+            break;
+        }
+        case 'q':
+            delete inbox;
+            return;
+        default:
+            break;
+        }
+    }
+    catch (std::exception& e) { print("Exception: " << e.what()); }
+}
+
+template <typename QueueType>
+void TestRingQueue(const char * Name, bool MultipleThreads)
+{
+    print("Capacity:");
+    int capacity;
+    input(capacity);
+    QueueType * queue = new QueueType(capacity);
+    while (true) try
+    {
+        print("");
+        print("p Item                => TryPush(Item)");
+        print("b Count Item1 Item2...=> TryPush(Items, Count)");
+        print("P                     => TryPop(ItemOut)");
+        print("B Count               => TryPop(ItemsOut, Count)");
+        print("w Milliseconds        => TryPopUntil(ItemOut, now + Milliseconds)");
+        print("c                     => Clear()");
+        print("");
+        print("K => GetCapacity()");
+        print("C => GetCount()");
+        print("E => IsEmpty()");
+        print("");
+        if (MultipleThreads)
+            print("t Producers Consumers Times => Producers Push Times items each while Consumers Pop, then check the order");
+        else
+            print("t Times => A producer Pushes Times items while a consumer Pops, then check the order");
+        print("");
+        print("q => Quit " << Name << " Test");
+        print("");
+
+        char func;
+        int arg_int;
+        ITEMS_TYPE arg;
+        input(func);
+
+        switch (func)
+        {
+        case 'p':
+            input(arg);
+            print(queue->TryPush(arg));
+            break;
+        case 'b':
+        {
+            input(arg_int);
+            ITEMS_TYPE * items = new ITEMS_TYPE[arg_int];
+            for (int i = 0; i < arg_int; i++)
+                input(items[i]);
+            print("Pushed: " << queue->TryPush(items, arg_int));
+            delete[] items;
+            break;
+        }
+        case 'P':
+            if (queue->TryPop(arg))
+                print(arg);
+            else
+                print("Empty");
+            break;
+        case 'B':
+        {
+            input(arg_int);
+            ITEMS_TYPE * items = new ITEMS_TYPE[arg_int];
+            int popped = queue->TryPop(items, arg_int);
+            for (int i = 0; i < popped; i++)
+                print(items[i]);
+            print("Popped: " << popped);
+            delete[] items;
+            break;
+        }
+        case 'w':
+            input(arg_int);
+            if (queue->TryPopUntil(arg, std::chrono::steady_clock::now() + std::chrono::milliseconds(arg_int)))
+                print(arg);
+            else
+                print("Timeout");
+            break;
+        case 'c':
+            queue->Clear();
+            break;
+        case 'K':
+            print(queue->GetCapacity());
+            break;
+        case 'C':
+            print(queue->GetCount());
+            break;
+        case 'E':
+            print(queue->IsEmpty());
+            break;
+        case 't':
+        {
+            int producers_count = 1;
+            int consumers_count = 1;
+            int times;
+            if (MultipleThreads)
+            {
+                input(producers_count);
+                input(consumers_count);
+            }
+            input(times);
+
+            // The items of each producer must be popped by each consumer in the order they are pushed
+            int ** next = new int*[consumers_count];
+            int popped = 0;
+            bool ordered = true;
+            std::mutex popped_mutex;
+            std::thread ** threads = new std::thread*[producers_count + consumers_count];
+            for (int i = 0; i < consumers_count; i++)
+            {
+                next[i] = new int[producers_count]();
+                threads[i] = new std::thread([&](int Index) {
+                    int local_popped = 0;
+                    bool local_ordered = true;
+                    while (true)
+                    {
+                        ITEMS_TYPE item = queue->Pop();
+                        if (item.empty())
+                            break; // Stop item
+                        int thread_index = std::stoi(item.substr(0, item.find(':')));
+                        int item_index = std::stoi(item.substr(item.find(':') + 1));
+                        if (item_index < next[Index][thread_index])
+                            local_ordered = false;
+                        next[Index][thread_index] = item_index + 1;
+                        local_popped++;
+                    }
+                    std::lock_guard<std::mutex> guard(popped_mutex);
+                    popped += local_popped;
+                    ordered = ordered && local_ordered;
+                }, i);
+            }
+            for (int i = 0; i < producers_count; i++)
+                threads[consumers_count + i] = new std::thread([&](int Index) {
+                    for (int j = 0; j < times; j++)
+                        queue->Push(std::to_string(Index) + ":" + std::to_string(j));
+                }, i);
+            for (int i = 0; i < producers_count; i++)
+                threads[consumers_count + i]->join();
+            for (int i = 0; i < consumers_count; i++)
+                queue->Push(ITEMS_TYPE());
+            for (int i = 0; i < producers_count + consumers_count; i++)
+            {
+                if (i < consumers_count)
+                    threads[i]->join();
+                delete threads[i];
+            }
+            for (int i = 0; i < consumers_count; i++)
+                delete[] next[i];
+            delete[] next;
+            delete[] threads;
+            print("Pushed: " << producers_count * times << ", Popped: " << popped << ", Ordered: " << ordered);
+            break;
+        }
+        case 'q':
+            delete queue;
+            return;
+        default:
+            break;
+        }
+    }
+    catch (std::exception& e) { print("Exception: " << e.what()); }
+}
+
+void TestPriorityQueue()
+{
+    Engine::Utilities::Collections::PriorityQueue<ITEMS_TYPE> * queue = new Engine::Utilities::Collections::PriorityQueue<ITEMS_TYPE>();
+    while (true) try
+    {
+        print("");
+        print("p Item Priority => Push(Item, Priority)");
+        print("b Count Item1 Priority1 Item2 Priority2... => Push(Items, Priorities, Count)");
+        print("Pr              => Pop()");
+        print("Po              => Pop(ItemOut, PriorityOut)");
+        print("c               => Clear()");
+        print("");
+        print("g      => GetFirstItem()");
+        print("G      => GetFirstPriority()");
+        print("d Item => GetDepthOf(Item)");
+        print("e Item => Contains(Item)");
+        print("C      => GetCount()");
+        print("E      => IsEmpty()");
+        print("");
+        print("q => Quit PriorityQueue Test");
+        print("");
+
+        char func;
+        ITEMS_TYPE arg;
+        int arg_int;
+        input(func);
+
+        switch (func)
+        {
+        case 'p':
+            input(arg);
+            input(arg_int);
+            queue->Push(arg, arg_int);
+            break;
+        case 'b':
+        {
+            input(arg_int);
+            int count = arg_int;
+            ITEMS_TYPE * items = new ITEMS_TYPE[count];
+            int * priorities = new int[count];
+            for (int i = 0; i < count; i++)
+            {
+                input(items[i]);
+                input(priorities[i]);
+            }
+            queue->Push(items, priorities, count);
+            delete[] items;
+            delete[] priorities;
+            break;
+        }
+        case 'P':
+            input(func);
+            if (func == 'r')
+                print(queue->Pop());
+            else if (func == 'o')
+                print(
+                    "return value: " << queue->Pop(arg, arg_int)
+                    << "\nItemOut=" << arg
+                    << "\nPriorityOut=" << arg_int
+                );
+            break;
+        case 'c':
+            queue->Clear();
+            break;
+        case 'g':
+            print(queue->GetFirstItem());
+            break;
+        case 'G':
+            print(queue->GetFirstPriority());
+            break;
+        case 'd':
+            input(arg);
+            print(queue->GetDepthOf(arg));
+            break;
+        case 'e':
+            input(arg);
+            print(queue->Contains(arg));
+            break;
+        case 'C':
+            print(queue->GetCount());
+            break;
+        case 'E':
+            print(queue->IsEmpty());
+            break;
+        case 'q':
+            delete queue;
+            return;
+        default:
+            break;
+        }
+    }
+    catch (std::exception& e) { print("Exception: " << e.what()); }
+}
+
+void TestIndexedPriorityQueue()
+{
+    typedef Engine::Utilities::Collections::IndexedPriorityQueue<ITEMS_TYPE> QueueType;
+    QueueType * queue = new QueueType();
+    while (true) try
+    {
+        print("");
+        print("p Item Priority   => Push(Item, Priority)");
+        print("u Handle Priority => UpdatePriority(Handle, Priority)");
+        print("r Handle          => Remove(Handle)");
+        print("Pr                => Pop()");
+        print("Po                => Pop(ItemOut, PriorityOut)");
+        print("c                 => Clear()");
+        print("");
+        print("g        => GetFirstItem()");
+        print("G        => GetFirstPriority()");
+        print("H        => GetFirstHandle()");
+        print("i Handle => GetItem(Handle)");
+        print("I Handle => GetPriority(Handle)");
+        print("e Handle => Contains(Handle)");
+        print("C        => GetCount()");
+        print("E        => IsEmpty()");
+        print("");
+        print("w Times => Push and TryRemove an item in the same slot Times times and check the handles,");
+        print("           then check that a forged handle of slot -1 is not found; 2147483648 times wraps the generation");
+        print("");
+        print("q => Quit IndexedPriorityQueue Test");
+        print("");
+
+        char func;
+        ITEMS_TYPE arg;
+        int arg_int;
+        QueueType::Handle arg_handle;
+        input(func);
+
+        switch (func)
+        {
+        case 'p':
+            input(arg);
+            input(arg_int);
+            print("Handle=" << queue->Push(arg, arg_int));
+            break;
+        case 'u':
+            input(arg_handle);
+            input(arg_int);
+            queue->UpdatePriority(arg_handle, arg_int);
+            break;
+        case 'r':
+            input(arg_handle);
+            queue->Remove(arg_handle);
+            break;
+        case 'P':
+            input(func);
+            if (func == 'r')
+                print(queue->Pop());
+            else if (func == 'o')
+                print(
+                    "return value: " << queue->Pop(arg, arg_int)
+                    << "\nItemOut=" << arg
+                    << "\nPriorityOut=" << arg_int
+                );
+            break;
+        case 'c':
+            queue->Clear();
+            break;
+        case 'g':
+            print(queue->GetFirstItem());
+            break;
+        case 'G':
+            print(queue->GetFirstPriority());
+            break;
+        case 'H':
+            print(queue->GetFirstHandle());
+            break;
+        case 'i':
+            input(arg_handle);
+            print(queue->GetItem(arg_handle));
+            break;
+        case 'I':
+            input(arg_handle);
+            print(queue->GetPriority(arg_handle));
+            break;
+        case 'e':
+            input(arg_handle);
+            print(queue->Contains(arg_handle));
+            break;
+        case 'C':
+            print(queue->GetCount());
+            break;
+        case 'E':
+            print(queue->IsEmpty());
+            break;
+        case 'w':
+        {
+            long long times;
+            input(times);
+            Engine::Utilities::Collections::IndexedPriorityQueue<int, int, true, false> numbers;
+            QueueType::Handle handle = 0;
+            long long invalid = 0;
+            for (long long i = 0; i < times; i++)
+            {
+                handle = numbers.Push(0, 0);
+                if (handle <= 0 || !numbers.TryRemove(handle))
+                    invalid++;
+            }
+            QueueType::Handle forged = ((QueueType::Handle)1 << 32) | 0xFFFFFFFF;
+            print("Last generation: " << (handle >> 32) << ", Invalid handles: " << invalid
+                << ", Forged handle found: " << numbers.Contains(forged) << (invalid == 0 ? "" : " (FAILED)"));
+            break;
+        }
+        case 'q':
+            delete queue;
+            return;
+        default:
+            break;
+        }
+    }
+    catch (std::exception& e) { print("Exception: " << e.what()); }
+}
+
+void TestDictionary()
+{
+    Engine::Utilities::Collections::Dictionary<KEY_TYPE, VALUE_TYPE> * dict = new Engine::Utilities::Collections::Dictionary<KEY_TYPE, VALUE_TYPE>();
+    while (true) try
+    {
+        print("");
+        print("s Key Value => SetValue(Key, Value)");
+        print("r Key       => Remove(Key)");
+        print("w Key Value Wait Hold => TrySetValueUntil(Key, Value, now + Wait) while another thread locks the dictionary for Hold milliseconds");
+        print("W Key Wait Hold       => TryRemoveUntil(Key, now + Wait) while another thread locks the dictionary for Hold milliseconds");
+        print("c           => Clear()");
+        print("");
+        print("g Key => GetValue(Key)");
+        print("e     => IsEmpty()");
+        print("f     => ForEach([](Key) { print(Key); })");
+        print("F     => ForEach([](Key, Value) { print(Key => Value); })");
+        print("");
+        print("q => Quit Dictionary Test");
+        print("");
+
+        char func;
+        KEY_TYPE arg_key;
+        VALUE_TYPE arg_value;
+        input(func);
+
+        switch (func)
+        {
+        case 's':
+            input(arg_key);
+            input(arg_value);
+            dict->SetValue(arg_key, arg_value);
+            break;
+        case 'r':
+            input(arg_key);
+            dict->Remove(arg_key);
+            break;
+        case 'w':
+        {
+            int wait, hold;
+            input(arg_key >> arg_value >> wait >> hold);
+            print(TryWhileLocked(dict, hold, [&]() { return dict->TrySetValueUntil(arg_key, arg_value, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
+            break;
+        }
+        case 'W':
+        {
+            int wait, hold;
+            input(arg_key >> wait >> hold);
+            print(TryWhileLocked(dict, hold, [&]() { return dict->TryRemoveUntil(arg_key, std::chrono::steady_clock::now() + std::chrono::milliseconds(wait)); }));
+            break;
+        }
         case 'c':
             dict->Clear();
             break;
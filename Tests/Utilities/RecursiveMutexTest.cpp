@@ -53,6 +53,26 @@ Example tests:
         0.751621: thread-3: done, destroying all local guards...
         0.751790: thread-4: done, destroying all local guards..
 
+- timed lock, timed shared-lock and timed upgradable-shared-lock:
+
+    input:
+        c
+        n         l   0     s 300 d
+        n s 100   fsl 0 100 s 100 d
+        n s 100   ful 0 400 s 100 d
+        n s 350   fl  0 100 s 100 d
+        s
+
+    possible output:
+        0.000312: thread-0: locked: local0-0
+        0.200544: thread-1: timed-shared-lock timed out: local1-shared-0
+        0.300518: thread-0: done, destroying all local guards...
+        0.300601: thread-2: timed-upgradable-shared-lock successful: local2-upgradable-shared-0
+        0.300713: thread-1: done, destroying all local guards...
+        0.400757: thread-2: done, destroying all local guards...
+        0.400862: thread-3: timed-lock successful: local3-0
+        0.500984: thread-3: done, destroying all local guards...
+
 - invalid operations (example: transition from shared-lock to lock or upgradable-shared-lock):
 
     input:
@@ -100,6 +120,25 @@ Example tests:
         1.101377: thread-3: try-lock successful: local3-0
         1.101395: thread-3: done, destroying all local guards...
 
+- upgrade and downgrade (a new shared-lock waits for the upgrade, whatever the fairness):
+
+    input:
+        c
+        n       ul 0 s 100 up 0 s 100 dn 0 s 100 d
+        n       sl 0 s 200 d
+        n s 150 sl 0 d
+        s
+
+    possible output:
+        0.000305: thread-0: upgradable-shared-lock: local0-upgradable-shared-0
+        0.000412: thread-1: shared-locked: local1-shared-0
+        0.200531: thread-1: done, destroying all local guards...
+        0.200602: thread-0: upgraded: local0-upgradable-shared-0 to local0-0
+        0.300698: thread-0: downgraded: local0-0 to local0-shared-0
+        0.300745: thread-2: shared-locked: local2-shared-0
+        0.300761: thread-2: done, destroying all local guards...
+        0.400812: thread-0: done, destroying all local guards...
+
 - transition from lock to shared-lock:
 
     input:
@@ -158,18 +197,50 @@ Example tests:
         1.051987: thread-0: locked: local0-0
         1.052001: thread-0: done, destroying all local guards...
 
+- fairness (the default RecursiveMutex<> is PhaseFair: a shared-lock that arrives while a lock waits
+  goes after that lock, but before the next one; enter f to compare with the other fairness policies):
+
+    input:
+        c
+        n         sl 0 s 300 d
+        n s 100   l  0 s 100 d
+        n s 200   sl 0 s 100 d
+        n s 250   l  0 s 100 d
+        n s 350   sl 0 s 100 d
+        s
+
+    possible output:
+        0.000116: thread-0: shared-locked: local0-shared-0
+        0.300205: thread-0: done, destroying all local guards...
+        0.300324: thread-1: locked: local1-0
+        0.400398: thread-1: done, destroying all local guards...
+        0.400497: thread-2: shared-locked: local2-shared-0
+        0.400506: thread-4: shared-locked: local4-shared-0
+        0.500617: thread-4: done, destroying all local guards...
+        0.500711: thread-2: done, destroying all local guards...
+        0.500738: thread-3: locked: local3-0
+        0.600828: thread-3: done, destroying all local guards...
+
 RecursiveMutexTest tests:
     print locking:   c  n l 0 s 500 d  n sl 0 s 500 d  n sl 0 s 500 d  n sl 0 s 500 d  n ul 0 s 500 d  s
     lock exceptions: c  n sl 0 l 0 tl 0 ul 0 gl 0 gtl 0 gul 0 d  s
     dict exceptions: c  n u 0 l 0 u 0 u 0 u 1 su 0 uu 0 gu 0 gsu 0 guu 0 d  s
+    fairness:        f
+    exclusion:       x 4 100000
+    shared counting: r 8 100000
+    many shared-locks: m 1000 100
+    shared values:   v 4 100000
 
 // ---------------------------------------------------------------- */
 
 #include "../../Engine/Engine.h"
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <numeric>
+#include <random>
 #include <string>
 #include <thread>
 #include <vector>
@@ -264,7 +335,12 @@ enum CommandType
     TryUpgradableSharedLock,
     GlobalTryLock,
     GlobalTrySharedLock,
-    GlobalTryUpgradableSharedLock
+    GlobalTryUpgradableSharedLock,
+    TimedLock,
+    TimedSharedLock,
+    TimedUpgradableSharedLock,
+    Upgrade,
+    Downgrade
 };
 
 /// @brief Converts a short command name from CLI to CommandType to use in TestThread.
@@ -289,6 +365,11 @@ CommandType NameToCommandType(std::string name)
     else if (name == "gtl") return GlobalTryLock;
     else if (name == "gtsl") return GlobalTrySharedLock;
     else if (name == "gtul") return GlobalTryUpgradableSharedLock;
+    else if (name == "fl") return TimedLock;
+    else if (name == "fsl") return TimedSharedLock;
+    else if (name == "ful") return TimedUpgradableSharedLock;
+    else if (name == "up") return Upgrade;
+    else if (name == "dn") return Downgrade;
     else throw std::domain_error("Undefined command");
 }
 
@@ -299,12 +380,22 @@ struct Command
     std::string GuardId;
     /// @brief Sleep duration in milliseconds. Only used if the CommandType is Sleep.
     double SleepDuration;
+    /// @brief Timeout in milliseconds. Only used if the CommandType is a timed lock.
+    double Timeout;
     Command() {}
     /// @brief Constructs a Sleep type command.
     Command(double SleepDuration) : Type(CommandType::Sleep), SleepDuration(SleepDuration) {}
     Command(CommandType Type, std::string GuardId) : Type(Type), GuardId(GuardId) {}
+    /// @brief Constructs a timed lock type command.
+    Command(CommandType Type, std::string GuardId, double Timeout) : Type(Type), GuardId(GuardId), Timeout(Timeout) {}
 };
 
+/// @brief Checks whether a CommandType takes a timeout after its guard id.
+bool IsTimedCommandType(CommandType Type)
+{
+    return Type == TimedLock || Type == TimedSharedLock || Type == TimedUpgradableSharedLock;
+}
+
 /// @brief Used to create test threads containing command lists by user.
 class TestThread
 {
@@ -479,6 +570,104 @@ private:
         }
     }
 
+    /// @brief Implementation of commands of type CommandType::TimedLock
+    void TimedLock(std::string guard_id, double timeout)
+    {
+        std::string expanded_guard_id = "local" + std::to_string(ID) + "-" + guard_id;
+        try
+        {
+            EnsureGuardExistence(LockGuards, guard_id);
+            RecursiveMutex<>::LockGuard guard;
+            if (GlobalTestMutex.TryGetLockFor(guard, std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout * 1ms)))
+            {
+                *LockGuards.GetValue(guard_id) = guard;
+                print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": timed-lock successful: " << expanded_guard_id);
+            }
+            else print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": timed-lock timed out: " << expanded_guard_id);
+        }
+        catch (RecursiveMutex<>::LockAfterSharedLockException& e)
+        {
+            print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": exception on timed-lock attempt, "
+                                                << expanded_guard_id << ": " << e.what());
+        }
+    }
+
+    /// @brief Implementation of commands of type CommandType::TimedSharedLock
+    void TimedSharedLock(std::string guard_id, double timeout)
+    {
+        std::string expanded_guard_id = "local" + std::to_string(ID) + "-shared-" + guard_id;
+        EnsureGuardExistence(SharedLockGuards, guard_id);
+        RecursiveMutex<>::SharedLockGuard guard;
+        if (GlobalTestMutex.TryGetSharedLockFor(guard, std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout * 1ms)))
+        {
+            *SharedLockGuards.GetValue(guard_id) = guard;
+            print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": timed-shared-lock successful: " << expanded_guard_id);
+        }
+        else print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": timed-shared-lock timed out: " << expanded_guard_id);
+    }
+
+    /// @brief Implementation of commands of type CommandType::TimedUpgradableSharedLock
+    void TimedUpgradableSharedLock(std::string guard_id, double timeout)
+    {
+        std::string expanded_guard_id = "local" + std::to_string(ID) + "-upgradable-shared-" + guard_id;
+        try
+        {
+            EnsureGuardExistence(UpgradableSharedLockGuards, guard_id);
+            RecursiveMutex<>::UpgradableSharedLockGuard guard;
+            if (GlobalTestMutex.TryGetUpgradableSharedLockFor(guard, std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout * 1ms)))
+            {
+                *UpgradableSharedLockGuards.GetValue(guard_id) = guard;
+                print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": timed-upgradable-shared-lock successful: " << expanded_guard_id);
+            }
+            else print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": timed-upgradable-shared-lock timed out: " << expanded_guard_id);
+        }
+        catch (RecursiveMutex<>::UpgradableSharedLockAfterSharedLockException& e)
+        {
+            print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": exception on timed-upgradable-shared-lock attempt, "
+                                                << expanded_guard_id << ": " << e.what());
+        }
+    }
+
+    /// @brief Implementation of commands of type CommandType::Upgrade
+    void Upgrade(std::string guard_id)
+    {
+        std::string expanded_upgradable_guard_id = "local" + std::to_string(ID) + "-upgradable-shared-" + guard_id;
+        std::string expanded_guard_id = "local" + std::to_string(ID) + "-" + guard_id;
+        try
+        {
+            EnsureGuardExistence(UpgradableSharedLockGuards, guard_id);
+            EnsureGuardExistence(LockGuards, guard_id);
+            *LockGuards.GetValue(guard_id) = UpgradableSharedLockGuards.GetValue(guard_id)->Upgrade();
+            print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": upgraded: "
+                                                << expanded_upgradable_guard_id << " to " << expanded_guard_id);
+        }
+        catch (RecursiveMutex<>::InvalidOperation& e) // UnlockedGuardException or LockAfterSharedLockException
+        {
+            print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": exception on upgrade attempt, "
+                                                << expanded_upgradable_guard_id << ": " << e.what());
+        }
+    }
+
+    /// @brief Implementation of commands of type CommandType::Downgrade
+    void Downgrade(std::string guard_id)
+    {
+        std::string expanded_guard_id = "local" + std::to_string(ID) + "-" + guard_id;
+        std::string expanded_shared_guard_id = "local" + std::to_string(ID) + "-shared-" + guard_id;
+        try
+        {
+            EnsureGuardExistence(LockGuards, guard_id);
+            EnsureGuardExistence(SharedLockGuards, guard_id);
+            *SharedLockGuards.GetValue(guard_id) = LockGuards.GetValue(guard_id)->Downgrade();
+            print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": downgraded: "
+                                                << expanded_guard_id << " to " << expanded_shared_guard_id);
+        }
+        catch (RecursiveMutex<>::UnlockedGuardException& e)
+        {
+            print_locked(GetStrTimeSinceStart() << ": thread-" << ID << ": exception on downgrade attempt, "
+                                                << expanded_guard_id << ": " << e.what());
+        }
+    }
+
     /// @brief Implementation of commands of type CommandType::GlobalLock
     void GlobalLock(std::string guard_id)
     {
@@ -659,6 +848,13 @@ private:
             case CommandType::GlobalTryLock:                 GlobalTryLock(cmd.GuardId);                 break;
             case CommandType::GlobalTrySharedLock:           GlobalTrySharedLock(cmd.GuardId);           break;
             case CommandType::GlobalTryUpgradableSharedLock: GlobalTryUpgradableSharedLock(cmd.GuardId); break;
+            // ------------------------------------
+            case CommandType::TimedLock:                     TimedLock(cmd.GuardId, cmd.Timeout);                     break;
+            case CommandType::TimedSharedLock:               TimedSharedLock(cmd.GuardId, cmd.Timeout);               break;
+            case CommandType::TimedUpgradableSharedLock:     TimedUpgradableSharedLock(cmd.GuardId, cmd.Timeout);     break;
+            // ------------------------------------
+            case CommandType::Upgrade:                       Upgrade(cmd.GuardId);                       break;
+            case CommandType::Downgrade:                     Downgrade(cmd.GuardId);                     break;
         }
     }
 
@@ -676,11 +872,17 @@ public:
             print("Command:");
             print("  s <milliseconds>           => Sleep");
             print("  <mutex_command> <guard_id> => Mutex commands");
+            print("  <timed_command> <guard_id> <milliseconds> => Timed mutex commands");
             print("Local guard mutex commands:");
             print("  l:  Lock, u: Unlock,      sl:  SharedLock, su: SharedUnlock");
             print("  ul: UpgradableSharedLock, uu: UpgradableSharedUnlock");
             print("  tl: TryLock,              tsl: TrySharedLock");
             print("  tul: TryUpgradableSharedLock");
+            print("Local guard timed mutex commands:");
+            print("  fl:  TimedLock,            fsl: TimedSharedLock");
+            print("  ful: TimedUpgradableSharedLock");
+            print("  up:  Upgrade the upgradable-shared-lock guard to the lock guard of the same id");
+            print("  dn:  Downgrade the lock guard to the shared-lock guard of the same id");
             print("Global guard mutex commands");
             print("  gl:  Lock, gu: Unlock,     gsl:  SharedLock, gsu: SharedUnlock");
             print("  gul: UpgradableSharedLock, guu: UpgradableSharedUnlock");
@@ -703,7 +905,12 @@ public:
                 {
                     CommandType Type = NameToCommandType(str);
                     input(str);
-                    Commands.push_back(Command(Type, str));
+                    if (IsTimedCommandType(Type))
+                    {
+                        input(number);
+                        Commands.push_back(Command(Type, str, number));
+                    }
+                    else Commands.push_back(Command(Type, str));
                 }
                 catch (std::domain_error&) // thrown by NameToCommandType
                 {
@@ -736,6 +943,195 @@ public:
     }
 };
 
+/// @brief Runs the fairness example on a new mutex and gets the order of the acquisitions:
+///        r0 shared-locks, w1 waits to lock, r2 shared-locks while w1 waits,
+///        w3 waits to lock and r4 shared-locks while w1 holds the lock.
+template <typename MutexType>
+std::string GetFairnessOrder()
+{
+    MutexType mutex;
+    std::mutex order_mutex;
+    std::string order;
+    auto acquired = [&](const char* name)
+    {
+        std::lock_guard<std::mutex> guard(order_mutex);
+        order += order.empty() ? name : std::string(" ") + name;
+    };
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() { auto guard = mutex.GetSharedLock(); acquired("r0"); std::this_thread::sleep_for(300ms); });
+    threads.emplace_back([&]() { std::this_thread::sleep_for(100ms); auto guard = mutex.GetLock(); acquired("w1"); std::this_thread::sleep_for(100ms); });
+    threads.emplace_back([&]() { std::this_thread::sleep_for(200ms); auto guard = mutex.GetSharedLock(); acquired("r2"); std::this_thread::sleep_for(100ms); });
+    threads.emplace_back([&]() { std::this_thread::sleep_for(250ms); auto guard = mutex.GetLock(); acquired("w3"); std::this_thread::sleep_for(100ms); });
+    threads.emplace_back([&]() { std::this_thread::sleep_for(350ms); auto guard = mutex.GetSharedLock(); acquired("r4"); std::this_thread::sleep_for(100ms); });
+    for (auto& t : threads) t.join();
+    return order;
+}
+
+/// @brief Prints the acquisition order of every fairness policy, and checks that the default one is PhaseFair.
+void FairnessTest()
+{
+    std::string reader_preferring = GetFairnessOrder<RecursiveMutex<true, true, ReaderPreferring>>();
+    std::string writer_preferring = GetFairnessOrder<RecursiveMutex<true, true, WriterPreferring>>();
+    std::string phase_fair = GetFairnessOrder<RecursiveMutex<true, true, PhaseFair>>();
+    std::string default_fairness = GetFairnessOrder<RecursiveMutex<>>();
+    print("ReaderPreferring:           " << reader_preferring << (reader_preferring == "r0 r2 w1 r4 w3" ? "" : " (expected r0 r2 w1 r4 w3)"));
+    print("WriterPreferring:           " << writer_preferring << (writer_preferring == "r0 w1 w3 r2 r4" ? "" : " (expected r0 w1 w3 r2 r4)"));
+    print("PhaseFair:                  " << phase_fair << (phase_fair == "r0 w1 r2 r4 w3" ? "" : " (expected r0 w1 r2 r4 w3)"));
+    print("RecursiveMutex<> (default): " << default_fairness << (default_fairness == phase_fair ? " (PhaseFair)" : " (not PhaseFair)"));
+}
+
+/// @brief Mixes locks and shared-locks of a mutex on ThreadsCount threads, checks that a lock excludes
+///        every other holder and that no increment done under the lock is lost.
+void ExclusionTest(int ThreadsCount, int Iterations)
+{
+    RecursiveMutex<> mutex;
+    int counter = 0; // Only changed under the lock
+    std::atomic<int> writers(0);
+    std::atomic<int> readers(0);
+    std::atomic<int> violations(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadsCount; t++)
+        threads.emplace_back([&]()
+        {
+            for (int i = 0; i < Iterations; i++)
+            {
+                if (i % 4 == 0)
+                {
+                    auto guard = mutex.GetLock();
+                    if (writers++ != 0 || readers != 0) violations++;
+                    counter++;
+                    writers--;
+                }
+                else
+                {
+                    auto guard = mutex.GetSharedLock();
+                    readers++;
+                    if (writers != 0) violations++;
+                    readers--;
+                }
+            }
+        });
+    for (auto& t : threads) t.join();
+    int expected = ThreadsCount * ((Iterations + 3) / 4);
+    print("Counter: " << counter << "/" << expected << ", Violations: " << violations
+        << (counter == expected && violations == 0 ? "" : " (FAILED)"));
+}
+
+/// @brief Takes nested shared-locks of a mutex on ThreadsCount threads and checks that every thread's
+///        shared-lock count returns to 0: a thread can lock after releasing its shared-locks,
+///        and the mutex can be try-locked once all the threads are done.
+void SharedCountingTest(int ThreadsCount, int Iterations)
+{
+    RecursiveMutex<> mutex;
+    std::atomic<int> exceptions(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadsCount; t++)
+        threads.emplace_back([&]()
+        {
+            for (int i = 0; i < Iterations; i++)
+            {
+                {
+                    std::vector<RecursiveMutex<>::SharedLockGuard> guards;
+                    for (int depth = 0; depth <= i % 3; depth++)
+                        guards.push_back(mutex.GetSharedLock());
+                }
+                if (i % 8 == 0)
+                {
+                    try { auto guard = mutex.GetLock(); }
+                    catch (RecursiveMutex<>::InvalidOperation&) { exceptions++; }
+                }
+            }
+        });
+    for (auto& t : threads) t.join();
+    RecursiveMutex<>::LockGuard guard;
+    bool is_locked = mutex.TryGetLock(guard);
+    print("Lock exceptions: " << exceptions << ", Try-lock after the threads: " << (is_locked ? "successful" : "failed")
+        << (exceptions == 0 && is_locked ? "" : " (FAILED)"));
+}
+
+/// @brief Shared-locks MutexesCount mutexes at once in a shuffled order, every other one twice, and releases the guards
+///        in another shuffled order, Iterations times. Past the few inline slots, the shared-locks of the thread
+///        are found through a hash table: a held mutex must refuse the lock of the thread, a released one must not.
+void ManySharedLocksTest(int MutexesCount, int Iterations)
+{
+    std::vector<RecursiveMutex<>> mutexes(MutexesCount);
+    std::vector<int> order(MutexesCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 random(42);
+    int failures = 0;
+    for (int i = 0; i < Iterations; i++)
+    {
+        std::shuffle(order.begin(), order.end(), random);
+        std::vector<RecursiveMutex<>::SharedLockGuard> guards;
+        for (int index : order)
+        {
+            guards.push_back(mutexes[index].GetSharedLock());
+            if (index % 2 == 0)
+                guards.push_back(mutexes[index].GetSharedLock());
+        }
+        for (auto& mutex : mutexes)
+        {
+            RecursiveMutex<>::LockGuard guard;
+            try { if (mutex.TryGetLock(guard)) failures++; }
+            catch (RecursiveMutex<>::InvalidOperation&) {}
+        }
+
+        std::vector<int> release_order(guards.size());
+        std::iota(release_order.begin(), release_order.end(), 0);
+        std::shuffle(release_order.begin(), release_order.end(), random);
+        for (int index : release_order)
+            guards[index] = RecursiveMutex<>::SharedLockGuard();
+        for (auto& mutex : mutexes)
+        {
+            RecursiveMutex<>::LockGuard guard;
+            if (!mutex.TryGetLock(guard)) failures++;
+        }
+    }
+    print("Failures: " << failures << (failures == 0 ? "" : " (FAILED)"));
+}
+
+/// @brief A value that is too large for a lock-free std::atomic, so Shared stores it behind a sequence lock.
+struct Triple
+{
+    long long A, B, C;
+};
+
+/// @brief Adds to a Shared<int> and sets a Shared<Triple> and a Shared<std::string> on ThreadsCount threads,
+///        checks that no addition is lost and that no torn Triple or string is read.
+void SharedTest(int ThreadsCount, int Iterations)
+{
+    Shared<int> sum = 0;
+    Shared<Triple> triple = Triple{ 0, 0, 0 };
+    Shared<std::string> text = std::string(64, '0');
+    std::atomic<int> torn(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < ThreadsCount; t++)
+        threads.emplace_back([&, t]()
+        {
+            for (int i = 0; i < Iterations; i++)
+            {
+                sum.FetchAdd(1);
+                if (i % 2 == t % 2)
+                {
+                    triple = Triple{ i, i, i };
+                    text = std::string(64, (char)('0' + i % 10));
+                }
+                else
+                {
+                    Triple value = triple;
+                    if (value.A != value.B || value.B != value.C) torn++;
+                    std::string str = text;
+                    if (str.find_first_not_of(str[0]) != std::string::npos) torn++;
+                }
+            }
+        });
+    for (auto& t : threads) t.join();
+    print("Lock-free: int: " << (Shared<int>::IsLockFree() ? "yes" : "no") << ", Triple: " << (Shared<Triple>::IsLockFree() ? "yes" : "no")
+        << ", std::string: " << (Shared<std::string>::IsLockFree() ? "yes" : "no"));
+    print("Sum: " << sum.Get() << "/" << ThreadsCount * Iterations << ", Torn reads: " << torn
+        << (sum.Get() == ThreadsCount * Iterations && torn == 0 ? "" : " (FAILED)"));
+}
+
 int main()
 {
     std::vector<std::shared_ptr<TestThread>> Threads;
@@ -744,9 +1140,18 @@ int main()
         while (true)
         {
             std::string str;
-            print("Enter c to clear, n to create a new thread, s to start, or q (or e) to quit:");
+            print("Enter c to clear, n to create a new thread, s to start, f to compare the fairness policies,");
+            print("x <threads> <iterations> to test the exclusion of the locks,");
+            print("r <threads> <iterations> to test the counting of the nested shared-locks,");
+            print("m <mutexes> <iterations> to test holding the shared-locks of many mutexes,");
+            print("v <threads> <iterations> to test the Shared values, or q (or e) to quit:");
             input(str);
             if (str == "c") { NextThreadID = 0; Threads.clear(); }
+            else if (str == "f") FairnessTest();
+            else if (str == "x") { int threads, iterations; input(threads >> iterations); ExclusionTest(threads, iterations); }
+            else if (str == "r") { int threads, iterations; input(threads >> iterations); SharedCountingTest(threads, iterations); }
+            else if (str == "m") { int mutexes, iterations; input(mutexes >> iterations); ManySharedLocksTest(mutexes, iterations); }
+            else if (str == "v") { int threads, iterations; input(threads >> iterations); SharedTest(threads, iterations); }
             else if (str == "n") Threads.push_back(std::shared_ptr<TestThread>(new TestThread()));
             else if (str == "s") break;
             else if (str == "q" || str == "e") return 0;